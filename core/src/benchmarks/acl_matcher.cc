@@ -0,0 +1,86 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "include/bareos.h"
+#include "benchmark/benchmark.h"
+
+#include "dird/ua.h"
+
+#include <string>
+#include <vector>
+
+using namespace directordaemon;
+namespace bm = benchmark;
+
+/* ACL lists as used by restricted consoles of big installations: a lot of
+ * literal client names with a few patterns in between.  Every row of a
+ * "list jobs" or of a .bvfs command is checked against such a list. */
+
+namespace {
+std::vector<std::string> MakeAclList(int num_entries)
+{
+  std::vector<std::string> list;
+  for (int i = 0; i < num_entries; ++i) {
+    if (i % 100 == 99) {
+      list.push_back("!tenant-" + std::to_string(i) + "-.*");
+    } else {
+      list.push_back("client-" + std::to_string(i) + "-fd");
+    }
+  }
+  return list;
+}
+
+std::vector<std::string> MakeItems(int num_entries)
+{
+  std::vector<std::string> items;
+  for (int i = 0; i < num_entries; i += num_entries / 10) {
+    items.push_back("client-" + std::to_string(i) + "-fd");
+  }
+  items.push_back("tenant-" + std::to_string(num_entries - 1) + "-fd");
+  items.push_back("unknown-fd");
+  return items;
+}
+}  // namespace
+
+static void BM_AclMatcherBuild(bm::State& state)
+{
+  auto list = MakeAclList(state.range(0));
+
+  for (auto _ : state) { bm::DoNotOptimize(AclMatcher(list)); }
+
+  state.SetItemsProcessed(state.iterations() * list.size());
+}
+BENCHMARK(BM_AclMatcherBuild)->RangeMultiplier(10)->Range(10, 10'000);
+
+static void BM_AclMatcherFind(bm::State& state)
+{
+  AclMatcher matcher(MakeAclList(state.range(0)));
+  auto items = MakeItems(state.range(0));
+
+  for (auto _ : state) {
+    for (auto& item : items) {
+      bm::DoNotOptimize(
+          matcher.Find(Client_ACL, item.c_str(), item.size()));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * items.size());
+}
+BENCHMARK(BM_AclMatcherFind)->RangeMultiplier(10)->Range(10, 10'000);
@@ -0,0 +1,183 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "include/bareos.h"
+#include "benchmark/benchmark.h"
+
+#include "dird/dird_conf.h"
+#include "dird/dird_globals.h"
+#include "lib/parse_conf.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace directordaemon;
+namespace bm = benchmark;
+
+/* Generates director configurations with N clients, N filesets and N jobs
+ * and measures how long it takes to parse them, to parse them again while
+ * the old configuration is still alive (as done by reload) and to look up
+ * resources by name. */
+
+namespace {
+std::string ConfigFile(int num_resources)
+{
+  auto path = std::filesystem::temp_directory_path()
+              / ("bareos-config-lookup-" + std::to_string(num_resources)
+                 + ".conf");
+
+  std::ofstream out(path);
+  out << "Director {\n"
+         "  Name = bareos-dir\n"
+         "  Password = \"dir_password\"\n"
+         "  Messages = Daemon\n"
+         "  Working Directory = \"/tmp\"\n"
+         "}\n"
+         "Messages {\n  Name = Daemon\n}\n"
+         "Messages {\n  Name = Standard\n}\n"
+         "Catalog {\n"
+         "  Name = MyCatalog\n"
+         "  DB Name = bareos\n"
+         "  DB User = bareos\n"
+         "}\n"
+         "Storage {\n"
+         "  Name = File\n"
+         "  Address = localhost\n"
+         "  Password = \"sd_password\"\n"
+         "  Device = FileStorage\n"
+         "  Media Type = File\n"
+         "}\n"
+         "Pool {\n  Name = Full\n  Pool Type = Backup\n}\n"
+         "Schedule {\n"
+         "  Name = Nightly\n"
+         "  Run = Level=Full mon at 2:05\n"
+         "}\n"
+         "JobDefs {\n"
+         "  Name = DefaultJob\n"
+         "  Type = Backup\n"
+         "  Level = Incremental\n"
+         "  Schedule = Nightly\n"
+         "  Storage = File\n"
+         "  Messages = Standard\n"
+         "  Pool = Full\n"
+         "}\n";
+  for (int i = 0; i < num_resources; ++i) {
+    const std::string n = std::to_string(i);
+    out << "Client {\n"
+           "  Name = client-" << n << "\n"
+           "  Address = client-" << n << ".example.com\n"
+           "  Password = \"fd_password\"\n"
+           "}\n"
+           "FileSet {\n"
+           "  Name = fileset-" << n << "\n"
+           "  Include {\n"
+           "    File = /srv/" << n << "\n"
+           "  }\n"
+           "}\n"
+           "Job {\n"
+           "  Name = job-" << n << "\n"
+           "  JobDefs = DefaultJob\n"
+           "  Client = client-" << n << "\n"
+           "  FileSet = fileset-" << n << "\n"
+           "}\n";
+  }
+  return path.string();
+}
+
+std::unique_ptr<ConfigurationParser> ParsedConfig(const std::string& file)
+{
+  std::unique_ptr<ConfigurationParser> config{
+      InitDirConfig(file.c_str(), M_ERROR_TERM)};
+  my_config = config.get();
+  my_config->ParseConfig();
+  return config;
+}
+}  // namespace
+
+static void BM_ParseConfig(bm::State& state)
+{
+  OSDependentInit();
+  const std::string file = ConfigFile(state.range(0));
+
+  for (auto _ : state) {
+    auto config = ParsedConfig(file);
+
+    state.PauseTiming();
+    config.reset();
+    my_config = nullptr;
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 3);
+}
+BENCHMARK(BM_ParseConfig)
+    ->RangeMultiplier(4)
+    ->Range(100, 6'400)
+    ->Unit(bm::kMillisecond);
+
+static void BM_ReloadConfig(bm::State& state)
+{
+  OSDependentInit();
+  auto config = ParsedConfig(ConfigFile(state.range(0)));
+
+  for (auto _ : state) {
+    auto previous = my_config->BackupCurrentConfiguration();
+    my_config->ParseConfig();
+
+    state.PauseTiming();
+    previous.reset();
+    state.ResumeTiming();
+  }
+
+  my_config = nullptr;
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 3);
+}
+BENCHMARK(BM_ReloadConfig)
+    ->RangeMultiplier(4)
+    ->Range(100, 6'400)
+    ->Unit(bm::kMillisecond);
+
+static void BM_GetResWithName(bm::State& state)
+{
+  OSDependentInit();
+  const int num_resources = state.range(0);
+  auto config = ParsedConfig(ConfigFile(num_resources));
+
+  std::vector<std::string> names;
+  std::mt19937 gen;
+  std::uniform_int_distribution<int> dist(0, num_resources - 1);
+  for (int i = 0; i < 1'000; ++i) {
+    names.push_back("client-" + std::to_string(dist(gen)));
+  }
+
+  for (auto _ : state) {
+    for (auto& name : names) {
+      bm::DoNotOptimize(my_config->GetResWithName(R_CLIENT, name.c_str()));
+    }
+  }
+
+  my_config = nullptr;
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_GetResWithName)->RangeMultiplier(4)->Range(100, 6'400);
@@ -0,0 +1,142 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "include/bareos.h"
+#include "benchmark/benchmark.h"
+
+#include "dird/dird.h"
+#include "dird/dird_conf.h"
+#include "dird/director_jcr_impl.h"
+#include "dird/jcr_util.h"
+#include "dird/jobq.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace directordaemon;
+namespace bm = benchmark;
+
+/* Queues a lot of jobs that compete for a few client slots and measures how
+ * long it takes until all of them went through the job queue.  The jobs
+ * themselves do nothing, so this is all dispatch overhead, i.e. the time
+ * between a job releasing its slot and the next job being started. */
+
+namespace {
+constexpr int kWorkers = 20;
+constexpr int kSlotsPerClient = 2;
+
+std::mutex done_mutex;
+std::condition_variable done_cv;
+int jobs_left = 0;
+
+void* RunEngine(void* arg)
+{
+  JobControlRecord* jcr = (JobControlRecord*)arg;
+
+  jcr->setJobStatus(JS_Terminated);
+
+  std::unique_lock lock(done_mutex);
+  if (--jobs_left == 0) { done_cv.notify_one(); }
+  return nullptr;
+}
+
+struct test_config {
+  JobResource job;
+  std::vector<std::unique_ptr<ClientResource>> clients;
+
+  test_config(int num_clients, int num_jobs)
+  {
+    job.resource_name_ = const_cast<char*>("dispatch-job");
+    job.MaxConcurrentJobs = num_jobs;
+    job.rjs = std::make_shared<RuntimeJobStatus>();
+    for (int i = 0; i < num_clients; ++i) {
+      auto& client = clients.emplace_back(std::make_unique<ClientResource>());
+      client->resource_name_ = const_cast<char*>("dispatch-client");
+      client->MaxConcurrentJobs = kSlotsPerClient;
+      client->rcs = std::make_shared<RuntimeClientStatus>();
+    }
+  }
+
+  ~test_config()
+  {
+    job.resource_name_ = nullptr;
+    for (auto& client : clients) { client->resource_name_ = nullptr; }
+  }
+};
+
+JobControlRecord* MakeJob(test_config& config, int num)
+{
+  JobControlRecord* jcr = NewDirectorJcr(nullptr);
+  jcr->setJobType(JT_BACKUP);
+  jcr->setJobLevel(L_INCREMENTAL);
+  jcr->JobPriority = 10;
+  jcr->dir_impl->res.job = &config.job;
+  jcr->dir_impl->res.rjs = config.job.rjs;
+  jcr->dir_impl->res.client
+      = config.clients[num % config.clients.size()].get();
+  jcr->dir_impl->max_concurrent_jobs = config.job.MaxConcurrentJobs;
+  return jcr;
+}
+}  // namespace
+
+static void BM_JobqDispatch(bm::State& state)
+{
+  const int num_jobs = state.range(0);
+  const int num_clients = state.range(1);
+  test_config config(num_clients, num_jobs);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    jobq_t jq{};
+    JobqInit(&jq, kWorkers, RunEngine);
+    std::vector<JobControlRecord*> jcrs;
+    for (int i = 0; i < num_jobs; ++i) {
+      jcrs.push_back(MakeJob(config, i));
+    }
+    jobs_left = num_jobs;
+    state.ResumeTiming();
+
+    for (auto* jcr : jcrs) {
+      JobqAdd(&jq, jcr);
+      FreeJcr(jcr); /* the queue holds its own reference */
+    }
+
+    {
+      std::unique_lock lock(done_mutex);
+      done_cv.wait(lock, [] { return jobs_left == 0; });
+    }
+
+    state.PauseTiming();
+    JobqDestroy(&jq);
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_jobs);
+}
+BENCHMARK(BM_JobqDispatch)
+    ->ArgNames({"jobs", "clients"})
+    ->Args({1'000, 1})
+    ->Args({1'000, 100})
+    ->Args({10'000, 1})
+    ->Args({10'000, 100})
+    ->Unit(bm::kMillisecond)
+    ->UseRealTime();
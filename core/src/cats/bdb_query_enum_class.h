@@ -93,7 +93,14 @@ class BareosDbQueryEnum {
     subscription_units_client_total_3 = 82,
     subscription_units_plugin_total_1 = 83,
     subscription_client_detail_2 = 84,
-    SQL_QUERY_NUMBER = 85
+    prepared_insert_jobmedia_10 = 85,
+    prepared_update_media_endblock_3 = 86,
+    prepared_update_media_lastwritten_2 = 87,
+    prepared_update_media_31 = 88,
+    prepared_insert_file_9 = 89,
+    prepared_find_next_volume_4 = 90,
+    prepared_find_next_volume_inchanger_5 = 91,
+    SQL_QUERY_NUMBER = 92
   };
 };
 
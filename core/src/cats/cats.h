@@ -45,6 +45,10 @@
 #include "lib/util.h"
 
 #include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
 #include <string>
 #include <stdexcept>
 #include <system_error>
@@ -483,6 +487,43 @@ typedef struct sql_field {
   uint32_t flags = 0;         /* flags */
 } SQL_FIELD;
 
+/**
+ * A parameter of a prepared statement.
+ * Integers are sent as binary int8 values, everything else is sent as text
+ * and gets its type from the place where it is used in the statement.
+ * Strings are not copied, so they have to outlive the query.
+ */
+class SqlParam {
+ public:
+  SqlParam(int32_t value) : SqlParam(static_cast<int64_t>(value)) {}
+  SqlParam(uint32_t value) : SqlParam(static_cast<int64_t>(value)) {}
+  SqlParam(int64_t value) : binary_{true}
+  {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = sizeof(int8_) - 1; i >= 0; --i) {
+      int8_[i] = static_cast<char>(bits & 0xff);
+      bits >>= 8;
+    }
+  }
+  // may not fit into an int8, so the server has to parse it
+  SqlParam(uint64_t value) : owned_{std::to_string(value)} {}
+  SqlParam(const char* value) : borrowed_{value} {}
+
+  const char* value() const
+  {
+    if (binary_) { return int8_; }
+    return borrowed_ ? borrowed_ : owned_.c_str();
+  }
+  int length() const { return binary_ ? sizeof(int8_) : 0; }
+  bool IsBinary() const { return binary_; }
+
+ private:
+  bool binary_{false};
+  char int8_[8]{};
+  const char* borrowed_{nullptr};
+  std::string owned_{};
+};
+
 class BareosSqlError : public std::runtime_error {
  public:
   BareosSqlError(const char* what) : std::runtime_error(what) {}
@@ -516,6 +557,13 @@ class BareosDb : public BareosDbQueryEnum {
   bool disabled_batch_insert_
       = false;                 /**< Explicitly disabled batch insert mode ? */
   bool is_private_ = false;    /**< Private connection ? */
+  std::optional<bool> file_partitioned_{}; /**< File table partitioned ? */
+  JobId_t file_partition_job_ = 0; /**< Last job whose File partition exists */
+  struct {
+    uint64_t prepared = 0; /**< Statements prepared on this connection */
+    uint64_t hits = 0;     /**< Executions of already prepared statements */
+    std::chrono::microseconds plan_time{0}; /**< Time spent preparing */
+  } prepared_stats_;
   uint32_t cached_path_id = 0; /**< Cached path id */
   uint32_t last_hash_key_ = 0; /**< Last hash key lookup on query table */
   POOLMEM* fname = nullptr;    /**< Filename only */
@@ -585,6 +633,9 @@ class BareosDb : public BareosDbQueryEnum {
   /* sql.c */
  private:
   void ListDashes(OutputFormatter* send);
+  bool FileTableIsPartitioned();
+  void ExpireFilePartitions();
+  void DropFilePartitions(const std::vector<std::string>& expired);
 
  public:
   char* strerror(libbareos::source_location loc
@@ -636,6 +687,7 @@ class BareosDb : public BareosDbQueryEnum {
   bool CreateStorageRecord(JobControlRecord* jcr, StorageDbRecord* sr);
   bool CreateMediatypeRecord(JobControlRecord* jcr, MediaTypeDbRecord* mr);
   bool WriteBatchFileRecords(JobControlRecord* jcr);
+  bool CreateFilePartition(JobId_t JobId);
   bool CreateAttributesRecord(JobControlRecord* jcr, AttributesDbRecord* ar);
   bool CreateRestoreObjectRecord(JobControlRecord* jcr,
                                  RestoreObjectDbRecord* ar);
@@ -928,6 +980,10 @@ class BareosDb : public BareosDbQueryEnum {
   bool SqlQuery(const char* query);
   bool SqlExec(const char* query);  // like SqlQuery, but does not store result
   bool SqlQuery(const char* query, DB_RESULT_HANDLER* ResultHandler, void* ctx);
+  /* Like SqlQuery, but runs a predefined query as prepared statement.
+   * Its placeholders $1, $2, ... are taken from params. */
+  bool SqlQueryPrepared(SQL_QUERY query,
+                        std::initializer_list<SqlParam> params);
 
   /* sql_update.cc */
   bool UpdateJobStartRecord(JobControlRecord* jcr, JobDbRecord* jr);
@@ -1044,6 +1100,10 @@ class BareosDb : public BareosDbQueryEnum {
                                    DB_RESULT_HANDLER* ResultHandler,
                                    void* ctx)
       = 0;
+  virtual bool SqlQueryPreparedWithoutHandler(SQL_QUERY query,
+                                              const SqlParam* params,
+                                              int num_params)
+      = 0;
   virtual const char* sql_strerror(void) = 0;
   virtual void SqlDataSeek(int row) = 0;
   virtual int SqlAffectedRows(void) = 0;
@@ -1,11 +1,16 @@
 DROP FUNCTION IF EXISTS decode_lstat();
 DROP FUNCTION IF EXISTS bareos_frombase64();
+DROP FUNCTION IF EXISTS bareos_file_partition(INTEGER);
+DROP FUNCTION IF EXISTS bareos_expired_file_partitions();
+DROP FUNCTION IF EXISTS bareos_drop_file_partition(TEXT);
 DROP VIEW IF EXISTS backup_unit_overview;
 DROP VIEW IF EXISTS latest_full_size_categorized;
 -- DROP TABLE IF EXISTS unsavedfiles;
 DROP TABLE IF EXISTS basefiles;
 DROP TABLE IF EXISTS jobmedia;
 DROP TABLE IF EXISTS file;
+DROP TABLE IF EXISTS FilePartition;
+DROP TABLE IF EXISTS FilePartitioning;
 DROP TABLE IF EXISTS job;
 DROP TABLE IF EXISTS jobhisto;
 DROP TABLE IF EXISTS media;
@@ -11,3 +11,14 @@ GRANT SELECT, UPDATE ON ALL SEQUENCES IN SCHEMA public TO @DB_USER@;
 
 -- For functions 
 GRANT EXECUTE ON ALL FUNCTIONS IN SCHEMA public TO @DB_USER@;
+
+-- Expired partitions of a partitioned File table are detached by the
+-- catalog user, which requires ownership of the table
+DO $$
+BEGIN
+  IF EXISTS (SELECT 1 FROM pg_partitioned_table
+             WHERE partrelid = to_regclass('file')) THEN
+    ALTER TABLE File OWNER TO @DB_USER@;
+  END IF;
+END
+$$;
@@ -0,0 +1,192 @@
+-- Convert the File table into a table partitioned by JobId ranges.
+--
+-- When all jobs of a partition have their files purged, the whole
+-- partition gets detached and dropped instead of deleting its rows one
+-- by one, which avoids the I/O and vacuum load of huge DELETEs.
+--
+-- Existing file records stay where they are: the current File table
+-- becomes the first partition, covering all JobIds that exist already.
+-- This needs one scan of the table to validate the partition bounds and
+-- builds a new primary key index, so plan for the time and disk space.
+--
+-- The script can be run on a new and on an existing catalog and does
+-- nothing if the File table is already partitioned.  It needs PostgreSQL 14
+-- or later (DETACH PARTITION CONCURRENTLY), older servers are refused.
+
+DO $$
+BEGIN
+  IF current_setting('server_version_num')::integer < 140000 THEN
+    RAISE EXCEPTION 'Partitioning the File table needs PostgreSQL 14 or later';
+  END IF;
+END
+$$;
+
+begin;
+
+CREATE TABLE IF NOT EXISTS FilePartitioning (
+   JobIdsPerPartition INTEGER NOT NULL CHECK (JobIdsPerPartition > 0)
+);
+
+CREATE TABLE IF NOT EXISTS FilePartition (
+   Name             TEXT      NOT NULL,
+   FromJobId        INTEGER   NOT NULL,
+   ToJobId          INTEGER   NOT NULL,
+   PRIMARY KEY (Name)
+);
+
+DO $$
+DECLARE
+  width INTEGER := 1000;
+  boundary INTEGER;
+BEGIN
+  IF EXISTS (SELECT 1 FROM pg_partitioned_table
+             WHERE partrelid = to_regclass('file')) THEN
+    RAISE NOTICE 'File table is already partitioned';
+    RETURN;
+  END IF;
+
+  IF NOT EXISTS (SELECT 1 FROM FilePartitioning) THEN
+    INSERT INTO FilePartitioning (JobIdsPerPartition) VALUES (width);
+  END IF;
+  SELECT JobIdsPerPartition INTO width FROM FilePartitioning;
+
+  LOCK TABLE File IN ACCESS EXCLUSIVE MODE;
+  SELECT (GREATEST(COALESCE(MAX(JobId), 0),
+                   (SELECT COALESCE(MAX(JobId), 0) FROM File)) / width + 1)
+         * width
+    INTO boundary FROM Job;
+
+  ALTER TABLE File RENAME TO file_p0;
+  -- replaced by the primary key of the partitioned table
+  ALTER TABLE file_p0 DROP CONSTRAINT file_pkey;
+  ALTER INDEX file_jpfid_idx RENAME TO file_p0_jpfid_idx;
+  ALTER INDEX file_pjidpart_idx RENAME TO file_p0_pjidpart_idx;
+
+  CREATE TABLE File (
+     FileId           BIGINT      NOT NULL
+                                  DEFAULT nextval('file_fileid_seq'),
+     FileIndex        INTEGER     NOT NULL  DEFAULT 0,
+     JobId            INTEGER     NOT NULL,
+     PathId           INTEGER     NOT NULL,
+     DeltaSeq         SMALLINT    NOT NULL  DEFAULT 0,
+     MarkId           INTEGER     NOT NULL  DEFAULT 0,
+     Fhinfo           NUMERIC(20) NOT NULL  DEFAULT 0,
+     Fhnode           NUMERIC(20) NOT NULL  DEFAULT 0,
+     LStat            TEXT        NOT NULL,
+     Md5              TEXT        NOT NULL,
+     Name             TEXT        NOT NULL,
+     PRIMARY KEY (FileId, JobId)
+  ) PARTITION BY RANGE (JobId);
+  ALTER SEQUENCE file_fileid_seq OWNED BY File.FileId;
+  CREATE INDEX file_jpfid_idx ON File (JobId, PathId, Name);
+  CREATE INDEX file_pjidpart_idx ON File(PathId,JobId)
+    WHERE FileIndex = 0 AND Name = '';
+
+  -- lets ATTACH skip its own validation scan
+  EXECUTE format('ALTER TABLE file_p0 ADD CONSTRAINT file_p0_jobid_check '
+                 'CHECK (JobId >= 0 AND JobId < %s)', boundary);
+  EXECUTE format('ALTER TABLE File ATTACH PARTITION file_p0 '
+                 'FOR VALUES FROM (0) TO (%s)', boundary);
+  ALTER TABLE file_p0 DROP CONSTRAINT file_p0_jobid_check;
+  INSERT INTO FilePartition (Name, FromJobId, ToJobId)
+    VALUES ('file_p0', 0, boundary);
+END
+$$;
+
+-- Returns the name of the partition that holds the files of the given job.
+-- The partition gets created when it does not exist yet.
+CREATE OR REPLACE FUNCTION bareos_file_partition(job INTEGER)
+RETURNS TEXT AS $$
+DECLARE
+  width INTEGER;
+  first INTEGER;
+  part TEXT;
+BEGIN
+  SELECT Name INTO part FROM FilePartition
+    WHERE job >= FromJobId AND job < ToJobId;
+  IF FOUND THEN
+    RETURN part;
+  END IF;
+
+  LOCK TABLE FilePartition IN SHARE ROW EXCLUSIVE MODE;
+  SELECT Name INTO part FROM FilePartition
+    WHERE job >= FromJobId AND job < ToJobId;
+  IF FOUND THEN
+    RETURN part;
+  END IF;
+
+  SELECT JobIdsPerPartition INTO width FROM FilePartitioning;
+  first := (job / width) * width;
+  -- a previous partition may end in the middle of this range
+  SELECT GREATEST(first, COALESCE(MAX(ToJobId), 0)) INTO first
+    FROM FilePartition WHERE ToJobId <= job;
+  part := 'file_p' || first;
+  EXECUTE format('CREATE TABLE %I PARTITION OF File '
+                 'FOR VALUES FROM (%s) TO (%s)',
+                 part, first, (job / width + 1) * width);
+  INSERT INTO FilePartition (Name, FromJobId, ToJobId)
+    VALUES (part, first, (job / width + 1) * width);
+  RETURN part;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+-- Returns the partitions whose jobs either have their files purged or do
+-- not exist anymore.  Partitions that can still receive new jobs are left
+-- out.  The director detaches them with DETACH PARTITION CONCURRENTLY, which
+-- cannot run inside a function, and drops them afterwards with
+-- bareos_drop_file_partition().
+DROP FUNCTION IF EXISTS bareos_expire_file_partitions();
+CREATE OR REPLACE FUNCTION bareos_expired_file_partitions()
+RETURNS SETOF TEXT AS $$
+DECLARE
+  next_job INTEGER;
+BEGIN
+  SELECT COALESCE(MAX(JobId), 0) + 1 INTO next_job FROM Job;
+  RETURN QUERY
+    SELECT part.Name FROM FilePartition part
+    WHERE part.ToJobId <= next_job
+      AND NOT EXISTS (SELECT 1 FROM Job
+                      WHERE JobId >= part.FromJobId AND JobId < part.ToJobId
+                        AND PurgedFiles = 0)
+    ORDER BY part.FromJobId;
+END;
+$$ LANGUAGE plpgsql STABLE SECURITY DEFINER SET search_path = public;
+
+-- Drops a partition that was detached from the File table.  Returns false
+-- if it is still attached (or its detach was not finalized yet).
+CREATE OR REPLACE FUNCTION bareos_drop_file_partition(part TEXT)
+RETURNS BOOLEAN AS $$
+BEGIN
+  IF NOT EXISTS (SELECT 1 FROM FilePartition WHERE Name = part) THEN
+    RAISE EXCEPTION '% is no partition of the File table', part;
+  END IF;
+  IF EXISTS (SELECT 1 FROM pg_inherits
+             WHERE inhrelid = to_regclass(quote_ident(part))) THEN
+    RETURN FALSE;
+  END IF;
+  EXECUTE format('DROP TABLE IF EXISTS %I', part);
+  DELETE FROM FilePartition WHERE Name = part;
+  RETURN TRUE;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = public;
+
+commit;
+
+-- Detaching partitions requires ownership of the File table, so hand it to
+-- the catalog user when the database scripts tell us who that is and the
+-- role already exists. Otherwise grant_bareos_privileges does it.
+\if :{?db_user}
+select set_config('bareos.db_user', :'db_user', false);
+DO $$
+BEGIN
+  IF EXISTS (SELECT 1 FROM pg_roles
+             WHERE rolname = current_setting('bareos.db_user')) THEN
+    EXECUTE format('ALTER TABLE File OWNER TO %I',
+                   current_setting('bareos.db_user'));
+  END IF;
+END
+$$;
+\endif
+
+set client_min_messages = warning;
+analyze File;
@@ -41,6 +41,7 @@
 #include "lib/edit.h"
 #include "lib/berrno.h"
 #include "lib/dlist.h"
+#include "lib/metrics.h"
 
 /* -----------------------------------------------------------------------
  *
@@ -52,6 +53,25 @@
 static pthread_mutex_t db_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 static dlist<BareosDbPostgresql>* db_list = NULL;
 
+// Wall clock time of catalog queries as seen by the daemon
+static metrics::Histogram& QueryDuration(bool prepared)
+{
+  static constexpr const char* help = "Duration of catalog queries";
+  static metrics::Histogram& plain = metrics::Global().GetHistogram(
+      "bareos_catalog_query_duration_seconds", help, {{"kind", "plain"}});
+  static metrics::Histogram& prepared_queries = metrics::Global().GetHistogram(
+      "bareos_catalog_query_duration_seconds", help, {{"kind", "prepared"}});
+  return prepared ? prepared_queries : plain;
+}
+
+static void ObserveQuery(bool prepared,
+                         std::chrono::steady_clock::time_point start)
+{
+  QueryDuration(prepared).Observe(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count());
+}
+
 namespace postgres {
 
 struct result_deleter {
@@ -80,23 +100,25 @@ result do_query(PGconn* db_handle, const char* query, retries r = {10})
 
 const char* strerror(PGconn* db_handle) { return PQerrorMessage(db_handle); }
 
+bool reconnect(PGconn* db_handle)
+{
+  PQreset(db_handle);
+  if (PQstatus(db_handle) != CONNECTION_OK) { return false; }
+  return static_cast<bool>(do_query(db_handle,
+                                    "SET datestyle TO 'ISO, YMD';"
+                                    "SET cursor_tuple_fraction=1;"
+                                    "SET standard_conforming_strings=on;"
+                                    "SET client_min_messages TO WARNING;",
+                                    retries{1}));
+}
+
 result try_query(PGconn* db_handle, bool try_reconnection, const char* query)
 {
   Dmsg1(500, "try_query starts with '%s'\n", query);
 
   auto res = do_query(db_handle, query);
-  if (!res && try_reconnection) {
-    PQreset(db_handle);
-    if (PQstatus(db_handle) == CONNECTION_OK) {
-      if (do_query(db_handle,
-                   "SET datestyle TO 'ISO, YMD';"
-                   "SET cursor_tuple_fraction=1;"
-                   "SET standard_conforming_strings=on;"
-                   "SET client_min_messages TO WARNING;",
-                   retries{1})) {
-        res = do_query(db_handle, query);
-      }
-    }
+  if (!res && try_reconnection && reconnect(db_handle)) {
+    res = do_query(db_handle, query);
   }
   if (res) {
     Dmsg1(500, "try_query succeeded with query %s", query);
@@ -324,6 +346,11 @@ void BareosDbPostgresql::CloseDatabase(JobControlRecord* jcr)
   ref_count_--;
   if (ref_count_ == 0) {
     if (connected_) { SqlFreeResult(); }
+    Dmsg3(100,
+          "Prepared statements: %" PRIu64 " prepared, %" PRIu64
+          " hits, %lldus planning\n",
+          prepared_stats_.prepared, prepared_stats_.hits,
+          static_cast<long long>(prepared_stats_.plan_time.count()));
     db_list->remove(this);
     if (db_handle_) { PQfinish(db_handle_); }
     if (RwlIsInit(&lock_)) { RwlDestroy(&lock_); }
@@ -612,19 +639,13 @@ bool BareosDbPostgresql::SqlQueryWithoutHandler(const char* query,
                                                 query_flags flags)
 {
   CheckOwnership();
+  auto start = std::chrono::steady_clock::now();
   auto result
       = postgres::try_query(db_handle_, try_reconnect_ && !transaction_, query);
+  ObserveQuery(false, start);
   if (result) {
     if (!flags.test(query_flag::DiscardResult)) {
-      PQclear(result_);
-      result_ = result.release();
-      field_number_ = -1;
-      fields_fetched_ = false;
-      num_fields_ = (int)PQnfields(result_);
-      Dmsg1(500, "We have %d fields\n", num_fields_);
-      num_rows_ = PQntuples(result_);
-      Dmsg1(500, "We have %d rows\n", num_rows_);
-      row_number_ = 0; /* we can start to fetch something */
+      StoreResult(result.release());
     }
     return true;
   } else {
@@ -632,6 +653,119 @@ bool BareosDbPostgresql::SqlQueryWithoutHandler(const char* query,
   }
 }
 
+/**
+ * Make sure the predefined query is prepared on the current server
+ * connection.  Integer parameters are declared as int8, the types of
+ * all others are inferred by the server.
+ */
+bool BareosDbPostgresql::PrepareStatement(SQL_QUERY query,
+                                          const SqlParam* params,
+                                          int num_params)
+{
+  static constexpr Oid kInt8Oid = 20;
+  const size_t index = static_cast<size_t>(query);
+  const int backend_pid = PQbackendPID(db_handle_);
+
+  // After a reconnect the statements of the old session are gone.
+  if (backend_pid != prepared_backend_pid_) {
+    prepared_.reset();
+    prepared_backend_pid_ = backend_pid;
+  }
+
+  if (prepared_.test(index)) {
+    prepared_stats_.hits++;
+    return true;
+  }
+
+  std::vector<Oid> types(num_params);
+  for (int i = 0; i < num_params; ++i) {
+    types[i] = params[i].IsBinary() ? kInt8Oid : 0;
+  }
+
+  const char* name = get_predefined_query_name(query);
+  auto start = std::chrono::steady_clock::now();
+  postgres::result res{PQprepare(db_handle_, name, get_predefined_query(query),
+                                 num_params, types.data())};
+  prepared_stats_.plan_time
+      += std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start);
+
+  if (!res || PQresultStatus(res.get()) != PGRES_COMMAND_OK) {
+    Dmsg2(50, "Could not prepare %s: %s", name, sql_strerror());
+    return false;
+  }
+
+  Dmsg1(500, "Prepared statement %s\n", name);
+  prepared_.set(index);
+  prepared_stats_.prepared++;
+  return true;
+}
+
+/**
+ * Run a predefined query as prepared statement.  The statement gets
+ * prepared on first use and is reused for the lifetime of the server
+ * connection, so parsing and planning are only done once.
+ *
+ * Returns:  true  on success
+ *           false on failure
+ */
+bool BareosDbPostgresql::SqlQueryPreparedWithoutHandler(SQL_QUERY query,
+                                                        const SqlParam* params,
+                                                        int num_params)
+{
+  CheckOwnership();
+
+  std::vector<const char*> values(num_params);
+  std::vector<int> lengths(num_params);
+  std::vector<int> formats(num_params);
+  for (int i = 0; i < num_params; ++i) {
+    values[i] = params[i].value();
+    lengths[i] = params[i].length();
+    formats[i] = params[i].IsBinary() ? 1 : 0;
+  }
+
+  const char* name = get_predefined_query_name(query);
+  const bool try_reconnection = try_reconnect_ && !transaction_;
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    if (PrepareStatement(query, params, num_params)) {
+      auto start = std::chrono::steady_clock::now();
+      postgres::result res{PQexecPrepared(db_handle_, name, num_params,
+                                          values.data(), lengths.data(),
+                                          formats.data(), 0)};
+      ObserveQuery(true, start);
+      if (res) {
+        auto status = PQresultStatus(res.get());
+        if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK) {
+          StoreResult(res.release());
+          return true;
+        }
+      }
+    }
+
+    Dmsg2(50, "Prepared statement %s failed: %s", name, sql_strerror());
+    if (!try_reconnection || PQstatus(db_handle_) == CONNECTION_OK
+        || !postgres::reconnect(db_handle_)) {
+      break;
+    }
+  }
+
+  return false;
+}
+
+// Take ownership of the result and make its rows available for fetching.
+void BareosDbPostgresql::StoreResult(PGresult* result)
+{
+  PQclear(result_);
+  result_ = result;
+  field_number_ = -1;
+  fields_fetched_ = false;
+  num_fields_ = (int)PQnfields(result_);
+  Dmsg1(500, "We have %d fields\n", num_fields_);
+  num_rows_ = PQntuples(result_);
+  Dmsg1(500, "We have %d rows\n", num_rows_);
+  row_number_ = 0; /* we can start to fetch something */
+}
+
 void BareosDbPostgresql::SqlFreeResult(void)
 {
   DbLocker _{this};
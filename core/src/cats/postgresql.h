@@ -80,6 +80,9 @@ class BareosDbPostgresql : public BareosDb {
                            void* ctx) override;
   bool SqlQueryWithoutHandler(const char* query,
                               query_flags flags = {}) override;
+  bool SqlQueryPreparedWithoutHandler(SQL_QUERY query,
+                                      const SqlParam* params,
+                                      int num_params) override;
   void SqlFreeResult(void) override;
   SQL_ROW SqlFetchRow(void) override;
   const char* sql_strerror(void) override;
@@ -97,6 +100,10 @@ class BareosDbPostgresql : public BareosDb {
 
   bool CheckDatabaseEncoding();
   bool SetClientOptions();
+  bool PrepareStatement(SQL_QUERY query,
+                        const SqlParam* params,
+                        int num_params);
+  void StoreResult(PGresult* result);
 
   bool fields_fetched_
       = false;         /**< Marker, if field descriptions are already fetched */
@@ -109,6 +116,9 @@ class BareosDbPostgresql : public BareosDb {
   SQL_FIELD* fields_ = nullptr;     /**< Defined fields */
   bool allow_transactions_ = false; /**< Transactions allowed ? */
   bool transaction_ = false;        /**< Transaction started ? */
+  std::bitset<static_cast<size_t>(SQL_QUERY::SQL_QUERY_NUMBER)>
+      prepared_{};                  /**< Statements known to the server */
+  int prepared_backend_pid_ = 0;    /**< Server process they belong to */
 
   PGconn* db_handle_;
   PGresult* result_;
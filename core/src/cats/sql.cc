@@ -396,6 +396,26 @@ void BareosDb::SplitPathAndFile(JobControlRecord* jcr, const char* filename)
   Dmsg2(500, "split path=%s file=%s\n", path, fname);
 }
 
+/**
+ * Check whether the File table was converted into a table partitioned by
+ * JobId (see ddl/partitioning). The answer is cached per connection.
+ */
+bool BareosDb::FileTableIsPartitioned()
+{
+  if (!file_partitioned_) {
+    uint32_t count = 0;
+    if (!SqlQuery("SELECT COUNT(*) FROM pg_partitioned_table"
+                  " WHERE partrelid = to_regclass('file')",
+                  DbIntHandler, &count)) {
+      return false;
+    }
+    file_partitioned_ = count > 0;
+    Dmsg1(100, "File table is %spartitioned\n",
+          *file_partitioned_ ? "" : "not ");
+  }
+  return *file_partitioned_;
+}
+
 static int MaxLength(int MaxLength)
 {
   int max_len = MaxLength;
@@ -898,6 +918,11 @@ void BareosDb::DbDebugPrint(FILE* fp)
           NPRTB(get_db_name()), NPRTB(get_db_user()),
           IsConnected() ? "true" : "false");
   fprintf(fp, "\tcmd=\"%s\" changes=%i\n", NPRTB(cmd), changes);
+  fprintf(fp,
+          "\tprepared statements=%" PRIu64 " hits=%" PRIu64
+          " plan time=%lldus\n",
+          prepared_stats_.prepared, prepared_stats_.hits,
+          static_cast<long long>(prepared_stats_.plan_time.count()));
 
   PrintLockInfo(fp);
 }
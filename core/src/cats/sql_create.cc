@@ -33,8 +33,12 @@
 static const int dbglevel = 100;
 
 #include "cats.h"
+#include "cats/sql.h"
 #include "lib/edit.h"
 
+#include <set>
+#include <string>
+
 /* -----------------------------------------------------------------------
  *
  *   Generic Routines (or almost generic)
@@ -109,39 +113,32 @@ bool BareosDb::CreateJobmediaRecord(JobControlRecord* jcr, JobMediaDbRecord* jm)
   if (count < 0) { count = 0; }
   count++;
 
-  /* clang-format off */
-  Mmsg(cmd,
-       "INSERT INTO JobMedia (JobId,MediaId,FirstIndex,LastIndex,"
-       "StartFile,EndFile,StartBlock,EndBlock,VolIndex,JobBytes) "
-       "VALUES (%" PRIu32 ",%" PRIdbid ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu64 ")",
-       jm->JobId,
-       jm->MediaId,
-       jm->FirstIndex, jm->LastIndex,
-       jm->StartFile, jm->EndFile,
-       jm->StartBlock, jm->EndBlock,
-       static_cast<uint32_t>(count),
-       jm->JobBytes);
-  /* clang-format on */
-
-  Dmsg0(300, "%s", cmd);
-  if (InsertDb(jcr, cmd) != 1) {
-    Mmsg2(errmsg, T_("Create JobMedia record %s failed: ERR=%s\n"), cmd,
+  Dmsg3(300, "Create JobMedia JobId=%" PRIu32 " MediaId=%" PRIdbid
+        " VolIndex=%d\n",
+        jm->JobId, jm->MediaId, count);
+  if (!SqlQueryPrepared(SQL_QUERY::prepared_insert_jobmedia_10,
+                        {jm->JobId, jm->MediaId, jm->FirstIndex, jm->LastIndex,
+                         jm->StartFile, jm->EndFile, jm->StartBlock,
+                         jm->EndBlock, static_cast<uint32_t>(count),
+                         jm->JobBytes})
+      || SqlAffectedRows() != 1) {
+    Mmsg1(errmsg, T_("Create JobMedia record failed: ERR=%s\n"),
           sql_strerror());
-  } else {
-    // Worked, now update the Media record with the EndFile and EndBlock
-    Mmsg(cmd,
-         "UPDATE Media SET EndFile=%" PRIu32 ", EndBlock=%" PRIu32
-         " WHERE MediaId=%" PRIdbid,
-         jm->EndFile, jm->EndBlock, jm->MediaId);
-    if (UpdateDb(jcr, cmd) == -1) {
-      Mmsg2(errmsg, T_("Update Media record %s failed: ERR=%s\n"), cmd,
-            sql_strerror());
-    } else {
-      return true;
-    }
+    Jmsg(jcr, M_FATAL, 0, "%s", errmsg);
+    return false;
   }
+  changes++;
 
-  return false;
+  // Worked, now update the Media record with the EndFile and EndBlock
+  if (!SqlQueryPrepared(SQL_QUERY::prepared_update_media_endblock_3,
+                        {jm->EndFile, jm->EndBlock, jm->MediaId})) {
+    Mmsg1(errmsg, T_("Update Media record failed: ERR=%s\n"), sql_strerror());
+    Jmsg(jcr, M_ERROR, 0, "%s", errmsg);
+    return false;
+  }
+  changes++;
+
+  return true;
 }
 
 /**
@@ -771,6 +768,8 @@ bool BareosDb::WriteBatchFileRecords(JobControlRecord* jcr)
 {
   bool retval = false;
   int JobStatus = jcr->getJobStatus();
+  std::string file_table{"File"};
+  PoolMem query(PM_MESSAGE);
 
   if (!jcr->batch_started) { /* no files to backup ? */
     Dmsg0(50, "db_create_file_record : no files\n");
@@ -778,6 +777,8 @@ bool BareosDb::WriteBatchFileRecords(JobControlRecord* jcr)
   }
 
   DbLocker _{jcr->db_batch};
+  StageTimer timer(jcr->pipeline_stats, PipelineStage::kCatalogInsert);
+  timer.SetItems(jcr->db_batch->changes);
 
   Dmsg1(50, "db_create_file_record changes=%d\n", changes);
 
@@ -808,17 +809,38 @@ bool BareosDb::WriteBatchFileRecords(JobControlRecord* jcr)
     goto bail_out;
   }
 
+  if (jcr->db_batch->FileTableIsPartitioned()) {
+    /* Every job in the batch (bscan mixes them) needs its partition.  A
+     * batch normally holds the files of a single job, these can go straight
+     * into the partition of that job. */
+    std::set<std::string> partitions;
+    auto partition = [&partitions](int, char** row) {
+      if (row[0]) { partitions.insert(row[0]); }
+      return true;
+    };
+    if (!jcr->db_batch->SqlQuery("SELECT bareos_file_partition(JobId)"
+                                 " FROM (SELECT DISTINCT JobId FROM batch) jobs",
+                                 ObjectHandler<decltype(partition)>,
+                                 &partition)) {
+      Jmsg1(jcr, M_FATAL, 0, "Create File partition %s\n",
+            jcr->db_batch->strerror());
+      goto bail_out;
+    }
+    if (partitions.size() == 1) { file_table = *partitions.begin(); }
+  }
+
   /* clang-format off */
-  if (!jcr->db_batch->SqlQuery(
-        "INSERT INTO File (FileIndex, JobId, PathId, Name, LStat, MD5, DeltaSeq, Fhinfo, Fhnode) "
-        "SELECT batch.FileIndex, batch.JobId, Path.PathId, "
-        "batch.Name, batch.LStat, batch.MD5, batch.DeltaSeq, batch.Fhinfo, batch.Fhnode "
-        "FROM batch "
-        "JOIN Path ON (batch.Path = Path.Path) ")) {
+  Mmsg(query,
+       "INSERT INTO %s (FileIndex, JobId, PathId, Name, LStat, MD5, DeltaSeq, Fhinfo, Fhnode) "
+       "SELECT batch.FileIndex, batch.JobId, Path.PathId, "
+       "batch.Name, batch.LStat, batch.MD5, batch.DeltaSeq, batch.Fhinfo, batch.Fhnode "
+       "FROM batch "
+       "JOIN Path ON (batch.Path = Path.Path) ", file_table.c_str());
+  /* clang-format on */
+  if (!jcr->db_batch->SqlQuery(query.c_str())) {
      Jmsg1(jcr, M_FATAL, 0, "Fill File table %s\n", errmsg);
      goto bail_out;
   }
-  /* clang-format on */
 
   jcr->setJobStatus(JobStatus); /* reset entry status */
   Jmsg(jcr, M_INFO, 0, "Insert of attributes batch table done\n");
@@ -833,6 +855,25 @@ bail_out:
   return retval;
 }
 
+/**
+ * On a catalog with a partitioned File table (see ddl/partitioning), make
+ * sure the partition for the files of the given job exists.  File records
+ * that are not inserted by CreateAttributesRecord() need to call this first.
+ */
+bool BareosDb::CreateFilePartition(JobId_t JobId)
+{
+  DbLocker _{this};
+  if (JobId == file_partition_job_ || !FileTableIsPartitioned()) {
+    return true;
+  }
+
+  Mmsg(cmd, "SELECT bareos_file_partition(%" PRIu32 ")", JobId);
+  if (!SqlQuery(cmd, nullptr, nullptr)) { return false; }
+
+  file_partition_job_ = JobId;
+  return true;
+}
+
 /**
  * Create File record in BareosDb
  *
@@ -873,6 +914,7 @@ bool BareosDb::CreateBatchFileAttributesRecord(JobControlRecord* jcr,
     jcr->batch_started = true;
   }
 
+  StageTimer timer(jcr->pipeline_stats, PipelineStage::kCatalogQueue);
   DbLocker batch_lock{jcr->db_batch};
   jcr->db_batch->SplitPathAndFile(jcr, ar->fname);
 
@@ -922,33 +964,42 @@ bool BareosDb::CreateFileRecord(JobControlRecord* jcr, AttributesDbRecord* ar)
   bool retval = false;
   static const char* no_digest = "0";
   const char* digest;
+  SQL_ROW row;
 
   ASSERT(ar->JobId);
   ASSERT(ar->PathId);
 
-  esc_name = CheckPoolMemorySize(esc_name, 2 * fnl + 2);
-  EscapeString(jcr, esc_name, fname, fnl);
-
   if (ar->Digest == NULL || ar->Digest[0] == 0) {
     digest = no_digest;
   } else {
     digest = ar->Digest;
   }
 
-  /* clang-format off */
-  Mmsg(cmd,
-       "INSERT INTO File (FileIndex,JobId,PathId,Name,"
-       "LStat,MD5,DeltaSeq,Fhinfo,Fhnode) VALUES (%u,%u,%u,'%s','%s','%s',%u,%" PRIu64 ",%" PRIu64 ")",
-       ar->FileIndex, ar->JobId, ar->PathId, esc_name,
-       ar->attr, digest, ar->DeltaSeq, ar->Fhinfo, ar->Fhnode);
-  /* clang-format on */
+  if (!CreateFilePartition(ar->JobId)) {
+    Mmsg2(errmsg, T_("Create File partition for JobId %" PRIu32
+                     " failed. ERR=%s"),
+          ar->JobId, sql_strerror());
+    Jmsg(jcr, M_FATAL, 0, "%s", errmsg);
+    return false;
+  }
+
+  /* The parameters are passed separately from the statement,
+   * so the name does not need to be escaped. */
+  ar->FileId = 0;
+  if (SqlQueryPrepared(SQL_QUERY::prepared_insert_file_9,
+                       {ar->FileIndex, ar->JobId, ar->PathId, fname, ar->attr,
+                        digest, ar->DeltaSeq, ar->Fhinfo, ar->Fhnode})
+      && (row = SqlFetchRow()) != NULL) {
+    ar->FileId = str_to_int64(row[0]);
+  }
+  SqlFreeResult();
 
-  ar->FileId = SqlInsertAutokeyRecord(cmd, NT_("File"));
   if (ar->FileId == 0) {
-    Mmsg2(errmsg, T_("Create db File record %s failed. ERR=%s"), cmd,
+    Mmsg2(errmsg, T_("Create db File record %s failed. ERR=%s"), fname,
           sql_strerror());
     Jmsg(jcr, M_FATAL, 0, "%s", errmsg);
   } else {
+    changes++;
     retval = true;
   }
   return retval;
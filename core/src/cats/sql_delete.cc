@@ -29,8 +29,12 @@
 #include "include/bareos.h"
 
 #include "cats.h"
+#include "cats/sql.h"
 #include "lib/edit.h"
 
+#include <string>
+#include <vector>
+
 /* -----------------------------------------------------------------------
  *
  *   Generic Routines (or almost generic)
@@ -208,6 +212,17 @@ void BareosDb::PurgeFiles(const char* jobids)
   }
 
   PoolMem query(PM_MESSAGE);
+  bool partitioned = FileTableIsPartitioned();
+
+  if (partitioned) {
+    /* Mark the jobs first, so that every partition of the File table whose
+     * jobs are all purged now can be dropped as a whole. Only the records
+     * of jobs in partitions that are still in use need to be deleted. */
+    Mmsg(query, "UPDATE Job SET PurgedFiles=1 WHERE JobId IN (%s)", jobids);
+    SqlQuery(query.c_str());
+
+    ExpireFilePartitions();
+  }
 
   Mmsg(query, "DELETE FROM File WHERE JobId IN (%s)", jobids);
   SqlQuery(query.c_str());
@@ -215,8 +230,67 @@ void BareosDb::PurgeFiles(const char* jobids)
   Mmsg(query, "DELETE FROM BaseFiles WHERE JobId IN (%s)", jobids);
   SqlQuery(query.c_str());
 
-  Mmsg(query, "UPDATE Job SET PurgedFiles=1 WHERE JobId IN (%s)", jobids);
-  SqlQuery(query.c_str());
+  if (!partitioned) {
+    Mmsg(query, "UPDATE Job SET PurgedFiles=1 WHERE JobId IN (%s)", jobids);
+    SqlQuery(query.c_str());
+  }
+}
+
+/**
+ * Detach and drop all partitions of the File table whose jobs are purged.
+ * DETACH PARTITION CONCURRENTLY does not block the queries on the other
+ * partitions, but it cannot run inside a transaction block and waits for
+ * all transactions that still use the partition. It therefore runs on a
+ * private connection, so this (usually the director's main) connection is
+ * not held up while the detach is waiting.
+ */
+void BareosDb::ExpireFilePartitions()
+{
+  // the maintenance connection has to see PurgedFiles=1
+  EndTransaction(nullptr);
+
+  BareosDb* mdb = CloneDatabaseConnection(nullptr, true, false, true);
+  if (!mdb) {
+    Dmsg0(100, "Could not open a connection to expire File partitions\n");
+    return;
+  }
+
+  std::vector<std::string> expired;
+  auto collect = [&expired](int, char** row) {
+    if (row[0]) { expired.emplace_back(row[0]); }
+    return true;
+  };
+  if (mdb->SqlQuery("SELECT bareos_expired_file_partitions()",
+                    ObjectHandler<decltype(collect)>, &collect)) {
+    mdb->DropFilePartitions(expired);
+  }
+  mdb->CloseDatabase(nullptr);
+}
+
+void BareosDb::DropFilePartitions(const std::vector<std::string>& expired)
+{
+
+  PoolMem query(PM_MESSAGE);
+  for (const auto& name : expired) {
+    Mmsg(query, "ALTER TABLE File DETACH PARTITION %s CONCURRENTLY",
+         name.c_str());
+    if (!SqlQuery(query.c_str())) {
+      // an interrupted detach needs to be finalized
+      Mmsg(query, "ALTER TABLE File DETACH PARTITION %s FINALIZE",
+           name.c_str());
+      if (!SqlQuery(query.c_str())) {
+        Dmsg2(100, "Could not detach File partition %s. ERR=%s\n",
+              name.c_str(), sql_strerror());
+        continue;
+      }
+    }
+
+    Mmsg(query, "SELECT bareos_drop_file_partition('%s')", name.c_str());
+    if (!SqlQuery(query.c_str(), nullptr, nullptr)) {
+      Dmsg2(100, "Could not drop File partition %s. ERR=%s\n", name.c_str(),
+            sql_strerror());
+    }
+  }
 }
 
 void BareosDb::PurgeJobs(const char* jobids)
@@ -467,27 +467,40 @@ retry_fetch:
          "'Recycle','Purged','Used','Append') AND Enabled=1 "
          "ORDER BY LastWritten LIMIT %d",
          edit_int64(mr->PoolId, ed1), esc_type, item);
+  } else if (!bstrcmp(mr->VolStatus, "Recycle")
+             && !bstrcmp(mr->VolStatus, "Purged")) {
+    /* The common case of looking for the next volume to append to is
+     * done for every job, so it uses a prepared statement. */
+    Dmsg2(100, "fnextvol: PoolId=%" PRIdbid " VolStatus=%s\n", mr->PoolId,
+          mr->VolStatus);
+    bool ok;
+    SqlFreeResult();
+    if (InChanger) {
+      ok = SqlQueryPrepared(
+          SQL_QUERY::prepared_find_next_volume_inchanger_5,
+          {mr->PoolId, mr->MediaType, mr->VolStatus, item, mr->StorageId});
+    } else {
+      ok = SqlQueryPrepared(SQL_QUERY::prepared_find_next_volume_4,
+                            {mr->PoolId, mr->MediaType, mr->VolStatus, item});
+    }
+    if (!ok) {
+      Jmsg(jcr, M_FATAL, 0, "%s", errmsg);
+      Dmsg1(050, "Rtn numrows=%d\n", num_rows);
+      return num_rows;
+    }
+    goto fetch_rows;
   } else {
     PoolMem changer(PM_MESSAGE);
     PoolMem order(PM_MESSAGE);
 
-    // Find next available volume
+    // Find next volume to recycle
     if (InChanger) {
       Mmsg(changer, "AND InChanger=1 AND StorageId=%s",
            edit_int64(mr->StorageId, ed1));
     }
 
-    if (bstrcmp(mr->VolStatus, "Recycle") || bstrcmp(mr->VolStatus, "Purged")) {
-      PmStrcpy(order,
-               "AND Recycle=1 ORDER BY LastWritten ASC,MediaId"); /* Take oldest
-                                                                     that can be
-                                                                     recycled */
-    } else {
-      FillQuery<SQL_QUERY::sql_media_order_most_recently_written>(
-          order); /* Take
-                                                                    most
-                     recently written */
-    }
+    // Take oldest that can be recycled
+    PmStrcpy(order, "AND Recycle=1 ORDER BY LastWritten ASC,MediaId");
 
     Mmsg(cmd,
          "SELECT MediaId,VolumeName,VolJobs,VolFiles,VolBlocks,"
@@ -512,6 +525,7 @@ retry_fetch:
     return num_rows;
   }
 
+fetch_rows:
   num_rows = SqlNumRows();
   if (item > num_rows || item < 1) {
     Dmsg2(050, "item=%d got=%d\n", item, num_rows);
@@ -117,6 +117,25 @@ bool BareosDb::SqlExec(const char* query)
   return retval;
 }
 
+bool BareosDb::SqlQueryPrepared(SQL_QUERY query,
+                                std::initializer_list<SqlParam> params)
+{
+  bool retval;
+  const char* query_name = get_predefined_query_name(query);
+
+  Dmsg2(debuglevel, "called: %s with query name %s\n", __PRETTY_FUNCTION__,
+        query_name);
+
+  DbLocker _{this};
+  retval = SqlQueryPreparedWithoutHandler(query, params.begin(),
+                                          static_cast<int>(params.size()));
+  if (!retval) {
+    Mmsg(errmsg, T_("Query failed: %s: ERR=%s\n"), query_name, sql_strerror());
+  }
+
+  return retval;
+}
+
 bool BareosDb::SqlQuery(const char* query,
                         DB_RESULT_HANDLER* ResultHandler,
                         void* ctx)
@@ -287,16 +287,11 @@ bool BareosDb::UpdateMediaRecord(JobControlRecord* jcr, MediaDbRecord* mr)
 {
   char dt[MAX_TIME_LENGTH];
   time_t ttime;
-  char ed1[50], ed2[50], ed3[50], ed4[50];
-  char ed5[50], ed6[50], ed7[50], ed8[50];
-  char ed9[50], ed10[50], ed11[50];
   char esc_medianame[MAX_ESCAPE_NAME_LENGTH];
-  char esc_status[MAX_ESCAPE_NAME_LENGTH];
 
   Dmsg1(100, "update_media: FirstWritten=%" PRItime "\n", mr->FirstWritten);
   DbLocker _{this};
   EscapeString(jcr, esc_medianame, mr->VolumeName, strlen(mr->VolumeName));
-  EscapeString(jcr, esc_status, mr->VolStatus, strlen(mr->VolStatus));
 
   if (mr->set_first_written) {
     Dmsg1(400, "Set FirstWritten Vol=%s\n", mr->VolumeName);
@@ -322,44 +317,39 @@ bool BareosDb::UpdateMediaRecord(JobControlRecord* jcr, MediaDbRecord* mr)
     UpdateDb(jcr, cmd);
   }
 
+  /* The statements below run for every volume update during a backup,
+   * so they are prepared once per connection. */
   if (mr->LastWritten != 0) {
     ttime = mr->LastWritten;
     bstrutime(dt, sizeof(dt), ttime);
-    Mmsg(cmd,
-         "UPDATE Media Set LastWritten='%s' "
-         "WHERE VolumeName='%s'",
-         dt, esc_medianame);
-    UpdateDb(jcr, cmd);
+    if (SqlQueryPrepared(SQL_QUERY::prepared_update_media_lastwritten_2,
+                         {dt, mr->VolumeName})) {
+      changes++;
+    } else {
+      Jmsg(jcr, M_ERROR, 0, "%s", errmsg);
+    }
   }
 
-  Mmsg(cmd,
-       "UPDATE Media SET VolJobs=%u,"
-       "VolFiles=%u,VolBlocks=%u,VolBytes=%s,VolMounts=%u,VolErrors=%u,"
-       "VolWrites=%u,MaxVolBytes=%s,VolStatus='%s',"
-       "Slot=%d,InChanger=%d,VolReadTime=%s,VolWriteTime=%s,"
-       "LabelType=%d,StorageId=%s,PoolId=%s,VolRetention=%s,VolUseDuration=%s,"
-       "MaxVolJobs=%u,MaxVolFiles=%u,Enabled=%d,LocationId=%s,"
-       "ScratchPoolId=%s,RecyclePoolId=%s,RecycleCount=%u,Recycle=%d,"
-       "ActionOnPurge=%u,"
-       "EncryptionKey='%s',"
-       "MinBlocksize=%u,MaxBlocksize=%u "
-       "WHERE VolumeName='%s'",
-       mr->VolJobs, mr->VolFiles, mr->VolBlocks, edit_uint64(mr->VolBytes, ed1),
-       mr->VolMounts, mr->VolErrors, mr->VolWrites,
-       edit_uint64(mr->MaxVolBytes, ed2), esc_status, mr->Slot, mr->InChanger,
-       edit_int64(mr->VolReadTime, ed3), edit_int64(mr->VolWriteTime, ed4),
-       mr->LabelType, edit_int64(mr->StorageId, ed5),
-       edit_int64(mr->PoolId, ed6), edit_uint64(mr->VolRetention, ed7),
-       edit_uint64(mr->VolUseDuration, ed8), mr->MaxVolJobs, mr->MaxVolFiles,
-       mr->Enabled, edit_uint64(mr->LocationId, ed9),
-       edit_uint64(mr->ScratchPoolId, ed10),
-       edit_uint64(mr->RecyclePoolId, ed11), mr->RecycleCount, mr->Recycle,
-       mr->ActionOnPurge, mr->EncrKey, mr->MinBlocksize, mr->MaxBlocksize,
-       esc_medianame);
-
-  Dmsg1(400, "%s\n", cmd);
-
-  bool retval = UpdateDb(jcr, cmd) > 0;
+  Dmsg1(400, "update_media: VolumeName=%s\n", mr->VolumeName);
+
+  bool retval = false;
+  if (SqlQueryPrepared(
+          SQL_QUERY::prepared_update_media_31,
+          {mr->VolJobs, mr->VolFiles, mr->VolBlocks, mr->VolBytes,
+           mr->VolMounts, mr->VolErrors, mr->VolWrites, mr->MaxVolBytes,
+           mr->VolStatus, mr->Slot, mr->InChanger,
+           static_cast<int64_t>(mr->VolReadTime),
+           static_cast<int64_t>(mr->VolWriteTime), mr->LabelType,
+           mr->StorageId, mr->PoolId, mr->VolRetention, mr->VolUseDuration,
+           mr->MaxVolJobs, mr->MaxVolFiles, mr->Enabled, mr->LocationId,
+           mr->ScratchPoolId, mr->RecyclePoolId, mr->RecycleCount,
+           mr->Recycle, mr->ActionOnPurge, mr->EncrKey, mr->MinBlocksize,
+           mr->MaxBlocksize, mr->VolumeName})) {
+    changes++;
+    retval = SqlAffectedRows() > 0;
+  } else {
+    Jmsg(jcr, M_ERROR, 0, "%s", errmsg);
+  }
 
   // Make sure InChanger is 0 for any record having the same Slot
   MakeInchangerUnique(jcr, mr);
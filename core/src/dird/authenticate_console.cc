@@ -102,7 +102,7 @@ void ConsoleAuthenticator::DoNamedAuthentication()
       NULL, my_config, console_name_.c_str(),
       optional_console_resource_->password_, optional_console_resource_);
   if (auth_success_) {
-    ua_->user_acl = UserAcl::from_config(optional_console_resource_);
+    ua_->user_acl = UserAcl::compiled(optional_console_resource_);
   } else {
     ua_->user_acl = nullptr;
     Dmsg1(200, "Could not authenticate console %s\n", console_name_.c_str());
@@ -336,7 +336,7 @@ OptionResult ConsoleAuthenticatorFrom_18_2::AuthenticatePamUser()
         ua_->user_acl = nullptr;
         auth_success_ = false;
       } else {
-        ua_->user_acl = UserAcl::from_config(user);
+        ua_->user_acl = UserAcl::compiled(user);
         auth_success_ = true;
       }
     }
@@ -66,7 +66,11 @@ inline constexpr const char passiveclientcmd[]
     = "passive client address=%s port=%" PRIu32 " ssl=%u\n";
 
 /* Responses received from File daemon */
+inline constexpr const char accuratestatecmd[]
+    = "accuratestate job=%s reference=%s\n";
 inline constexpr const char OKbackup[] = "2000 OK backup\n";
+inline constexpr const char OKaccuratestateLoaded[]
+    = "2000 OK accuratestate loaded\n";
 inline constexpr const char OKstore[] = "2000 OK storage\n";
 inline constexpr const char OKpassiveclient[] = "2000 OK passive client\n";
 inline constexpr const char EndJob[]
@@ -238,9 +242,10 @@ static int AccurateListHandler(void* ctx, int num_fields, char** row)
 
 /* In this procedure, we check if the current fileset is using checksum
  * FileSet-> Include-> Options-> Accurate/Verify/BaseJob=checksum
+ * for a backup of the given level.
  * This procedure uses jcr->HasBase, so it must be call after the initialization
  */
-static bool IsChecksumNeededByFileset(JobControlRecord* jcr)
+static bool IsChecksumNeededByFileset(JobControlRecord* jcr, int32_t level)
 {
   IncludeExcludeItem* inc;
   FileOptions* fopts;
@@ -268,7 +273,7 @@ static bool IsChecksumNeededByFileset(JobControlRecord* jcr)
             have_basejob_option = in_block = jcr->HasBase;
             break;
           case 'C': /* Accurate keyword */
-            in_block = !jcr->is_JobLevel(L_FULL);
+            in_block = level != L_FULL;
             break;
           case ':': /* End of keyword */
             in_block = false;
@@ -294,9 +299,34 @@ static bool IsChecksumNeededByFileset(JobControlRecord* jcr)
   return false;
 }
 
+/*
+ * Clients that keep the file list of their last backup of a job are asked
+ * whether they have the one of the reference JobIds (0 on a full backup).
+ * This also tells them to keep the list of this job.
+ *    DIR -> FD : accuratestate job=<name> reference=<jobids>
+ *    FD -> DIR : 2000 OK accuratestate loaded|missing
+ */
+static bool ClientHasAccurateState(JobControlRecord* jcr, const char* reference)
+{
+  BareosSocket* fd = jcr->file_bsock;
+
+  if (jcr->dir_impl->FDVersion < FD_VERSION_55 || !jcr->JobId
+      || !jcr->is_JobType(JT_BACKUP) || jcr->rerunning || jcr->HasBase
+      || jcr->dir_impl->use_accurate_chksum) {
+    return false;
+  }
+
+  std::string job{jcr->dir_impl->res.job->resource_name_};
+  BashSpaces(job);
+  fd->fsend(accuratestatecmd, job.c_str(), reference);
+  if (BgetDirmsg(fd) <= 0) { return false; }
+
+  return bstrcmp(fd->msg, OKaccuratestateLoaded);
+}
+
 /*
  * Send current file list to FD
- *    DIR -> FD : accurate files=xxxx
+ *    DIR -> FD : accurate files=xxxx jobids=<jobids>
  *    DIR -> FD : /path/to/file\0Lstat\0MD5\0Delta
  *    DIR -> FD : /path/to/dir/\0Lstat\0MD5\0Delta
  *    ...
@@ -319,8 +349,6 @@ bool SendAccurateCurrentFiles(JobControlRecord* jcr)
       jcr->HasBase = true;
       Jmsg(jcr, M_INFO, 0, T_("Using BaseJobId(s): %s\n"),
            jobids.GetAsString().c_str());
-    } else {
-      return true;
     }
   } else {
     // For Incr/Diff level, we search for older jobs
@@ -333,8 +361,35 @@ bool SendAccurateCurrentFiles(JobControlRecord* jcr)
     }
   }
 
-  // Don't send and store the checksum if fileset doesn't require it
-  jcr->dir_impl->use_accurate_chksum = IsChecksumNeededByFileset(jcr);
+  /* Don't send and store the checksum if fileset doesn't require it.  A full
+   * backup without base jobs has nothing to send, but the client may keep
+   * its file list for the next backup, unless that one needs checksums. */
+  bool nothing_to_send = jcr->is_JobLevel(L_FULL) && !jcr->HasBase;
+  jcr->dir_impl->use_accurate_chksum = IsChecksumNeededByFileset(
+      jcr, nothing_to_send ? L_INCREMENTAL : jcr->getJobLevel());
+
+  if (nothing_to_send) {
+    ClientHasAccurateState(jcr, "0");
+    return true;
+  }
+
+  /* Pruning the files of a job does not change the JobIds, but the client
+   * must not skip what the catalog does not know about anymore. */
+  Mmsg(buf,
+       "SELECT count(*) FROM Job WHERE JobId IN (%s) AND PurgedFiles <> 0",
+       jobids.GetAsString().c_str());
+  db_list_ctx purged;
+  jcr->db->SqlQuery(buf.c_str(), DbListHandler, &purged);
+  bool files_purged = purged.GetAsString() != "0";
+
+  if (ClientHasAccurateState(
+          jcr, files_purged ? "0" : jobids.GetAsString().c_str())) {
+    Jmsg(jcr, M_INFO, 0,
+         T_("Client has the Accurate information of JobId(s) %s, not "
+            "sending it.\n"),
+         jobids.GetAsString().c_str());
+    return true;
+  }
 
   timer accurate_timer;
 
@@ -349,7 +404,8 @@ bool SendAccurateCurrentFiles(JobControlRecord* jcr)
     Jmsg(jcr, M_INFO, 0, "Sending Accurate information (estimated %s files).\n",
          count_as_str.c_str());
   }
-  jcr->file_bsock->fsend("accurate files=%s\n", count_as_str.c_str());
+  jcr->file_bsock->fsend("accurate files=%s jobids=%s\n", count_as_str.c_str(),
+                         jobids.GetAsString().c_str());
 
 
   accurate_list_handler_args args;
@@ -640,6 +696,7 @@ bool DoNativeBackup(JobControlRecord* jcr)
     jcr->db_batch->WriteBatchFileRecords(
         jcr);  // used by bulk batch file insert
   }
+  ReportPipelineStats(jcr, {}, "dir");
   if (jcr->HasBase) {
     if (DbLocker _{jcr->db}; !jcr->db->CommitBaseFileAttributesRecord(jcr)) {
       Jmsg(jcr, M_FATAL, 0, "%s", jcr->db->strerror());
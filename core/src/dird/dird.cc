@@ -40,6 +40,7 @@
 #include "lib/daemon.h"
 #include "lib/berrno.h"
 #include "lib/edit.h"
+#include "lib/metrics_server.h"
 #include "lib/tls/openssl.h"
 #include "lib/bsignal.h"
 #include "lib/daemon.h"
@@ -367,6 +368,8 @@ int main(int argc, char* argv[])
 
   StartStatisticsThread();
 
+  if (me->metrics_enable) { StartMetricsServer(me->metrics_addrs); }
+
   Dmsg0(200, "Start UA server\n");
   if (!StartSocketServer(me->DIRaddrs)) { TerminateDird(0); }
 
@@ -400,6 +403,7 @@ static
   debug_level = 0; /* turn off debug */
 
   DestroyConfigureUsageString();
+  StopMetricsServer();
   StopSocketServer();
   StopStatisticsThread();
   StopWatchdog();
@@ -3,7 +3,7 @@
 
    Copyright (C) 2000-2008 Free Software Foundation Europe e.V.
    Copyright (C) 2011-2016 Planets Communications B.V.
-   Copyright (C) 2013-2025 Bareos GmbH & Co. KG
+   Copyright (C) 2013-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -190,6 +190,7 @@ struct RuntimeStorageStatus final {
 
   int32_t NumConcurrentJobs{0};      /**< Number of concurrent jobs running */
   int32_t NumConcurrentReadJobs{0};  /**< Number of jobs reading */
+  uint64_t Releases{0};              /**< Released job slots, see jobq.cc */
   drive_number_t drives{0};          /**< Number of drives in autochanger */
   slot_number_t slots{0};            /**< Number of slots in autochanger */
   std::mutex changer_lock;           /**< Any access to
@@ -206,10 +207,12 @@ struct RuntimeStorageStatus final {
 
 struct RuntimeClientStatus {
   int32_t NumConcurrentJobs{0}; /**< Number of concurrent jobs running */
+  uint64_t Releases{0};         /**< Released job slots, see jobq.cc */
 };
 
 struct RuntimeJobStatus {
   int32_t NumConcurrentJobs{0}; /**< Number of concurrent jobs running */
+  uint64_t Releases{0};         /**< Released job slots, see jobq.cc */
 };
 
 inline constexpr slot_number_t INDEX_DRIVE_OFFSET = 0;
@@ -225,6 +228,7 @@ inline constexpr slot_number_t INDEX_SLOT_OFFSET = 100;
 #define FD_VERSION_52 52
 #define FD_VERSION_53 53
 #define FD_VERSION_54 54
+#define FD_VERSION_55 55
 
 } /* namespace directordaemon */
 
@@ -124,6 +124,10 @@ static const ResourceItem dir_items[] = {
   { "Address", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_dir, DIRaddrs), {config::DefaultValue{DIR_DEFAULT_PORT}, config::Alias{"DirAddress"}}},
   { "Addresses", CFG_TYPE_ADDRESSES, ITEM(res_dir, DIRaddrs), {config::DefaultValue{DIR_DEFAULT_PORT}, config::Alias{"DirAddresses"}}},
   { "SourceAddress", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_dir, DIRsrc_addr), {config::DefaultValue{"0"}, config::Alias{"DirSourceAddress"}}},
+  { "MetricsEnable", CFG_TYPE_BOOL, ITEM(res_dir, metrics_enable), {config::DefaultValue{"false"}, config::IntroducedIn{26, 0, 0}, config::Description{"Serve metrics in the OpenMetrics text format via HTTP on the metrics addresses."}}},
+  { "MetricsAddress", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_dir, metrics_addrs), {config::DefaultValue{"9121"}, config::IntroducedIn{26, 0, 0}}},
+  { "MetricsAddresses", CFG_TYPE_ADDRESSES, ITEM(res_dir, metrics_addrs), {config::DefaultValue{"9121"}, config::IntroducedIn{26, 0, 0}}},
+  { "MetricsPort", CFG_TYPE_ADDRESSES_PORT, ITEM(res_dir, metrics_addrs), {config::DefaultValue{"9121"}, config::IntroducedIn{26, 0, 0}}},
   { "QueryFile", CFG_TYPE_DIR, ITEM(res_dir, query_file), {config::DefaultValue{PATH_BAREOS_SCRIPTDIR "/query.sql"}, config::Description{"File containing queries used by the bconsole 'query' command."}, config::PlatformSpecific{}}},
   { "WorkingDirectory", CFG_TYPE_DIR, ITEM(res_dir, working_directory), {config::DefaultValue{PATH_BAREOS_WORKINGDIR}, config::PlatformSpecific{}}},
   { "PluginDirectory", CFG_TYPE_DIR, ITEM(res_dir, plugin_directory), {config::IntroducedIn{14, 2, 0}, config::Description{"Plugins are loaded from this directory. To load only specific plugins, use 'Plugin Names'."}}},
@@ -1966,6 +1970,9 @@ void FilesetResource::PrintConfigIncludeExcludeOptions(
       case 'x':
         send.KeyBool("AutoExclude", false);
         break;
+      case 'B':
+        send.KeyBool("BlockDelta", true);
+        break;
       default:
         Emsg1(M_ERROR, 0, T_("Unknown include/exclude option: %c\n"), *p);
         break;
@@ -3752,6 +3759,7 @@ static void FreeResource(BareosResource* res, int type)
       if (p->query_file) { free(p->query_file); }
       if (p->DIRaddrs) { FreeAddresses(p->DIRaddrs); }
       if (p->DIRsrc_addr) { FreeAddresses(p->DIRsrc_addr); }
+      if (p->metrics_addrs) { FreeAddresses(p->metrics_addrs); }
       if (p->verid) { free(p->verid); }
       if (p->keyencrkey.value) { free(p->keyencrkey.value); }
       if (p->audit_events) { delete p->audit_events; }
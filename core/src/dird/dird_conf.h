@@ -105,6 +105,7 @@ class DirectorResource
   virtual ~DirectorResource() = default;
   dlist<IPADDR>* DIRaddrs = nullptr;
   dlist<IPADDR>* DIRsrc_addr = nullptr; /* Address to source connections from */
+  dlist<IPADDR>* metrics_addrs = nullptr; /* OpenMetrics listen addresses */
   char* query_file = nullptr;           /* SQL query file */
   char* working_directory = nullptr;    /* WorkingDirectory */
   char* scripts_directory = nullptr;    /* ScriptsDirectory */
@@ -122,6 +123,7 @@ class DirectorResource
       = false;  // Workaround for Isilon 9.1.0.0 not accepting -1 as value for
                 // FhInfo (which is the tape offset)
   bool auditing = false; /* Auditing enabled */
+  bool metrics_enable = false; /* OpenMetrics listener enabled */
   alist<const char*>* audit_events
       = nullptr;                  /* Specific audit events to enable */
   uint32_t ndmp_loglevel = 0;     /* NDMP Protocol specific loglevel to use */
@@ -157,6 +159,8 @@ enum
 };
 
 // Profile Resource
+struct UserAcl;
+
 class ProfileResource : public BareosResource {
  public:
   ProfileResource() = default;
@@ -187,6 +191,7 @@ class ConsoleResource
   virtual ~ConsoleResource() = default;
   AclConfig user_acl;
   bool use_pam_authentication_ = false; /**< PAM Console */
+  std::shared_ptr<const UserAcl> compiled_acl{}; /**< see UserAcl::compiled */
 };
 
 class UserResource : public BareosResource {
@@ -194,6 +199,7 @@ class UserResource : public BareosResource {
   UserResource() = default;
   virtual ~UserResource() = default;
   AclConfig user_acl;
+  std::shared_ptr<const UserAcl> compiled_acl{}; /**< see UserAcl::compiled */
 };
 
 // Catalog Resource
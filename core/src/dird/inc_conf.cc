@@ -87,7 +87,8 @@ enum
   INC_KW_SIZE,
   INC_KW_SHADOWING,
   INC_KW_AUTO_EXCLUDE,
-  INC_KW_FORCE_ENCRYPTION
+  INC_KW_FORCE_ENCRYPTION,
+  INC_KW_BLOCK_DELTA
 };
 
 /*
@@ -125,6 +126,7 @@ static struct s_kw FS_option_kw[]
        {"shadowing", INC_KW_SHADOWING},
        {"autoexclude", INC_KW_AUTO_EXCLUDE},
        {"forceencryption", INC_KW_FORCE_ENCRYPTION},
+       {"blockdelta", INC_KW_BLOCK_DELTA},
        {NULL, 0}};
 
 // Options for FileSet keywords
@@ -216,6 +218,8 @@ static struct s_fs_opt FS_options[]
        {"no", INC_KW_AUTO_EXCLUDE, "x"},
        {"yes", INC_KW_FORCE_ENCRYPTION, "Ef"},
        {"no", INC_KW_FORCE_ENCRYPTION, "0"},
+       {"yes", INC_KW_BLOCK_DELTA, "B"},
+       {"no", INC_KW_BLOCK_DELTA, "0"},
        {NULL, 0, 0}};
 
 // Imported subroutines
@@ -275,6 +279,7 @@ const ResourceItem options_items[] = {
   { "Shadowing", CFG_TYPE_OPTION, 0, nullptr, {}},
   { "AutoExclude", CFG_TYPE_OPTION, 0, nullptr, {}},
   { "ForceEncryption", CFG_TYPE_OPTION, 0, nullptr, {}},
+  { "BlockDelta", CFG_TYPE_OPTION, 0, nullptr, {}},
   { "Meta", CFG_TYPE_META, 0, nullptr, {}},
   {}
 };
@@ -29,6 +29,14 @@
  * allocated and they can immediately be run, and the
  * running queue where jobs are placed when they are
  * running.
+ *
+ * Jobs with a start time in the future are kept in a heap
+ * ordered by start time, which a single timer thread moves
+ * to the waiting_jobs queue once their time has come.
+ *
+ * Waiting jobs are only retried when something happened that
+ * can let them run: a job was added, removed or finished, or
+ * the resource a job is waiting for got released.
  */
 
 #include "include/bareos.h"
@@ -38,27 +46,87 @@
 #include "dird/jobq.h"
 #include "dird/storage.h"
 #include "lib/berrno.h"
+#include "lib/metrics.h"
 #include "lib/thread_specific_data.h"
 #include "dird/jcr_util.h"
 
+#include <algorithm>
+
 namespace directordaemon {
 
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Every runtime status counts how often one of its slots was released.
+ * A waiting job remembers the counter of the resource it could not get and
+ * its value at the time, so it is only retried after a slot of exactly that
+ * resource became free.  The counters are protected by mutex. */
+
+/* All initialized job queues, so that resources released outside of a job
+ * queue can wake up the jobs waiting for them.  Protected by mutex. */
+static std::vector<jobq_t*> job_queues;
+
+/* Waiting jobs are all retried at least this often, e.g. to notice
+ * changed limits after a configuration reload. */
+static constexpr int kResourceRecheckInterval = 30;
+
 /* Forward referenced functions */
 extern "C" void* jobq_server(void* arg);
-extern "C" void* sched_wait(void* arg);
+extern "C" void* jobq_timer(void* arg);
 
 static int StartServer(jobq_t* jq);
-static bool AcquireResources(JobControlRecord* jcr);
+static int StartTimer(jobq_t* jq);
+static int QueueJob(jobq_t* jq, jobq_item_t* item);
+static bool MayAcquireResources(jobq_item_t* je);
+static bool AcquireResources(jobq_item_t* je);
 static bool RescheduleJob(JobControlRecord* jcr, jobq_t* jq, jobq_item_t* je);
-static bool IncClientConcurrency(JobControlRecord* jcr);
+static bool IncClientConcurrency(JobControlRecord* jcr, jobq_item_t* je);
 static void DecClientConcurrency(JobControlRecord* jcr);
-static bool IncJobConcurrency(JobControlRecord* jcr);
+static bool IncJobConcurrency(JobControlRecord* jcr, jobq_item_t* je);
 static void DecJobConcurrency(JobControlRecord* jcr);
-static bool IncWriteStore(JobControlRecord* jcr);
+static bool IncWriteStore(JobControlRecord* jcr, jobq_item_t* je);
+static void ReleaseReadStore(JobControlRecord* jcr);
 static void DecWriteStore(JobControlRecord* jcr);
 
+// Ordering of the delayed_jobs heap, the earliest start time is on top
+static bool StartsLater(const jobq_item_t* a, const jobq_item_t* b)
+{
+  return a->jcr->sched_time > b->jcr->sched_time;
+}
+
+// Time jobs spent in the wait and ready queues before they started
+static metrics::Histogram& WaitTime()
+{
+  static metrics::Histogram& wait_time = metrics::Global().GetHistogram(
+      "bareos_jobq_wait_seconds",
+      "Time jobs waited in the job queue for their resources", {},
+      metrics::WaitBuckets());
+  return wait_time;
+}
+
+static void CollectJobqMetrics(jobq_t* jq, metrics::Writer& writer)
+{
+  lock_mutex(jq->mutex);
+  std::int64_t delayed = jq->delayed_jobs->size();
+  std::int64_t waiting = jq->waiting_jobs->size();
+  std::int64_t ready = jq->ready_jobs->size();
+  std::int64_t running = jq->running_jobs->size();
+  std::int64_t workers = jq->num_workers;
+  std::int64_t max_workers = jq->max_workers;
+  unlock_mutex(jq->mutex);
+
+  writer.Family("bareos_jobq_jobs", "gauge", "Jobs in the job queue");
+  writer.Sample("bareos_jobq_jobs", {{"state", "delayed"}}, delayed);
+  writer.Sample("bareos_jobq_jobs", {{"state", "waiting"}}, waiting);
+  writer.Sample("bareos_jobq_jobs", {{"state", "ready"}}, ready);
+  writer.Sample("bareos_jobq_jobs", {{"state", "running"}}, running);
+  writer.Family("bareos_jobq_workers", "gauge",
+                "Threads serving the job queue");
+  writer.Sample("bareos_jobq_workers", {}, workers);
+  writer.Family("bareos_jobq_max_workers", "gauge",
+                "Maximum number of threads serving the job queue");
+  writer.Sample("bareos_jobq_max_workers", {}, max_workers);
+}
+
 /*
  * Initialize a job queue
  *
@@ -95,7 +163,17 @@ int JobqInit(jobq_t* jq, int max_workers, void* (*engine)(void* arg))
     pthread_attr_destroy(&jq->attr);
     return status;
   }
+  if ((status = pthread_cond_init(&jq->timer, NULL)) != 0) {
+    BErrNo be;
+    Jmsg1(NULL, M_ERROR, 0, T_("pthread_cond_init: ERR=%s\n"),
+          be.bstrerror(status));
+    pthread_cond_destroy(&jq->work);
+    pthread_mutex_destroy(&jq->mutex);
+    pthread_attr_destroy(&jq->attr);
+    return status;
+  }
   jq->quit = false;
+  jq->timer_running = false;
   jq->max_workers = max_workers; /* max threads to create */
   jq->num_workers = 0;           /* no threads yet */
   jq->engine = engine;           /* routine to run */
@@ -105,6 +183,15 @@ int JobqInit(jobq_t* jq, int max_workers, void* (*engine)(void* arg))
   jq->waiting_jobs = new dlist<jobq_item_t>();
   jq->running_jobs = new dlist<jobq_item_t>();
   jq->ready_jobs = new dlist<jobq_item_t>();
+  jq->delayed_jobs = new std::vector<jobq_item_t*>();
+
+  lock_mutex(mutex);
+  job_queues.push_back(jq);
+  unlock_mutex(mutex);
+
+  WaitTime();
+  jq->metrics_collector = metrics::Global().AddCollector(
+      [jq](metrics::Writer& writer) { CollectJobqMetrics(jq, writer); });
 
   return 0;
 }
@@ -117,16 +204,22 @@ int JobqInit(jobq_t* jq, int max_workers, void* (*engine)(void* arg))
  */
 int JobqDestroy(jobq_t* jq)
 {
-  int status, status1, status2;
+  int status, status1, status2, status3;
 
   if (jq->valid != JOBQ_VALID) { return EINVAL; }
+  metrics::Global().RemoveCollector(jq->metrics_collector);
+  lock_mutex(mutex);
+  job_queues.erase(std::find(job_queues.begin(), job_queues.end(), jq));
+  unlock_mutex(mutex);
   lock_mutex(jq->mutex);
   jq->valid = 0; /* prevent any more operations */
 
   // If any threads are active, wake them
-  if (jq->num_workers > 0) {
+  if (jq->num_workers > 0 || jq->timer_running) {
     jq->quit = true;
-    while (jq->num_workers > 0) {
+    pthread_cond_broadcast(&jq->work);
+    pthread_cond_signal(&jq->timer);
+    while (jq->num_workers > 0 || jq->timer_running) {
       if ((status = pthread_cond_wait(&jq->work, &jq->mutex)) != 0) {
         BErrNo be;
         Jmsg1(NULL, M_ERROR, 0, T_("pthread_cond_wait: ERR=%s\n"),
@@ -139,56 +232,75 @@ int JobqDestroy(jobq_t* jq)
   unlock_mutex(jq->mutex);
   status = pthread_mutex_destroy(&jq->mutex);
   status1 = pthread_cond_destroy(&jq->work);
-  status2 = pthread_attr_destroy(&jq->attr);
+  status2 = pthread_cond_destroy(&jq->timer);
+  status3 = pthread_attr_destroy(&jq->attr);
   delete jq->waiting_jobs;
   delete jq->running_jobs;
   delete jq->ready_jobs;
-  return (status != 0 ? status : (status1 != 0 ? status1 : status2));
-}
 
-struct wait_pkt {
-  JobControlRecord* jcr;
-  jobq_t* jq;
-};
+  // Jobs that never reached their start time are simply dropped
+  for (jobq_item_t* item : *jq->delayed_jobs) {
+    FreeJcr(item->jcr); /* release the reference taken by JobqAdd() */
+    free(item);
+  }
+  delete jq->delayed_jobs;
+  if (status == 0) { status = status1; }
+  if (status == 0) { status = status2; }
+  return (status != 0 ? status : status3);
+}
 
 /**
  * Wait until schedule time arrives before starting. Normally
- * this routine is only used for jobs started from the console
- * for which the user explicitly specified a start time. Otherwise
- * most jobs are put into the job queue only when their
- * scheduled time arrives.
+ * this is only used for jobs started from the console
+ * for which the user explicitly specified a start time and for
+ * rescheduled jobs. Otherwise most jobs are put into the job
+ * queue only when their scheduled time arrives.
+ *
+ * One thread serves all such jobs, sleeping until the earliest
+ * start time in the heap or until it gets woken up because a
+ * job with an earlier start time was added.
  */
-extern "C" void* sched_wait(void* arg)
+extern "C" void* jobq_timer(void* arg)
 {
-  JobControlRecord* jcr = ((wait_pkt*)arg)->jcr;
-  jobq_t* jq = ((wait_pkt*)arg)->jq;
+  jobq_t* jq = (jobq_t*)arg;
 
   SetJcrInThreadSpecificData(nullptr);
-  Dmsg0(2300, "Enter sched_wait.\n");
-  free(arg);
-  time_t wtime = jcr->sched_time - time(NULL);
-  jcr->setJobStatusWithPriorityCheck(JS_WaitStartTime);
+  Dmsg0(2300, "Start jobq_timer\n");
+  lock_mutex(jq->mutex);
 
-  // Wait until scheduled time arrives
-  if (wtime > 0) {
-    Jmsg(jcr, M_INFO, 0,
-         T_("Job %s waiting %lld seconds for scheduled start time.\n"),
-         jcr->Job, static_cast<long long>(wtime));
-  }
+  while (!jq->quit) {
+    if (jq->delayed_jobs->empty()) {
+      pthread_cond_wait(&jq->timer, &jq->mutex);
+      continue;
+    }
+
+    jobq_item_t* item = jq->delayed_jobs->front();
+    time_t now = time(NULL);
+    if (item->jcr->sched_time > now) {
+      struct timespec timeout;
 
-  // Check every 30 seconds if canceled
-  while (wtime > 0) {
-    Dmsg3(2300, "Waiting on sched time, jobid=%" PRIu32 " secs=%lld use=%d\n",
-          jcr->JobId, static_cast<long long>(wtime), jcr->UseCount());
-    if (wtime > 30) { wtime = 30; }
-    Bmicrosleep(wtime, 0);
-    if (jcr->IsJobCanceled()) { break; }
-    wtime = jcr->sched_time - time(NULL);
+      timeout.tv_sec = item->jcr->sched_time;
+      timeout.tv_nsec = 0;
+      Dmsg2(2300, "Waiting on sched time, jobid=%" PRIu32 " secs=%lld\n",
+            item->jcr->JobId,
+            static_cast<long long>(item->jcr->sched_time - now));
+      pthread_cond_timedwait(&jq->timer, &jq->mutex, &timeout);
+      continue;
+    }
+
+    std::pop_heap(jq->delayed_jobs->begin(), jq->delayed_jobs->end(),
+                  StartsLater);
+    jq->delayed_jobs->pop_back();
+    Dmsg1(200, "resched use=%d\n", item->jcr->UseCount());
+    QueueJob(jq, item);
   }
-  Dmsg1(200, "resched use=%d\n", jcr->UseCount());
-  JobqAdd(jq, jcr);
-  FreeJcr(jcr); /* we are done with jcr */
-  Dmsg0(2300, "Exit sched_wait\n");
+
+  jq->timer_running = false;
+
+  // Wake up destroy routine if he is waiting
+  pthread_cond_broadcast(&jq->work);
+  unlock_mutex(jq->mutex);
+  Dmsg0(2300, "End jobq_timer\n");
 
   return NULL;
 }
@@ -200,11 +312,8 @@ extern "C" void* sched_wait(void* arg)
 int JobqAdd(jobq_t* jq, JobControlRecord* jcr)
 {
   int status;
-  jobq_item_t *item, *li;
-  bool inserted = false;
+  jobq_item_t* item;
   time_t wtime = jcr->sched_time - time(NULL);
-  pthread_t id;
-  wait_pkt* sched_pkt;
 
   Dmsg3(2300, "JobqAdd jobid=%" PRIu32 " jcr=%p UseCount=%d\n", jcr->JobId, jcr,
         jcr->UseCount());
@@ -216,29 +325,56 @@ int JobqAdd(jobq_t* jq, JobControlRecord* jcr)
   jcr->IncUseCount(); /* mark jcr in use by us */
   Dmsg3(2300, "JobqAdd jobid=%" PRIu32 " jcr=%p UseCount=%d\n", jcr->JobId, jcr,
         jcr->UseCount());
-  if (!jcr->IsJobCanceled() && wtime > 0) {
-    sched_pkt = (wait_pkt*)malloc(sizeof(wait_pkt));
-    sched_pkt->jcr = jcr;
-    sched_pkt->jq = jq;
-    status = pthread_create(&id, &jq->attr, sched_wait, (void*)sched_pkt);
-    if (status != 0) { /* thread not created */
-      BErrNo be;
-      Jmsg1(jcr, M_ERROR, 0, T_("pthread_thread_create: ERR=%s\n"),
-            be.bstrerror(status));
-    }
-    return status;
-  }
-
-  lock_mutex(jq->mutex);
 
   if ((item = (jobq_item_t*)malloc(sizeof(jobq_item_t))) == NULL) {
     FreeJcr(jcr); /* release jcr */
     return ENOMEM;
   }
   item->jcr = jcr;
+  item->blocked_on = nullptr;
+  item->blocked_release = 0;
+  item->queued = 0;
+
+  if (!jcr->IsJobCanceled() && wtime > 0) {
+    jcr->setJobStatusWithPriorityCheck(JS_WaitStartTime);
+    Jmsg(jcr, M_INFO, 0,
+         T_("Job %s waiting %lld seconds for scheduled start time.\n"),
+         jcr->Job, static_cast<long long>(wtime));
+
+    lock_mutex(jq->mutex);
+    if ((status = StartTimer(jq)) == 0) {
+      jq->delayed_jobs->push_back(item);
+      std::push_heap(jq->delayed_jobs->begin(), jq->delayed_jobs->end(),
+                     StartsLater);
+    } else {
+      free(item);
+    }
+    unlock_mutex(jq->mutex);
+    return status;
+  }
+
+  lock_mutex(jq->mutex);
 
   // While waiting in a queue this job is not attached to a thread
   SetJcrInThreadSpecificData(nullptr);
+  status = QueueJob(jq, item);
+
+  unlock_mutex(jq->mutex);
+  Dmsg0(2300, "Return JobqAdd\n");
+  return status;
+}
+
+/**
+ * Put a job whose start time has come into the wait queue.
+ * Must be called with jq->mutex held.
+ */
+static int QueueJob(jobq_t* jq, jobq_item_t* item)
+{
+  JobControlRecord* jcr = item->jcr;
+  jobq_item_t* li;
+  bool inserted = false;
+
+  item->queued = time(nullptr);
   if (jcr->IsJobCanceled()) {
     // Add job to ready queue so that it is canceled quickly
     jq->ready_jobs->prepend(item);
@@ -267,11 +403,8 @@ int JobqAdd(jobq_t* jq, JobControlRecord* jcr)
   }
 
   // Ensure that at least one server looks at the queue.
-  status = StartServer(jq);
-
-  unlock_mutex(jq->mutex);
-  Dmsg0(2300, "Return JobqAdd\n");
-  return status;
+  pthread_cond_signal(&jq->work);
+  return StartServer(jq);
 }
 
 /**
@@ -297,19 +430,31 @@ int JobqRemove(jobq_t* jq, JobControlRecord* jcr)
       break;
     }
   }
-  if (!found) {
-    unlock_mutex(jq->mutex);
-    Dmsg2(2300, "JobqRemove jobid=%" PRIu32 " jcr=%p not in wait queue\n",
-          jcr->JobId, jcr);
-    return EINVAL;
+  if (found) {
+    jq->waiting_jobs->remove(item);
+  } else {
+    // Maybe it is still waiting for its start time
+    auto it = std::find_if(
+        jq->delayed_jobs->begin(), jq->delayed_jobs->end(),
+        [jcr](const jobq_item_t* delayed) { return delayed->jcr == jcr; });
+    if (it == jq->delayed_jobs->end()) {
+      unlock_mutex(jq->mutex);
+      Dmsg2(2300, "JobqRemove jobid=%" PRIu32 " jcr=%p not in wait queue\n",
+            jcr->JobId, jcr);
+      return EINVAL;
+    }
+    item = *it;
+    jq->delayed_jobs->erase(it);
+    std::make_heap(jq->delayed_jobs->begin(), jq->delayed_jobs->end(),
+                   StartsLater);
   }
 
   // Move item to be the first on the list
-  jq->waiting_jobs->remove(item);
   jq->ready_jobs->prepend(item);
   Dmsg2(2300, "JobqRemove jobid=%" PRIu32 " jcr=%p moved to ready queue\n",
         jcr->JobId, jcr);
 
+  pthread_cond_signal(&jq->work);
   status = StartServer(jq);
 
   unlock_mutex(jq->mutex);
@@ -317,6 +462,28 @@ int JobqRemove(jobq_t* jq, JobControlRecord* jcr)
   return status;
 }
 
+// Start the timer thread if it isn't already running, otherwise wake it up
+static int StartTimer(jobq_t* jq)
+{
+  int status = 0;
+  pthread_t id;
+
+  if (jq->timer_running) {
+    pthread_cond_signal(&jq->timer);
+    return 0;
+  }
+
+  Dmsg0(2300, "Create timer thread\n");
+  if ((status = pthread_create(&id, &jq->attr, jobq_timer, (void*)jq)) != 0) {
+    BErrNo be;
+    Jmsg1(NULL, M_ERROR, 0, T_("pthread_create: ERR=%s\n"),
+          be.bstrerror(status));
+    return status;
+  }
+  jq->timer_running = true;
+  return 0;
+}
+
 // Start the server thread if it isn't already running
 static int StartServer(jobq_t* jq)
 {
@@ -350,6 +517,7 @@ extern "C" void* jobq_server(void* arg)
   int status;
   bool timedout = false;
   bool work = true;
+  bool recheck_all = true;
 
   SetJcrInThreadSpecificData(nullptr);
   Dmsg0(2300, "Start jobq_server\n");
@@ -393,6 +561,7 @@ extern "C" void* jobq_server(void* arg)
       jq->ready_jobs->remove(je);
       if (!jq->ready_jobs->empty()) {
         Dmsg0(2300, "ready queue not empty start server\n");
+        pthread_cond_signal(&jq->work);
         if (StartServer(jq) != 0) {
           jq->num_workers--;
           unlock_mutex(jq->mutex);
@@ -400,6 +569,9 @@ extern "C" void* jobq_server(void* arg)
         }
       }
       jq->running_jobs->append(je);
+      if (je->queued) {
+        WaitTime().Observe(static_cast<double>(time(nullptr) - je->queued));
+      }
 
       // Attach jcr to this thread while we run the job
       jcr->SetKillable(true);
@@ -431,11 +603,13 @@ extern "C" void* jobq_server(void* arg)
        * been acquired for jobs canceled before they were put into the ready
        * queue. */
       if (jcr->dir_impl->acquired_resource_locks) {
-        DecReadStore(jcr);
+        ReleaseReadStore(jcr);
         DecWriteStore(jcr);
         DecClientConcurrency(jcr);
         DecJobConcurrency(jcr);
         jcr->dir_impl->acquired_resource_locks = false;
+        // the other servers might sleep on the released resources
+        pthread_cond_broadcast(&jq->work);
       }
 
       if (RescheduleJob(jcr, jq, je)) { continue; /* go look for more work */ }
@@ -499,7 +673,14 @@ extern "C" void* jobq_server(void* arg)
           break;
         }
 
-        if (!AcquireResources(jcr)) {
+        /* Don't bother with jobs whose missing resource wasn't released
+         * since we last tried. */
+        if (!recheck_all && !MayAcquireResources(je)) {
+          je = jn;
+          continue;
+        }
+
+        if (!AcquireResources(je)) {
           // If resource conflict, job is canceled
           if (!jcr->IsJobCanceled()) {
             je = jn; /* point to next waiting job */
@@ -517,6 +698,7 @@ extern "C" void* jobq_server(void* arg)
         je = jn; /* Point to next waiting job */
       } /* end for loop */
     } /* end if */
+    recheck_all = false;
 
     Dmsg0(2300, "Done checking wait queue.\n");
 
@@ -545,16 +727,17 @@ extern "C" void* jobq_server(void* arg)
     }
 
     work = !jq->ready_jobs->empty() || !jq->waiting_jobs->empty();
-    if (work) {
-      /* If a job is waiting on a Resource, don't consume all
-       * the CPU time looping looking for work, and even more
-       * important, release the lock so that a job that has
-       * terminated can give us the resource. */
-      unlock_mutex(jq->mutex);
-      Bmicrosleep(2, 0); /* pause for 2 seconds */
-      lock_mutex(jq->mutex);
+    if (jq->ready_jobs->empty() && !jq->waiting_jobs->empty()) {
+      /* All waiting jobs are stuck on a resource or their priority.
+       * Sleep until a job gets added, removed or ready to run, or until a
+       * resource gets released, so there is nothing to poll for. */
+      gettimeofday(&tv, NULL);
+      timeout.tv_nsec = tv.tv_usec * 1000;
+      timeout.tv_sec = tv.tv_sec + kResourceRecheckInterval;
+      Dmsg0(2300, "Waiting for resources to be released\n");
+      status = pthread_cond_timedwait(&jq->work, &jq->mutex, &timeout);
+      if (status == ETIMEDOUT) { recheck_all = true; }
 
-      // Recompute work as something may have changed in last 2 secs
       work = !jq->ready_jobs->empty() || !jq->waiting_jobs->empty();
     }
     Dmsg1(2300, "Loop again. work=%d\n", work);
@@ -692,6 +875,34 @@ static bool RescheduleJob(JobControlRecord* jcr, jobq_t* jq, jobq_item_t* je)
   return retval;
 }
 
+/* Remember that je could not get the resource with the given release
+ * counter. Must be called with mutex held. */
+static void NoteBlocked(jobq_item_t* je, const uint64_t& releases)
+{
+  if (!je) { return; }
+  je->blocked_on = &releases;
+  je->blocked_release = releases;
+}
+
+// A slot of a resource became free. Must be called with mutex held.
+static void NoteReleased(uint64_t& releases) { releases++; }
+
+/**
+ * See if it makes sense to try to acquire the resources of a waiting job,
+ * i.e. it was never tried, got canceled or the resource it is waiting for
+ * was released since the last try.
+ */
+static bool MayAcquireResources(jobq_item_t* je)
+{
+  if (!je->blocked_on || je->jcr->IsJobCanceled()) { return true; }
+
+  lock_mutex(mutex);
+  bool released = *je->blocked_on != je->blocked_release;
+  unlock_mutex(mutex);
+
+  return released;
+}
+
 /**
  * See if we can acquire all the necessary resources for the job
  * (JobControlRecord)
@@ -699,10 +910,13 @@ static bool RescheduleJob(JobControlRecord* jcr, jobq_t* jq, jobq_item_t* je)
  *  Returns: true  if successful
  *           false if resource failure
  */
-static bool AcquireResources(JobControlRecord* jcr)
+static bool AcquireResources(jobq_item_t* je)
 {
+  JobControlRecord* jcr = je->jcr;
+
   // Set that we didn't acquire any resource locks yet.
   jcr->dir_impl->acquired_resource_locks = false;
+  je->blocked_on = nullptr;
 
   /* Some Job Types are excluded from the client and storage concurrency
    * as they have no interaction with the client or storage at all. */
@@ -730,7 +944,7 @@ static bool AcquireResources(JobControlRecord* jcr)
   }
 
   if (jcr->dir_impl->res.read_storage) {
-    if (!IncReadStore(jcr)) {
+    if (!IncReadStore(jcr, je)) {
       jcr->setJobStatusWithPriorityCheck(JS_WaitStoreRes);
 
       return false;
@@ -738,27 +952,27 @@ static bool AcquireResources(JobControlRecord* jcr)
   }
 
   if (jcr->dir_impl->res.write_storage) {
-    if (!IncWriteStore(jcr)) {
-      DecReadStore(jcr);
+    if (!IncWriteStore(jcr, je)) {
+      ReleaseReadStore(jcr);
       jcr->setJobStatusWithPriorityCheck(JS_WaitStoreRes);
 
       return false;
     }
   }
 
-  if (!IncClientConcurrency(jcr)) {
+  if (!IncClientConcurrency(jcr, je)) {
     // Back out previous locks
     DecWriteStore(jcr);
-    DecReadStore(jcr);
+    ReleaseReadStore(jcr);
     jcr->setJobStatusWithPriorityCheck(JS_WaitClientRes);
 
     return false;
   }
 
-  if (!IncJobConcurrency(jcr)) {
+  if (!IncJobConcurrency(jcr, je)) {
     // Back out previous locks
     DecWriteStore(jcr);
-    DecReadStore(jcr);
+    ReleaseReadStore(jcr);
     DecClientConcurrency(jcr);
     jcr->setJobStatusWithPriorityCheck(JS_WaitJobRes);
 
@@ -770,7 +984,7 @@ static bool AcquireResources(JobControlRecord* jcr)
   return true;
 }
 
-static bool IncClientConcurrency(JobControlRecord* jcr)
+static bool IncClientConcurrency(JobControlRecord* jcr, jobq_item_t* je)
 {
   if (!jcr->dir_impl->res.client || jcr->dir_impl->IgnoreClientConcurrency) {
     return true;
@@ -788,6 +1002,7 @@ static bool IncClientConcurrency(JobControlRecord* jcr)
     return true;
   }
 
+  NoteBlocked(je, jcr->dir_impl->res.client->rcs->Releases);
   unlock_mutex(mutex);
 
   return false;
@@ -803,11 +1018,12 @@ static void DecClientConcurrency(JobControlRecord* jcr)
     Dmsg2(50, "Dec Client=%s rncj=%d\n",
           jcr->dir_impl->res.client->resource_name_,
           jcr->dir_impl->res.client->rcs->NumConcurrentJobs);
+    NoteReleased(jcr->dir_impl->res.client->rcs->Releases);
   }
   unlock_mutex(mutex);
 }
 
-static bool IncJobConcurrency(JobControlRecord* jcr)
+static bool IncJobConcurrency(JobControlRecord* jcr, jobq_item_t* je)
 {
   lock_mutex(mutex);
   if (jcr->dir_impl->res.rjs->NumConcurrentJobs
@@ -820,6 +1036,7 @@ static bool IncJobConcurrency(JobControlRecord* jcr)
     return true;
   }
 
+  NoteBlocked(je, jcr->dir_impl->res.rjs->Releases);
   unlock_mutex(mutex);
 
   return false;
@@ -831,6 +1048,7 @@ static void DecJobConcurrency(JobControlRecord* jcr)
   jcr->dir_impl->res.rjs->NumConcurrentJobs--;
   Dmsg2(50, "Dec Job=%s rncj=%d\n", jcr->dir_impl->res.job->resource_name_,
         jcr->dir_impl->res.rjs->NumConcurrentJobs);
+  NoteReleased(jcr->dir_impl->res.rjs->Releases);
   unlock_mutex(mutex);
 }
 
@@ -838,7 +1056,7 @@ static void DecJobConcurrency(JobControlRecord* jcr)
  * Note: IncReadStore() and DecReadStore() are
  * called from SelectNextRstore() in src/dird/job.c
  */
-bool IncReadStore(JobControlRecord* jcr)
+bool IncReadStore(JobControlRecord* jcr, jobq_item_t* je)
 {
   if (jcr->dir_impl->IgnoreStorageConcurrency) { return true; }
 
@@ -857,6 +1075,8 @@ bool IncReadStore(JobControlRecord* jcr)
 
     return true;
   }
+  NoteBlocked(
+      je, jcr->dir_impl->res.read_storage->runtime_storage_status->Releases);
   unlock_mutex(mutex);
 
   Dmsg2(50, "Fail to acquire Rstore=%s rncj=%d\n",
@@ -867,7 +1087,29 @@ bool IncReadStore(JobControlRecord* jcr)
   return false;
 }
 
+/* Wakes up the servers of all job queues, so that jobs waiting for a resource
+ * that was released outside of a job queue are retried right away.  Must not
+ * be called with a job queue lock held. */
+static void WakeWaitingJobs()
+{
+  lock_mutex(mutex);
+  std::vector<jobq_t*> queues = job_queues;
+  unlock_mutex(mutex);
+
+  for (jobq_t* jq : queues) {
+    lock_mutex(jq->mutex);
+    pthread_cond_broadcast(&jq->work);
+    unlock_mutex(jq->mutex);
+  }
+}
+
 void DecReadStore(JobControlRecord* jcr)
+{
+  ReleaseReadStore(jcr);
+  WakeWaitingJobs();
+}
+
+static void ReleaseReadStore(JobControlRecord* jcr)
 {
   if (jcr->dir_impl->res.read_storage
       && !jcr->dir_impl->IgnoreStorageConcurrency) {
@@ -898,11 +1140,13 @@ void DecReadStore(JobControlRecord* jcr)
            jcr->dir_impl->res.read_storage->runtime_storage_status
                ->NumConcurrentJobs);
     }
+    NoteReleased(
+        jcr->dir_impl->res.read_storage->runtime_storage_status->Releases);
     unlock_mutex(mutex);
   }
 }
 
-static bool IncWriteStore(JobControlRecord* jcr)
+static bool IncWriteStore(JobControlRecord* jcr, jobq_item_t* je)
 {
   if (jcr->dir_impl->IgnoreStorageConcurrency) { return true; }
 
@@ -920,6 +1164,8 @@ static bool IncWriteStore(JobControlRecord* jcr)
 
     return true;
   }
+  NoteBlocked(
+      je, jcr->dir_impl->res.write_storage->runtime_storage_status->Releases);
   unlock_mutex(mutex);
 
   Dmsg2(50, "Fail to acquire Wstore=%s wncj=%d\n",
@@ -950,6 +1196,8 @@ static void DecWriteStore(JobControlRecord* jcr)
            jcr->dir_impl->res.write_storage->runtime_storage_status
                ->NumConcurrentJobs);
     }
+    NoteReleased(
+        jcr->dir_impl->res.write_storage->runtime_storage_status->Releases);
     unlock_mutex(mutex);
   }
 }
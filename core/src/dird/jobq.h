@@ -2,7 +2,7 @@
    BAREOS® - Backup Archiving REcovery Open Sourced
 
    Copyright (C) 2000-2006 Free Software Foundation Europe e.V.
-   Copyright (C) 2016-2021 Bareos GmbH & Co. KG
+   Copyright (C) 2016-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -36,6 +36,9 @@
 #include "lib/dlink.h"
 #include "include/jcr.h"
 
+#include <cstdint>
+#include <vector>
+
 template <typename T> class dlist;
 
 namespace directordaemon {
@@ -44,21 +47,28 @@ namespace directordaemon {
 struct jobq_item_t {
   dlink<jobq_item_t> link;
   JobControlRecord* jcr;
+  const uint64_t* blocked_on; /* releases of the resource it could not get */
+  uint64_t blocked_release;   /* value of *blocked_on at the time */
+  time_t queued;            /* time the job entered the wait queue */
 };
 
 // Structure describing a work queue
 struct jobq_t {
-  pthread_mutex_t mutex;            /* queue access control */
-  pthread_cond_t work;              /* wait for work */
-  pthread_attr_t attr;              /* create detached threads */
-  dlist<jobq_item_t>* waiting_jobs; /* list of jobs waiting */
-  dlist<jobq_item_t>* running_jobs; /* jobs running */
-  dlist<jobq_item_t>* ready_jobs;   /* jobs ready to run */
-  int valid;                        /* queue initialized */
-  bool quit;                        /* jobq should quit */
-  int max_workers;                  /* max threads */
-  int num_workers;                  /* current threads */
-  void* (*engine)(void* arg);       /* user engine */
+  pthread_mutex_t mutex;                   /* queue access control */
+  pthread_cond_t work;                     /* wait for work */
+  pthread_cond_t timer;                    /* wake up the timer thread */
+  pthread_attr_t attr;                     /* create detached threads */
+  dlist<jobq_item_t>* waiting_jobs;        /* list of jobs waiting */
+  dlist<jobq_item_t>* running_jobs;        /* jobs running */
+  dlist<jobq_item_t>* ready_jobs;          /* jobs ready to run */
+  std::vector<jobq_item_t*>* delayed_jobs; /* heap of jobs by start time */
+  int valid;                               /* queue initialized */
+  bool quit;                               /* jobq should quit */
+  bool timer_running;                      /* timer thread started */
+  int max_workers;                         /* max threads */
+  int num_workers;                         /* current threads */
+  void* (*engine)(void* arg);              /* user engine */
+  std::size_t metrics_collector;           /* reports the queue lengths */
 };
 
 #define JOBQ_VALID 0xdec1993
@@ -71,7 +81,7 @@ extern int JobqDestroy(jobq_t* wq);
 extern int JobqAdd(jobq_t* wq, JobControlRecord* jcr);
 extern int JobqRemove(jobq_t* wq, JobControlRecord* jcr);
 
-bool IncReadStore(JobControlRecord* jcr);
+bool IncReadStore(JobControlRecord* jcr, jobq_item_t* je = nullptr);
 void DecReadStore(JobControlRecord* jcr);
 
 } /* namespace directordaemon */
@@ -1730,6 +1730,7 @@ void MigrationCleanup(JobControlRecord* jcr, int TermCode)
             case APT_NDMPV2:
             case APT_NDMPV3:
             case APT_NDMPV4:
+              mig_jcr->db->CreateFilePartition(mig_jcr->dir_impl->jr.JobId);
               Mmsg(query, sql_migrate_ndmp_metadata, new_jobid, old_jobid,
                    new_jobid);
               mig_jcr->db->SqlQuery(query.c_str());
@@ -1769,6 +1770,7 @@ void MigrationCleanup(JobControlRecord* jcr, int TermCode)
             case APT_NDMPV2:
             case APT_NDMPV3:
             case APT_NDMPV4:
+              mig_jcr->db->CreateFilePartition(mig_jcr->dir_impl->jr.JobId);
               Mmsg(query, sql_copy_ndmp_metadata, new_jobid, old_jobid,
                    new_jobid);
               mig_jcr->db->SqlQuery(query.c_str());
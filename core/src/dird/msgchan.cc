@@ -58,7 +58,7 @@ inline constexpr const char jobcmd[]
       "rerunning=%d VolSessionId=%" PRIu32 " VolSessionTime=%" PRIu32
       " Quota=%" PRIu64
       " "
-      "Protocol=%d BackupFormat=%s\n";
+      "Protocol=%d BackupFormat=%s Priority=%d\n";
 inline constexpr const char use_storage[]
     = "use storage=%s media_type=%s pool_name=%s "
       "pool_type=%s append=%d copy=%d stripe=%d\n";
@@ -366,7 +366,7 @@ bool StartStorageDaemonJob(JobControlRecord* jcr, bool send_bsr)
       jcr->dir_impl->spool_data, jcr->dir_impl->res.job->PreferMountedVolumes,
       edit_int64(jcr->dir_impl->spool_size, ed2), jcr->rerunning,
       jcr->VolSessionId, jcr->VolSessionTime, remainingquota,
-      jcr->getJobProtocol(), backup_format.c_str());
+      jcr->getJobProtocol(), backup_format.c_str(), jcr->JobPriority);
 
   Dmsg1(100, ">stored: %s", sd_socket->msg);
   if (BgetDirmsg(sd_socket) > 0) {
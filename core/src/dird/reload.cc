@@ -20,6 +20,7 @@
 */
 
 #include "dird/reload.h"
+#include "dird/ua.h"
 
 #include <cassert>
 #include <atomic>
@@ -129,7 +130,10 @@ bool CheckResources()
         && (console->user_acl.HasAcl() || console->user_acl.profiles)) {
       consoles_with_auth_problems.emplace_back(console->resource_name_);
     }
+    UserAcl::compiled(console);
   }
+  UserResource* user;
+  foreach_res (user, R_USER) { UserAcl::compiled(user); }
   if (!consoles_with_auth_problems.empty()) {
     Jmsg(nullptr, M_FATAL, 0,
          "Combining `Use Pam Authentication` with ACL commands or `Profile` in "
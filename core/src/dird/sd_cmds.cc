@@ -66,6 +66,10 @@ inline constexpr const char dotstatuscmd[] = ".status %s\n";
 inline constexpr const char statuscmd[] = "status %s\n";
 inline constexpr const char bandwidthcmd[]
     = "setbandwidth=%" PRId64 " Job=%s\n";
+inline constexpr const char sharedbandwidthcmd[]
+    = "setbandwidth=%" PRId64 " Shared\n";
+inline constexpr const char interfacebandwidthcmd[]
+    = "setbandwidth=%" PRId64 " Shared Interface=%s\n";
 inline constexpr const char pluginoptionscmd[] = "pluginoptions %s\n";
 inline constexpr const char getSecureEraseCmd[] = "getSecureEraseCmd\n";
 
@@ -869,6 +873,19 @@ bool SendBwlimitToSd(JobControlRecord* jcr, const char* Job)
   return true;
 }
 
+// Without an address the limit shared by all jobs of the daemon is set.
+bool SendSharedBwlimitToSd(JobControlRecord* jcr, const char* address)
+{
+  BareosSocket* sd = jcr->store_bsock;
+
+  if (address) {
+    sd->fsend(interfacebandwidthcmd, jcr->max_bandwidth, address);
+  } else {
+    sd->fsend(sharedbandwidthcmd, jcr->max_bandwidth);
+  }
+  return response(jcr, sd, OKBandwidth, "Bandwidth", DISPLAY_ERROR);
+}
+
 bool DoStorageResolve(UaContext* ua, StorageResource* store)
 {
   BareosSocket* sd;
@@ -62,6 +62,7 @@ bool NativeAutochangerVolumeOperation(UaContext* ua,
                                       drive_number_t drive,
                                       slot_number_t slot);
 bool SendBwlimitToSd(JobControlRecord* jcr, const char* Job);
+bool SendSharedBwlimitToSd(JobControlRecord* jcr, const char* address);
 bool SendSecureEraseReqToSd(JobControlRecord* jcr);
 bool DoStorageResolve(UaContext* ua, StorageResource* store);
 bool SendStoragePluginOptions(JobControlRecord* jcr);
@@ -33,6 +33,15 @@
 #include "lib/bsock.h"
 #include "dird/dird_conf.h"
 
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 class JobControlRecord;
 class BareosDb;
 class guid_list;
@@ -45,10 +54,49 @@ namespace directordaemon {
 struct ua_cmdstruct;
 struct RestoreBootstrapRecord;
 
+/**
+ * An ACL list prepared for checking items against it.  Literal entries
+ * are looked up in a hash map and regular expressions are compiled only
+ * once.  Just like for the plain list the first matching entry decides.
+ */
+class AclMatcher {
+ public:
+  AclMatcher() = default;
+  explicit AclMatcher(std::span<const std::string> list);
+
+  // Returns whether the first matching entry allows or denies the item.
+  std::optional<bool> Find(int acl, const char* item, int item_length) const;
+
+ private:
+  static constexpr std::size_t kNoMatch
+      = std::numeric_limits<std::size_t>::max();
+
+  struct RegexFree {
+    void operator()(regex_t* preg) const
+    {
+      regfree(preg);
+      delete preg;
+    }
+  };
+  struct Regex {
+    std::size_t position;
+    std::unique_ptr<regex_t, RegexFree> preg;
+  };
+
+  // per entry of the list: allow or deny
+  std::vector<bool> allow_{};
+  // lower case name -> first entry with that name
+  std::unordered_map<std::string, std::size_t> literals_{};
+  // regular expressions in list order
+  std::vector<Regex> regexes_{};
+  std::size_t all_position_{kNoMatch};
+};
+
 struct UserAcl {
   std::string name{};
 
   std::vector<std::string> acl_lists[Num_ACL];
+  AclMatcher matchers[Num_ACL]; /**< acl_lists prepared for AclAccessOk */
 
   template <typename Resource,
             AclConfig Resource::* Accessor = &Resource::user_acl>
@@ -71,10 +119,25 @@ struct UserAcl {
       for (auto* profile : cfg->profiles) {
         for (auto* entry : profile->ACL_lists[acl]) { list.push_back(entry); }
       }
+
+      result->matchers[acl] = AclMatcher(list);
     }
 
     return result;
   }
+
+  /* The ACLs of a console or user only change together with the
+   * configuration, so they are prepared once per resource and shared by
+   * all of its sessions.  A reload creates new resources and with them
+   * new ACLs, while running sessions keep the ones they started with. */
+  template <typename Resource>
+  static std::shared_ptr<const UserAcl> compiled(Resource* res)
+  {
+    static std::mutex mutex;
+    std::lock_guard lock(mutex);
+    if (!res->compiled_acl) { res->compiled_acl = from_config(res); }
+    return res->compiled_acl;
+  }
 };
 
 class UaContext {
@@ -97,7 +160,7 @@ class UaContext {
   BareosDb* private_db{
       nullptr}; /**< Private database connection only used by this ua */
   CatalogResource* catalog{nullptr};
-  std::unique_ptr<UserAcl> user_acl{
+  std::shared_ptr<const UserAcl> user_acl{
       nullptr};                       /**< acl from console or user resource */
   POOLMEM* cmd;                       /**< Return command/name buffer */
   POOLMEM* args;                      /**< Command line arguments */
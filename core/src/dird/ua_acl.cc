@@ -32,6 +32,8 @@
 #include "lib/edit.h"
 #include "lib/parse_conf.h"
 
+#include <algorithm>
+#include <cctype>
 #include <string>
 
 namespace directordaemon {
@@ -52,89 +54,86 @@ constexpr bool is_regex(std::string_view string_to_check)
   return string_to_check.npos != string_to_check.find_first_of(".()[]|^$+?*");
 }
 
-/**
- * acl_list_value: value of the ACL definition.
- * acl_list_compare_value: value to compare against. This is identical to
- * acl_list_value or a modified acl_list_value to compare against.
- */
-static inline bool CompareAclListValueWithItem(
-    int acl,
-    const char* acl_list_value,
-    const char* acl_list_compare_value,
-    const char* item,
-    int item_length)
+static std::string ToLower(const char* value)
 {
-  // gives full access
-  if (Bstrcasecmp("*all*", acl_list_compare_value)) {
-    Dmsg2(1400, "Global ACL found in %d %s\n", acl, acl_list_value);
-    return true;
+  std::string lower{value};
+  for (auto& c : lower) {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
   }
+  return lower;
+}
 
-  if (Bstrcasecmp(item, acl_list_compare_value)) {
-    // Explicit match.
-    Dmsg3(1400, "ACL found %s in %d %s\n", item, acl, acl_list_value);
-    return true;
-  }
+AclMatcher::AclMatcher(std::span<const std::string> list)
+{
+  allow_.reserve(list.size());
+  for (std::size_t position = 0; position < list.size(); ++position) {
+    const std::string& list_value = list[position];
 
-  /* If we didn't get an exact match see if we can use the pattern as a
-   * regex. */
-  if (is_regex(acl_list_compare_value)) {
-    regex_t preg{};
-    int rc = regcomp(&preg, acl_list_compare_value, REG_EXTENDED | REG_ICASE);
-    if (rc != 0) {
-      // Not a valid regular expression so skip it.
-      Dmsg1(1400, "Not a valid regex %s, ignoring for regex compare\n",
-            acl_list_value);
-      return false;
+    // See if this is a deny acl.
+    const bool deny = !list_value.empty() && list_value[0] == '!';
+    const char* compare_value = list_value.c_str() + (deny ? 1 : 0);
+    allow_.push_back(!deny);
+
+    // gives full access
+    if (Bstrcasecmp("*all*", compare_value)) {
+      all_position_ = std::min(all_position_, position);
+      continue;
     }
 
-    int nmatch = 1;
-    regmatch_t pmatch[1]{};
-    if (regexec(&preg, item, nmatch, pmatch, 0) == 0) {
-      // Make sure its not a partial match but a full match.
-      Dmsg2(1400, "Found match start offset %" PRIiz " end offset %" PRIiz "\n",
-            static_cast<ssize_t>(pmatch[0].rm_so),
-            static_cast<ssize_t>(pmatch[0].rm_eo));
-      if ((pmatch[0].rm_eo - pmatch[0].rm_so) >= item_length) {
-        Dmsg3(1400, "ACL found %s in %d using regex %s\n", item, acl,
-              acl_list_value);
-        regfree(&preg);
-        return true;
+    // only the first entry for a name can ever match
+    literals_.emplace(ToLower(compare_value), position);
+
+    /* If the item is not matched literally, see if we can use the pattern
+     * as a regex. */
+    if (is_regex(compare_value)) {
+      auto preg = std::make_unique<regex_t>();
+      if (regcomp(preg.get(), compare_value, REG_EXTENDED | REG_ICASE) != 0) {
+        // Not a valid regular expression so skip it.
+        Dmsg1(1400, "Not a valid regex %s, ignoring for regex compare\n",
+              list_value.c_str());
+        continue;
       }
+      regexes_.push_back(
+          {position, std::unique_ptr<regex_t, RegexFree>(preg.release())});
     }
-    regfree(&preg);
   }
-  return false;
 }
 
 /**
- * Loop over the items in the alist and verify if they match the given item
- * that access was requested for.
+ * Find the first entry of the list that matches the item that access was
+ * requested for.  Only regexes in front of the first literal match have to
+ * be tried.
  */
-static inline std::optional<bool> FindInAclList(
-    std::span<const std::string> list,
-    int acl,
-    const char* item,
-    int item_length)
+std::optional<bool> AclMatcher::Find(int acl,
+                                     const char* item,
+                                     int item_length) const
 {
-  // Search list for item
-  for (auto& list_value : list) {
-    // See if this is a deny acl.
-    if (list_value[0] == '!') {
-      if (CompareAclListValueWithItem(acl, list_value.c_str(),
-                                      list_value.c_str() + 1, item,
-                                      item_length)) {
-        return false;
-      }
-    } else {
-      if (CompareAclListValueWithItem(acl, list_value.c_str(),
-                                      list_value.c_str(), item, item_length)) {
-        return true;
+  std::size_t first = all_position_;
+
+  if (auto found = literals_.find(ToLower(item)); found != literals_.end()) {
+    first = std::min(first, found->second);
+  }
+
+  for (auto& regex : regexes_) {
+    if (regex.position >= first) { break; }
+
+    regmatch_t pmatch[1]{};
+    if (regexec(regex.preg.get(), item, 1, pmatch, 0) == 0) {
+      // Make sure its not a partial match but a full match.
+      Dmsg2(1400, "Found match start offset %" PRIiz " end offset %" PRIiz "\n",
+            static_cast<ssize_t>(pmatch[0].rm_so),
+            static_cast<ssize_t>(pmatch[0].rm_eo));
+      if ((pmatch[0].rm_eo - pmatch[0].rm_so) >= item_length) {
+        first = regex.position;
+        break;
       }
     }
   }
 
-  return std::nullopt;
+  if (first == kNoMatch) { return std::nullopt; }
+
+  Dmsg3(1400, "ACL found %s in %d at entry %" PRIuz "\n", item, acl, first);
+  return allow_[first];
 }
 
 // This version expects the length of the item which we must check.
@@ -165,7 +164,7 @@ bool UaContext::AclAccessOk(int acl,
     goto bail_out;
   }
 
-  retval = FindInAclList(user_acl->acl_lists[acl], acl, item, item_length);
+  retval = user_acl->matchers[acl].Find(acl, item, item_length);
 
 bail_out:
   if (audit_event && !retval.value_or(false)) {
@@ -334,7 +334,8 @@ static struct ua_cmdstruct commands[] = {
     {NT_("estimate"), EstimateCmd,
      T_("Performs FileSet estimate, listing gives full listing"),
      NT_("fileset=<fileset-name> client=<client-name> level=<level> "
-         "accurate=<yes/no> job=<job-name> listing"),
+         "accurate=<yes/no> job=<job-name> listing | fast "
+         "[timelimit=<seconds>]"),
      true, true},
     {NT_("exit"), quit_cmd, T_("Terminate Bconsole session"), NT_(""), false,
      false},
@@ -453,7 +454,7 @@ static struct ua_cmdstruct commands[] = {
     {NT_("setbandwidth"), SetbwlimitCmd, T_("Sets bandwidth"),
      NT_("[ client=<client-name> | storage=<storage-name> | jobid=<jobid> "
          "| job=<job-name> | ujobid=<unique-jobid> state=<job_state> | all ] "
-         "limit=<nn-kbs> [ yes ]"),
+         "limit=<nn-kbs> [ shared [ interface=<address> ] ] [ yes ]"),
      true, true},
     {NT_("setdebug"), SetdebugCmd, T_("Sets debug level"),
      NT_("level=<nn> trace=0/1 timestamp=0/1 client=<client-name> | dir | "
@@ -882,10 +883,14 @@ static inline bool SetbwlimitFiled(UaContext* ua,
   return true;
 }
 
+/* With shared set, the limit is the one all jobs of the storage daemon
+ * share, or if an address is given, all jobs using that address. */
 static inline bool setbwlimit_stored(UaContext* ua,
                                      StorageResource* store,
                                      int64_t limit,
-                                     char* Job)
+                                     char* Job,
+                                     bool shared,
+                                     const char* address)
 {
   // Check the storage daemon protocol.
   switch (store->Protocol) {
@@ -914,7 +919,14 @@ static inline bool setbwlimit_stored(UaContext* ua,
   }
 
   Dmsg0(120, "Connected to Storage daemon\n");
-  if (!SendBwlimitToFd(ua->jcr, Job)) {
+  if (shared) {
+    if (!SendSharedBwlimitToSd(ua->jcr, address)) {
+      ua->ErrorMsg(T_("Failed to set bandwidth limit on Storage daemon.\n"));
+    } else {
+      ua->InfoMsg(T_("OK Limiting shared bandwidth to %" PRId64 "kb/s %s\n"),
+                  limit / 1024, address ? address : "");
+    }
+  } else if (!SendBwlimitToSd(ua->jcr, Job)) {
     ua->ErrorMsg(T_("Failed to set bandwidth limit on Storage daemon.\n"));
   } else {
     ua->InfoMsg(T_("OK Limiting bandwidth to %" PRId64 "kb/s %s\n"),
@@ -939,6 +951,10 @@ static bool SetbwlimitCmd(UaContext* ua, const char*)
   StorageResource* store = NULL;
   char Job[MAX_NAME_LENGTH];
   const char* lst[] = {"job", "jobid", "ujobid", "all", "state", NULL};
+  bool shared = false;
+  const char* address = nullptr;
+
+  *Job = 0;
 
   i = FindArgWithValue(ua, NT_("limit"));
   if (i >= 0) { limit = ((int64_t)atoi(ua->argv[i]) * 1024); }
@@ -976,13 +992,20 @@ static bool SetbwlimitCmd(UaContext* ua, const char*)
     delete selection;
   } else if (FindArg(ua, NT_("storage")) >= 0) {
     store = get_storage_resource(ua);
+    shared = FindArg(ua, NT_("shared")) >= 0;
+    if (i = FindArgWithValue(ua, NT_("interface")); i >= 0) {
+      shared = true;
+      address = ua->argv[i];
+    }
   } else {
     client = get_client_resource(ua);
   }
 
   if (client) { return SetbwlimitFiled(ua, client, limit, Job); }
 
-  if (store) { return setbwlimit_stored(ua, store, limit, Job); }
+  if (store) {
+    return setbwlimit_stored(ua, store, limit, Job, shared, address);
+  }
 
   return true;
 }
@@ -1738,6 +1761,8 @@ static bool EstimateCmd(UaContext* ua, const char*)
   ClientResource* client = NULL;
   FilesetResource* fileset = NULL;
   int listing = 0;
+  bool fast = false;
+  uint32_t time_limit = 0;
   JobControlRecord* jcr = ua->jcr;
   bool accurate_set = false;
   bool accurate = false;
@@ -1792,6 +1817,21 @@ static bool EstimateCmd(UaContext* ua, const char*)
       continue;
     }
 
+    if (Bstrcasecmp(ua->argk[i], NT_("fast"))) {
+      fast = true;
+      continue;
+    }
+
+    if (Bstrcasecmp(ua->argk[i], NT_("timelimit"))) {
+      if (ua->argv[i] && Is_a_number(ua->argv[i])) {
+        time_limit = str_to_uint64(ua->argv[i]);
+        continue;
+      } else {
+        ua->ErrorMsg(T_("Time limit in seconds missing.\n"));
+        return false;
+      }
+    }
+
     if (Bstrcasecmp(ua->argk[i], NT_("level"))) {
       if (ua->argv[i]) {
         if (!GetLevelFromName(jcr, ua->argv[i])) {
@@ -1829,6 +1869,15 @@ static bool EstimateCmd(UaContext* ua, const char*)
     }
   }
 
+  if (fast && listing) {
+    ua->ErrorMsg(T_("A fast estimate cannot list the files.\n"));
+    return false;
+  }
+  if (time_limit && !fast) {
+    ua->ErrorMsg(T_("A time limit needs a fast estimate.\n"));
+    return false;
+  }
+
   if (!job && !(client && fileset)) {
     if (!(job = select_job_resource(ua))) { return false; }
   }
@@ -1909,8 +1958,17 @@ static bool EstimateCmd(UaContext* ua, const char*)
     return false;
   }
 
+  if (fast && jcr->dir_impl->FDVersion < FD_VERSION_55) {
+    ua->ErrorMsg(T_("Client %s does not support fast estimates.\n"),
+                 jcr->dir_impl->res.client->resource_name_);
+    goto bail_out;
+  }
+
   // The level string change if accurate mode is enabled
-  if (accurate_set) {
+  if (fast) {
+    // a fast estimate only looks at the file system, not at the catalog
+    jcr->accurate = false;
+  } else if (accurate_set) {
     jcr->accurate = accurate;
   } else {
     jcr->accurate = job->accurate;
@@ -1927,7 +1985,12 @@ static bool EstimateCmd(UaContext* ua, const char*)
   Dmsg1(40, "estimate accurate=%d\n", jcr->accurate);
   if (!SendAccurateCurrentFiles(jcr)) { goto bail_out; }
 
-  jcr->file_bsock->fsend("estimate listing=%d\n", listing);
+  if (fast) {
+    jcr->file_bsock->fsend("estimate listing=0 fast=1 timelimit=%" PRIu32 "\n",
+                           time_limit);
+  } else {
+    jcr->file_bsock->fsend("estimate listing=%d\n", listing);
+  }
   while (jcr->file_bsock->recv() >= 0) {
     ua->SendMsg("%s", jcr->file_bsock->msg);
   }
@@ -217,6 +217,11 @@ bool DoNativeVbackupInit(JobControlRecord* jcr)
  * Do a virtual backup, which consolidates all previous backups into a sort of
  * synthetic Full.
  *
+ * The storage daemon reads every record of the consolidated jobs and writes
+ * it to the new volume, for all device types.  On chunked devices sharing a
+ * chunk store the payload is not stored twice, but it is still read and
+ * written; referencing the existing records instead is not implemented.
+ *
  * Returns:  false on failure
  *           true  on success
  */
@@ -385,6 +390,7 @@ bool DoNativeVbackup(JobControlRecord* jcr)
     jcr->db_batch->WriteBatchFileRecords(
         jcr); /* used by bulk batch file insert */
   }
+  ReportPipelineStats(jcr, {}, "dir");
   if (!jcr->is_JobStatus(JS_Terminated)) { return false; }
 
   NativeVbackupCleanup(jcr, jcr->getJobStatus(), JobLevel_of_first_job);
@@ -471,7 +477,8 @@ void NativeVbackupCleanup(JobControlRecord* jcr, int TermCode, int JobLevel)
           + "SELECT FileIndex, "s + std::to_string(jcr->JobId) + " AS JobId, "s
           + "PathId, LStat, MD5, Name FROM ("s + inner_query.c_str() + ") T "s
           + "WHERE FileIndex = 0"s;
-    if (DbLocker _{jcr->db}; !jcr->db->SqlQuery(outer_query.c_str())) {
+    if (DbLocker _{jcr->db}; !jcr->db->CreateFilePartition(jcr->JobId)
+                              || !jcr->db->SqlQuery(outer_query.c_str())) {
       Jmsg(jcr, M_WARNING, 0, "Error replicating deleted files: ERR=%s\n",
            jcr->db->strerror());
     }
@@ -25,6 +25,7 @@
 #include "include/filetypes.h"
 #include "filed/filed.h"
 #include "filed/accurate.h"
+#include "filed/accurate_state.h"
 #include "filed/filed_globals.h"
 #include "filed/filed_jcr_impl.h"
 #include "filed/verify.h"
@@ -128,11 +129,15 @@ bool AccurateFinish(JobControlRecord* jcr)
       retval = jcr->fd_impl->file_list->SendDeletedList();
     }
 
+    if (retval) { SaveAccurateState(jcr); }
+
     AccurateFree(jcr);
     if (jcr->is_JobLevel(L_FULL)) {
       Jmsg(jcr, M_INFO, 0, T_("Space saved with Base jobs: %" PRIu64 " MB\n"),
            jcr->fd_impl->base_size / (1024 * 1024));
     }
+  } else {
+    SaveAccurateState(jcr); /* full backup, every file was sent */
   }
 
   return retval;
@@ -190,6 +195,7 @@ bool AccurateCheckFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt)
 
   DecodeStat(payload->lstat, &statc, sizeof(statc),
              &LinkFIc); /** decode catalog stat */
+  ff_pkt->accurate_statp = statc;
 
   if (!jcr->rerunning && (jcr->getJobLevel() == L_FULL)) {
     accurate_opts = ff_pkt->base_job_opts;
@@ -310,6 +316,31 @@ bail_out:
   return file_changed;
 }
 
+BareosAccurateFilelist* NewAccurateFilelist(JobControlRecord* jcr,
+                                            uint32_t number_of_files)
+{
+#ifdef HAVE_LMDB
+  if (me->always_use_lmdb
+      || (me->IsMemberPresent("LmdbThreshold")
+          && number_of_files >= me->lmdb_threshold)) {
+    return new BareosAccurateFilelistLmdb(jcr, number_of_files);
+  }
+#endif
+  return new BareosAccurateFilelistHtable(jcr, number_of_files);
+}
+
+uint32_t LastJobId(const char* jobids)
+{
+  const char* last = strrchr(jobids, ',');
+  return str_to_uint64(last ? last + 1 : jobids);
+}
+
+/*
+ * Load the file list of the previous backup.  Directors that know it also
+ * send the JobIds the list was built from:
+ *
+ *   accurate files=<count> [jobids=<jobids>]
+ */
 bool AccurateCmd(JobControlRecord* jcr)
 {
   uint32_t accurate_max_file_count;
@@ -320,24 +351,19 @@ bool AccurateCmd(JobControlRecord* jcr)
 
   if (jcr->IsJobCanceled()) { return true; }
 
-  if (bsscanf(dir->msg, "accurate files=%u", &accurate_max_file_count) != 1) {
+  PoolMem jobids(PM_MESSAGE);
+  jobids.check_size(dir->message_length + 1);
+  if (bsscanf(dir->msg, "accurate files=%u jobids=%s",
+              &accurate_max_file_count, jobids.c_str())
+      == 2) {
+    jcr->fd_impl->previous_jobid = LastJobId(jobids.c_str());
+  } else if (bsscanf(dir->msg, "accurate files=%u", &accurate_max_file_count)
+             != 1) {
     dir->fsend(T_("2991 Bad accurate command\n"));
     return false;
   }
 
-  jcr->fd_impl->file_list = nullptr;
-#ifdef HAVE_LMDB
-  if (me->always_use_lmdb
-      || (me->IsMemberPresent("LmdbThreshold")
-          && accurate_max_file_count >= me->lmdb_threshold)) {
-    jcr->fd_impl->file_list
-        = new BareosAccurateFilelistLmdb(jcr, accurate_max_file_count);
-  }
-#endif
-  if (!jcr->fd_impl->file_list) {
-    jcr->fd_impl->file_list
-        = new BareosAccurateFilelistHtable(jcr, accurate_max_file_count);
-  }
+  jcr->fd_impl->file_list = NewAccurateFilelist(jcr, accurate_max_file_count);
 
   if (!jcr->fd_impl->file_list->init()) { return false; }
 
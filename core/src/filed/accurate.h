@@ -2,7 +2,7 @@
    BAREOS® - Backup Archiving REcovery Open Sourced
 
    Copyright (C) 2013-2014 Planets Communications B.V.
-   Copyright (C) 2013-2024 Bareos GmbH & Co. KG
+   Copyright (C) 2013-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -43,6 +43,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <functional>
 #include "include/config.h"
 #include "include/baconfig.h"
 #include "lib/jcr.h"
@@ -58,6 +59,10 @@ struct accurate_payload {
 };
 
 
+// Called for each file of the list, stops the iteration if it returns false.
+using AccurateFileVisitor
+    = std::function<bool(char* fname, accurate_payload* payload)>;
+
 // Accurate payload storage abstraction classes.
 class BareosAccurateFilelist {
  protected:
@@ -88,6 +93,13 @@ class BareosAccurateFilelist {
   virtual bool UpdatePayload(char* fname, accurate_payload* payload) = 0;
   virtual bool SendBaseFileList() = 0;
   virtual bool SendDeletedList() = 0;
+  virtual bool ForEachFile(const AccurateFileVisitor& visit) = 0;
+
+  bool IsSeen(accurate_payload* payload) const
+  {
+    return seen_bitmap_.at(payload->filenr);
+  }
+
   void MarkFileAsSeen(accurate_payload* payload)
   {
     /* Something went really wrong if we are supposed to mark a file as seen
@@ -155,6 +167,7 @@ class BareosAccurateFilelistHtable : public BareosAccurateFilelist {
   bool UpdatePayload(char* fname, accurate_payload* payload) override;
   bool SendBaseFileList() override;
   bool SendDeletedList() override;
+  bool ForEachFile(const AccurateFileVisitor& visit) override;
 };
 
 #ifdef HAVE_LMDB
@@ -197,9 +210,12 @@ class BareosAccurateFilelistLmdb : public BareosAccurateFilelist {
   bool UpdatePayload(char* fname, accurate_payload* payload) override;
   bool SendBaseFileList() override;
   bool SendDeletedList() override;
+  bool ForEachFile(const AccurateFileVisitor& visit) override;
 };
 #endif /* HAVE_LMDB */
 
+BareosAccurateFilelist* NewAccurateFilelist(JobControlRecord* jcr,
+                                            uint32_t number_of_files);
 bool AccurateFinish(JobControlRecord* jcr);
 bool AccurateCheckFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt);
 bool AccurateMarkFileAsSeen(JobControlRecord* jcr, char* fname);
@@ -207,6 +223,8 @@ bool accurate_unMarkFileAsSeen(JobControlRecord* jcr, char* fname);
 bool AccurateMarkAllFilesAsSeen(JobControlRecord* jcr);
 bool accurate_unMarkAllFilesAsSeen(JobControlRecord* jcr);
 void AccurateFree(JobControlRecord* jcr);
+// The last of a comma separated list of JobIds, 0 if there is none.
+uint32_t LastJobId(const char* jobids);
 
 
 } /* namespace filedaemon */
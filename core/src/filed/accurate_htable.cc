@@ -191,6 +191,17 @@ bool BareosAccurateFilelistHtable::SendDeletedList()
   return true;
 }
 
+bool BareosAccurateFilelistHtable::ForEachFile(
+    const AccurateFileVisitor& visit)
+{
+  CurFile* elt;
+
+  foreach_htable (elt, file_list_) {
+    if (!visit(elt->fname, &elt->payload)) { return false; }
+  }
+  return true;
+}
+
 void BareosAccurateFilelistHtable::destroy()
 {
   delete file_list_;
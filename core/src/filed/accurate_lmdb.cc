@@ -541,6 +541,58 @@ bail_out:
   return retval;
 }
 
+bool BareosAccurateFilelistLmdb::ForEachFile(const AccurateFileVisitor& visit)
+{
+  int result;
+  MDB_cursor* cursor;
+  MDB_val key, data;
+  bool retval = true;
+
+  // Commit any pending write transactions.
+  if (db_rw_txn_) {
+    result = mdb_txn_commit(db_rw_txn_);
+    if (result != 0) {
+      Jmsg1(jcr_, M_FATAL, 0, T_("Unable close write transaction: %s\n"),
+            mdb_strerror(result));
+      return false;
+    }
+    db_rw_txn_ = NULL;
+  }
+
+  result = mdb_cursor_open(db_ro_txn_, db_dbi_, &cursor);
+  if (result != 0) {
+    Jmsg1(jcr_, M_FATAL, 0, T_("Unable create cursor: %s\n"),
+          mdb_strerror(result));
+    return false;
+  }
+
+  while ((result = mdb_cursor_get(cursor, &key, &data, MDB_NEXT)) == 0) {
+    // Private copy with the lstat and chksum pointers fixed up, see
+    // lookup_payload().
+    pay_load_ = CheckPoolMemorySize(pay_load_, data.mv_size);
+    accurate_payload* payload = (accurate_payload*)pay_load_;
+    memcpy(payload, data.mv_data, data.mv_size);
+    payload->lstat = (char*)payload + sizeof(accurate_payload);
+    payload->chksum = payload->lstat + strlen(payload->lstat) + 1;
+
+    if (!visit((char*)key.mv_data, payload)) {
+      retval = false;
+      break;
+    }
+  }
+  mdb_cursor_close(cursor);
+
+  mdb_txn_reset(db_ro_txn_);
+  result = mdb_txn_renew(db_ro_txn_);
+  if (result != 0) {
+    Jmsg1(jcr_, M_FATAL, 0, T_("Unable to renew read transaction: %s\n"),
+          mdb_strerror(result));
+    return false;
+  }
+
+  return retval;
+}
+
 void BareosAccurateFilelistLmdb::destroy()
 {
   // Abort any pending read transaction.
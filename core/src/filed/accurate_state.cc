@@ -0,0 +1,326 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Accurate information the client keeps of its last backup of a job
+ *
+ * The state is a header followed by the files in the format the director
+ * sends them: fname\0lstat\0delta_seq\0
+ */
+
+#include "include/bareos.h"
+#include "include/jcr.h"
+#include "filed/filed.h"
+#include "filed/accurate.h"
+#include "filed/accurate_state.h"
+#include "filed/fd_plugins.h"
+#include "filed/filed_globals.h"
+#include "filed/filed_jcr_impl.h"
+#include "lib/berrno.h"
+#include "lib/bsock.h"
+#include "lib/edit.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace filedaemon {
+
+static const int debuglevel = 100;
+static constexpr const char kStateMagic[] = "BAREOS ACCURATE STATE 1";
+
+inline constexpr const char OKAccurateStateLoaded[]
+    = "2000 OK accuratestate loaded\n";
+inline constexpr const char OKAccurateStateMissing[]
+    = "2000 OK accuratestate missing\n";
+
+std::string AccurateStatePath(const char* working_directory,
+                              const char* director,
+                              const char* job)
+{
+  std::string path{working_directory};
+  path += '/';
+  path += director;
+  path += '.';
+  path += job;
+  path += ".accurate";
+  return path;
+}
+
+static bool ReadHeader(std::ifstream& in,
+                       std::string& chain,
+                       std::uint64_t& count)
+{
+  std::string magic, chain_line, count_line;
+  if (!std::getline(in, magic) || !std::getline(in, chain_line)
+      || !std::getline(in, count_line)) {
+    return false;
+  }
+  if (magic != kStateMagic || !chain_line.starts_with("chain=")
+      || !count_line.starts_with("files=")) {
+    return false;
+  }
+  chain = chain_line.substr(6);
+  count = str_to_uint64(count_line.c_str() + 6);
+  return true;
+}
+
+std::optional<std::uint64_t> PeekAccurateState(const std::string& path,
+                                               const std::string& chain)
+{
+  std::ifstream in(path, std::ios::binary);
+  std::string state_chain;
+  std::uint64_t count;
+
+  if (!in || !ReadHeader(in, state_chain, count)) { return std::nullopt; }
+  if (state_chain != chain) {
+    Dmsg2(debuglevel, "accurate state is for JobIds %s, not %s\n",
+          state_chain.c_str(), chain.c_str());
+    return std::nullopt;
+  }
+  return count;
+}
+
+bool ReadAccurateState(const std::string& path, const AccurateStateEntry& add)
+{
+  std::ifstream in(path, std::ios::binary);
+  std::string chain, fname, lstat, delta_seq;
+  std::uint64_t count, read = 0;
+
+  if (!in || !ReadHeader(in, chain, count)) { return false; }
+
+  while (std::getline(in, fname, '\0')) {
+    if (!std::getline(in, lstat, '\0') || !std::getline(in, delta_seq, '\0')) {
+      return false;
+    }
+    if (!add(fname.data(), lstat.data(), str_to_int32(delta_seq.c_str()))) {
+      return false;
+    }
+    read++;
+  }
+
+  return in.eof() && read == count;
+}
+
+AccurateStateWriter::AccurateStateWriter(std::string path,
+                                         std::string chain,
+                                         bool track_names)
+    : path_{std::move(path)}
+    , tmp_path_{path_ + "." + std::to_string(LastJobId(chain.c_str()))
+                + ".tmp"}
+    , chain_{std::move(chain)}
+    , track_names_{track_names}
+{
+}
+
+AccurateStateWriter::~AccurateStateWriter() { Abort(); }
+
+bool AccurateStateWriter::Open()
+{
+  out_.open(tmp_path_, std::ios::binary | std::ios::trunc);
+  if (!out_) { return false; }
+
+  out_ << kStateMagic << '\n' << "chain=" << chain_ << '\n' << "files=";
+  count_pos_ = out_.tellp();
+  // room for the count, which is only known at the end
+  out_ << std::string(20, '0') << '\n';
+  return static_cast<bool>(out_);
+}
+
+void AccurateStateWriter::Add(const char* fname,
+                              const char* lstat,
+                              std::int32_t delta_seq)
+{
+  std::lock_guard lock(mutex_);
+  if (!out_.is_open()) { return; }
+
+  out_ << fname << '\0' << lstat << '\0' << delta_seq << '\0';
+  count_++;
+  if (track_names_) { names_.emplace(fname); }
+}
+
+bool AccurateStateWriter::Contains(const char* fname) const
+{
+  std::lock_guard lock(mutex_);
+  return names_.contains(fname);
+}
+
+bool AccurateStateWriter::Commit()
+{
+  std::lock_guard lock(mutex_);
+  if (!out_.is_open()) { return false; }
+
+  char count[21];
+  snprintf(count, sizeof(count), "%020" PRIu64, count_);
+  out_.seekp(count_pos_);
+  out_.write(count, 20);
+  out_.close();
+
+  if (out_.fail() || rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+    unlink(tmp_path_.c_str());
+    return false;
+  }
+  names_.clear();
+  return true;
+}
+
+void AccurateStateWriter::Abort()
+{
+  std::lock_guard lock(mutex_);
+  if (!out_.is_open()) { return; }
+
+  out_.close();
+  unlink(tmp_path_.c_str());
+  names_.clear();
+}
+
+// Fills the accurate file list from the state, if it belongs to reference.
+static bool LoadAccurateState(JobControlRecord* jcr,
+                              const std::string& path,
+                              const std::string& reference)
+{
+  auto count = PeekAccurateState(path, reference);
+  if (!count) { return false; }
+
+  jcr->fd_impl->file_list = NewAccurateFilelist(jcr, *count);
+  BareosAccurateFilelist* list = jcr->fd_impl->file_list;
+  if (!list->init()) {
+    AccurateFree(jcr);
+    return false;
+  }
+
+  bool ok = ReadAccurateState(
+      path, [list](char* fname, char* lstat, std::int32_t delta_seq) {
+        list->AddFile(fname, strlen(fname), lstat, strlen(lstat), nullptr, 0,
+                      delta_seq);
+        return true;
+      });
+  if (!ok || !list->EndLoad()) {
+    Dmsg1(debuglevel, "could not load accurate state %s\n", path.c_str());
+    AccurateFree(jcr);
+    return false;
+  }
+
+  jcr->accurate = true;
+  Dmsg2(debuglevel, "loaded %" PRIu64 " files from accurate state %s\n",
+        *count, path.c_str());
+  return true;
+}
+
+/**
+ * The director asks whether we still have the accurate information of the
+ * JobIds it would send, and tells us to keep the one of this job:
+ *
+ *   accuratestate job=<job name> reference=<jobids or 0>
+ *
+ * If we have it, it does not send the file list at all.
+ */
+bool AccurateStateCmd(JobControlRecord* jcr)
+{
+  BareosSocket* dir = jcr->dir_bsock;
+  PoolMem job(PM_NAME), reference(PM_MESSAGE);
+
+  job.check_size(dir->message_length + 1);
+  reference.check_size(dir->message_length + 1);
+  if (bsscanf(dir->msg, "accuratestate job=%s reference=%s", job.c_str(),
+              reference.c_str())
+      != 2) {
+    dir->fsend(T_("2991 Bad accuratestate command\n"));
+    return false;
+  }
+  UnbashSpaces(job.c_str());
+  jcr->fd_impl->previous_jobid = LastJobId(reference.c_str());
+
+  if (!me->keep_accurate_state || jcr->IsJobCanceled()
+      || !IsNameValid(job.c_str())) {
+    return dir->fsend(OKAccurateStateMissing);
+  }
+
+  std::string path
+      = AccurateStatePath(me->working_directory,
+                          jcr->fd_impl->director->resource_name_, job.c_str());
+  std::string chain = std::to_string(jcr->JobId);
+  bool loaded = false;
+
+  if (!jcr->is_JobLevel(L_FULL) && !bstrcmp(reference.c_str(), "0")) {
+    chain = std::string{reference.c_str()} + "," + chain;
+    loaded = LoadAccurateState(jcr, path, reference.c_str());
+  }
+
+  auto writer = std::make_unique<AccurateStateWriter>(
+      path, chain, !jcr->is_JobLevel(L_FULL));
+  if (writer->Open()) {
+    jcr->fd_impl->accurate_state = std::move(writer);
+  } else {
+    BErrNo be;
+    Jmsg(jcr, M_WARNING, 0,
+         T_("Cannot keep the accurate information of this job in %s: "
+            "ERR=%s\n"),
+         path.c_str(), be.bstrerror());
+  }
+
+  return dir->fsend(loaded ? OKAccurateStateLoaded : OKAccurateStateMissing);
+}
+
+/**
+ * Called at the end of a successful backup, before the accurate file list
+ * is freed.  The state is the file list of the previous backup without the
+ * files that were deleted, updated with the files sent by this job, which
+ * is what the catalog will have.
+ */
+bool SaveAccurateState(JobControlRecord* jcr)
+{
+  auto writer = std::move(jcr->fd_impl->accurate_state);
+  if (!writer) { return true; }
+
+  if (BareosAccurateFilelist* list = jcr->fd_impl->file_list) {
+    list->ForEachFile([jcr, list, &writer](char* fname,
+                                          accurate_payload* payload) {
+      // The files the deleted list skips stay in the catalog
+      bool kept = list->IsSeen(payload) || PluginCheckFile(jcr, fname);
+      if (kept && !writer->Contains(fname)) {
+        writer->Add(fname, payload->lstat, payload->delta_seq);
+      }
+      return true;
+    });
+  }
+
+  if (!writer->Commit()) {
+    BErrNo be;
+    Jmsg(jcr, M_WARNING, 0,
+         T_("Cannot keep the accurate information of this job: ERR=%s\n"),
+         be.bstrerror());
+    return false;
+  }
+  return true;
+}
+
+// Remember the attributes of a file sent to the storage daemon.
+void RecordAccurateState(JobControlRecord* jcr,
+                         const char* fname,
+                         const char* lstat,
+                         std::int32_t delta_seq)
+{
+  if (auto& writer = jcr->fd_impl->accurate_state) {
+    writer->Add(fname, lstat, delta_seq);
+  }
+}
+
+} /* namespace filedaemon */
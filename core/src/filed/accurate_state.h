@@ -0,0 +1,103 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Accurate information the client keeps of its last backup of a job
+ */
+
+#ifndef BAREOS_FILED_ACCURATE_STATE_H_
+#define BAREOS_FILED_ACCURATE_STATE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+class JobControlRecord;
+
+namespace filedaemon {
+
+/* The file list the director would send for the next accurate backup of a
+ * job, stored in the working directory.  It is only valid for the chain of
+ * JobIds it was written for, the director compares that chain with the
+ * JobIds it would build the list from. */
+std::string AccurateStatePath(const char* working_directory,
+                              const char* director,
+                              const char* job);
+
+using AccurateStateEntry
+    = std::function<bool(char* fname, char* lstat, std::int32_t delta_seq)>;
+
+/* Returns the number of files of the state if it belongs to chain, without
+ * reading them. */
+std::optional<std::uint64_t> PeekAccurateState(const std::string& path,
+                                               const std::string& chain);
+
+// Calls add for every file of the state, returns false if it is damaged.
+bool ReadAccurateState(const std::string& path, const AccurateStateEntry& add);
+
+/* Writes the state of the running job, it only replaces the old one on
+ * Commit.  The chain ends with the JobId of the running job, which also
+ * names the temporary file, so concurrent runs of a job do not write into
+ * the same one. */
+class AccurateStateWriter {
+ public:
+  AccurateStateWriter(std::string path, std::string chain, bool track_names);
+  ~AccurateStateWriter();
+
+  bool Open();
+  bool IsOpen() const { return out_.is_open(); }
+
+  // Thread safe, as attributes may be sent from several threads.
+  void Add(const char* fname, const char* lstat, std::int32_t delta_seq);
+  // Whether fname was added, if names are tracked.
+  bool Contains(const char* fname) const;
+
+  bool Commit();
+  void Abort();
+
+  const std::string& Chain() const { return chain_; }
+
+ private:
+  std::string path_;
+  std::string tmp_path_;
+  std::string chain_;
+  bool track_names_;
+  std::ofstream out_;
+  std::streampos count_pos_{};
+  std::uint64_t count_{0};
+  std::unordered_set<std::string> names_{};
+  mutable std::mutex mutex_{};
+};
+
+bool AccurateStateCmd(JobControlRecord* jcr);
+bool SaveAccurateState(JobControlRecord* jcr);
+void RecordAccurateState(JobControlRecord* jcr,
+                         const char* fname,
+                         const char* lstat,
+                         std::int32_t delta_seq);
+
+} /* namespace filedaemon */
+
+#endif  // BAREOS_FILED_ACCURATE_STATE_H_
@@ -28,6 +28,7 @@
 
 #include "include/bareos.h"
 #include "filed/filed.h"
+#include "filed/authenticate.h"
 #include "filed/filed_globals.h"
 #include "filed/filed_jcr_impl.h"
 #include "filed/restore.h"
@@ -53,8 +54,9 @@ const int debuglevel = 50;
  *  52 13Jul13 - Added plugin options
  *  53 02Apr15 - Added setdebug timestamp
  *  54 29Oct15 - Added getSecureEraseCmd
+ *  55 19Oct26 - Added accuratestate, the client keeps the accurate list
  */
-inline constexpr const char OK_hello[] = "2000 OK Hello 54\n";
+inline constexpr const char OK_hello[] = "2000 OK Hello 55\n";
 
 inline constexpr const char Dir_sorry[] = "2999 Authentication failed.\n";
 
@@ -200,9 +202,29 @@ bool AuthenticateWithStoragedaemon(JobControlRecord* jcr)
       jcr, my_config->CreateOwnQualifiedNameForNetworkDump(),
       (char*)jcr->client_name, password, me);
 
-  // Destroy session key
-  memset(jcr->sd_auth_key, 0, strlen(jcr->sd_auth_key));
+  /* The data connections of a striped backup are authenticated with the
+   * same key later on, BackupCmd() destroys it then. */
+  if (me->data_connections <= 1) { DestroyStorageAuthKey(jcr); }
 
   return result;
 }
+
+// Authenticate an additional data connection to the storage daemon.
+bool AuthenticateDataConnection(JobControlRecord* jcr, BareosSocket* sd)
+{
+  s_password password;
+
+  password.encoding = p_encoding_md5;
+  password.value = jcr->sd_auth_key;
+  return sd->AuthenticateOutboundConnection(
+      nullptr, my_config->CreateOwnQualifiedNameForNetworkDump(),
+      (char*)jcr->client_name, password, me);
+}
+
+void DestroyStorageAuthKey(JobControlRecord* jcr)
+{
+  if (jcr->sd_auth_key) {
+    memset(jcr->sd_auth_key, 0, strlen(jcr->sd_auth_key));
+  }
+}
 } /* namespace filedaemon */
@@ -31,6 +31,8 @@ bool AuthenticateWithDirector(JobControlRecord* jcr,
                               DirectorResource* director);
 bool AuthenticateStoragedaemon(JobControlRecord* jcr);
 bool AuthenticateWithStoragedaemon(JobControlRecord* jcr);
+bool AuthenticateDataConnection(JobControlRecord* jcr, BareosSocket* sd);
+void DestroyStorageAuthKey(JobControlRecord* jcr);
 
 } /* namespace filedaemon */
 
@@ -33,9 +33,12 @@
 #include "filed/filed.h"
 #include "filed/filed_globals.h"
 #include "filed/accurate.h"
+#include "filed/accurate_state.h"
+#include "filed/block_delta.h"
 #include "filed/compression.h"
 #include "filed/crypto.h"
 #include "filed/heartbeat.h"
+#include "filed/client_dedup.h"
 #include "filed/backup.h"
 #include "filed/filed_jcr_impl.h"
 #include "include/ch.h"
@@ -45,7 +48,9 @@
 #include "lib/attribs.h"
 #include "lib/berrno.h"
 #include "lib/bsock.h"
+#include "lib/bsock_striped.h"
 #include "lib/btimers.h"
+#include "lib/edit.h"
 #include "lib/parse_conf.h"
 #include "lib/util.h"
 #include "lib/version.h"
@@ -55,7 +60,11 @@
 #include "lib/channel.h"
 #include "lib/network_order.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <optional>
+#include <span>
 
 namespace filedaemon {
 
@@ -98,7 +107,8 @@ static int send_data(JobControlRecord* jcr,
                      int stream,
                      FindFilesPacket* ff_pkt,
                      DIGEST* digest,
-                     DIGEST* signature_digest);
+                     DIGEST* signature_digest,
+                     BlockDeltaFile* block_delta);
 bool EncodeAndSendAttributes(JobControlRecord* jcr,
                              FindFilesPacket* ff_pkt,
                              int& data_stream);
@@ -143,9 +153,13 @@ bool BlastDataToStorageDaemon(JobControlRecord* jcr, crypto_cipher_t cipher)
     bool ktls_enabled = sd->KtlsForSend();
     Jmsg(jcr, M_INFO, 0, "Sending via kTLS: %s\n", ktls_enabled ? "yes" : "no");
   }
-
+  sd->SetZeroCopy(me->enable_zerocopy);
 
   jcr->setJobStatusWithPriorityCheck(JS_Running);
+  jcr->pipeline_stats.Start();
+  if (!me->pipeline_trace_directory.empty()) {
+    jcr->pipeline_stats.EnableTrace();
+  }
   Jmsg(jcr, M_INFO, 0, T_("Version: %s (%s) %s\n"), kBareosVersionStrings.Full,
        kBareosVersionStrings.Date, kBareosVersionStrings.GetOsInfo());
 
@@ -173,6 +187,19 @@ bool BlastDataToStorageDaemon(JobControlRecord* jcr, crypto_cipher_t cipher)
 
   if (!CryptoSessionStart(jcr, cipher)) { return false; }
 
+  /* Stripe the data over the data connections, if the storage daemon agreed
+   * to use some.  The main connection only carries the heartbeats then. */
+  std::optional<StripedSender> striped_sender;
+  if (auto& connections = jcr->fd_impl->data_connections;
+      !connections.empty()) {
+    for (auto* connection : connections) {
+      connection->SetBufferSize(buf_size, BNET_SETBUF_WRITE);
+      connection->SetZeroCopy(me->enable_zerocopy);
+    }
+    striped_sender.emplace(sd, connections);
+    sd->SetStripedSender(&striped_sender.value());
+  }
+
   SetFindOptions((FindFilesPacket*)jcr->fd_impl->ff, jcr->fd_impl->incremental,
                  jcr->fd_impl->since_time);
 
@@ -182,7 +209,16 @@ bool BlastDataToStorageDaemon(JobControlRecord* jcr, crypto_cipher_t cipher)
                            AccurateCheckFile);
   }
 
-  auto hb_send = MakeHeartbeatMonitor(jcr);
+  /* With client side deduplication we read the answers of the SD ourselves,
+   * so no second thread may read from the SD socket.  The heartbeats the SD
+   * sends while it waits (e.g. for a volume) still arrive: BgetMsg() skips
+   * them when ClientDedup reads the next answer.  Only the heartbeat to the
+   * Director needs a thread of its own then. */
+  bool read_sd = jcr->fd_impl->client_dedup != nullptr;
+  auto hb_send = read_sd ? std::optional<heartbeat_sd_dir>{}
+                         : MakeHeartbeatMonitor(jcr);
+  auto hb_dir
+      = read_sd ? MakeDirHeartbeat(jcr) : std::optional<heartbeat_dir>{};
 
   if (have_acl) { jcr->fd_impl->acl_data = std::make_unique<AclBuildData>(); }
 
@@ -215,8 +251,20 @@ bool BlastDataToStorageDaemon(JobControlRecord* jcr, crypto_cipher_t cipher)
   AccurateFinish(jcr); /* send deleted or base file list to SD */
 
   hb_send.reset();
+  hb_dir.reset();
 
   sd->signal(BNET_EOD); /* end of sending data */
+  sd->SetStripedSender(nullptr);
+
+  if (auto* dedup = jcr->fd_impl->client_dedup.get()) {
+    char ed1[50], ed2[50];
+    Jmsg(jcr, M_INFO, 0,
+         T_("Client side deduplication: %s of %s data bytes were not sent.\n"),
+         edit_uint64_with_commas(dedup->BytesSkipped(), ed1),
+         edit_uint64_with_commas(dedup->BytesTotal(), ed2));
+  }
+
+  ReportPipelineStats(jcr, me->pipeline_trace_directory, "fd");
 
   if (jcr->fd_impl->big_buf) {
     free(jcr->fd_impl->big_buf);
@@ -266,7 +314,7 @@ static inline bool SaveRsrcAndFinder(b_save_ctx& bsctx)
                         : STREAM_MACOS_FORK_DATA;
 
       status = send_data(bsctx.jcr, rsrc_stream, bsctx.ff_pkt, bsctx.digest,
-                         bsctx.signing_digest);
+                         bsctx.signing_digest, nullptr);
 
       memcpy(bsctx.ff_pkt->flags, flags, sizeof(flags));
       bclose(&bsctx.ff_pkt->bfd);
@@ -530,6 +578,7 @@ int SaveFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
   bool has_file_data = false;
   save_pkt sp; /* use by option plugin */
   BareosSocket* sd = jcr->store_bsock;
+  std::optional<BlockDeltaFile> block_delta;
 
   if (jcr->IsJobCanceled() || jcr->IsIncomplete()) { return 0; }
 
@@ -710,8 +759,14 @@ int SaveFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
     plugin_started = true;
   }
 
+  // Decide on block deltas, the attributes carry the delta sequence
+  if (!do_plugin_set) { block_delta = SetupBlockDelta(jcr, ff_pkt); }
+
   // Send attributes -- must be done after binit()
-  if (!EncodeAndSendAttributes(jcr, ff_pkt, data_stream)) { goto bail_out; }
+  {
+    StageTimer timer(jcr->pipeline_stats, PipelineStage::kMetadata);
+    if (!EncodeAndSendAttributes(jcr, ff_pkt, data_stream)) { goto bail_out; }
+  }
 
   // Meta data only for restore object
   if (IS_FT_OBJECT(ff_pkt->type)) { goto good_rtn; }
@@ -763,9 +818,15 @@ int SaveFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
     ff_pkt->bfd.reparse_point
         = (ff_pkt->type == FT_REPARSE || ff_pkt->type == FT_JUNCTION);
 
-    if (bopen(&ff_pkt->bfd, ff_pkt->fname, O_RDONLY | O_BINARY | noatime, 0,
-              ff_pkt->statp.st_rdev)
-        < 0) {
+    int open_status;
+    {
+      StageTimer timer(jcr->pipeline_stats, PipelineStage::kMetadata);
+      timer.SetItems(0);
+      open_status = bopen(&ff_pkt->bfd, ff_pkt->fname,
+                          O_RDONLY | O_BINARY | noatime, 0,
+                          ff_pkt->statp.st_rdev);
+    }
+    if (open_status < 0) {
       ff_pkt->ff_errno = errno;
       BErrNo be;
       Jmsg(jcr, M_NOTSAVED, 0, T_("     Cannot open \"%s\": ERR=%s.\n"),
@@ -784,7 +845,8 @@ int SaveFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
     }
 
     status = send_data(jcr, data_stream, ff_pkt, bsctx.digest,
-                       bsctx.signing_digest);
+                       bsctx.signing_digest,
+                       block_delta ? &block_delta.value() : nullptr);
 
     if (BitIsSet(FO_CHKCHANGES, ff_pkt->flags)) { HasFileChanged(jcr, ff_pkt); }
 
@@ -903,19 +965,29 @@ static inline bool SendDataToSd(b_ctx* bctx)
   // Uncompressed cipher input length
   bctx->cipher_input_len = sd->message_length;
 
-  // Update checksum if requested
-  if (bctx->digest) {
-    CryptoDigestUpdate(bctx->digest, (uint8_t*)bctx->rbuf, sd->message_length);
-  }
+  auto& stats = bctx->jcr->pipeline_stats;
 
-  // Update signing digest if requested
-  if (bctx->signing_digest) {
-    CryptoDigestUpdate(bctx->signing_digest, (uint8_t*)bctx->rbuf,
-                       sd->message_length);
+  if (bctx->digest || bctx->signing_digest) {
+    StageTimer timer(stats, PipelineStage::kDigest);
+    timer.SetBytes(sd->message_length);
+
+    // Update checksum if requested
+    if (bctx->digest) {
+      CryptoDigestUpdate(bctx->digest, (uint8_t*)bctx->rbuf,
+                         sd->message_length);
+    }
+
+    // Update signing digest if requested
+    if (bctx->signing_digest) {
+      CryptoDigestUpdate(bctx->signing_digest, (uint8_t*)bctx->rbuf,
+                         sd->message_length);
+    }
   }
 
   // Compress the data.
   if (BitIsSet(FO_COMPRESS, bctx->ff_pkt->flags)) {
+    StageTimer timer(stats, PipelineStage::kCompress);
+    timer.SetBytes(sd->message_length);
     if (!CompressData(bctx->jcr, bctx->ff_pkt->Compress_algo, bctx->rbuf,
                       bctx->jcr->store_bsock->message_length, bctx->cbuf,
                       bctx->max_compress_len, &bctx->compress_len)) {
@@ -944,10 +1016,13 @@ static inline bool SendDataToSd(b_ctx* bctx)
 
   // Encrypt the data.
   need_more_data = false;
-  if (BitIsSet(FO_ENCRYPT, bctx->ff_pkt->flags)
-      && !EncryptData(bctx, &need_more_data)) {
-    if (need_more_data) { return true; }
-    return false;
+  if (BitIsSet(FO_ENCRYPT, bctx->ff_pkt->flags)) {
+    StageTimer timer(stats, PipelineStage::kEncrypt);
+    timer.SetBytes(bctx->cipher_input_len);
+    if (!EncryptData(bctx, &need_more_data)) {
+      if (need_more_data) { return true; }
+      return false;
+    }
   }
 
   // Send the buffer to the Storage daemon
@@ -957,7 +1032,21 @@ static inline bool SendDataToSd(b_ctx* bctx)
   }
   sd->msg = bctx->wbuf; /* set correct write buffer */
 
-  if (!sd->send()) {
+  bool sent;
+  auto* dedup = bctx->jcr->fd_impl->client_dedup.get();
+  {
+    StageTimer timer(stats, PipelineStage::kSend);
+    timer.SetBytes(sd->message_length);
+    // encrypted data never repeats, so there is no point in asking the SD
+    if (dedup && !BitIsSet(FO_ENCRYPT, bctx->ff_pkt->flags)) {
+      sent = dedup->Send(sd, sd->msg, sd->message_length);
+    } else {
+      std::span<const char> message{sd->msg, (std::size_t)sd->message_length};
+      sent = sd->SendFragments({&message, 1});
+    }
+  }
+
+  if (!sent) {
     if (!bctx->jcr->IsJobCanceled()) {
       Jmsg1(bctx->jcr, M_FATAL, 0, T_("Network send error to SD. ERR=%s\n"),
             sd->bstrerror());
@@ -1041,8 +1130,13 @@ static inline bool SendPlainDataSerially(b_ctx& bctx)
 
   // Read the file data
   for (;;) {
-    auto read_bytes
-        = bread_ignoring_interrupts(&bctx.ff_pkt->bfd, bctx.rbuf, bctx.rsize);
+    ssize_t read_bytes;
+    {
+      StageTimer timer(bctx.jcr->pipeline_stats, PipelineStage::kRead);
+      read_bytes = bread_ignoring_interrupts(&bctx.ff_pkt->bfd, bctx.rbuf,
+                                             bctx.rsize);
+      timer.SetBytes(read_bytes > 0 ? read_bytes : 0);
+    }
     sd->message_length = read_bytes;
     if (read_bytes < 0) {
       /* the api contract is the following:
@@ -1065,21 +1159,96 @@ bail_out:
   return retval;
 }
 
-static result<std::size_t> SendData(BareosSocket* sd,
-                                    POOLMEM* data,
-                                    size_t size)
+/**
+ * Read the whole file in the blocks of its block map, but only send the
+ * blocks that changed since the previous backup.  Every message starts with
+ * its offset in the file, so the restore can write it into the file that
+ * was restored from the previous parts.
+ */
+static inline bool SendBlockDelta(b_ctx& bctx, BlockDeltaFile& file)
 {
-  sd->message_length = size;
-  sd->msg = data; /* set correct write buffer */
+  JobControlRecord* jcr = bctx.jcr;
+  BareosSocket* sd = jcr->store_bsock;
+  auto& bfd = bctx.ff_pkt->bfd;
+  auto& stats = jcr->pipeline_stats;
+  const std::size_t block_size = file.current.block_size;
+  std::vector<char> block(block_size);
+  std::uint64_t offset = 0;
+  bool retval = false;
 
-  if (!sd->send()) {
-    PoolMem error;
-    Mmsg(error, "Network send error to SD. ERR=%s", sd->bstrerror());
-    return error;
+  // The digest of the catalog covers the whole file, not just what is sent
+  DIGEST* digest = std::exchange(bctx.digest, nullptr);
+
+  for (;;) {
+    std::size_t filled = 0;
+    ssize_t read_bytes = 0;
+    {
+      StageTimer timer(stats, PipelineStage::kRead);
+      while (filled < block_size) {
+        read_bytes = bread_ignoring_interrupts(&bfd, block.data() + filled,
+                                               block_size - filled);
+        if (read_bytes <= 0) { break; }
+        filled += read_bytes;
+      }
+      timer.SetBytes(filled);
+    }
+    if (read_bytes < 0) {
+      // see SendPlainDataSerially() for why this is no send error
+      sd->message_length = read_bytes;
+      retval = true;
+      goto bail_out;
+    }
+    if (filled == 0) { break; }
+
+    BlockHash hash;
+    {
+      StageTimer timer(stats, PipelineStage::kDigest);
+      timer.SetBytes(filled);
+      if (digest) {
+        CryptoDigestUpdate(digest, (uint8_t*)block.data(), filled);
+      }
+      hash = HashBlock(jcr, block.data(), filled);
+    }
+    std::size_t index = file.current.hashes.size();
+    file.current.hashes.push_back(hash);
+
+    bool last = filled < block_size
+                || offset + filled >= (uint64_t)bctx.ff_pkt->statp.st_size;
+    bool changed = !file.previous || !file.previous->Unchanged(index, hash);
+    if (changed && file.skip_zeros && !last
+        && IsBufZero(block.data(), filled)) {
+      changed = false;
+    }
+
+    if (changed) {
+      for (std::size_t pos = 0; pos < filled; pos += bctx.rsize) {
+        std::size_t size = std::min<std::size_t>(bctx.rsize, filled - pos);
+        std::memcpy(bctx.rbuf, block.data() + pos, size);
+        bfd.offset = offset + pos;
+        sd->message_length = size;
+        if (!SendDataToSd(&bctx)) { goto bail_out; }
+      }
+    } else {
+      jcr->ReadBytes += filled;
+    }
+
+    offset += filled;
+    if (filled < block_size) { break; }
   }
 
-  Dmsg1(130, "Send data to SD len=%d\n", sd->message_length);
-  return size;
+  if (!file.current.Write(file.map_path)) {
+    BErrNo be;
+    Jmsg(jcr, M_WARNING, 0,
+         T_("Could not write block map of \"%s\", the next backup saves the "
+            "whole file. ERR=%s\n"),
+         bctx.ff_pkt->fname, be.bstrerror());
+  }
+  sd->message_length = 0;
+  retval = true;
+
+bail_out:
+  bctx.digest = digest;
+  return retval;
 }
 
 class data_message {
@@ -1091,8 +1260,9 @@ class data_message {
    * itself and is equal to the number of bytes already read from the file
    * descriptor. */
   static inline constexpr std::size_t header_size = OFFSET_FADDR_SIZE;
-  /* our bsocket functions assume that they are allowed to overwrite
-   * the four bytes directly preceding the given buffer
+  /* BareosSocket::send() assumes that it is allowed to overwrite
+   * the four bytes directly preceding the given buffer.  Only the client
+   * side deduplication still sends that way, see fragments().
    * To keep the message alignment to 8, we "allocate" full 8 bytes instead
    * of the required 4. */
   static inline constexpr std::size_t bnet_size = 8;
@@ -1166,20 +1336,62 @@ class data_message {
       return size_with_header - header_size;
     }
   }
+
+  // the message as header and data, for BareosSocket::SendFragments()
+  std::array<std::span<const char>, 2> fragments() const
+  {
+    return {std::span{header_ptr(), has_header ? header_size : 0},
+            std::span{data_ptr(), data_size()}};
+  }
 };
 
 using shared_message = std::shared_ptr<data_message>;
 
+static result<std::size_t> SendData(BareosSocket* sd,
+                                    ClientDedup* dedup,
+                                    const shared_message& shared,
+                                    PipelineStats& stats)
+{
+  data_message& message = *shared;
+  auto size = message.message_size();
+  StageTimer timer(stats, PipelineStage::kSend);
+  timer.SetBytes(size);
+  bool sent;
+  if (dedup) {
+    // technically we are overwriting part of message here
+    // but its only the "size" field of the message, which is not
+    // read/written to otherwise after making it a shared_message.
+    sd->message_length = size;
+    sd->msg = message.as_socket_message(); /* set correct write buffer */
+    sent = dedup->Send(sd, sd->msg, size);
+  } else {
+    // with MSG_ZEROCOPY the socket keeps the message until it was sent
+    sent = sd->SendFragments(message.fragments(), shared);
+  }
+
+  if (!sent) {
+    PoolMem error;
+    Mmsg(error, "Network send error to SD. ERR=%s", sd->bstrerror());
+    return error;
+  }
+
+  Dmsg1(130, "Send data to SD len=%zu\n", size);
+  return size;
+}
+
 static std::future<result<std::size_t>> MakeSendThread(
     thread_pool& pool,
     BareosSocket* sd,
+    ClientDedup* dedup,
+    PipelineStats& stats,
     channel::output<std::future<result<shared_message>>> out)
 {
   std::promise<result<std::size_t>> promise;
   std::future fut = promise.get_future();
 
   pool.borrow_thread(
-      [prom = std::move(promise), out = std::move(out), sd]() mutable {
+      [prom = std::move(promise), out = std::move(out), sd, dedup,
+       &stats]() mutable {
         std::size_t accumulated = 0;
         for (;;) {
           std::optional out_fut = out.get();
@@ -1191,13 +1403,7 @@ static std::future<result<std::size_t>> MakeSendThread(
           }
 
           auto& val = p.value_unchecked();
-          auto size = val->message_size();
-          POOLMEM* msg = val->as_socket_message();
-
-          // technically we are overwriting part of message here
-          // but its only the "size" field of the message, which is not
-          // read/written to otherwise after making it a shared_message.
-          result ret = SendData(sd, msg, size);
+          result ret = SendData(sd, dedup, val, stats);
           if (ret.holds_error()) {
             prom.set_value(std::move(ret.error_unchecked()));
             return;
@@ -1217,8 +1423,12 @@ struct compression_context {
 };
 
 static result<shared_message> DoCompressMessage(compression_context& compctx,
-                                                const data_message& input)
+                                                const data_message& input,
+                                                PipelineStats& stats)
 {
+  StageTimer timer(stats, PipelineStage::kCompress);
+  timer.SetBytes(input.data_size());
+
   auto data_size = RequiredCompressionOutputBufferSize(compctx.algorithm,
                                                        input.data_size());
 
@@ -1321,7 +1531,10 @@ static inline bool SendPlainData(b_ctx& bctx)
       = channel::CreateBufferedChannel<std::future<result<shared_message>>>(
           num_workers);
 
-  std::future bytes_send_fut = MakeSendThread(threadpool, sd, std::move(out));
+  auto& stats = bctx.jcr->pipeline_stats;
+  std::future bytes_send_fut
+      = MakeSendThread(threadpool, sd, bctx.jcr->fd_impl->client_dedup.get(),
+                       stats, std::move(out));
 
   DIGEST* checksum = bctx.digest;
   DIGEST* signing = bctx.signing_digest;
@@ -1343,8 +1556,13 @@ static inline bool SendPlainData(b_ctx& bctx)
     data_message msg(max_buf_size);
     for (bool skip_block = true; skip_block;) {
       skip_block = false;
-      ssize_t read_bytes
-          = bread_ignoring_interrupts(&bfd, msg.data_ptr(), msg.data_size());
+      ssize_t read_bytes;
+      {
+        StageTimer timer(stats, PipelineStage::kRead);
+        read_bytes
+            = bread_ignoring_interrupts(&bfd, msg.data_ptr(), msg.data_size());
+        timer.SetBytes(read_bytes > 0 ? read_bytes : 0);
+      }
       // update offset _before_ sending the header
       offset = bfd.offset;
 
@@ -1396,10 +1614,12 @@ static inline bool SendPlainData(b_ctx& bctx)
     }
 
     if (checksum || signing) {
-      update_digest.emplace(compute_group.submit([checksum, signing,
+      update_digest.emplace(compute_group.submit([checksum, signing, &stats,
                                                   shared_msg]() mutable {
         auto* data = reinterpret_cast<const uint8_t*>(shared_msg->data_ptr());
         auto size = shared_msg->data_size();
+        StageTimer timer(stats, PipelineStage::kDigest);
+        timer.SetBytes(size);
         // Update checksum if requested
         if (checksum) { CryptoDigestUpdate(checksum, data, size); }
 
@@ -1411,8 +1631,8 @@ static inline bool SendPlainData(b_ctx& bctx)
     std::future<result<shared_message>> copy_fut;
     if (compctx) {
       copy_fut = compute_group.submit(
-          [cctx = compctx.value(), shared_msg]() mutable {
-            return DoCompressMessage(cctx, *shared_msg.get());
+          [cctx = compctx.value(), shared_msg, &stats]() mutable {
+            return DoCompressMessage(cctx, *shared_msg.get(), stats);
           });
     } else {
       std::promise<result<shared_message>> prom;
@@ -1468,7 +1688,8 @@ static int send_data(JobControlRecord* jcr,
                      int stream,
                      FindFilesPacket* ff_pkt,
                      DIGEST* digest,
-                     DIGEST* signing_digest)
+                     DIGEST* signing_digest,
+                     BlockDeltaFile* block_delta)
 {
   b_ctx bctx;
   BareosSocket* sd = jcr->store_bsock;
@@ -1527,7 +1748,11 @@ static int send_data(JobControlRecord* jcr,
     if (!SendPlainData(bctx)) { goto bail_out; }
   }
 #else
-  if (!SendPlainData(bctx)) { goto bail_out; }
+  if (block_delta) {
+    if (!SendBlockDelta(bctx, *block_delta)) { goto bail_out; }
+  } else {
+    if (!SendPlainData(bctx)) { goto bail_out; }
+  }
 #endif
 
   if (sd->message_length < 0) { /* error */
@@ -1566,6 +1791,16 @@ static int send_data(JobControlRecord* jcr,
     }
   }
 
+  // records queued for deduplication belong to this data stream
+  if (auto* dedup = jcr->fd_impl->client_dedup.get();
+      dedup && !dedup->Flush(sd)) {
+    if (!jcr->IsJobCanceled()) {
+      Jmsg1(jcr, M_FATAL, 0, T_("Network send error to SD. ERR=%s\n"),
+            sd->bstrerror());
+    }
+    goto bail_out;
+  }
+
   if (!sd->signal(BNET_EOD)) { /* indicate end of file data */
     if (!jcr->IsJobCanceled()) {
       Jmsg1(jcr, M_FATAL, 0, T_("Network send error to SD. ERR=%s\n"),
@@ -1760,6 +1995,11 @@ bool EncodeAndSendAttributes(JobControlRecord* jcr,
   }
 
   if (!IS_FT_OBJECT(ff_pkt->type) && ff_pkt->type != FT_DELETED) {
+    if (status && ff_pkt->type != FT_BASE) {
+      bool dir = ff_pkt->type == FT_DIREND || ff_pkt->type == FT_REPARSE;
+      RecordAccurateState(jcr, dir ? ff_pkt->link_or_dir : ff_pkt->fname,
+                          attribs.c_str(), ff_pkt->delta_seq);
+    }
     UnstripPath(ff_pkt);
   }
 
@@ -0,0 +1,286 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Block level incremental backups of large files
+ */
+
+#include "include/bareos.h"
+#include "include/filetypes.h"
+#include "include/jcr.h"
+#include "filed/block_delta.h"
+#include "filed/filed.h"
+#include "filed/filed_globals.h"
+#include "filed/filed_jcr_impl.h"
+#include "findlib/bfile.h"
+#include "findlib/create_file.h"
+#include "findlib/find.h"
+#include "lib/attr.h"
+#include "lib/berrno.h"
+#include "lib/serial.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+
+namespace filedaemon {
+
+static const int debuglevel = 150;
+static constexpr std::uint32_t kBlockMapMagic = 0x42444d32; /* "BDM2" */
+static constexpr std::size_t kBlockMapHeaderSize
+    = 4 + 4 + 4 + 4 + 8 + 8 + 8 + 8;
+// what the director appends to the job name: .YYYY-MM-DD_HH.MM.SS_NN
+static constexpr std::size_t kUniqueJobSuffixLength = 23;
+
+BlockHash HashBlock(JobControlRecord* jcr, const char* data, std::size_t size)
+{
+  BlockHash hash{};
+  DIGEST* digest = crypto_digest_new(jcr, CRYPTO_DIGEST_XXH128);
+  if (!digest) { return hash; }
+
+  uint32_t length = hash.size();
+  CryptoDigestUpdate(digest, (const uint8_t*)data, size);
+  CryptoDigestFinalize(digest, hash.data(), &length);
+  CryptoDigestFree(digest);
+  return hash;
+}
+
+bool BlockMap::Describes(const struct stat& st,
+                         std::int32_t t_delta_seq,
+                         std::uint32_t t_job_id) const
+{
+  std::size_t blocks = (size + block_size - 1) / block_size;
+  return t_job_id != 0 && job_id == t_job_id && delta_seq == t_delta_seq
+         && size == st.st_size
+         && mtime == st.st_mtime && ctime == st.st_ctime
+         && hashes.size() == blocks;
+}
+
+bool BlockMap::Write(const std::string& path) const
+{
+  std::vector<char> header(kBlockMapHeaderSize);
+  ser_declare;
+
+  SerBegin(header.data(), header.size());
+  ser_uint32(kBlockMapMagic);
+  ser_uint32(job_id);
+  ser_uint32(block_size);
+  ser_int32(delta_seq);
+  ser_int64(size);
+  ser_int64(mtime);
+  ser_int64(ctime);
+  ser_uint64(hashes.size());
+  SerEnd(header.data(), header.size());
+
+  if (auto slash = path.rfind('/'); slash != std::string::npos) {
+    std::string dir = path.substr(0, slash);
+    if (mkdir(dir.c_str(), 0750) != 0 && errno != EEXIST) { return false; }
+  }
+
+  // write a new file and rename it, a crash never leaves a partial map
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(header.data(), header.size());
+    for (auto& hash : hashes) {
+      out.write((const char*)hash.data(), hash.size());
+    }
+    if (!out.flush()) {
+      unlink(tmp.c_str());
+      return false;
+    }
+  }
+
+  if (rename(tmp.c_str(), path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::optional<BlockMap> BlockMap::Read(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) { return std::nullopt; }
+
+  std::vector<char> header(kBlockMapHeaderSize);
+  if (!in.read(header.data(), header.size())) { return std::nullopt; }
+
+  BlockMap map;
+  std::uint32_t magic;
+  std::uint64_t size, mtime, ctime, count;
+  unser_declare;
+
+  // lib/serial only reads unsigned 64 bit values
+  UnserBegin(header.data(), header.size());
+  unser_uint32(magic);
+  unser_uint32(map.job_id);
+  unser_uint32(map.block_size);
+  unser_int32(map.delta_seq);
+  unser_uint64(size);
+  unser_uint64(mtime);
+  unser_uint64(ctime);
+  unser_uint64(count);
+  UnserEnd(header.data(), header.size());
+  map.size = static_cast<std::int64_t>(size);
+  map.mtime = static_cast<std::int64_t>(mtime);
+  map.ctime = static_cast<std::int64_t>(ctime);
+
+  if (magic != kBlockMapMagic || map.block_size == 0 || map.size < 0) {
+    return std::nullopt;
+  }
+  std::uint64_t blocks = (map.size + map.block_size - 1) / map.block_size;
+  if (count != blocks) { return std::nullopt; }
+
+  map.hashes.resize(count);
+  for (auto& hash : map.hashes) {
+    if (!in.read((char*)hash.data(), hash.size())) { return std::nullopt; }
+  }
+
+  return map;
+}
+
+std::string BlockMapPath(const char* working_directory,
+                         const char* director,
+                         const char* job,
+                         const char* fname)
+{
+  std::string key{director};
+  key += '\0';
+  key.append(job, std::max(strlen(job), kUniqueJobSuffixLength)
+                      - kUniqueJobSuffixLength);
+  key += '\0';
+  key += fname;
+  BlockHash name = HashBlock(nullptr, key.data(), key.size());
+
+  std::string path{working_directory};
+  path += "/block-delta/";
+  for (auto byte : name) {
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02x", byte);
+    path += hex;
+  }
+  path += ".map";
+  return path;
+}
+
+std::optional<BlockDeltaFile> SetupBlockDelta(JobControlRecord* jcr,
+                                              FindFilesPacket* ff_pkt)
+{
+  // only block delta files carry a delta sequence in the core
+  std::int32_t previous_seq = ff_pkt->delta_seq;
+  ff_pkt->delta_seq = 0;
+
+#if defined(HAVE_WIN32)
+  return std::nullopt;
+#else
+  /* Encrypted data has to go into a plain data stream, which cannot carry
+   * the offsets of the blocks. */
+  if (!BitIsSet(FO_BLOCK_DELTA, ff_pkt->flags) || ff_pkt->type != FT_REG
+      || ff_pkt->statp.st_size < kBlockDeltaMinimumSize
+      || !IsPortableBackup(&ff_pkt->bfd) || BitIsSet(FO_ENCRYPT, ff_pkt->flags)
+      || jcr->fd_impl->crypto.pki_encrypt) {
+    return std::nullopt;
+  }
+
+  BlockDeltaFile file;
+  file.map_path
+      = BlockMapPath(me->working_directory,
+                     jcr->fd_impl->director->resource_name_, jcr->Job,
+                     ff_pkt->fname);
+
+  /* Deltas are only made against the previous backup of this job, which is
+   * the last one of the accurate list.  Differentials would leave a gap in
+   * the chain when restoring. */
+  if (jcr->getJobLevel() == L_INCREMENTAL && ff_pkt->accurate_found
+      && previous_seq < kBlockDeltaMaximumChain) {
+    auto previous = BlockMap::Read(file.map_path);
+    if (previous && previous->block_size == kBlockDeltaBlockSize
+        && previous->Describes(ff_pkt->accurate_statp, previous_seq,
+                               jcr->fd_impl->previous_jobid)) {
+      file.previous = std::move(previous);
+      ff_pkt->delta_seq = previous_seq + 1;
+    } else {
+      Dmsg1(debuglevel, "no usable block map for %s\n", ff_pkt->fname);
+    }
+  }
+
+  file.skip_zeros = !file.previous && BitIsSet(FO_SPARSE, ff_pkt->flags);
+  file.current.job_id = jcr->JobId;
+  file.current.delta_seq = ff_pkt->delta_seq;
+  file.current.size = ff_pkt->statp.st_size;
+  file.current.mtime = ff_pkt->statp.st_mtime;
+  file.current.ctime = ff_pkt->statp.st_ctime;
+
+  // Blocks are sent with their file offset, holes are handled by us.
+  ClearBit(FO_SPARSE, ff_pkt->flags);
+  SetBit(FO_OFFSETS, ff_pkt->flags);
+
+  Dmsg2(debuglevel, "block delta %s delta_seq=%d\n", ff_pkt->fname,
+        ff_pkt->delta_seq);
+  return file;
+#endif
+}
+
+int OpenBlockDeltaFile(JobControlRecord* jcr,
+                       Attributes* attr,
+                       BareosFilePacket* bfd)
+{
+#if defined(HAVE_WIN32)
+  Qmsg1(jcr, M_ERROR, 0,
+        T_("Restoring block delta files is not supported on Windows: %s\n"),
+        attr->ofname);
+  return CF_ERROR;
+#else
+  if (IsBopen(bfd)) { bclose(bfd); }
+
+  SetPortableBackup(bfd);
+  if (bopen(bfd, attr->ofname, O_WRONLY | O_BINARY, 0, attr->statp.st_rdev)
+      < 0) {
+    BErrNo be;
+    be.SetErrno(bfd->BErrNo);
+    Qmsg2(jcr, M_ERROR, 0,
+          T_("Cannot apply changed blocks to %s, the previous parts of the "
+             "file are missing: ERR=%s\n"),
+          attr->ofname, be.bstrerror());
+    return CF_ERROR;
+  }
+
+  return CF_EXTRACT;
+#endif
+}
+
+bool FinishBlockDeltaFile([[maybe_unused]] JobControlRecord* jcr,
+                          [[maybe_unused]] Attributes* attr,
+                          [[maybe_unused]] BareosFilePacket* bfd)
+{
+#if !defined(HAVE_WIN32)
+  if (ftruncate(bfd->filedes, attr->statp.st_size) != 0) {
+    BErrNo be;
+    Jmsg2(jcr, M_ERROR, 0, T_("Cannot truncate %s: ERR=%s\n"),
+          attr->ofname, be.bstrerror());
+    return false;
+  }
+#endif
+  return true;
+}
+
+} /* namespace filedaemon */
@@ -0,0 +1,120 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Block level incremental backups of large files
+ */
+
+#ifndef BAREOS_FILED_BLOCK_DELTA_H_
+#define BAREOS_FILED_BLOCK_DELTA_H_
+
+#include "include/bareos.h"
+#include "lib/crypto.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct Attributes;
+struct BareosFilePacket;
+struct FindFilesPacket;
+
+namespace filedaemon {
+
+// Granularity in which changes are detected.
+inline constexpr std::uint32_t kBlockDeltaBlockSize = 1024 * 1024;
+// Smaller files are always saved as a whole.
+inline constexpr std::int64_t kBlockDeltaMinimumSize
+    = 16 * std::int64_t{kBlockDeltaBlockSize};
+/* A restore needs every part of the chain, so after this many deltas the
+ * whole file is saved again. */
+inline constexpr std::int32_t kBlockDeltaMaximumChain = 64;
+
+using BlockHash = std::array<std::uint8_t, CRYPTO_DIGEST_XXH128_SIZE>;
+
+BlockHash HashBlock(JobControlRecord* jcr, const char* data, std::size_t size);
+
+/* The hashes of all blocks of a file, as saved by a backup.  It is kept in
+ * the working directory, so that the next incremental backup of the same
+ * job knows which blocks changed. */
+struct BlockMap {
+  std::uint32_t job_id{0}; /* backup that wrote the map */
+  std::uint32_t block_size{kBlockDeltaBlockSize};
+  std::int32_t delta_seq{0}; /* delta sequence the file was saved with */
+  std::int64_t size{0};
+  std::int64_t mtime{0};
+  std::int64_t ctime{0};
+  std::vector<BlockHash> hashes{};
+
+  /* Whether this map describes the file that the catalog knows from backup
+   * t_job_id with stat st and delta sequence t_delta_seq.  Maps written by a
+   * backup that did not make it into the catalog do not. */
+  bool Describes(const struct stat& st,
+                 std::int32_t t_delta_seq,
+                 std::uint32_t t_job_id) const;
+
+  bool Unchanged(std::size_t index, const BlockHash& hash) const
+  {
+    return index < hashes.size() && hashes[index] == hash;
+  }
+
+  bool Write(const std::string& path) const;
+  static std::optional<BlockMap> Read(const std::string& path);
+};
+
+/* Where the map of fname is kept.  job is the unique name of the running
+ * job; all runs of a job share their maps, but other jobs backing up the
+ * same file (with another fileset, say) have their own. */
+std::string BlockMapPath(const char* working_directory,
+                         const char* director,
+                         const char* job,
+                         const char* fname);
+
+// What SaveFile() needs to know about a file saved with block deltas.
+struct BlockDeltaFile {
+  std::string map_path{};
+  std::optional<BlockMap> previous{}; /* set if only changes are sent */
+  BlockMap current{};                 /* filled while the file is read */
+  bool skip_zeros{false};             /* leave holes when saving the base */
+};
+
+/* Decides how a file is saved and sets ff_pkt->delta_seq and the stream
+ * flags accordingly, so it has to be called before the attributes are sent.
+ * Returns nothing if the file is saved the normal way. */
+std::optional<BlockDeltaFile> SetupBlockDelta(JobControlRecord* jcr,
+                                              FindFilesPacket* ff_pkt);
+
+/* Opens the file restored from the previous parts of the chain, so that
+ * the changed blocks can be written into it.  Returns a CF_ status. */
+int OpenBlockDeltaFile(JobControlRecord* jcr,
+                       Attributes* attr,
+                       BareosFilePacket* bfd);
+
+// Cuts the file to its saved size, it might have shrunk.
+bool FinishBlockDeltaFile(JobControlRecord* jcr,
+                          Attributes* attr,
+                          BareosFilePacket* bfd);
+
+} /* namespace filedaemon */
+
+#endif  // BAREOS_FILED_BLOCK_DELTA_H_
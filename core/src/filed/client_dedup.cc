@@ -0,0 +1,162 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "filed/client_dedup.h"
+#include "include/jcr.h"
+#include "lib/bget_msg.h"
+#include "lib/bnet.h"
+#include "lib/bsock.h"
+#include "lib/chunk_manifest.h"
+
+#include <cstring>
+
+namespace filedaemon {
+
+bool ClientDedup::SendPlain(BareosSocket* sd, POOLMEM* data, std::size_t size)
+{
+  POOLMEM* save = sd->msg;
+  sd->msg = data;
+  sd->message_length = size;
+  bool ok = sd->send();
+  sd->msg = save;
+  return ok;
+}
+
+bool ClientDedup::Send(BareosSocket* sd, POOLMEM* data, std::size_t size)
+{
+  bytes_total_ += size;
+
+  // small records would be stored inline by the storage daemon anyway
+  std::optional<std::vector<chunk_manifest::chunk>> chunks;
+  if (size >= chunker_.AverageSize()) {
+    chunks = chunk_manifest::Build(chunker_, data, size);
+  }
+
+  bool ok = true;
+  if (!chunks) {
+    // plain records must not overtake the queued ones
+    ok = Flush(sd) && SendPlain(sd, data, size);
+  } else {
+    if (!filling_.records.empty()
+        && filling_.data.size() + size > max_batch_size) {
+      ok = SendManifest(sd);
+    }
+    filling_.chunks += chunks->size();
+    filling_.records.push_back(std::move(chunks).value());
+    filling_.data.insert(filling_.data.end(), data, data + size);
+    if (ok && filling_.records.size() >= max_batch_records) {
+      ok = SendManifest(sd);
+    }
+  }
+
+  sd->message_length = size;
+  return ok;
+}
+
+bool ClientDedup::Flush(BareosSocket* sd)
+{
+  if (!SendManifest(sd)) { return false; }
+  while (!unanswered_.empty()) {
+    if (!SendMissing(sd)) { return false; }
+  }
+  return true;
+}
+
+bool ClientDedup::SendManifest(BareosSocket* sd)
+{
+  if (filling_.records.empty()) { return true; }
+
+  if (!sd->signal(BNET_CHUNK_MANIFEST)) { return false; }
+
+  POOLMEM* save = sd->msg;
+  sd->msg = buffer_.addr();
+  sd->message_length = chunk_manifest::Encode(filling_.records, sd->msg);
+  bool ok = sd->send();
+  buffer_.addr() = sd->msg;  // the buffer might have been reallocated
+  sd->msg = save;
+  if (!ok) { return false; }
+
+  unanswered_.push_back(std::move(filling_));
+  filling_ = batch{};
+
+  // the storage daemon looks up this manifest while we send the data of
+  // the previous one
+  if (unanswered_.size() >= max_unanswered) { return SendMissing(sd); }
+  return true;
+}
+
+bool ClientDedup::SendMissing(BareosSocket* sd)
+{
+  batch current = std::move(unanswered_.front());
+  unanswered_.pop_front();
+
+  POOLMEM* save = sd->msg;
+  sd->msg = buffer_.addr();
+
+  bool ok = false;
+  std::optional<std::vector<bool>> known;
+
+  if (int n = BgetMsg(sd); n >= 0) {
+    known = chunk_manifest::DecodeKnown(sd->msg, n, current.chunks);
+    if (!known) {
+      Jmsg0(sd->get_jcr(), M_FATAL, 0,
+            T_("Bad chunk manifest response from SD.\n"));
+    }
+  }
+
+  if (known && sd->signal(BNET_CHUNK_DATA)) {
+    std::size_t missing_size = 0;
+    std::size_t i = 0;
+    for (auto& chunks : current.records) {
+      for (auto& chunk : chunks) {
+        if (!(*known)[i++]) { missing_size += chunk.size; }
+      }
+    }
+
+    if (missing_size > 0) {
+      sd->msg = CheckPoolMemorySize(sd->msg, missing_size);
+      char* dest = sd->msg;
+      const char* src = current.data.data();
+      i = 0;
+      for (auto& chunks : current.records) {
+        for (auto& chunk : chunks) {
+          if (!(*known)[i++]) {
+            std::memcpy(dest, src, chunk.size);
+            dest += chunk.size;
+          }
+          src += chunk.size;
+        }
+      }
+      sd->message_length = missing_size;
+      ok = sd->send();
+    } else {
+      ok = true;
+    }
+
+    bytes_skipped_ += current.data.size() - missing_size;
+  }
+
+  buffer_.addr() = sd->msg;  // the buffer might have been reallocated
+  sd->msg = save;
+  return ok;
+}
+
+} /* namespace filedaemon */
@@ -0,0 +1,88 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_FILED_CLIENT_DEDUP_H_
+#define BAREOS_FILED_CLIENT_DEDUP_H_
+
+#include "include/bareos.h"
+#include "lib/chunk_manifest.h"
+#include "lib/fastcdc.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class BareosSocket;
+
+namespace filedaemon {
+
+/* Sends data records as chunk manifests (see lib/chunk_manifest.h), so that
+ * only the chunks the storage daemon does not hold yet cross the network.
+ * Records are collected into batches and the manifest of the next batch is
+ * sent before the answer to the previous one is read, so the network round
+ * trip is neither paid per record nor waited for.  The storage daemon answers
+ * every manifest, so nobody else may read from the socket while this is in
+ * use. */
+class ClientDedup {
+ public:
+  // Throws std::invalid_argument if chunk_size is not usable
+  explicit ClientDedup(std::size_t chunk_size) : chunker_{chunk_size} {}
+
+  /* Sends size bytes at data as one data record; the record might only be
+   * queued.  data needs to be usable as a socket message.  Afterwards
+   * sd->message_length is size again, so callers can do their accounting as
+   * usual.  Returns false on errors. */
+  bool Send(BareosSocket* sd, POOLMEM* data, std::size_t size);
+  /* Sends all queued records.  Needs to be called before anything else than
+   * a data record is sent, i.e. before the end of every data stream. */
+  bool Flush(BareosSocket* sd);
+
+  std::uint64_t BytesTotal() const { return bytes_total_; }
+  std::uint64_t BytesSkipped() const { return bytes_skipped_; }
+
+ private:
+  static constexpr std::size_t max_batch_records = 256;
+  // the missing data of a batch is sent as a single network message
+  static constexpr std::size_t max_batch_size = 768 * 1024;
+  // manifests sent before we wait for the oldest answer
+  static constexpr std::size_t max_unanswered = 2;
+
+  struct batch {
+    chunk_manifest::batch records;
+    std::vector<char> data;  // the records, concatenated
+    std::size_t chunks{0};
+  };
+
+  FastCdcChunker chunker_;
+  PoolMem buffer_{PM_MESSAGE};
+  batch filling_;
+  std::deque<batch> unanswered_;
+  std::uint64_t bytes_total_{0};
+  std::uint64_t bytes_skipped_{0};
+
+  bool SendPlain(BareosSocket* sd, POOLMEM* data, std::size_t size);
+  bool SendManifest(BareosSocket* sd);
+  bool SendMissing(BareosSocket* sd);
+};
+
+} /* namespace filedaemon */
+
+#endif  // BAREOS_FILED_CLIENT_DEDUP_H_
@@ -35,6 +35,7 @@
 #include "filed/estimate.h"
 #include "filed/evaluate_job_command.h"
 #include "filed/heartbeat.h"
+#include "filed/client_dedup.h"
 #include "filed/fileset.h"
 #include "filed/filed_jcr_impl.h"
 #include "filed/socket_server.h"
@@ -58,6 +59,7 @@
 #include "filed/backup.h"
 #include "lib/compression.h"
 #include "filed/accurate.h"
+#include "filed/accurate_state.h"
 
 #if defined(WIN32_VSS)
 #  include "findlib/win32.h"
@@ -65,6 +67,7 @@
 #endif
 
 #include <atomic>
+#include <cmath>
 
 namespace filedaemon {
 
@@ -133,6 +136,8 @@ static bool OpenSdReadSession(JobControlRecord* jcr);
 static void SetStorageAuthKeyAndTlsPolicy(JobControlRecord* jcr,
                                           char* key,
                                           TlsPolicy policy);
+static uint32_t OpenDataConnections(JobControlRecord* jcr, uint32_t count);
+static void CloseDataConnections(JobControlRecord* jcr);
 
 /* Exported functions */
 
@@ -149,6 +154,7 @@ struct s_fd_dir_cmds {
  * string.
  */
 static struct s_fd_dir_cmds cmds[] = {
+    {"accuratestate", AccurateStateCmd, false},
     {"accurate", AccurateCmd, false},
     {"backup", BackupCmd, false},
     {"bootstrap", BootstrapCmd, false},
@@ -211,6 +217,8 @@ inline constexpr const char endrestoreobjectcmd[] = "restoreobject end\n";
 inline constexpr const char pluginoptionscmd[] = "pluginoptions %s";
 inline constexpr const char verifycmd[] = "verify level=%30s";
 inline constexpr const char Estimatecmd[] = "estimate listing=%d";
+inline constexpr const char FastEstimatecmd[]
+    = "estimate listing=%d fast=%d timelimit=%u";
 inline constexpr const char runscriptcmd[]
     = "Run OnSuccess=%d OnFailure=%d AbortOnError=%d When=%d Command=%s";
 inline constexpr const char resolvecmd[] = "resolve %s";
@@ -223,6 +231,9 @@ inline constexpr const char OkAuthorization[] = "2000 OK Authorization\n";
 inline constexpr const char OKBandwidth[] = "2000 OK Bandwidth\n";
 inline constexpr const char OKinc[] = "2000 OK include\n";
 inline constexpr const char OKest[] = "2000 OK estimate files=%s bytes=%s\n";
+inline constexpr const char OKestsampled[]
+    = "2000 OK estimate files=%s bytes=%s (+/- %s files, +/- %s bytes at 95%% "
+      "confidence, %s directories extrapolated from %s samples)\n";
 inline constexpr const char OKlevel[] = "2000 OK level\n";
 inline constexpr const char OKbackup[] = "2000 OK backup\n";
 inline constexpr const char OKbootstrap[] = "2000 OK bootstrap\n";
@@ -254,12 +265,21 @@ inline constexpr const char BadPluginOptions[]
 inline constexpr const char OK_end[] = "3000 OK end\n";
 inline constexpr const char OK_close[] = "3000 OK close Status = %d\n";
 inline constexpr const char OK_open[] = "3000 OK open ticket = %d\n";
+inline constexpr const char OK_open_dedup[]
+    = "3000 OK open ticket = %d dedup chunksize = %u\n";
+inline constexpr const char OK_open_streams[]
+    = "3000 OK open ticket = %d streams = %u\n";
 inline constexpr const char OK_data[] = "3000 OK data\n";
 inline constexpr const char OK_append[] = "3000 OK append data\n";
 
 // Commands sent to Storage Daemon
 inline constexpr const char append_open[] = "append open session\n";
+inline constexpr const char append_open_dedup[] = "append open session dedup\n";
+inline constexpr const char append_open_streams[]
+    = "append open session streams=%u\n";
 inline constexpr const char append_data[] = "append data %d\n";
+inline constexpr const char append_data_streams[]
+    = "append data %d streams=%u\n";
 inline constexpr const char append_end[] = "append end session %d\n";
 inline constexpr const char append_close[] = "append close session %d\n";
 inline constexpr const char read_open[]
@@ -816,7 +836,9 @@ static bool SetdebugCmd(JobControlRecord* jcr)
 static bool EstimateCmd(JobControlRecord* jcr)
 {
   BareosSocket* dir = jcr->dir_bsock;
-  char ed1[50], ed2[50];
+  char ed1[50], ed2[50], ed3[50], ed4[50], ed5[50], ed6[50];
+  int fast = 0;
+  uint32_t time_limit = 0;
 
   // See if we are allowed to run estimate cmds.
   if (!ValidateCommand(
@@ -828,14 +850,35 @@ static bool EstimateCmd(JobControlRecord* jcr)
     return 0;
   }
 
-  if (bsscanf(dir->msg, Estimatecmd, &jcr->fd_impl->listing) != 1) {
+  if (bsscanf(dir->msg, FastEstimatecmd, &jcr->fd_impl->listing, &fast,
+              &time_limit)
+          != 3
+      && bsscanf(dir->msg, Estimatecmd, &jcr->fd_impl->listing) != 1) {
     PmStrcpy(jcr->errmsg, dir->msg);
     Jmsg(jcr, M_FATAL, 0, T_("Bad estimate command: %s\n"), jcr->errmsg);
     dir->fsend(T_("2992 Bad estimate command.\n"));
     return false;
   }
 
-  MakeEstimate(jcr);
+  if (!fast) {
+    MakeEstimate(jcr);
+  } else {
+    FastEstimateResult result = MakeFastEstimate(jcr, time_limit);
+    if (result.Sampled()) {
+      auto rounded = [](double value) {
+        return static_cast<uint64_t>(std::llround(value));
+      };
+      dir->fsend(OKestsampled,
+                 edit_uint64_with_commas(rounded(result.estimated_files), ed1),
+                 edit_uint64_with_commas(rounded(result.estimated_bytes), ed2),
+                 edit_uint64_with_commas(rounded(result.files_error), ed3),
+                 edit_uint64_with_commas(rounded(result.bytes_error), ed4),
+                 edit_uint64_with_commas(result.directories_left, ed5),
+                 edit_uint64_with_commas(result.samples, ed6));
+      dir->signal(BNET_EOD);
+      return true;
+    }
+  }
 
   dir->fsend(OKest,
              edit_uint64_with_commas(jcr->fd_impl->num_files_examined, ed1),
@@ -1408,6 +1451,8 @@ static bool StorageCmd(JobControlRecord* jcr)
   }
 
   SetStorageAuthKeyAndTlsPolicy(jcr, sd_auth_key.c_str(), tls_policy);
+  jcr->fd_impl->stored_addr = stored_addr;
+  jcr->fd_impl->stored_port = stored_port;
 
   Dmsg3(110, "Open storage: %s:%d ssl=%u\n", stored_addr, stored_port,
         static_cast<unsigned int>(tls_policy));
@@ -1480,6 +1525,77 @@ bail_out:
   return false;
 }
 
+/* Open one more connection to the storage daemon to stripe the backup data
+ * over.  It is set up and authenticated just like the main connection. */
+static BareosSocket* OpenDataConnection(JobControlRecord* jcr, uint32_t index)
+{
+  BareosSocket* sd = new BareosSocketTCP;
+
+  sd->SetSourceAddress(me->FDsrc_addr);
+  if (!sd->connect(jcr, 1, (int)me->SDConnectTimeout, me->heartbeat_interval,
+                   T_("Storage daemon"), jcr->fd_impl->stored_addr.data(),
+                   nullptr, jcr->fd_impl->stored_port, false)) {
+    delete sd;
+    return nullptr;
+  }
+
+  bool ok = true;
+  if (jcr->sd_tls_policy == TlsPolicy::kBnetTlsAuto) {
+    std::string qualified_resource_name
+        = global_resource::QualifiedName(global_resource::Type::Job, jcr->Job);
+
+    sd->SetEnableKtls(me->enable_ktls);
+    ok = sd->DoTlsHandshake(TlsPolicy::kBnetTlsAuto, me, false,
+                            qualified_resource_name.c_str(), jcr->sd_auth_key,
+                            jcr);
+  }
+
+  if (ok) {
+    sd->fsend("Hello Start Job %s DataConnection=%u\n", jcr->Job, index);
+    ok = AuthenticateDataConnection(jcr, sd);
+  }
+
+  if (!ok) {
+    sd->close();
+    delete sd;
+    return nullptr;
+  }
+
+  sd->SetJcr(jcr);
+  return sd;
+}
+
+/* Open the data connections the storage daemon agreed to.  If some of them
+ * fail, the data is striped over the others.  Returns the number of opened
+ * connections. */
+static uint32_t OpenDataConnections(JobControlRecord* jcr, uint32_t count)
+{
+  for (uint32_t i = 1; i <= count; ++i) {
+    BareosSocket* sd = OpenDataConnection(jcr, i);
+    if (!sd) {
+      Jmsg(jcr, M_WARNING, 0,
+           T_("Could not open data connection %u of %u to Storage daemon "
+              "%s:%d\n"),
+           i, count, jcr->fd_impl->stored_addr.c_str(),
+           jcr->fd_impl->stored_port);
+      break;
+    }
+    jcr->fd_impl->data_connections.push_back(sd);
+  }
+
+  DestroyStorageAuthKey(jcr);
+  return jcr->fd_impl->data_connections.size();
+}
+
+static void CloseDataConnections(JobControlRecord* jcr)
+{
+  for (auto* sd : jcr->fd_impl->data_connections) {
+    sd->close();
+    delete sd;
+  }
+  jcr->fd_impl->data_connections.clear();
+}
+
 #ifndef HAVE_WIN32
 static void LogFlagStatus(JobControlRecord* jcr,
                           int flag,
@@ -1737,14 +1853,48 @@ static bool BackupCmd(JobControlRecord* jcr)
   dir->fsend(OKbackup);
   Dmsg1(110, "filed>dird: %s", dir->msg);
 
-  // Send Append Open Session to Storage daemon
-  sd->fsend(append_open);
+  /* Send Append Open Session to Storage daemon.  Data that is sent as chunk
+   * manifests cannot be striped, as we have to read the answers of the
+   * storage daemon in between.  A passive client is called by the storage
+   * daemon and has no address to open more connections to. */
+  if (me->client_side_dedup) {
+    sd->fsend(append_open_dedup);
+  } else if (me->data_connections > 1
+             && !jcr->fd_impl->stored_addr.empty()) {
+    sd->fsend(append_open_streams, me->data_connections);
+  } else {
+    sd->fsend(append_open);
+  }
   Dmsg1(110, ">stored: %s", sd->msg);
 
   // Expect to receive back the Ticket number
   if (BgetMsg(sd) >= 0) {
+    uint32_t chunk_size = 0;
+    uint32_t streams = 0;
+
     Dmsg1(110, "<stored: %s", sd->msg);
-    if (bsscanf(sd->msg, OK_open, &jcr->fd_impl->Ticket) != 1) {
+    if (bsscanf(sd->msg, OK_open_streams, &jcr->fd_impl->Ticket, &streams)
+        == 2) {
+      if (streams > 1 && OpenDataConnections(jcr, streams) > 0) {
+        Jmsg(jcr, M_INFO, 0,
+             T_("Striping data over %" PRIuz " connections.\n"),
+             jcr->fd_impl->data_connections.size());
+      }
+    } else if (bsscanf(sd->msg, OK_open_dedup, &jcr->fd_impl->Ticket,
+                       &chunk_size)
+               == 2) {
+      try {
+        jcr->fd_impl->client_dedup = std::make_unique<ClientDedup>(chunk_size);
+        Jmsg(jcr, M_INFO, 0,
+             T_("Using client side deduplication (chunk size %u).\n"),
+             chunk_size);
+      } catch (const std::invalid_argument&) {
+        Jmsg(jcr, M_WARNING, 0,
+             T_("Storage daemon requested unusable chunk size %u. Not using "
+                "client side deduplication.\n"),
+             chunk_size);
+      }
+    } else if (bsscanf(sd->msg, OK_open, &jcr->fd_impl->Ticket) != 1) {
       Jmsg(jcr, M_FATAL, 0, T_("Bad response to append open: %s\n"), sd->msg);
       goto cleanup;
     }
@@ -1755,7 +1905,13 @@ static bool BackupCmd(JobControlRecord* jcr)
   }
 
   // Send Append data command to Storage daemon
-  sd->fsend(append_data, jcr->fd_impl->Ticket);
+  if (auto& connections = jcr->fd_impl->data_connections;
+      !connections.empty()) {
+    sd->fsend(append_data_streams, jcr->fd_impl->Ticket,
+              static_cast<uint32_t>(connections.size()));
+  } else {
+    sd->fsend(append_data, jcr->fd_impl->Ticket);
+  }
   Dmsg1(110, ">stored: %s", sd->msg);
 
   // Expect to get OK data
@@ -1907,6 +2063,9 @@ static bool BackupCmd(JobControlRecord* jcr)
   }
 
 cleanup:
+  CloseDataConnections(jcr);
+  DestroyStorageAuthKey(jcr);
+
 #if defined(WIN32_VSS)
   if (jcr->fd_impl->pVSSClient) {
     jcr->fd_impl->pVSSClient->DestroyWriterInfo();
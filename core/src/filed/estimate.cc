@@ -2,7 +2,7 @@
    BAREOS® - Backup Archiving REcovery Open Sourced
 
    Copyright (C) 2001-2008 Free Software Foundation Europe e.V.
-   Copyright (C) 2016-2025 Bareos GmbH & Co. KG
+   Copyright (C) 2016-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -29,13 +29,50 @@
 #include "include/bareos.h"
 #include "include/filetypes.h"
 #include "filed/filed.h"
+#include "filed/filed_globals.h"
 #include "filed/filed_jcr_impl.h"
 #include "filed/accurate.h"
+#include "filed/estimate.h"
+#include "lib/bsock.h"
 
 namespace filedaemon {
 
 static int TallyFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool);
 
+namespace {
+// Applies the Options{} and Exclude{} of the fileset like FindFiles() does.
+class FilesetFilter : public EstimateFilter {
+ public:
+  FilesetFilter(findFILESET* fileset,
+                const std::vector<findIncludeExcludeItem*>& includes)
+      : includes_{includes}
+  {
+    ff_.fileset = fileset;
+  }
+
+  ~FilesetFilter()
+  {
+    // AcceptFile() copies these from the fileset, they are not ours to free
+    ff_.fstypes.init();
+    ff_.drivetypes.init();
+  }
+
+  bool Accept(std::size_t set,
+              const char* path,
+              const struct stat& statp) override
+  {
+    ClearAllBits(FO_MAX, ff_.flags);
+    ff_.fname = const_cast<char*>(path);
+    ff_.statp = statp;
+    return AcceptFile(&ff_, includes_[set]);
+  }
+
+ private:
+  const std::vector<findIncludeExcludeItem*>& includes_;
+  FindFilesPacket ff_{};
+};
+}  // namespace
+
 // Find all the requested files and count them.
 int MakeEstimate(JobControlRecord* jcr)
 {
@@ -57,6 +94,60 @@ int MakeEstimate(JobControlRecord* jcr)
   return status;
 }
 
+FastEstimateResult MakeFastEstimate(JobControlRecord* jcr,
+                                    uint32_t time_limit)
+{
+  FindFilesPacket* ff = (FindFilesPacket*)jcr->fd_impl->ff;
+  findFILESET* fileset = ff->fileset;
+  FastEstimateOptions options;
+  std::vector<findIncludeExcludeItem*> includes;
+
+  jcr->setJobStatusWithPriorityCheck(JS_Running);
+
+  for (int i = 0; fileset && i < fileset->include_list.size(); i++) {
+    findIncludeExcludeItem* incexe = fileset->include_list.get(i);
+    // Same flags as FindFiles() uses for this Include{}
+    char flags[FOPTS_BYTES]{};
+    for (int j = 0; j < incexe->opts_list.size(); j++) {
+      CopyBits(FO_MAX, incexe->opts_list.get(j)->flags, flags);
+    }
+
+    EstimateIncludeSet& set = options.sets.emplace_back();
+    set.one_fs = !BitIsSet(FO_MULTIFS, flags);
+    set.recurse = !BitIsSet(FO_NO_RECURSION, flags);
+    set.mtime_only = BitIsSet(FO_MTIMEONLY, flags);
+    set.track_hardlinks = !BitIsSet(FO_NO_HARDLINK, flags);
+    for (auto* ignoredir : incexe->ignoredir) {
+      set.ignoredir.emplace_back(ignoredir);
+    }
+
+    dlistString* node;
+    foreach_dlist (node, &incexe->name_list) {
+      set.paths.emplace_back(node->c_str());
+    }
+    foreach_dlist (node, &incexe->plugin_list) {
+      jcr->dir_bsock->fsend(
+          T_("Plugin \"%s\" is not part of a fast estimate.\n"),
+          node->c_str());
+    }
+    includes.push_back(incexe);
+  }
+
+  options.workers = me->MaxWorkersPerJob;
+  if (ff->incremental) { options.since_time = ff->save_time; }
+  if (time_limit > 0) { options.time_limit = std::chrono::seconds(time_limit); }
+  options.make_filter = [fileset, &includes] {
+    return std::make_unique<FilesetFilter>(fileset, includes);
+  };
+  options.canceled = [jcr] { return jcr->IsJobCanceled(); };
+
+  FastEstimateResult result = FastEstimate(options, jcr->fd_impl->threads);
+  jcr->fd_impl->num_files_examined = result.files;
+  jcr->JobFiles = result.files;
+  jcr->JobBytes = result.bytes;
+  return result;
+}
+
 /**
  * Called here by find() for each file included.
  *
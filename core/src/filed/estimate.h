@@ -1,7 +1,7 @@
 /*
    BAREOS® - Backup Archiving REcovery Open Sourced
 
-   Copyright (C) 2018-2021 Bareos GmbH & Co. KG
+   Copyright (C) 2018-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -22,9 +22,15 @@
 #ifndef BAREOS_FILED_ESTIMATE_H_
 #define BAREOS_FILED_ESTIMATE_H_
 
+#include "filed/fast_estimate.h"
+
 namespace filedaemon {
 
 int MakeEstimate(JobControlRecord* jcr);
+/* Estimate from the metadata of the directories only.  With a time_limit
+ * (in seconds) the rest is extrapolated once the time is used up. */
+FastEstimateResult MakeFastEstimate(JobControlRecord* jcr,
+                                    uint32_t time_limit);
 
 } /* namespace filedaemon */
 
@@ -0,0 +1,406 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Metadata only estimate that reads directories in parallel
+ */
+
+#include "include/bareos.h"
+#include "filed/fast_estimate.h"
+#include "lib/thread_pool.h"
+#include "lib/thread_util.h"
+
+#include <dirent.h>
+
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <set>
+#include <utility>
+
+#if !defined(HAVE_WIN32)
+#  include <fcntl.h>
+#endif
+#if defined(HAVE_LINUX_OS)
+#  include <sys/sysmacros.h>
+#endif
+
+namespace filedaemon {
+
+namespace {
+// z value of the two sided 95% confidence interval
+constexpr double kConfidence95 = 1.96;
+// Share of the time limit spent reading directories, the rest is sampling.
+constexpr double kWalkShare = 0.8;
+constexpr std::size_t kMaximumSamples = 10000;
+constexpr int kMaximumSampleDepth = 256;
+
+using steady_clock = std::chrono::steady_clock;
+using hardlink_set = synchronized<std::set<std::pair<dev_t, ino_t>>>;
+
+struct PendingDirectory {
+  std::string path{};
+  dev_t device{};
+  std::size_t set{};
+};
+
+struct DirectoryCount {
+  std::uint64_t files{0};
+  std::uint64_t bytes{0};
+  std::vector<PendingDirectory> subdirs{};
+};
+
+struct WalkState {
+  std::deque<PendingDirectory> queue{};
+  std::size_t busy{0};    /* threads reading a directory */
+  std::size_t running{0}; /* threads that did not finish yet */
+  bool stop{false};
+  std::uint64_t files{0};
+  std::uint64_t bytes{0};
+  std::uint64_t directories_read{0};
+};
+
+std::string JoinPath(const std::string& directory, const char* name)
+{
+  if (!directory.empty() && IsPathSeparator(directory.back())) {
+    return directory + name;
+  }
+  return directory + '/' + name;
+}
+
+bool StatEntry(DIR* directory,
+               const char* name,
+               const std::string& path,
+               struct stat* statp)
+{
+#if defined(HAVE_WIN32)
+  (void)directory;
+  (void)name;
+  return lstat(path.c_str(), statp) == 0;
+#else
+  (void)path;
+#  if defined(STATX_BASIC_STATS) && defined(AT_STATX_DONT_SYNC)
+  /* Only ask for what is counted and let network file systems answer from
+   * their attribute cache. */
+  struct statx stx;
+  if (statx(dirfd(directory), name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+            STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_INO | STATX_SIZE
+                | STATX_MTIME | STATX_CTIME,
+            &stx)
+      == 0) {
+    *statp = {};
+    statp->st_mode = stx.stx_mode;
+    statp->st_nlink = stx.stx_nlink;
+    statp->st_ino = stx.stx_ino;
+    statp->st_size = stx.stx_size;
+    statp->st_mtime = stx.stx_mtime.tv_sec;
+    statp->st_ctime = stx.stx_ctime.tv_sec;
+    statp->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+    return true;
+  }
+  if (errno != ENOSYS) { return false; }
+#  endif
+  return fstatat(dirfd(directory), name, statp, AT_SYMLINK_NOFOLLOW) == 0;
+#endif
+}
+
+bool HasIgnoredir(const EstimateIncludeSet& set, const std::string& path)
+{
+  for (auto& ignoredir : set.ignoredir) {
+    struct stat sb;
+    if (stat(JoinPath(path, ignoredir.c_str()).c_str(), &sb) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Counts a file that is not a directory like TallyFile() does.  Samples
+ * only look up the hard links, see SampleTree(). */
+void CountFile(const FastEstimateOptions& options,
+               const EstimateIncludeSet& set,
+               const struct stat& statp,
+               hardlink_set* hardlinks,
+               bool sampling,
+               DirectoryCount& count)
+{
+  time_t since = options.since_time;
+  if (since != 0 && statp.st_mtime < since
+      && (set.mtime_only || statp.st_ctime < since)) {
+    return; /* not changed */
+  }
+
+  count.files++;
+  if (!S_ISREG(statp.st_mode) || statp.st_size <= 0) { return; }
+
+  if (hardlinks && set.track_hardlinks && statp.st_nlink > 1) {
+    auto seen = hardlinks->lock();
+    std::pair link{statp.st_dev, statp.st_ino};
+    if (sampling ? seen->count(link) != 0 : !seen->emplace(link).second) {
+      return; /* the data is saved with the first link */
+    }
+  }
+  count.bytes += statp.st_size;
+}
+
+void ReadDirectory(const FastEstimateOptions& options,
+                   const PendingDirectory& pending,
+                   EstimateFilter* filter,
+                   hardlink_set* hardlinks,
+                   bool sampling,
+                   DirectoryCount& count)
+{
+  DIR* directory = opendir(pending.path.c_str());
+  if (!directory) {
+    Dmsg2(100, "Cannot open directory %s: ERR=%d\n", pending.path.c_str(),
+          errno);
+    return;
+  }
+
+  const EstimateIncludeSet& set = options.sets[pending.set];
+  while (struct dirent* entry = readdir(directory)) {
+    const char* name = entry->d_name;
+    if (name[0] == '.'
+        && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+      continue;
+    }
+
+    std::string path = JoinPath(pending.path, name);
+    struct stat statp;
+    if (!StatEntry(directory, name, path, &statp)) { continue; }
+    if (filter && !filter->Accept(pending.set, path.c_str(), statp)) {
+      continue;
+    }
+
+    if (!S_ISDIR(statp.st_mode)) {
+      CountFile(options, set, statp, hardlinks, sampling, count);
+      continue;
+    }
+
+    if (HasIgnoredir(set, path)) { continue; }
+    count.files++;
+    if (set.recurse && (!set.one_fs || statp.st_dev == pending.device)) {
+      count.subdirs.push_back({std::move(path), statp.st_dev, pending.set});
+    }
+  }
+  closedir(directory);
+}
+
+/* Knuth's estimate of the size of a tree: follow one random path down and
+ * weight what is found on each level by the number of choices made to get
+ * there.  The mean of many of these is the size of the whole tree.
+ *
+ * The data of hard links already counted while reading the directories is
+ * skipped.  Links are not remembered between samples though, as that would
+ * change what the next sample sees, so data linked from several of the
+ * directories that were not read is estimated too high. */
+std::pair<double, double> SampleTree(const FastEstimateOptions& options,
+                                     PendingDirectory pending,
+                                     EstimateFilter* filter,
+                                     hardlink_set& hardlinks,
+                                     std::mt19937_64& random)
+{
+  double files = 0, bytes = 0, weight = 1;
+
+  for (int depth = 0; depth < kMaximumSampleDepth; ++depth) {
+    DirectoryCount count;
+    ReadDirectory(options, pending, filter, &hardlinks, true, count);
+    files += weight * count.files;
+    bytes += weight * count.bytes;
+    if (count.subdirs.empty()) { break; }
+
+    weight *= count.subdirs.size();
+    std::uniform_int_distribution<std::size_t> pick(0,
+                                                    count.subdirs.size() - 1);
+    pending = std::move(count.subdirs[pick(random)]);
+  }
+  return {files, bytes};
+}
+
+struct SampleStatistics {
+  std::size_t count{0};
+  double sum{0};
+  double sum_of_squares{0};
+
+  void Add(double value)
+  {
+    count++;
+    sum += value;
+    sum_of_squares += value * value;
+  }
+
+  double Mean() const { return count ? sum / count : 0; }
+
+  // Half width of the confidence interval of the mean.
+  double Error() const
+  {
+    if (count < 2) { return 0; }
+    double mean = Mean();
+    double variance = (sum_of_squares - count * mean * mean) / (count - 1);
+    if (variance <= 0) { return 0; }
+    return kConfidence95 * std::sqrt(variance / count);
+  }
+};
+}  // namespace
+
+FastEstimateResult FastEstimate(const FastEstimateOptions& options,
+                                thread_pool& threads)
+{
+  auto start = steady_clock::now();
+  std::optional<steady_clock::time_point> walk_deadline, sample_deadline;
+  if (options.time_limit) {
+    walk_deadline = start
+                    + std::chrono::duration_cast<steady_clock::duration>(
+                        *options.time_limit * kWalkShare);
+    sample_deadline = start + *options.time_limit;
+  }
+  auto canceled = [&options] {
+    return options.canceled && options.canceled();
+  };
+
+  FastEstimateResult result;
+  hardlink_set hardlinks;
+  synchronized<WalkState> state;
+  std::condition_variable changed;
+
+  // The top level entries are always part of the estimate.
+  {
+    auto locked = state.lock();
+    for (std::size_t i = 0; i < options.sets.size(); ++i) {
+      const EstimateIncludeSet& set = options.sets[i];
+      for (auto& path : set.paths) {
+        struct stat statp;
+        if (lstat(path.c_str(), &statp) != 0) { continue; }
+
+        if (!S_ISDIR(statp.st_mode)) {
+          DirectoryCount count;
+          CountFile(options, set, statp, &hardlinks, false, count);
+          locked->files += count.files;
+          locked->bytes += count.bytes;
+        } else if (!HasIgnoredir(set, path)) {
+          locked->files++;
+          locked->queue.push_back({path, statp.st_dev, i});
+        }
+      }
+    }
+  }
+
+  std::size_t workers = options.workers ? options.workers : 1;
+  state.lock()->running = workers;
+  threads.borrow_threads(workers, [&] {
+    std::unique_ptr<EstimateFilter> filter
+        = options.make_filter ? options.make_filter() : nullptr;
+    DirectoryCount total;
+    std::uint64_t directories_read = 0;
+
+    for (;;) {
+      PendingDirectory pending;
+      {
+        auto locked = state.lock();
+        locked.wait(changed, [](const WalkState& walk) {
+          return walk.stop || !walk.queue.empty() || walk.busy == 0;
+        });
+        bool out_of_time
+            = walk_deadline && steady_clock::now() > *walk_deadline;
+        if (!locked->stop && (canceled() || out_of_time)) {
+          locked->stop = true;
+          changed.notify_all();
+        }
+        if (locked->stop || locked->queue.empty()) { break; }
+
+        pending = std::move(locked->queue.front());
+        locked->queue.pop_front();
+        locked->busy++;
+      }
+
+      DirectoryCount count;
+      ReadDirectory(options, pending, filter.get(), &hardlinks, false, count);
+      total.files += count.files;
+      total.bytes += count.bytes;
+      directories_read++;
+
+      {
+        auto locked = state.lock();
+        for (auto& subdir : count.subdirs) {
+          locked->queue.push_back(std::move(subdir));
+        }
+        locked->busy--;
+      }
+      changed.notify_all();
+    }
+    // the job may go on as soon as the last thread is counted down
+    filter.reset();
+
+    auto locked = state.lock();
+    locked->files += total.files;
+    locked->bytes += total.bytes;
+    locked->directories_read += directories_read;
+    locked->running--;
+    changed.notify_all();
+  });
+
+  std::vector<PendingDirectory> left;
+  {
+    auto locked = state.lock();
+    locked.wait(changed, [](const WalkState& walk) {
+      return walk.running == 0;
+    });
+    result.files = locked->files;
+    result.bytes = locked->bytes;
+    result.directories_read = locked->directories_read;
+    left.assign(std::make_move_iterator(locked->queue.begin()),
+                std::make_move_iterator(locked->queue.end()));
+  }
+
+  result.directories_left = left.size();
+  result.estimated_files = result.files;
+  result.estimated_bytes = result.bytes;
+  if (left.empty() || canceled()) { return result; }
+
+  /* Estimate what is below the directories that were not read from trees
+   * below randomly picked ones. */
+  std::unique_ptr<EstimateFilter> filter
+      = options.make_filter ? options.make_filter() : nullptr;
+  std::mt19937_64 random{std::random_device{}()};
+  std::uniform_int_distribution<std::size_t> pick(0, left.size() - 1);
+  SampleStatistics files, bytes;
+
+  /* Stops at the deadline, only the first sample is always taken.  A sample
+   * reads just one directory on each level of the tree. */
+  while (files.count < kMaximumSamples && !canceled()
+         && (files.count == 0 || steady_clock::now() < *sample_deadline)) {
+    auto [sample_files, sample_bytes] = SampleTree(
+        options, left[pick(random)], filter.get(), hardlinks, random);
+    files.Add(sample_files);
+    bytes.Add(sample_bytes);
+  }
+
+  double directories = left.size();
+  result.samples = files.count;
+  result.estimated_files += directories * files.Mean();
+  result.estimated_bytes += directories * bytes.Mean();
+  result.files_error = directories * files.Error();
+  result.bytes_error = directories * bytes.Error();
+  return result;
+}
+
+} /* namespace filedaemon */
@@ -0,0 +1,102 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Metadata only estimate that reads directories in parallel
+ */
+
+#ifndef BAREOS_FILED_FAST_ESTIMATE_H_
+#define BAREOS_FILED_FAST_ESTIMATE_H_
+
+#include "include/bareos.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct thread_pool;
+
+namespace filedaemon {
+
+// What is walked for one Include{} of the fileset.
+struct EstimateIncludeSet {
+  std::vector<std::string> paths{};
+  std::vector<std::string> ignoredir{}; /* skip directories with this file */
+  bool one_fs{true};
+  bool recurse{true};
+  bool mtime_only{false};
+  bool track_hardlinks{true}; /* count the data of hard links once */
+};
+
+/* Decides which entries below the top level paths are part of the fileset.
+ * Every worker thread gets its own filter. */
+class EstimateFilter {
+ public:
+  virtual ~EstimateFilter() = default;
+  virtual bool Accept(std::size_t set,
+                      const char* path,
+                      const struct stat& statp)
+      = 0;
+};
+
+struct FastEstimateOptions {
+  std::vector<EstimateIncludeSet> sets{};
+  std::size_t workers{1};
+  time_t since_time{0}; /* only count files changed since, 0 counts all */
+  /* Without a time limit every directory is read.  Otherwise the directories
+   * that are left when the time is used up are estimated from random
+   * samples. */
+  std::optional<std::chrono::steady_clock::duration> time_limit{};
+  std::function<std::unique_ptr<EstimateFilter>()> make_filter{};
+  std::function<bool()> canceled{};
+};
+
+struct FastEstimateResult {
+  // Counted in the directories that were read
+  std::uint64_t files{0};
+  std::uint64_t bytes{0};
+  std::uint64_t directories_read{0};
+  // Not read when the time ran out, their content is extrapolated
+  std::uint64_t directories_left{0};
+  std::size_t samples{0};
+  double estimated_files{0};
+  double estimated_bytes{0};
+  // Half width of the 95% confidence interval of the estimates
+  double files_error{0};
+  double bytes_error{0};
+
+  bool Sampled() const { return directories_left > 0; }
+};
+
+/* Counts the files and bytes of the sets like an estimate, but only from
+ * the metadata found in the directories: no plugins, no accurate checks and
+ * no ACLs or extended attributes.  Reads the directories on
+ * options.workers threads borrowed from threads. */
+FastEstimateResult FastEstimate(const FastEstimateOptions& options,
+                                thread_pool& threads);
+
+} /* namespace filedaemon */
+
+#endif  // BAREOS_FILED_FAST_ESTIMATE_H_
@@ -41,6 +41,7 @@
 #include "filed/socket_server.h"
 #include "lib/cli.h"
 #include "lib/mntent_cache.h"
+#include "lib/metrics_server.h"
 #include "lib/daemon.h"
 #include "lib/bnet_network_dump.h"
 #include "lib/bsignal.h"
@@ -245,6 +246,8 @@ int main(int argc, char* argv[])
   // if configured, start threads and connect to Director.
   StartConnectToDirectorThreads();
 
+  if (me->metrics_enable) { StartMetricsServer(me->metrics_addrs); }
+
   // start socket server to listen for new connections.
   StartSocketServer(me->FDaddrs);
 
@@ -267,6 +270,7 @@ void TerminateFiled(int sig)
   StopWatchdog();
 
   StopConnectToDirectorThreads(true);
+  StopMetricsServer();
   StopSocketServer();
 
   UnloadFdPlugins();
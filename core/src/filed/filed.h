@@ -50,7 +50,7 @@ void TerminateFiled(int sig);
 
 
 // File Daemon protocol version
-const int FD_PROTOCOL_VERSION = 54;
+const int FD_PROTOCOL_VERSION = 55;
 
 } /* namespace filedaemon */
 #endif  // BAREOS_FILED_FILED_H_
@@ -85,12 +85,16 @@ static const ResourceItem cli_items[] = {
   { "Address", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_client, FDaddrs), {config::DefaultValue{FD_DEFAULT_PORT}, config::Alias{"FdAddress"}}},
   { "Addresses", CFG_TYPE_ADDRESSES, ITEM(res_client, FDaddrs), {config::DefaultValue{FD_DEFAULT_PORT}, config::Alias{"FdAddresses"}}},
   { "SourceAddress", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_client, FDsrc_addr), {config::DefaultValue{"0"}, config::Alias{"FdSourceAddress"}}},
+  { "MetricsEnable", CFG_TYPE_BOOL, ITEM(res_client, metrics_enable), {config::DefaultValue{"false"}, config::IntroducedIn{26, 0, 0}, config::Description{"Serve metrics in the OpenMetrics text format via HTTP on the metrics addresses."}}},
+  { "MetricsAddress", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_client, metrics_addrs), {config::DefaultValue{"9122"}, config::IntroducedIn{26, 0, 0}}},
+  { "MetricsAddresses", CFG_TYPE_ADDRESSES, ITEM(res_client, metrics_addrs), {config::DefaultValue{"9122"}, config::IntroducedIn{26, 0, 0}}},
+  { "MetricsPort", CFG_TYPE_ADDRESSES_PORT, ITEM(res_client, metrics_addrs), {config::DefaultValue{"9122"}, config::IntroducedIn{26, 0, 0}}},
   { "WorkingDirectory", CFG_TYPE_DIR, ITEM(res_client, working_directory), {config::DefaultValue{PATH_BAREOS_WORKINGDIR}, config::PlatformSpecific{}}},
   { "PluginDirectory", CFG_TYPE_DIR, ITEM(res_client, plugin_directory), {}},
   { "PluginNames", CFG_TYPE_PLUGIN_NAMES, ITEM(res_client, plugin_names), {}},
   { "ScriptsDirectory", CFG_TYPE_DIR, ITEM(res_client, scripts_directory), {config::DefaultValue{PATH_BAREOS_SCRIPTDIR}, config::Description{"Path to directory containing script files"}, config::PlatformSpecific{}}},
   { "MaximumConcurrentJobs", CFG_TYPE_PINT32, ITEM(res_client, MaxConcurrentJobs), {config::DeprecatedSince{24, 0, 0}, config::DefaultValue{"1000"}}},
-  { "MaximumWorkersPerJob", CFG_TYPE_PINT32, ITEM(res_client, MaxWorkersPerJob), {config::IntroducedIn{23, 0, 0}, config::DefaultValue{"2"}, config::Description{"The maximum number of worker threads that bareos will use during backup."}}},
+  { "MaximumWorkersPerJob", CFG_TYPE_PINT32, ITEM(res_client, MaxWorkersPerJob), {config::IntroducedIn{23, 0, 0}, config::DefaultValue{"2"}, config::Description{"The maximum number of worker threads that bareos will use during backup, verify jobs and fast estimates."}}},
   { "Messages", CFG_TYPE_RES, ITEM(res_client, messages), {config::Code{R_MSGS}}},
   { "SdConnectTimeout", CFG_TYPE_TIME, ITEM(res_client, SDConnectTimeout), {config::DefaultValue{"1800"}}},
   { "HeartbeatInterval", CFG_TYPE_TIME, ITEM(res_client, heartbeat_interval), {config::DefaultValue{"0"}}},
@@ -116,6 +120,12 @@ static const ResourceItem cli_items[] = {
     config::Description{"The grpc module to use for grpc fallback."},
     config::DefaultValue{"bareos-grpc-fd-plugin-bridge"}}},
   { "EnableKtls", CFG_TYPE_BOOL, ITEM(res_client, enable_ktls), {config::DefaultValue{"false"}, config::Description{"If set to \"yes\", Bareos will allow the SSL implementation to use Kernel TLS."}, config::IntroducedIn{23, 0, 0}}},
+  { "ClientSideDeduplication", CFG_TYPE_BOOL, ITEM(res_client, client_side_dedup), {config::DefaultValue{"false"}, config::Description{"If set to \"yes\", file data is sent as chunk fingerprints first, so that chunks already known to a deduplicating Storage Daemon are not transferred again."}, config::IntroducedIn{26, 0, 0}}},
+  { "EnableZeroCopy", CFG_TYPE_BOOL, ITEM(res_client, enable_zerocopy), {config::DefaultValue{"false"}, config::Description{"If set to \"yes\", large data messages are sent to the Storage Daemon with MSG_ZEROCOPY on Linux, so the kernel does not need to copy them.  This only pays off on fast networks and falls back to normal sends where it is not supported."}, config::IntroducedIn{26, 0, 0}}},
+  { "DataConnections", CFG_TYPE_PINT32, ITEM(res_client, data_connections), {config::DefaultValue{"1"}, config::Description{"Number of network connections the backup data is striped over when sending it to the Storage Daemon.  More than one connection helps on links with a high bandwidth delay product, where a single TCP connection cannot fill the link.  Not used together with client side deduplication."}, config::IntroducedIn{26, 0, 0}}},
+  { "RestoreMetadataWorkers", CFG_TYPE_PINT32, ITEM(res_client, restore_metadata_workers), {config::DefaultValue{"0"}, config::Description{"Number of threads that set owner, mode and times of restored files.  If set, these are applied in batches relative to cached directory descriptors and the owner, mode and times of directories are set in one pass at the end of the restore (or once too many directories are pending), instead of one file after another on the restore thread.  0 restores the attributes serially."}, config::IntroducedIn{26, 0, 0}}},
+  { "KeepAccurateState", CFG_TYPE_BOOL, ITEM(res_client, keep_accurate_state), {config::DefaultValue{"false"}, config::Description{"Keep the file list of the last accurate backup of every job in the working directory.  If the director would send the file list of exactly the jobs this list was made from, it does not send it."}, config::IntroducedIn{26, 0, 0}}},
+  { "PipelineTraceDirectory", CFG_TYPE_STDSTRDIR, ITEM(res_client, pipeline_trace_directory), {config::Description{"If set, every backup job writes the timing of its reads, digest, compression, encryption and network sends as Chrome trace event file <Job>-fd.trace.json into this directory."}, config::IntroducedIn{26, 0, 0}}},
   TLS_COMMON_CONFIG(res_client),
   TLS_CERT_CONFIG(res_client),
   {}
@@ -354,6 +364,7 @@ static void FreeResource(BareosResource* res, int type)
       if (p->plugin_directory) { free(p->plugin_directory); }
       if (p->plugin_names) { delete p->plugin_names; }
       if (p->FDaddrs) { FreeAddresses(p->FDaddrs); }
+      if (p->metrics_addrs) { FreeAddresses(p->metrics_addrs); }
       if (p->FDsrc_addr) { FreeAddresses(p->FDsrc_addr); }
       if (p->pki_keypair_file) { free(p->pki_keypair_file); }
       if (p->pki_keypair) { CryptoKeypairFree(p->pki_keypair); }
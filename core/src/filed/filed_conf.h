@@ -80,6 +80,7 @@ class ClientResource
 
   dlist<IPADDR>* FDaddrs = nullptr;
   dlist<IPADDR>* FDsrc_addr = nullptr; /* Address to source connections from */
+  dlist<IPADDR>* metrics_addrs = nullptr; /* OpenMetrics listen addresses */
   char* working_directory = nullptr;
   char* plugin_directory = nullptr; /* Plugin directory */
   alist<const char*>* plugin_names = nullptr;
@@ -93,6 +94,7 @@ class ClientResource
   uint32_t jcr_watchdog_time = 0;       /* Absolute time after which a Job gets
                                        terminated       regardless of its progress */
   bool allow_bw_bursting = false; /* Allow bursting with bandwidth limiting */
+  bool metrics_enable = false;    /* OpenMetrics listener enabled */
   bool pki_sign
       = false; /* Enable Data Integrity Verification via Digital Signatures */
   bool pki_encrypt = false;         /* Enable Data Encryption */
@@ -121,6 +123,12 @@ class ClientResource
 
   std::string grpc_module{};
   bool enable_ktls{false};
+  bool client_side_dedup{false}; /* Offer chunk manifests to the SD */
+  bool enable_zerocopy{false};   /* Send data with MSG_ZEROCOPY */
+  uint32_t data_connections{1};  /* Connections to stripe backup data over */
+  std::string pipeline_trace_directory{}; /* Where to write stage traces */
+  uint32_t restore_metadata_workers{0}; /* Threads setting file attributes */
+  bool keep_accurate_state{false}; /* Keep the file list of the last backup */
 };
 
 
@@ -40,8 +40,11 @@ class VSSClient;
 #endif
 
 namespace filedaemon {
+class AccurateStateWriter;
 class BareosAccurateFilelist;
+class ClientDedup;
 class DirectorResource;
+class VerifyPipeline;
 struct save_pkt;
 }  // namespace filedaemon
 
@@ -87,8 +90,15 @@ struct FiledJcrImpl {
   bool got_metadata{};            /**< Set when found job_metadata */
   bool multi_restore{};           /**< Dir can do multiple storage restore */
   filedaemon::BareosAccurateFilelist* file_list{}; /**< Previous file list (accurate mode) */
+  std::unique_ptr<filedaemon::AccurateStateWriter> accurate_state{}; /**< Set if the file list of this job is kept */
+  uint32_t previous_jobid{};      /**< Last backup of the accurate file list, if the director told us */
+  filedaemon::VerifyPipeline* verify_pipeline{}; /**< Set while a verify job sends its files */
   uint64_t base_size{};           /**< Compute space saved with base job */
   filedaemon::save_pkt* plugin_sp{}; /**< Plugin save packet */
+  std::unique_ptr<filedaemon::ClientDedup> client_dedup{}; /**< Set if the SD accepted chunk manifests */
+  std::string stored_addr{};      /**< Address of the storage daemon */
+  int stored_port{};              /**< Port of the storage daemon */
+  std::vector<BareosSocket*> data_connections{}; /**< Connections the backup data is striped over */
 #ifdef HAVE_WIN32
   VSSClient* pVSSClient{};        /**< VSS Client Instance */
 #endif
@@ -520,6 +520,9 @@ static int SetOptionsAndFlags(findFOPTS* fo, const char* opts)
       case 's':
         SetBit(FO_SPARSE, fo->flags);
         break;
+      case 'B':
+        SetBit(FO_BLOCK_DELTA, fo->flags);
+        break;
       case 'V': /* verify options */
         // Copy Verify Options
         for (j = 0; *p && *p != ':'; p++) {
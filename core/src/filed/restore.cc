@@ -36,6 +36,7 @@
 #include "filed/filed.h"
 #include "filed/filed_globals.h"
 #include "filed/filed_jcr_impl.h"
+#include "filed/block_delta.h"
 #include "filed/compression.h"
 #include "filed/crypto.h"
 #include "filed/restore.h"
@@ -92,6 +93,7 @@ const bool have_xattr = false;
 
 // Forward referenced functions
 static void FreeSignature(r_ctx& rctx);
+static void SetRestoredAttributes(r_ctx& rctx);
 static bool ClosePreviousStream(JobControlRecord* jcr, r_ctx& rctx);
 
 int32_t ExtractData(JobControlRecord* jcr,
@@ -413,6 +415,17 @@ void DoRestore(JobControlRecord* jcr)
 
   if (!AdjustDecompressionBuffers(jcr)) { goto bail_out; }
 
+  if (client && client->restore_metadata_workers > 0) {
+    if (RestoreMetadataQueue::Supported()) {
+      rctx.metadata = std::make_unique<RestoreMetadataQueue>(
+          jcr, jcr->fd_impl->threads, client->restore_metadata_workers);
+    } else {
+      Jmsg(jcr, M_INFO, 0,
+           T_("Restore Metadata Workers not supported on this platform, "
+              "restoring file attributes serially.\n"));
+    }
+  }
+
   rctx.cipher_ctx.buf = GetMemory(CRYPTO_CIPHER_MAX_BLOCK_SIZE);
   if (have_darwin_os) {
     rctx.fork_cipher_ctx.buf = GetMemory(CRYPTO_CIPHER_MAX_BLOCK_SIZE);
@@ -569,6 +582,14 @@ void DoRestore(JobControlRecord* jcr)
         if (jcr->IsPlugin()) {
           status
               = PluginCreateFile(jcr, attr, &rctx.bfd, jcr->fd_impl->replace);
+        } else if (attr->type == FT_REG && attr->delta_seq > 0) {
+          /* Changed blocks go into the file restored from the previous
+           * parts, unless that one was not replaced. */
+          if (rctx.block_delta_skipped.contains(attr->ofname)) {
+            status = CF_SKIP;
+          } else {
+            status = OpenBlockDeltaFile(jcr, attr, &rctx.bfd);
+          }
         }
 
         if (status == CF_CORE) {
@@ -587,6 +608,11 @@ void DoRestore(JobControlRecord* jcr)
           case CF_ERROR:
             break;
           case CF_SKIP:
+            if (!jcr->IsPlugin() && attr->type == FT_REG
+                && attr->delta_seq == 0
+                && attr->statp.st_size >= kBlockDeltaMinimumSize) {
+              rctx.block_delta_skipped.emplace(attr->ofname);
+            }
             jcr->JobFiles++;
             break;
           case CF_EXTRACT:
@@ -615,7 +641,7 @@ void DoRestore(JobControlRecord* jcr)
               if (jcr->IsPlugin()) {
                 PluginSetAttributes(jcr, attr, &rctx.bfd);
               } else {
-                SetAttributes(jcr, attr, &rctx.bfd);
+                SetRestoredAttributes(rctx);
               }
             }
             break;
@@ -1032,6 +1058,17 @@ ok_out:
   if (jcr->cp_thread) { win32_cleanup_copy_thread(jcr); }
 #endif
 
+  // Wait for the outstanding attributes and set the directory times.
+  if (rctx.metadata) {
+    if (std::uint64_t errors = rctx.metadata->Finish(); errors > 0) {
+      Jmsg(jcr, M_WARNING, 0,
+           T_("Encountered %" PRIu64
+              " errors while restoring file attributes\n"),
+           errors);
+    }
+    rctx.metadata.reset();
+  }
+
   // First output the statistics.
   Dmsg2(10, "End Do Restore. Files=%" PRIu32 " Bytes=%s\n", jcr->JobFiles,
         edit_uint64(jcr->JobBytes, ec1));
@@ -1290,7 +1327,11 @@ static bool ClosePreviousStream(JobControlRecord* jcr, r_ctx& rctx)
     if (jcr->IsPlugin()) {
       PluginSetAttributes(rctx.jcr, rctx.attr, &rctx.bfd);
     } else {
-      SetAttributes(rctx.jcr, rctx.attr, &rctx.bfd);
+      if (rctx.attr->type == FT_REG && rctx.attr->delta_seq > 0
+          && IsBopen(&rctx.bfd)) {
+        FinishBlockDeltaFile(jcr, rctx.attr, &rctx.bfd);
+      }
+      SetRestoredAttributes(rctx);
     }
     rctx.extract = false;
 
@@ -1315,6 +1356,24 @@ static bool ClosePreviousStream(JobControlRecord* jcr, r_ctx& rctx)
   return true;
 }
 
+/**
+ * Hand the attributes of the current file to the metadata workers if they
+ * are used. Files with delayed acl or xattr streams are done right away, as
+ * those streams have to be restored after the file mode.  So are files that
+ * may be followed by block deltas, which set the attributes once more.
+ */
+static void SetRestoredAttributes(r_ctx& rctx)
+{
+  bool delayed = rctx.delayed_streams && !rctx.delayed_streams->empty();
+  bool block_delta = rctx.attr->type == FT_REG
+                     && rctx.attr->statp.st_size >= kBlockDeltaMinimumSize;
+  if (rctx.metadata && !delayed && !block_delta
+      && rctx.metadata->Submit(rctx.attr, &rctx.bfd)) {
+    return;
+  }
+  SetAttributes(rctx.jcr, rctx.attr, &rctx.bfd);
+}
+
 static void FreeSignature(r_ctx& rctx)
 {
   if (rctx.sig) {
@@ -23,7 +23,12 @@
 #ifndef BAREOS_FILED_RESTORE_H_
 #define BAREOS_FILED_RESTORE_H_
 
+#include <memory>
+#include <string>
+#include <unordered_set>
+
 #include "findlib/bfile.h"
+#include "findlib/restore_metadata.h"
 #include "lib/attr.h"
 template <typename T> class alist;
 
@@ -68,6 +73,8 @@ struct r_ctx {
   RestoreCipherContext cipher_ctx{}; /* Cryptographic restore context (if any) for file */
   RestoreCipherContext fork_cipher_ctx{}; /* Cryptographic restore context (if any)
                                               for alternative stream */
+  std::unique_ptr<RestoreMetadataQueue> metadata{}; /* Attributes applied by workers (if any) */
+  std::unordered_set<std::string> block_delta_skipped{}; /* Skipped block delta bases */
 };
 /* clang-format on */
 
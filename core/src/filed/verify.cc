@@ -30,7 +30,9 @@
 #include "include/filetypes.h"
 #include "include/streams.h"
 #include "filed/filed.h"
+#include "filed/filed_globals.h"
 #include "filed/filed_jcr_impl.h"
+#include "filed/verify.h"
 #include "findlib/find.h"
 #include "findlib/attribs.h"
 #include "lib/attribs.h"
@@ -49,9 +51,6 @@ const bool have_darwin_os = false;
 #endif
 
 static int VerifyFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool);
-static int ReadDigest(BareosFilePacket* bfd,
-                      DIGEST* digest,
-                      JobControlRecord* jcr);
 static bool calculate_file_chksum(JobControlRecord* jcr,
                                   FindFilesPacket* ff_pkt,
                                   DIGEST** digest,
@@ -59,6 +58,54 @@ static bool calculate_file_chksum(JobControlRecord* jcr,
                                   char** digest_buf,
                                   const char** digest_name);
 
+/* What is needed to digest a file.  It is a copy, as the find packet is
+ * reused for the next files while a worker still reads this one. */
+struct DigestSource {
+  std::string fname;
+  struct stat statp {};
+  int type{};
+  bool sparse{};
+  bool noatime{};
+  bool hfsplus{};
+  HfsPlusInfo hfsinfo{};
+};
+
+static DigestSource MakeDigestSource(FindFilesPacket* ff_pkt)
+{
+  DigestSource source;
+  source.fname = ff_pkt->fname;
+  source.statp = ff_pkt->statp;
+  source.type = ff_pkt->type;
+  source.sparse = BitIsSet(FO_SPARSE, ff_pkt->flags);
+  source.noatime = BitIsSet(FO_NOATIME, ff_pkt->flags);
+  source.hfsplus = BitIsSet(FO_HFSPLUS, ff_pkt->flags);
+  source.hfsinfo = ff_pkt->hfsinfo;
+  return source;
+}
+
+static void ReportDigestOutcome(JobControlRecord* jcr,
+                                const DigestOutcome& outcome)
+{
+  for (auto& error : outcome.errors) {
+    Jmsg(jcr, M_ERROR, 1, "%s", error.c_str());
+  }
+  if (outcome.read_error) { jcr->JobErrors++; }
+
+  // Can be used by BaseJobs or with accurate, update only for Verify jobs
+  if (jcr->is_JobType(JT_VERIFY)) { jcr->JobBytes += outcome.bytes; }
+  jcr->ReadBytes += outcome.bytes;
+}
+
+static int ReadDigest(BareosFilePacket* bfd,
+                      DIGEST* digest,
+                      const DigestSource& source,
+                      DigestOutcome& outcome,
+                      PipelineStats& stats);
+static void DigestSourceFile(const DigestSource& source,
+                             DIGEST* digest,
+                             DigestOutcome& outcome,
+                             PipelineStats& stats);
+
 /**
  * Find all the requested files and send attributes
  * to the Director.
@@ -75,8 +122,14 @@ void DoVerify(JobControlRecord* jcr)
   SetFindOptions((FindFilesPacket*)jcr->fd_impl->ff, jcr->fd_impl->incremental,
                  jcr->fd_impl->since_time);
   Dmsg0(10, "Start find files\n");
-  /* Subroutine VerifyFile() is called for each file */
-  FindFiles(jcr, (FindFilesPacket*)jcr->fd_impl->ff, VerifyFile, NULL);
+  {
+    VerifyPipeline pipeline(jcr, jcr->fd_impl->threads, me->MaxWorkersPerJob);
+    jcr->fd_impl->verify_pipeline = &pipeline;
+    /* Subroutine VerifyFile() is called for each file */
+    FindFiles(jcr, (FindFilesPacket*)jcr->fd_impl->ff, VerifyFile, NULL);
+    pipeline.Finish();
+    jcr->fd_impl->verify_pipeline = nullptr;
+  }
   Dmsg0(10, "End find files\n");
 
   if (jcr->fd_impl->big_buf) {
@@ -93,13 +146,11 @@ void DoVerify(JobControlRecord* jcr)
  */
 static int VerifyFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
 {
-  PoolMem attribs(PM_NAME), attribsEx(PM_NAME);
-  int status;
-  BareosSocket* dir;
+  PoolMem attribs(PM_NAME), attribsEx(PM_NAME), msg(PM_MESSAGE);
+  int length;
 
   if (jcr->IsJobCanceled()) { return 0; }
 
-  dir = jcr->dir_bsock;
   jcr->fd_impl->num_files_examined++; /* bump total file count */
 
   switch (ff_pkt->type) {
@@ -228,67 +279,243 @@ static int VerifyFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
   Dmsg2(400, "send Attributes inx=%" PRIu32 " fname=%s\n", jcr->JobFiles,
         ff_pkt->fname);
   if (ff_pkt->type == FT_LNK || ff_pkt->type == FT_LNKSAVED) {
-    status
-        = dir->fsend("%" PRIu32 " %d %s %s%c%s%c%s%c", jcr->JobFiles,
-                     STREAM_UNIX_ATTRIBUTES, ff_pkt->VerifyOpts, ff_pkt->fname,
-                     0, attribs.c_str(), 0, ff_pkt->link_or_dir, 0);
+    length = Mmsg(msg, "%" PRIu32 " %d %s %s%c%s%c%s%c", jcr->JobFiles,
+                  STREAM_UNIX_ATTRIBUTES, ff_pkt->VerifyOpts, ff_pkt->fname, 0,
+                  attribs.c_str(), 0, ff_pkt->link_or_dir, 0);
   } else if (ff_pkt->type == FT_DIREND || ff_pkt->type == FT_REPARSE
              || ff_pkt->type == FT_JUNCTION) {
     // Here link is the canonical filename (i.e. with trailing slash)
-    status = dir->fsend("%" PRIu32 " %d %s %s%c%s%c%c", jcr->JobFiles,
-                        STREAM_UNIX_ATTRIBUTES, ff_pkt->VerifyOpts,
-                        ff_pkt->link_or_dir, 0, attribs.c_str(), 0, 0);
+    length = Mmsg(msg, "%" PRIu32 " %d %s %s%c%s%c%c", jcr->JobFiles,
+                  STREAM_UNIX_ATTRIBUTES, ff_pkt->VerifyOpts,
+                  ff_pkt->link_or_dir, 0, attribs.c_str(), 0, 0);
   } else {
-    status = dir->fsend("%" PRIu32 " %d %s %s%c%s%c%c", jcr->JobFiles,
-                        STREAM_UNIX_ATTRIBUTES, ff_pkt->VerifyOpts,
-                        ff_pkt->fname, 0, attribs.c_str(), 0, 0);
+    length = Mmsg(msg, "%" PRIu32 " %d %s %s%c%s%c%c", jcr->JobFiles,
+                  STREAM_UNIX_ATTRIBUTES, ff_pkt->VerifyOpts, ff_pkt->fname,
+                  0, attribs.c_str(), 0, 0);
   }
-  Dmsg2(20, "filed>dir: attribs len=%d: msg=%s\n", dir->message_length,
-        dir->msg);
 
   if (!IS_FT_OBJECT(ff_pkt->type) && ff_pkt->type != FT_DELETED) {
     UnstripPath(ff_pkt);
   }
 
-  if (!status) {
-    Jmsg(jcr, M_FATAL, 0, T_("Network error in send to Director: ERR=%s\n"),
-         BnetStrerror(dir));
+  bool with_digest
+      = ff_pkt->type != FT_LNKSAVED && S_ISREG(ff_pkt->statp.st_mode)
+        && (BitIsSet(FO_MD5, ff_pkt->flags) || BitIsSet(FO_SHA1, ff_pkt->flags)
+            || BitIsSet(FO_SHA256, ff_pkt->flags)
+            || BitIsSet(FO_SHA512, ff_pkt->flags)
+            || BitIsSet(FO_XXH128, ff_pkt->flags));
+
+  auto* pipeline = jcr->fd_impl->verify_pipeline;
+  ASSERT(pipeline);
+  if (!pipeline->Add(ff_pkt, jcr->JobFiles, std::string(msg.c_str(), length),
+                     with_digest)) {
     return 0;
   }
 
-  if (ff_pkt->type != FT_LNKSAVED && S_ISREG(ff_pkt->statp.st_mode)
-      && (BitIsSet(FO_MD5, ff_pkt->flags) || BitIsSet(FO_SHA1, ff_pkt->flags)
-          || BitIsSet(FO_SHA256, ff_pkt->flags)
-          || BitIsSet(FO_SHA512, ff_pkt->flags)
-          || BitIsSet(FO_XXH128, ff_pkt->flags))) {
-    int digest_stream = STREAM_NONE;
-    DIGEST* digest = NULL;
-    char* digest_buf = NULL;
-    const char* digest_name = NULL;
-
-    if (calculate_file_chksum(jcr, ff_pkt, &digest, &digest_stream, &digest_buf,
-                              &digest_name)) {
-      // Did digest initialization fail?
-      if (digest_stream != STREAM_NONE && digest == NULL) {
-        Jmsg(jcr, M_WARNING, 0, T_("%s digest initialization failed\n"),
-             stream_to_ascii(digest_stream));
-      } else if (digest && digest_buf) {
-        Dmsg3(400, "send inx=%" PRIu32 " %s=%s\n", jcr->JobFiles, digest_name,
-              digest_buf);
-        dir->fsend("%" PRIu32 " %d %s *%s-%" PRIu32 "*", jcr->JobFiles,
-                   digest_stream, digest_buf, digest_name, jcr->JobFiles);
-        Dmsg3(20, "filed>dir: %s len=%d: msg=%s\n", digest_name,
-              dir->message_length, dir->msg);
-      }
+  return 1;
+}
+
+// The digest to use for the file, the first one set in the options.
+static crypto_digest_t SelectDigest(FindFilesPacket* ff_pkt, int* stream)
+{
+  if (BitIsSet(FO_MD5, ff_pkt->flags)) {
+    *stream = STREAM_MD5_DIGEST;
+    return CRYPTO_DIGEST_MD5;
+  } else if (BitIsSet(FO_SHA1, ff_pkt->flags)) {
+    *stream = STREAM_SHA1_DIGEST;
+    return CRYPTO_DIGEST_SHA1;
+  } else if (BitIsSet(FO_SHA256, ff_pkt->flags)) {
+    *stream = STREAM_SHA256_DIGEST;
+    return CRYPTO_DIGEST_SHA256;
+  } else if (BitIsSet(FO_SHA512, ff_pkt->flags)) {
+    *stream = STREAM_SHA512_DIGEST;
+    return CRYPTO_DIGEST_SHA512;
+  } else if (BitIsSet(FO_XXH128, ff_pkt->flags)) {
+    *stream = STREAM_XXH128_DIGEST;
+    return CRYPTO_DIGEST_XXH128;
+  }
+  *stream = STREAM_NONE;
+  return CRYPTO_DIGEST_NONE;
+}
+
+// Digests the whole file and finalizes the digest into outcome.
+static DigestOutcome ComputeDigest(const DigestSource& source,
+                                   DIGEST* digest,
+                                   PipelineStats& stats)
+{
+  DigestOutcome outcome;
+  DigestSourceFile(source, digest, outcome, stats);
+
+  uint32_t size;
+  char md[CRYPTO_DIGEST_MAX_SIZE];
+  size = sizeof(md);
+  if (outcome.opened && CryptoDigestFinalize(digest, (uint8_t*)md, &size)) {
+    outcome.digest.resize(BASE64_SIZE(size));
+    BinToBase64(outcome.digest.data(), outcome.digest.size(), md, size, true);
+    outcome.digest.resize(strlen(outcome.digest.c_str()));
+    outcome.name = crypto_digest_name(digest);
+  }
+  return outcome;
+}
+
+VerifyPipeline::VerifyPipeline(JobControlRecord* jcr,
+                               thread_pool& pool,
+                               std::size_t workers,
+                               Sender send)
+    : jcr_{jcr}
+    , workers_{workers}
+    , max_pending_{4 * workers}
+    , send_{std::move(send)}
+{
+  if (workers_ == 0) { return; }
+
+  group_.emplace(2 * workers_);
+  *latch_.lock() = workers_;
+  pool.borrow_threads(workers_, [this] {
+    group_->work_until_completion();
+
+    auto lock = latch_.lock();
+    *lock -= 1;
+    finished_.notify_one();
+  });
+}
+
+bool VerifyPipeline::Add(FindFilesPacket* ff_pkt,
+                         uint32_t file_index,
+                         std::string attributes,
+                         bool with_digest)
+{
+  if (!with_digest) {
+    return Add(PendingFile{file_index, std::move(attributes), STREAM_NONE});
+  }
+
+  int stream;
+  crypto_digest_t type = SelectDigest(ff_pkt, &stream);
+  DIGEST* digest = crypto_digest_new(jcr_, type);
+  if (!digest) {
+    // Did digest initialization fail?
+    Jmsg(jcr_, M_WARNING, 0, T_("%s digest initialization failed\n"),
+         stream_to_ascii(stream));
+    return Add(PendingFile{file_index, std::move(attributes), STREAM_NONE});
+  }
+
+  /* The digest is owned by the work, which has to free it even if it never
+   * runs because the job was cancelled. */
+  std::shared_ptr<DIGEST> owned(digest, CryptoDigestFree);
+  return Add(file_index, std::move(attributes), stream,
+             [this, source = MakeDigestSource(ff_pkt), owned]() {
+               return ComputeDigest(source, owned.get(),
+                                    jcr_->pipeline_stats);
+             });
+}
+
+bool VerifyPipeline::Add(uint32_t file_index,
+                         std::string attributes,
+                         int digest_stream,
+                         DigestWork work)
+{
+  PendingFile file{file_index, std::move(attributes), digest_stream};
+
+  if (!work) {
+    file.digest_stream = STREAM_NONE;
+  } else if (group_) {
+    file.digest = group_->submit([this, work = std::move(work)]() {
+      if (jcr_->IsJobCanceled()) { return DigestOutcome{.cancelled = true}; }
+      return work();
+    });
+  } else {
+    std::promise<DigestOutcome> done;
+    done.set_value(work());
+    file.digest = done.get_future();
+  }
+  return Add(std::move(file));
+}
+
+bool VerifyPipeline::Add(PendingFile file)
+{
+  pending_.push_back(std::move(file));
+
+  // Send the files that are done, wait for the oldest if too far ahead
+  while (!pending_.empty()) {
+    auto& front = pending_.front();
+    bool ready = !front.digest.valid()
+                 || front.digest.wait_for(std::chrono::seconds(0))
+                        == std::future_status::ready;
+    if (!ready && pending_.size() <= max_pending_) { break; }
+    if (!Send(front)) { return false; }
+    pending_.pop_front();
+  }
+  return true;
+}
+
+bool VerifyPipeline::Finish()
+{
+  bool ok = !send_error_;
+  while (!pending_.empty()) {
+    if (ok && !jcr_->IsJobCanceled()) { ok = Send(pending_.front()); }
+    pending_.pop_front();
+  }
+
+  if (group_) {
+    group_->shutdown();
+    latch_.lock().wait(finished_, [](std::size_t left) { return left == 0; });
+    group_.reset();
+  }
+  return ok;
+}
+
+bool VerifyPipeline::Send(const char* msg, std::size_t length)
+{
+  if (send_) {
+    if (!send_(msg, length)) {
+      send_error_ = true;
+      return false;
     }
+    return true;
+  }
 
-    // Cleanup.
-    if (digest_buf) { free(digest_buf); }
+  BareosSocket* dir = jcr_->dir_bsock;
 
-    if (digest) { CryptoDigestFree(digest); }
+  dir->msg = CheckPoolMemorySize(dir->msg, length + 1);
+  memcpy(dir->msg, msg, length);
+  dir->msg[length] = 0;
+  dir->message_length = length;
+  Dmsg2(20, "filed>dir: len=%d: msg=%s\n", dir->message_length, dir->msg);
+  if (!dir->send()) {
+    Jmsg(jcr_, M_FATAL, 0, T_("Network error in send to Director: ERR=%s\n"),
+         BnetStrerror(dir));
+    send_error_ = true;
+    return false;
   }
+  return true;
+}
 
-  return 1;
+bool VerifyPipeline::Send(PendingFile& file)
+{
+  std::optional<DigestOutcome> outcome;
+  if (file.digest.valid()) {
+    outcome = file.digest.get();
+    // the job is gone, the director does not wait for this file anymore
+    if (outcome->cancelled) { return true; }
+  }
+
+  if (!Send(file.attributes.data(), file.attributes.size())) { return false; }
+  if (!outcome) { return true; }
+
+  ReportDigestOutcome(jcr_, *outcome);
+  if (!outcome->opened) {
+    jcr_->JobErrors++;
+    return true;
+  }
+  if (outcome->digest.empty()) { return true; }
+
+  PoolMem msg(PM_MESSAGE);
+  Dmsg3(400, "send inx=%" PRIu32 " %s=%s\n", file.file_index, outcome->name,
+        outcome->digest.c_str());
+  int length = Mmsg(msg, "%" PRIu32 " %d %s *%s-%" PRIu32 "*", file.file_index,
+                    file.digest_stream, outcome->digest.c_str(), outcome->name,
+                    file.file_index);
+  return Send(msg.c_str(), length);
 }
 
 /**
@@ -296,48 +523,69 @@ static int VerifyFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, bool)
  * In case of errors we need the job control record and file name.
  */
 int DigestFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, DIGEST* digest)
+{
+  DigestOutcome outcome;
+
+  DigestSourceFile(MakeDigestSource(ff_pkt), digest, outcome,
+                   jcr->pipeline_stats);
+  ReportDigestOutcome(jcr, outcome);
+  if (!outcome.opened) {
+    ff_pkt->ff_errno = outcome.open_errno;
+    return 1;
+  }
+  return 0;
+}
+
+static void DigestSourceFile(const DigestSource& source,
+                             DIGEST* digest,
+                             DigestOutcome& outcome,
+                             PipelineStats& stats)
 {
   BareosFilePacket bfd;
 
   binit(&bfd);
 
-  int noatime = BitIsSet(FO_NOATIME, ff_pkt->flags) ? O_NOATIME : 0;
+  int noatime = source.noatime ? O_NOATIME : 0;
 
-  if ((bopen(&bfd, ff_pkt->fname, O_RDONLY | O_BINARY | noatime, 0,
-             ff_pkt->statp.st_rdev))
+  if ((bopen(&bfd, source.fname.c_str(), O_RDONLY | O_BINARY | noatime, 0,
+             source.statp.st_rdev))
       < 0) {
-    ff_pkt->ff_errno = errno;
+    outcome.opened = false;
+    outcome.open_errno = errno;
     BErrNo be;
     be.SetErrno(bfd.BErrNo);
-    Dmsg2(100, "Cannot open %s: ERR=%s\n", ff_pkt->fname, be.bstrerror());
-    Jmsg(jcr, M_ERROR, 1, T_("     Cannot open %s: ERR=%s.\n"), ff_pkt->fname,
+    Dmsg2(100, "Cannot open %s: ERR=%s\n", source.fname.c_str(),
+          be.bstrerror());
+    PoolMem error(PM_MESSAGE);
+    Mmsg(error, T_("     Cannot open %s: ERR=%s.\n"), source.fname.c_str(),
          be.bstrerror());
-    return 1;
+    outcome.errors.emplace_back(error.c_str());
+    return;
   }
-  ReadDigest(&bfd, digest, jcr);
+  ReadDigest(&bfd, digest, source, outcome, stats);
   bclose(&bfd);
 
   if constexpr (have_darwin_os) {
     // Open resource fork if necessary
-    if (BitIsSet(FO_HFSPLUS, ff_pkt->flags) && ff_pkt->hfsinfo.rsrclength > 0) {
-      if (BopenRsrc(&bfd, ff_pkt->fname, O_RDONLY | O_BINARY, 0) < 0) {
-        ff_pkt->ff_errno = errno;
+    if (source.hfsplus && source.hfsinfo.rsrclength > 0) {
+      if (BopenRsrc(&bfd, source.fname.c_str(), O_RDONLY | O_BINARY, 0) < 0) {
+        outcome.opened = false;
+        outcome.open_errno = errno;
         BErrNo be;
-        Jmsg(jcr, M_ERROR, -1,
-             T_("     Cannot open resource fork for %s: ERR=%s.\n"),
-             ff_pkt->fname, be.bstrerror());
-        if (IsBopen(&ff_pkt->bfd)) { bclose(&ff_pkt->bfd); }
-        return 1;
+        PoolMem error(PM_MESSAGE);
+        Mmsg(error, T_("     Cannot open resource fork for %s: ERR=%s.\n"),
+             source.fname.c_str(), be.bstrerror());
+        outcome.errors.emplace_back(error.c_str());
+        return;
       }
-      ReadDigest(&bfd, digest, jcr);
+      ReadDigest(&bfd, digest, source, outcome, stats);
       bclose(&bfd);
     }
 
-    if (digest && BitIsSet(FO_HFSPLUS, ff_pkt->flags)) {
-      CryptoDigestUpdate(digest, (uint8_t*)ff_pkt->hfsinfo.fndrinfo, 32);
+    if (digest && source.hfsplus) {
+      CryptoDigestUpdate(digest, (uint8_t*)source.hfsinfo.fndrinfo, 32);
     }
   }
-  return 0;
 }
 
 /**
@@ -346,23 +594,31 @@ int DigestFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, DIGEST* digest)
  */
 static int ReadDigest(BareosFilePacket* bfd,
                       DIGEST* digest,
-                      JobControlRecord* jcr)
+                      const DigestSource& source,
+                      DigestOutcome& outcome,
+                      PipelineStats& stats)
 {
   char buf[DEFAULT_NETWORK_BUFFER_SIZE];
   int64_t n;
   int64_t bufsiz = (int64_t)sizeof(buf);
-  FindFilesPacket* ff_pkt = (FindFilesPacket*)jcr->fd_impl->ff;
   uint64_t fileAddr = 0; /* file address */
 
 
   Dmsg0(50, "=== ReadDigest\n");
-  while ((n = bread(bfd, buf, bufsiz)) > 0) {
+  for (;;) {
+    {
+      StageTimer timer(stats, PipelineStage::kRead);
+      n = bread(bfd, buf, bufsiz);
+      timer.SetBytes(n > 0 ? n : 0);
+    }
+    if (n <= 0) { break; }
+
     /* Check for sparse blocks */
-    if (BitIsSet(FO_SPARSE, ff_pkt->flags)) {
+    if (source.sparse) {
       bool allZeros = false;
-      if ((n == bufsiz && fileAddr + n < (uint64_t)ff_pkt->statp.st_size)
-          || ((ff_pkt->type == FT_RAW || ff_pkt->type == FT_FIFO)
-              && (uint64_t)ff_pkt->statp.st_size == 0)) {
+      if ((n == bufsiz && fileAddr + n < (uint64_t)source.statp.st_size)
+          || ((source.type == FT_RAW || source.type == FT_FIFO)
+              && (uint64_t)source.statp.st_size == 0)) {
         allZeros = IsBufZero(buf, bufsiz);
       }
       fileAddr += n; /* update file address */
@@ -370,23 +626,24 @@ static int ReadDigest(BareosFilePacket* bfd,
       if (allZeros) { continue; /* skip block of zeros */ }
     }
 
-    CryptoDigestUpdate(digest, (uint8_t*)buf, n);
-
-    /* Can be used by BaseJobs or with accurate, update only for Verify
-     * jobs
-     */
-    if (jcr->is_JobType(JT_VERIFY)) { jcr->JobBytes += n; }
-    jcr->ReadBytes += n;
+    {
+      StageTimer timer(stats, PipelineStage::kDigest);
+      timer.SetBytes(n);
+      CryptoDigestUpdate(digest, (uint8_t*)buf, n);
+    }
+    outcome.bytes += n;
   }
   Dmsg0(50, "=== ReadDigest END\n");
   if (n < 0) {
     BErrNo be;
     be.SetErrno(bfd->BErrNo);
-    Dmsg2(100, "Error reading file %s: ERR=%s\n", jcr->fd_impl->last_fname,
+    Dmsg2(100, "Error reading file %s: ERR=%s\n", source.fname.c_str(),
           be.bstrerror());
-    Jmsg(jcr, M_ERROR, 1, T_("Error reading file %s: ERR=%s\n"),
-         jcr->fd_impl->last_fname, be.bstrerror());
-    jcr->JobErrors++;
+    PoolMem error(PM_MESSAGE);
+    Mmsg(error, T_("Error reading file %s: ERR=%s\n"), source.fname.c_str(),
+         be.bstrerror());
+    outcome.errors.emplace_back(error.c_str());
+    outcome.read_error = true;
     return -1;
   }
   return 0;
@@ -411,21 +668,9 @@ static bool calculate_file_chksum(JobControlRecord* jcr,
 {
   /* Create our digest context.
    * If this fails, the digest will be set to NULL and not used. */
-  if (BitIsSet(FO_MD5, ff_pkt->flags)) {
-    *digest = crypto_digest_new(jcr, CRYPTO_DIGEST_MD5);
-    *digest_stream = STREAM_MD5_DIGEST;
-  } else if (BitIsSet(FO_SHA1, ff_pkt->flags)) {
-    *digest = crypto_digest_new(jcr, CRYPTO_DIGEST_SHA1);
-    *digest_stream = STREAM_SHA1_DIGEST;
-  } else if (BitIsSet(FO_SHA256, ff_pkt->flags)) {
-    *digest = crypto_digest_new(jcr, CRYPTO_DIGEST_SHA256);
-    *digest_stream = STREAM_SHA256_DIGEST;
-  } else if (BitIsSet(FO_SHA512, ff_pkt->flags)) {
-    *digest = crypto_digest_new(jcr, CRYPTO_DIGEST_SHA512);
-    *digest_stream = STREAM_SHA512_DIGEST;
-  } else if (BitIsSet(FO_XXH128, ff_pkt->flags)) {
-    *digest = crypto_digest_new(jcr, CRYPTO_DIGEST_XXH128);
-    *digest_stream = STREAM_XXH128_DIGEST;
+  crypto_digest_t type = SelectDigest(ff_pkt, digest_stream);
+  if (*digest_stream != STREAM_NONE) {
+    *digest = crypto_digest_new(jcr, type);
   }
 
   // compute MD5 or SHA1 hash
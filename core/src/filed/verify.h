@@ -1,7 +1,7 @@
 /*
    BAREOS® - Backup Archiving REcovery Open Sourced
 
-   Copyright (C) 2018-2023 Bareos GmbH & Co. KG
+   Copyright (C) 2018-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -23,9 +23,89 @@
 #define BAREOS_FILED_VERIFY_H_
 
 #include "lib/crypto.h"
+#include "lib/thread_pool.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+class JobControlRecord;
+struct FindFilesPacket;
 
 namespace filedaemon {
 
+/* What happened while digesting a file.  Workers do not touch the job, the
+ * job thread reports this once it sends the result. */
+struct DigestOutcome {
+  bool opened{true};
+  bool cancelled{}; /* not digested, as the job was cancelled first */
+  int open_errno{};
+  bool read_error{};
+  uint64_t bytes{};
+  std::vector<std::string> errors{};
+  std::string digest{}; /* base64, empty if none */
+  const char* name{};
+};
+
+/* Sends the attributes and digests of the files to the director in the
+ * order the files were found, while the digests are computed by worker
+ * threads.  At most max_pending files are read ahead of the director. */
+class VerifyPipeline {
+ public:
+  using Sender = std::function<bool(const char* msg, std::size_t length)>;
+  using DigestWork = std::function<DigestOutcome()>;
+
+  // Without send, the messages go to the director connection of the job.
+  VerifyPipeline(JobControlRecord* jcr,
+                 thread_pool& pool,
+                 std::size_t workers,
+                 Sender send = {});
+  ~VerifyPipeline() { Finish(); }
+
+  /* Queues the attributes of the file and, if with_digest, its digest.
+   * Sends what is done, returns false on a send error. */
+  bool Add(FindFilesPacket* ff_pkt,
+           uint32_t file_index,
+           std::string attributes,
+           bool with_digest);
+
+  /* Same, with the digest of stream digest_stream computed by work, which
+   * is empty for files without digest.  Files whose work has not started
+   * when the job is cancelled are not sent at all. */
+  bool Add(uint32_t file_index,
+           std::string attributes,
+           int digest_stream,
+           DigestWork work);
+
+  bool Finish();
+
+ private:
+  struct PendingFile {
+    uint32_t file_index{};
+    std::string attributes{};
+    int digest_stream{};
+    std::future<DigestOutcome> digest{};
+  };
+
+  bool Add(PendingFile file);
+  bool Send(PendingFile& file);
+  bool Send(const char* msg, std::size_t length);
+
+  JobControlRecord* jcr_;
+  std::size_t workers_;
+  std::size_t max_pending_;
+  Sender send_;
+  std::deque<PendingFile> pending_{};
+  std::optional<work_group> group_{};
+  synchronized<std::size_t> latch_{};
+  std::condition_variable finished_{};
+  bool send_error_{false};
+};
+
 int DigestFile(JobControlRecord* jcr, FindFilesPacket* ff_pkt, DIGEST* digest);
 void DoVerify(JobControlRecord* jcr);
 void DoVerifyVolume(JobControlRecord* jcr);
@@ -86,6 +86,7 @@ static std::string fopts_as_str(char (&flags)[FOPTS_BYTES])
   if (BitIsSet(FO_NO_AUTOEXCL, flags)) { join(s, sep, "NO_AUTOEXCL"); }
   if (BitIsSet(FO_FORCE_ENCRYPT, flags)) { join(s, sep, "FORCE_ENCRYPT"); }
   if (BitIsSet(FO_XXH128, flags)) { join(s, sep, "XXH128"); }
+  if (BitIsSet(FO_BLOCK_DELTA, flags)) { join(s, sep, "BLOCK_DELTA"); }
 
   return s;
 }
@@ -287,12 +288,21 @@ bool IsInFileset(FindFilesPacket* ff)
 }
 
 bool AcceptFile(FindFilesPacket* ff)
+{
+  return AcceptFile(ff, ff->fileset->incexe);
+}
+
+/**
+ * Same as above, but with the options of the given Include{} instead of the
+ * one FindFiles() is currently working on.  This does not touch the fileset,
+ * so it can be used by several threads, each with its own ff.
+ */
+bool AcceptFile(FindFilesPacket* ff, findIncludeExcludeItem* incexe)
 {
   int i, j, k;
   int fnm_flags;
   const char* basename;
   findFILESET* fileset = ff->fileset;
-  findIncludeExcludeItem* incexe = fileset->incexe;
   int (*match_func)(const char* pattern, const char* string, int flags);
 
   Dmsg1(debuglevel, "enter AcceptFile: fname=%s\n", ff->fname);
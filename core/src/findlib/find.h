@@ -228,6 +228,8 @@ struct FindFilesPacket {
   time_t save_time{0};            /**< Start of incremental time */
   bool accurate_found{false};     /**< Found in the accurate hash (valid after
                                        CheckChanges()) */
+  struct stat accurate_statp{};   /**< Stat of the previous backup (valid if
+                                       accurate_found) */
   bool incremental{false};        /**< Incremental save */
   bool no_read{false};            /**< Do not read this file when using Plugin */
   char VerifyOpts[MAX_OPTS]{};
@@ -281,6 +283,7 @@ bool MatchFiles(JobControlRecord* jcr,
 void TermFindFiles(FindFilesPacket* ff);
 bool IsInFileset(FindFilesPacket* ff);
 bool AcceptFile(FindFilesPacket* ff);
+bool AcceptFile(FindFilesPacket* ff, findIncludeExcludeItem* incexe);
 findIncludeExcludeItem* allocate_new_incexe(void);
 findIncludeExcludeItem* new_exclude(findFILESET* fileset);
 findIncludeExcludeItem* new_include(findFILESET* fileset);
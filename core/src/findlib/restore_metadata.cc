@@ -0,0 +1,318 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Deferred, batched application of restored file metadata
+ */
+
+#include "include/bareos.h"
+#include "include/filetypes.h"
+#include "include/jcr.h"
+#include "find.h"
+#include "findlib/restore_metadata.h"
+#include "lib/attr.h"
+#include "lib/berrno.h"
+#include "lib/edit.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+DirectoryFdCache::Descriptor::~Descriptor()
+{
+  if (fd >= 0) { close(fd); }
+}
+
+std::shared_ptr<DirectoryFdCache::Descriptor> DirectoryFdCache::Get(
+    const std::string& dir)
+{
+  std::unique_lock lock(mut_);
+
+  if (auto found = index_.find(dir); found != index_.end()) {
+    lru_.splice(lru_.begin(), lru_, found->second);
+    return found->second->second;
+  }
+
+  misses_++;
+  int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+#if defined(O_PATH)
+  // we never read the directory, so we do not need the permission to
+  flags |= O_PATH;
+#endif
+  int fd = open(dir.c_str(), flags);
+  if (fd < 0) { return nullptr; }
+
+  auto desc = std::make_shared<Descriptor>(fd);
+  lru_.emplace_front(dir, desc);
+  index_[dir] = lru_.begin();
+
+  if (lru_.size() > capacity_) {
+    // descriptors still in use by a worker are closed by their last owner
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+
+  return desc;
+}
+
+std::size_t DirectoryFdCache::size() const
+{
+  std::unique_lock lock(mut_);
+  return lru_.size();
+}
+
+bool RestoreMetadataQueue::Supported()
+{
+#if defined(HAVE_WIN32) || defined(HAVE_DARWIN_OS) \
+    || (defined(HAVE_CHFLAGS) && !defined(__stub_chflags))
+  /* windows attributes and bsd file flags need to be set in a specific
+   * order with regards to the times, so they stay with SetAttributes() */
+  return false;
+#else
+  return true;
+#endif
+}
+
+RestoreMetadataQueue::RestoreMetadataQueue(JobControlRecord* jcr,
+                                           thread_pool& pool,
+                                           std::size_t num_workers,
+                                           std::size_t max_pending_directories)
+    : jcr_{jcr}
+    , num_workers_{std::max<std::size_t>(num_workers, 1)}
+    , suppress_errors_{debug_level >= 100 || getuid() != 0}
+    , max_pending_directories_{std::max<std::size_t>(max_pending_directories,
+                                                     1)}
+    , group_{num_workers_ * 2}
+    , running_{num_workers_}
+{
+  batch_.reserve(batch_size);
+  pool.borrow_threads(num_workers_, [this] {
+    group_.work_until_completion();
+
+    auto lock = running_.lock();
+    *lock -= 1;
+    workers_done_.notify_one();
+  });
+}
+
+RestoreMetadataQueue::~RestoreMetadataQueue() { Finish(); }
+
+RestoreMetadataQueue::Entry RestoreMetadataQueue::MakeEntry(
+    const char* path,
+    int type,
+    const struct stat& st)
+{
+  Entry entry;
+  entry.path = path;
+  while (entry.path.size() > 1 && entry.path.back() == '/') {
+    entry.path.pop_back();
+  }
+  if (auto slash = entry.path.rfind('/'); slash != std::string::npos) {
+    entry.name_offset = slash + 1;
+  }
+  entry.depth = std::count(entry.path.begin(), entry.path.end(), '/');
+  entry.type = type;
+  entry.uid = st.st_uid;
+  entry.gid = st.st_gid;
+  entry.mode = st.st_mode;
+  entry.times[0].tv_sec = st.st_atime;
+  entry.times[1].tv_sec = st.st_mtime;
+  if (type == FT_REG) { entry.size = st.st_size; }
+  return entry;
+}
+
+bool RestoreMetadataQueue::Submit(Attributes* attr, BareosFilePacket* ofd)
+{
+  if (!Supported() || finished_ || ofd->cmd_plugin) { return false; }
+
+  Entry entry = MakeEntry(attr->ofname, attr->type, attr->statp);
+
+  if (IsBopen(ofd)) {
+    boffset_t fsize = blseek(ofd, 0, SEEK_END);
+    if (entry.size > 0 && fsize > 0 && fsize != entry.size) {
+      char ec1[50], ec2[50];
+      Jmsg3(jcr_, M_ERROR, 0,
+            T_("File size of restored file %s not correct. Original %s, "
+               "restored %s.\n"),
+            attr->ofname, edit_uint64(entry.size, ec1),
+            edit_uint64(fsize, ec2));
+    }
+    entry.size = -1;
+    bclose(ofd);
+  }
+  PmStrcpy(attr->ofname, "*None*");
+
+  // We do not restore sockets, so skip trying to restore their attributes.
+  if (entry.type == FT_SPEC && S_ISSOCK(entry.mode)) { return true; }
+
+  if (entry.type == FT_DIREND) {
+    directories_.push_back(std::move(entry));
+    if (directories_.size() >= max_pending_directories_) { ApplyDirectories(); }
+    return true;
+  }
+
+  batch_.push_back(std::move(entry));
+  if (batch_.size() >= batch_size) { SubmitBatch(); }
+
+  return true;
+}
+
+void RestoreMetadataQueue::SubmitBatch()
+{
+  if (batch_.empty()) { return; }
+
+  *queued_batches_.lock() += 1;
+  (void)group_.submit([this, batch = std::move(batch_)]() {
+    ApplyBatch(batch);
+
+    auto lock = queued_batches_.lock();
+    *lock -= 1;
+    if (*lock == 0) { batches_done_.notify_all(); }
+  });
+  batch_ = {};
+  batch_.reserve(batch_size);
+}
+
+void RestoreMetadataQueue::ApplyBatch(const std::vector<Entry>& batch)
+{
+  for (auto& entry : batch) { Apply(entry, true, true); }
+}
+
+std::uint64_t RestoreMetadataQueue::Finish()
+{
+  if (finished_) { return errors_.load(); }
+  finished_ = true;
+
+  SubmitBatch();
+  group_.shutdown();
+  running_.lock().wait(workers_done_, [](std::size_t n) { return n == 0; });
+
+  ApplyDirectories();
+
+  Dmsg2(100, "Restored metadata with %zu workers, %" PRIu64 " dir opens\n",
+        num_workers_, dirs_.misses());
+
+  return errors_.load();
+}
+
+void RestoreMetadataQueue::ApplyDirectories()
+{
+  /* The workers may still be changing entries inside of the directories,
+   * which could fail once a directory has its restored owner and mode. */
+  SubmitBatch();
+  queued_batches_.lock().wait(batches_done_,
+                              [](std::size_t n) { return n == 0; });
+
+  /* Children first: once a parent has its restored owner and mode we might
+   * not be allowed to look up anything inside of it anymore.  Changing a
+   * child does not touch the times of its parent. */
+  std::stable_sort(directories_.begin(), directories_.end(),
+                   [](const Entry& l, const Entry& r) {
+                     return l.depth > r.depth;
+                   });
+  for (auto& dir : directories_) { Apply(dir, true, true); }
+  directories_.clear();
+}
+
+void RestoreMetadataQueue::Apply(const Entry& entry,
+                                 bool owner_and_mode,
+                                 bool times)
+{
+  int dirfd = AT_FDCWD;
+  const char* name = entry.path.c_str();
+
+  std::shared_ptr<DirectoryFdCache::Descriptor> dir;
+  if (entry.name_offset > 0) {
+    std::string parent = entry.path.substr(0, entry.name_offset - 1);
+    dir = dirs_.Get(parent.empty() ? "/" : parent);
+  } else {
+    dir = dirs_.Get(".");
+  }
+  // without a directory descriptor we fall back to the full path
+  if (dir) {
+    dirfd = dir->fd;
+    name += entry.name_offset;
+  }
+
+  if (entry.size > 0) {
+    struct stat st;
+    if (fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW) == 0 && st.st_size > 0
+        && st.st_size != entry.size) {
+      char ec1[50], ec2[50];
+      Qmsg3(jcr_, M_ERROR, 0,
+            T_("File size of restored file %s not correct. Original %s, "
+               "restored %s.\n"),
+            entry.path.c_str(), edit_uint64(entry.size, ec1),
+            edit_uint64(st.st_size, ec2));
+    }
+  }
+
+  bool ok = true;
+  if (owner_and_mode && !ApplyOwnerAndMode(entry, dirfd, name)) { ok = false; }
+  if (times && !ApplyTimes(entry, dirfd, name)) { ok = false; }
+  if (!ok) { errors_++; }
+}
+
+bool RestoreMetadataQueue::ApplyOwnerAndMode(const Entry& entry,
+                                             int dirfd,
+                                             const char* name)
+{
+  bool ok = true;
+
+  // For links this changes the owner of the link, not of the real file.
+  if (fchownat(dirfd, name, entry.uid, entry.gid, AT_SYMLINK_NOFOLLOW) < 0
+      && !suppress_errors_) {
+    Error(T_("Unable to set file owner %s: ERR=%s\n"), entry);
+    ok = false;
+  }
+
+  // A chmod of a link would change the file behind it.
+  if (entry.type != FT_LNK && fchmodat(dirfd, name, entry.mode, 0) < 0
+      && !suppress_errors_) {
+    Error(T_("Unable to set file modes %s: ERR=%s\n"), entry);
+    ok = false;
+  }
+
+  return ok;
+}
+
+bool RestoreMetadataQueue::ApplyTimes(const Entry& entry,
+                                      int dirfd,
+                                      const char* name)
+{
+  // SetAttributes() never restored the times of links either
+  if (entry.type == FT_LNK) { return true; }
+
+  if (utimensat(dirfd, name, entry.times, AT_SYMLINK_NOFOLLOW) < 0
+      && !suppress_errors_) {
+    Error(T_("Unable to set file times %s: ERR=%s\n"), entry);
+    return false;
+  }
+  return true;
+}
+
+void RestoreMetadataQueue::Error(const char* fmt, const Entry& entry)
+{
+  BErrNo be;
+
+  // called from the workers, so the message has to be queued
+  Qmsg2(jcr_, M_ERROR, 0, fmt, entry.path.c_str(), be.bstrerror());
+}
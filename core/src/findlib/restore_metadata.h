@@ -0,0 +1,157 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Deferred, batched application of restored file metadata
+ */
+#ifndef BAREOS_FINDLIB_RESTORE_METADATA_H_
+#define BAREOS_FINDLIB_RESTORE_METADATA_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/thread_pool.h"
+
+class JobControlRecord;
+struct Attributes;
+struct BareosFilePacket;
+
+/* A bounded LRU of open directories.  Restored entries are addressed
+ * relative to the descriptor of their parent directory, so the kernel does
+ * not have to walk the full path again for every system call. */
+class DirectoryFdCache {
+ public:
+  struct Descriptor {
+    explicit Descriptor(int t_fd) : fd{t_fd} {}
+    ~Descriptor();
+    Descriptor(const Descriptor&) = delete;
+    Descriptor& operator=(const Descriptor&) = delete;
+
+    const int fd;
+  };
+
+  explicit DirectoryFdCache(std::size_t capacity = 256) : capacity_{capacity}
+  {
+  }
+
+  // Returns nullptr (with errno set) if dir cannot be opened.
+  std::shared_ptr<Descriptor> Get(const std::string& dir);
+
+  std::size_t size() const;
+  std::uint64_t misses() const { return misses_; }
+
+ private:
+  using entry = std::pair<std::string, std::shared_ptr<Descriptor>>;
+
+  mutable std::mutex mut_;
+  std::size_t capacity_;
+  std::list<entry> lru_;
+  std::unordered_map<std::string, std::list<entry>::iterator> index_;
+  std::uint64_t misses_{0};
+};
+
+/* Applies owner, mode and times of restored entries on worker threads.
+ *
+ * Regular files, links and special files are collected into batches that
+ * the workers apply with fchownat()/fchmodat()/utimensat() relative to a
+ * cached descriptor of the parent directory.  Directories are kept back
+ * until Finish(), so a restricted mode or foreign owner cannot get in the
+ * way of creating the entries below them, and restoring those entries does
+ * not change their times anymore.  Once more than max_pending_directories
+ * are kept back they are applied early: directories are sent after their
+ * contents, so only entries of a later job in a multi job restore can still
+ * end up in them. */
+class RestoreMetadataQueue {
+ public:
+  // Whether this platform can restore metadata this way.
+  static bool Supported();
+
+  RestoreMetadataQueue(JobControlRecord* jcr,
+                       thread_pool& pool,
+                       std::size_t num_workers,
+                       std::size_t max_pending_directories = 16 * 1024);
+  ~RestoreMetadataQueue();
+
+  RestoreMetadataQueue(const RestoreMetadataQueue&) = delete;
+  RestoreMetadataQueue& operator=(const RestoreMetadataQueue&) = delete;
+
+  /* Takes over what SetAttributes() would do for attr: ofd is closed and
+   * attr->ofname is reset.  Returns false, without touching anything, if
+   * the entry has to go through SetAttributes() instead. */
+  bool Submit(Attributes* attr, BareosFilePacket* ofd);
+
+  /* Waits until all queued entries are applied and restores the metadata
+   * of the directories.  Returns the number of entries that failed. */
+  std::uint64_t Finish();
+
+  std::uint64_t Errors() const { return errors_.load(); }
+
+  struct Entry {
+    std::string path;
+    std::size_t name_offset{0}; /* where the last component starts */
+    int type{0};
+    uid_t uid{0};
+    gid_t gid{0};
+    mode_t mode{0};
+    timespec times[2]{};
+    off_t size{-1}; /* expected size; checked if >= 0 */
+    std::size_t depth{0};
+  };
+
+  static Entry MakeEntry(const char* path, int type, const struct stat& st);
+
+ private:
+  void SubmitBatch();
+  void ApplyDirectories();
+  void ApplyBatch(const std::vector<Entry>& batch);
+  bool ApplyOwnerAndMode(const Entry& entry, int dirfd, const char* name);
+  bool ApplyTimes(const Entry& entry, int dirfd, const char* name);
+  void Apply(const Entry& entry, bool owner_and_mode, bool times);
+  void Error(const char* what, const Entry& entry);
+
+  static constexpr std::size_t batch_size = 64;
+
+  JobControlRecord* jcr_;
+  std::size_t num_workers_;
+  bool suppress_errors_;
+  std::size_t max_pending_directories_;
+  bool finished_{false};
+  DirectoryFdCache dirs_;
+  work_group group_;
+  synchronized<std::size_t> running_;
+  std::condition_variable workers_done_;
+  synchronized<std::size_t> queued_batches_;
+  std::condition_variable batches_done_;
+  std::vector<Entry> batch_;
+  std::vector<Entry> directories_;
+  std::atomic<std::uint64_t> errors_{0};
+};
+
+#endif  // BAREOS_FINDLIB_RESTORE_METADATA_H_
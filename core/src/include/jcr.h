@@ -45,6 +45,7 @@
 #include "lib/breg.h"
 #include "lib/dlink.h"
 #include "lib/path_list.h"
+#include "lib/pipeline_stats.h"
 #include "lib/guid_to_name.h"
 #include "lib/jcr.h"
 
@@ -182,6 +183,7 @@ class JobControlRecord {
   uint64_t JobBytes{};          /**< Number of bytes processed this job */
   uint64_t LastJobBytes{};      /**< Last sample number bytes */
   uint64_t ReadBytes{};         /**< Bytes read -- before compression */
+  PipelineStats pipeline_stats; /**< Time spent per data pipeline stage */
   FileId_t FileId{};            /**< Last FileId used */
   int32_t JobPriority{};        /**< Job priority */
   bool allow_mixed_priority{};  /**< Allow jobs with higher priority concurrently with this */
@@ -0,0 +1,204 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "lib/bandwidth_scheduler.h"
+
+#include <algorithm>
+
+namespace {
+// allow short bursts, larger requests are served on credit
+constexpr double min_burst = 256 * 1024;
+
+std::uint64_t Second(BandwidthScheduler::clock::time_point time)
+{
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             time.time_since_epoch())
+      .count();
+}
+}  // namespace
+
+BandwidthScheduler::BandwidthScheduler(std::uint64_t rate,
+                                       std::function<clock::time_point()> now)
+    : now_{std::move(now)}, last_refill_{now_()}
+{
+  SetRate(rate);
+}
+
+BandwidthScheduler::Flow::Flow(BandwidthScheduler& scheduler,
+                               std::uint32_t weight)
+    : scheduler_{scheduler}, weight_{std::max(weight, std::uint32_t{1})}
+{
+  std::unique_lock lock(scheduler_.mutex_);
+  scheduler_.flows_ += 1;
+  finish_ = scheduler_.virtual_time_;
+}
+
+BandwidthScheduler::Flow::~Flow()
+{
+  std::unique_lock lock(scheduler_.mutex_);
+  scheduler_.flows_ -= 1;
+}
+
+void BandwidthScheduler::SetRate(std::uint64_t rate)
+{
+  std::unique_lock lock(mutex_);
+  Refill(now_());
+  rate_ = rate;
+  burst_ = std::max(static_cast<double>(rate) / 10, min_burst);
+  tokens_ = std::min(tokens_, burst_);
+  served_.notify_all();
+}
+
+void BandwidthScheduler::Refill(clock::time_point now)
+{
+  if (rate_ > 0 && now > last_refill_) {
+    std::chrono::duration<double> elapsed = now - last_refill_;
+    tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+  }
+  last_refill_ = now;
+}
+
+void BandwidthScheduler::Account(clock::time_point now, std::size_t bytes)
+{
+  auto second = Second(now);
+  auto tag = second << slot_second_shift;
+  auto& slot = window_[second % window_size];
+  auto current = slot.load(std::memory_order_relaxed);
+  for (;;) {
+    // a slot of an older second starts over
+    auto next = (current & ~slot_bytes_mask) == tag
+                    ? current + bytes
+                    : tag | (bytes & slot_bytes_mask);
+    if (slot.compare_exchange_weak(current, next,
+                                   std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void BandwidthScheduler::Acquire(Flow& flow, std::size_t bytes)
+{
+  if (bytes == 0) { return; }
+
+  auto began = now_();
+  Account(began, bytes);
+  if (rate_.load(std::memory_order_relaxed) == 0) { return; }
+
+  std::unique_lock lock(mutex_);
+  if (rate_ == 0) { return; }
+
+  double start = std::max(virtual_time_, flow.finish_);
+  flow.finish_ = start + static_cast<double>(bytes) / flow.weight_;
+  auto request = waiting_.emplace(std::pair{start, next_ticket_++}, bytes);
+
+  for (auto now = began;; now = now_()) {
+    Refill(now);
+    if (rate_ == 0) { break; }
+
+    if (request.first != waiting_.begin()) {
+      served_.wait(lock);
+    } else if (tokens_ < 0) {
+      served_.wait_for(lock,
+                       std::chrono::duration<double>(-tokens_ / rate_));
+    } else {
+      /* The bucket may go into debt, so requests larger than the burst
+       * size do not starve. */
+      tokens_ -= static_cast<double>(bytes);
+      break;
+    }
+  }
+
+  virtual_time_ = std::max(virtual_time_, start);
+  waiting_.erase(request.first);
+  waited_ += now_() - began;
+  served_.notify_all();
+}
+
+BandwidthScheduler::statistics BandwidthScheduler::Statistics() const
+{
+  std::unique_lock lock(mutex_);
+  statistics stats{};
+  stats.rate = rate_;
+  stats.bytes = bytes_.load(std::memory_order_relaxed);
+  stats.flows = flows_;
+  stats.waiting = waiting_.size();
+  stats.waited_ms
+      = std::chrono::duration_cast<std::chrono::milliseconds>(waited_).count();
+
+  // only completed seconds that are still in the window count
+  auto current = Second(now_());
+  for (auto s = current - window_seconds; s < current; ++s) {
+    auto slot = window_[s % window_size].load(std::memory_order_relaxed);
+    if ((slot & ~slot_bytes_mask) == s << slot_second_shift) {
+      stats.throughput += slot & slot_bytes_mask;
+    }
+  }
+  stats.throughput /= window_seconds;
+
+  return stats;
+}
+
+namespace {
+struct interface_schedulers {
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<BandwidthScheduler>> schedulers;
+};
+
+interface_schedulers& Interfaces()
+{
+  static interface_schedulers interfaces;
+  return interfaces;
+}
+}  // namespace
+
+BandwidthScheduler& DaemonBandwidthScheduler()
+{
+  static BandwidthScheduler scheduler;
+  return scheduler;
+}
+
+BandwidthScheduler& InterfaceBandwidthScheduler(const std::string& address)
+{
+  auto& interfaces = Interfaces();
+  std::unique_lock lock(interfaces.mutex);
+  auto& scheduler = interfaces.schedulers[address];
+  if (!scheduler) { scheduler = std::make_unique<BandwidthScheduler>(); }
+  return *scheduler;
+}
+
+std::vector<std::pair<std::string, BandwidthScheduler::statistics>>
+InterfaceBandwidthStatistics()
+{
+  auto& interfaces = Interfaces();
+  std::unique_lock lock(interfaces.mutex);
+  std::vector<std::pair<std::string, BandwidthScheduler::statistics>> result;
+  for (auto& [address, scheduler] : interfaces.schedulers) {
+    result.emplace_back(address, scheduler->Statistics());
+  }
+  return result;
+}
+
+std::uint32_t BandwidthWeightFromPriority(std::int32_t priority)
+{
+  if (priority < 1) { priority = 1; }
+  return std::max(1000 / priority, 1);
+}
@@ -0,0 +1,131 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_LIB_BANDWIDTH_SCHEDULER_H_
+#define BAREOS_LIB_BANDWIDTH_SCHEDULER_H_
+
+/* A BandwidthScheduler is a token bucket that is shared by all the data
+ * connections of a daemon (or of one of its network interfaces).  Every
+ * connection draws from it through a Flow.  While the bucket is empty the
+ * waiting flows are served by start time fair queueing, i.e. each flow
+ * gets a share of the rate that is proportional to its weight. */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BandwidthScheduler {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  class Flow {
+   public:
+    Flow(BandwidthScheduler& scheduler, std::uint32_t weight);
+    ~Flow();
+    Flow(const Flow&) = delete;
+    Flow& operator=(const Flow&) = delete;
+
+    // Blocks until the scheduler allows the transfer of bytes.
+    void Acquire(std::size_t bytes) { scheduler_.Acquire(*this, bytes); }
+    std::uint32_t Weight() const { return weight_; }
+    BandwidthScheduler& Scheduler() const { return scheduler_; }
+
+   private:
+    friend class BandwidthScheduler;
+    BandwidthScheduler& scheduler_;
+    std::uint32_t weight_;
+    double finish_{0}; /* Virtual finish time of the last request */
+  };
+
+  struct statistics {
+    std::uint64_t rate;       /* Limit in bytes/s, 0 means unlimited */
+    std::uint64_t throughput; /* Bytes/s over the last few seconds */
+    std::uint64_t bytes;      /* Total bytes transferred */
+    std::uint64_t waited_ms;  /* Total time flows spent waiting */
+    std::size_t flows;        /* Number of active flows */
+    std::size_t waiting;      /* Number of requests waiting */
+  };
+
+  // The clock can be replaced for testing.
+  explicit BandwidthScheduler(
+      std::uint64_t rate = 0,
+      std::function<clock::time_point()> now = clock::now);
+
+  // Can be changed at any time, 0 means unlimited.
+  void SetRate(std::uint64_t rate);
+  statistics Statistics() const;
+
+ private:
+  static constexpr std::int64_t window_seconds = 5;
+  static constexpr std::int64_t window_size = window_seconds + 1;
+
+  /* A window slot holds the bytes of one second in its low bits and the
+   * second it belongs to in the high bits, so it can be updated with a
+   * single compare and swap. */
+  static constexpr int slot_second_shift = 40;
+  static constexpr std::uint64_t slot_bytes_mask
+      = (std::uint64_t{1} << slot_second_shift) - 1;
+
+  void Acquire(Flow& flow, std::size_t bytes);
+  void Refill(clock::time_point now);
+  // Lock free, so unlimited schedulers never take the mutex.
+  void Account(clock::time_point now, std::size_t bytes);
+
+  std::function<clock::time_point()> now_;
+  mutable std::mutex mutex_;
+  std::condition_variable served_;
+  std::atomic<std::uint64_t> rate_{0};
+  double tokens_{0};
+  double burst_{0};
+  clock::time_point last_refill_{};
+
+  // waiting requests ordered by their virtual start time
+  std::map<std::pair<double, std::uint64_t>, std::size_t> waiting_;
+  std::uint64_t next_ticket_{0};
+  double virtual_time_{0};
+
+  std::size_t flows_{0};
+  clock::duration waited_{};
+  std::atomic<std::uint64_t> bytes_{0};
+  std::array<std::atomic<std::uint64_t>, window_size> window_{};
+};
+
+/* The schedulers of this daemon: one for all connections and one for each
+ * local address data connections are made on. */
+BandwidthScheduler& DaemonBandwidthScheduler();
+BandwidthScheduler& InterfaceBandwidthScheduler(const std::string& address);
+std::vector<std::pair<std::string, BandwidthScheduler::statistics>>
+InterfaceBandwidthStatistics();
+
+// Higher job priorities (i.e. lower numbers) get a larger weight.
+std::uint32_t BandwidthWeightFromPriority(std::int32_t priority);
+
+#endif  // BAREOS_LIB_BANDWIDTH_SCHEDULER_H_
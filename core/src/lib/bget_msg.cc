@@ -72,6 +72,12 @@ int BgetMsg(BareosSocket* sock)
           sock->fsend(OK_msg); /* send response */
         }
         return n; /* end of data */
+      case BNET_CHUNK_MANIFEST:
+        Dmsg0(messagelevel, "Got BNET_CHUNK_MANIFEST\n");
+        return n;
+      case BNET_CHUNK_DATA:
+        Dmsg0(messagelevel, "Got BNET_CHUNK_DATA\n");
+        return n;
       case BNET_TERMINATE:
         Dmsg0(messagelevel, "Got BNET_TERMINATE\n");
         sock->SetTerminated();
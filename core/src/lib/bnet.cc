@@ -436,6 +436,8 @@ std::map<int, std::pair<std::string, std::string>> bnet_signal_to_text {
     {BNET_END_RTREE, {"BNET_END_RTREE", "End restore tree mode "}},
     {BNET_SUB_PROMPT, {"BNET_SUB_PROMPT", "Indicate we are at a subprompt "}},
     {BNET_TEXT_INPUT, {"BNET_TEXT_INPUT", "Get text input from user "}},
+    {BNET_CHUNK_MANIFEST, {"BNET_CHUNK_MANIFEST", "Data records follow as chunk manifest "}},
+    {BNET_CHUNK_DATA, {"BNET_CHUNK_DATA", "Missing chunks of a manifest follow "}},
 };
 /* clang-format on */
 
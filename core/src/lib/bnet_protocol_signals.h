@@ -57,7 +57,9 @@ enum
   BNET_START_RTREE = -25,  /* Start restore tree mode */
   BNET_END_RTREE = -26,    /* End restore tree mode */
   BNET_SUB_PROMPT = -27,   /* Indicate we are at a subprompt */
-  BNET_TEXT_INPUT = -28    /* Get text input from user */
+  BNET_TEXT_INPUT = -28,   /* Get text input from user */
+  BNET_CHUNK_MANIFEST = -29, /* Data records follow as chunk manifest */
+  BNET_CHUNK_DATA = -30      /* Missing chunks of a manifest follow */
 };
 
 static_assert(BNET_EOD == -1);
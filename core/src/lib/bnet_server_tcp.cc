@@ -71,10 +71,11 @@ static std::atomic<bool> quit{false};
  * Stop the Threaded Network Server if its really running in a separate thread.
  * e.g. set the quit flag and wait for the other thread to exit cleanly.
  */
-void BnetStopAndWaitForThreadServerTcp(pthread_t tid)
+void BnetStopAndWaitForThreadServerTcp(pthread_t tid,
+                                       std::atomic<bool>* quit_flag)
 {
   Dmsg0(100, "BnetThreadServer: Request Stop\n");
-  quit = true;
+  (quit_flag ? *quit_flag : quit) = true;
   if (!pthread_equal(tid, pthread_self())) {
     Dmsg0(100, "BnetThreadServer: Wait until finished\n");
     pthread_join(tid, nullptr);
@@ -271,11 +272,13 @@ void BnetThreadServerTcp(
     ConfigurationParser* config,
     std::atomic<BnetServerState>* const server_state,
     std::function<void*(void* bsock)> UserAgentShutdownCallback,
-    std::function<void()> CustomCallback)
+    std::function<void()> CustomCallback,
+    std::atomic<bool>* const quit_flag)
 {
   BNetThreadServerCleanupObject cleanup_object(thread_list);
 
-  quit = false;  // allow other threads to set this true during initialization
+  std::atomic<bool>& stop = quit_flag ? *quit_flag : quit;
+  stop = false;  // allow other threads to set this true during initialization
   if (server_state) { server_state->store(BnetServerState::kStarting); }
 
 #ifdef HAVE_POLL
@@ -313,7 +316,7 @@ void BnetThreadServerTcp(
 
   if (server_state) { server_state->store(BnetServerState::kStarted); }
 
-  while (!quit) {
+  while (!stop) {
     if (CustomCallback) { CustomCallback(); }
 #ifndef HAVE_POLL
     int maxfd = 0;
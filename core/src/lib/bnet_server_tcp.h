@@ -79,7 +79,8 @@ void BnetThreadServerTcp(
     ConfigurationParser* config,
     std::atomic<BnetServerState>* const server_state = nullptr,
     std::function<void*(void* bsock)> UserAgentShutdownCallback = nullptr,
-    std::function<void()> CustomCallback = nullptr);
+    std::function<void()> CustomCallback = nullptr,
+    std::atomic<bool>* const quit_flag = nullptr);
 
 void RemoveDuplicateAddresses(dlist<IPADDR>* addr_list);
 
@@ -87,6 +88,9 @@ int OpenSocketAndBind(IPADDR* ipaddr,
                       dlist<IPADDR>* addr_list,
                       uint16_t port_number);
 
-void BnetStopAndWaitForThreadServerTcp(pthread_t tid);
+/* Servers started with their own quit_flag have to be stopped with it,
+ * all others share one. */
+void BnetStopAndWaitForThreadServerTcp(pthread_t tid,
+                                       std::atomic<bool>* quit_flag = nullptr);
 
 #endif  // BAREOS_LIB_BNET_SERVER_TCP_H_
@@ -544,6 +544,25 @@ bool BareosSocket::send(const char* msg_in, uint32_t nbytes)
   return send();
 }
 
+bool BareosSocket::SendFragments(
+    std::span<const std::span<const char>> fragments,
+    std::shared_ptr<const void>)
+{
+  if (errors || IsTerminated()) { return false; }
+
+  std::size_t nbytes = 0;
+  for (auto fragment : fragments) { nbytes += fragment.size(); }
+
+  msg = CheckPoolMemorySize(msg, nbytes);
+  message_length = 0;
+  for (auto fragment : fragments) {
+    memcpy(msg + message_length, fragment.data(), fragment.size());
+    message_length += fragment.size();
+  }
+
+  return send();
+}
+
 void BareosSocket::SetKillable(bool killable)
 {
   if (jcr_) { jcr_->SetKillable(killable); }
@@ -761,6 +780,16 @@ void BareosSocket::OutputCipherMessageString(
   output_cb(str.c_str());
 }
 
+// Draw the traffic of this socket from a scheduler shared with others
+void BareosSocket::AddBandwidthFlow(
+    std::shared_ptr<BandwidthScheduler::Flow> flow)
+{
+  for (auto& added : bandwidth_flows_) {
+    if (&added->Scheduler() == &flow->Scheduler()) { return; }
+  }
+  bandwidth_flows_.push_back(std::move(flow));
+}
+
 // Try to limit the bandwidth of a network connection
 void BareosSocket::ControlBwlimit(int bytes)
 {
@@ -770,6 +799,9 @@ void BareosSocket::ControlBwlimit(int bytes)
   // If nothing written or read nothing todo.
   if (bytes == 0) { return; }
 
+  for (auto& flow : bandwidth_flows_) { flow->Acquire(bytes); }
+  if (bwlimit_ <= 0) { return; }
+
   // See if this is the first time we enter here.
   now = GetCurrentBtime();
   if (last_tick_ == 0) {
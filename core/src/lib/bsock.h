@@ -43,6 +43,7 @@
 
 #include "include/bareos.h"
 #include "lib/address_conf.h"
+#include "lib/bandwidth_scheduler.h"
 #include "lib/bnet_network_dump.h"
 #include "lib/bnet_protocol_signals.h"
 #include "lib/tls.h"
@@ -54,11 +55,13 @@
 #include <functional>
 #include <cassert>
 #include <atomic>
+#include <memory>
 #include <span>
 
 struct btimer_t; /* forward reference */
 class BareosSocket;
 class BStringList;
+class StripedSender;
 template <typename T> class dlist;
 btimer_t* StartBsockTimer(BareosSocket* bs, uint32_t wait);
 void StopBsockTimer(btimer_t* wid);
@@ -83,6 +86,7 @@ class BareosSocket {
   std::atomic<bool> suppress_error_msgs_; /* Set to suppress error messages */
   int sleep_time_after_authentication_error;
   bool enable_ktls_{false};
+  bool zerocopy_{false}; /* Try MSG_ZEROCOPY for big messages */
 
   unsigned remote_version{}; /* version hex of remote version; only for inbound;
                                 0 if unknown */
@@ -114,6 +118,8 @@ class BareosSocket {
   btime_t last_tick_;    /* Last tick used by bwlimit */
   bool tls_established_; /* is true when tls connection is established */
   std::unique_ptr<BnetDump> bnet_dump_;
+  StripedSender* striped_sender_{nullptr}; /* Sends the messages instead */
+  std::vector<std::shared_ptr<BandwidthScheduler::Flow>> bandwidth_flows_;
 
   virtual void FinInit(JobControlRecord* jcr,
                        int sockfd,
@@ -179,6 +185,13 @@ class BareosSocket {
   bool fsend(const char*, ...) PRINTF_LIKE(2, 3);
   bool vfsend(const char* fmt, va_list ap) PRINTF_LIKE(2, 0);
   bool send(const char* msg_in, uint32_t nbytes);
+  /* Sends the concatenation of all fragments as one message.  Unlike send()
+   * this needs no space in front of the data, so a header and a payload do
+   * not have to be copied into one buffer first.  If the fragments belong to
+   * an owner, the socket may keep it (and read the fragments) until the
+   * data was transmitted, otherwise they are done with on return. */
+  virtual bool SendFragments(std::span<const std::span<const char>> fragments,
+                             std::shared_ptr<const void> owner = nullptr);
   void SetKillable(bool killable);
   bool signal(int signal);
   const char* bstrerror(); /* last error on socket */
@@ -255,7 +268,10 @@ class BareosSocket {
   boffset_t get_data_end() { return data_end_; }
   int32_t get_FileIndex() { return FileIndex_; }
   void SetBwlimit(int64_t maxspeed) { bwlimit_ = maxspeed; }
-  bool UseBwlimit() { return bwlimit_ > 0; }
+  bool UseBwlimit() { return bwlimit_ > 0 || !bandwidth_flows_.empty(); }
+  /* Additionally draw the traffic of this socket from a shared scheduler.
+   * The flow may be shared with other sockets of the same job. */
+  void AddBandwidthFlow(std::shared_ptr<BandwidthScheduler::Flow> flow);
   void SetBwlimitBursting() { use_bursting_ = true; }
   void clear_bwlimit_bursting() { use_bursting_ = false; }
   void SetSpooling() { spool_ = true; }
@@ -272,6 +288,10 @@ class BareosSocket {
       std::string destination_qualified_name);
   bool IsBnetDumpEnabled() const { return bnet_dump_.get() != nullptr; }
   void SetEnableKtls(bool enable_ktls) { enable_ktls_ = enable_ktls; }
+  void SetZeroCopy(bool zerocopy) { zerocopy_ = zerocopy; }
+  /* While a sender is set, all messages and signals are striped over its
+   * connections instead of going out on this socket. */
+  void SetStripedSender(StripedSender* sender) { striped_sender_ = sender; }
 
   virtual bool KtlsForSend() = 0;
   virtual bool KtlsForRecv() = 0;
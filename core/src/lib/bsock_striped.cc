@@ -0,0 +1,320 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "include/bareos.h"
+#include "lib/bsock.h"
+#include "lib/bsock_striped.h"
+#include "lib/berrno.h"
+#include "lib/pipeline_stats.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(HAVE_POLL)
+#  include <poll.h>
+#endif
+
+StripedSender::StripedSender(BareosSocket* owner,
+                             std::vector<BareosSocket*> connections)
+    : owner_{owner}, connections_{std::move(connections)}
+{
+  ASSERT(!connections_.empty());
+}
+
+/* Send the concatenation of the fragments.  Messages that do not fit into
+ * one frame are split, just like BareosSocket::send() splits them into
+ * several packets. */
+bool StripedSender::Send(std::span<const std::span<const char>> fragments,
+                         std::shared_ptr<const void> owner)
+{
+  std::unique_lock lock(mutex_);
+
+  std::size_t left = 0;
+  for (auto fragment : fragments) { left += fragment.size(); }
+
+  std::vector<std::span<const char>> payload;
+  auto fragment = fragments.begin();
+  std::size_t offset = 0; /* already sent part of *fragment */
+  do {
+    std::size_t size = std::min(left, striping::max_payload);
+
+    payload.clear();
+    for (std::size_t needed = size; needed > 0;) {
+      std::size_t part = std::min(needed, fragment->size() - offset);
+      if (part > 0) { payload.push_back(fragment->subspan(offset, part)); }
+      offset += part;
+      needed -= part;
+      if (offset == fragment->size()) {
+        ++fragment;
+        offset = 0;
+      }
+    }
+
+    if (!SendFrame(payload, size, owner)) { return false; }
+    left -= size;
+  } while (left > 0);
+
+  return true;
+}
+
+bool StripedSender::Signal(std::int32_t signal)
+{
+  std::unique_lock lock(mutex_);
+  return SendFrame({}, signal);
+}
+
+namespace {
+// The trailer of a frame has to live as long as its payload.
+struct frame_owner {
+  std::shared_ptr<const void> payload;
+  striping::trailer trailer;
+};
+}  // namespace
+
+bool StripedSender::SendFrame(std::span<const std::span<const char>> payload,
+                              std::int32_t length,
+                              const std::shared_ptr<const void>& owner)
+{
+  if (owner_->errors || owner_->IsTerminated()) { return false; }
+
+  striping::trailer trailer{next_sequence_, length, 0};
+  std::shared_ptr<frame_owner> frame;
+  if (owner) { frame.reset(new frame_owner{owner, trailer}); }
+  const striping::trailer* sent_trailer = frame ? &frame->trailer : &trailer;
+  parts_.assign(payload.begin(), payload.end());
+  parts_.emplace_back(reinterpret_cast<const char*>(sent_trailer),
+                      sizeof(trailer));
+
+  BareosSocket* connection = NextConnection();
+  if (!connection || !connection->SendFragments(parts_, std::move(frame))) {
+    return Failed(connection);
+  }
+
+  next_sequence_ += 1;
+  if (owner_->UseBwlimit()) {
+    owner_->ControlBwlimit(std::max(length, 0) + sizeof(trailer));
+  }
+  return true;
+}
+
+/* Pick the first connection, starting after the one used last, that can
+ * take more data right now.  That way a connection that is slowed down by
+ * packet loss gets fewer frames than the others. */
+BareosSocket* StripedSender::NextConnection()
+{
+  const std::size_t count = connections_.size();
+
+#if defined(HAVE_POLL)
+  std::vector<struct pollfd> pfds(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    pfds[i].fd = connections_[(next_connection_ + i) % count]->fd_;
+    pfds[i].events = POLLOUT;
+    pfds[i].revents = 0;
+  }
+
+  for (;;) {
+    int status = poll(pfds.data(), count, 1000);
+    if (status > 0) { break; }
+    if (status < 0 && errno != EINTR) { break; } /* just take the next */
+    if (owner_->IsTerminated()) { return nullptr; }
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    if (pfds[i].revents != 0) {
+      std::size_t index = (next_connection_ + i) % count;
+      next_connection_ = (index + 1) % count;
+      return connections_[index];
+    }
+  }
+#endif
+
+  std::size_t index = next_connection_;
+  next_connection_ = (index + 1) % count;
+  return connections_[index];
+}
+
+bool StripedSender::Failed(BareosSocket* connection)
+{
+  owner_->errors++;
+  owner_->b_errno = connection && connection->b_errno ? connection->b_errno
+                                                      : EPIPE;
+  return false;
+}
+
+StripedReceiver::StripedReceiver(std::vector<BareosSocket*> connections,
+                                 std::size_t max_pending,
+                                 PipelineStats* stats)
+    : max_pending_{std::max<std::size_t>(max_pending, 1)}
+    , stats_{stats}
+    , connections_{std::move(connections)}
+{
+  running_ = connections_.size();
+  for (auto* connection : connections_) {
+    threads_.emplace_back(&StripedReceiver::Receive, this, connection);
+  }
+}
+
+StripedReceiver::~StripedReceiver() { Close(); }
+
+void StripedReceiver::Close()
+{
+  {
+    std::unique_lock lock(mutex_);
+    closed_ = true;
+  }
+  ready_.notify_all();
+  space_.notify_all();
+
+  for (auto& thread : threads_) {
+    if (thread.joinable()) { thread.join(); }
+  }
+}
+
+std::optional<StripedReceiver::message> StripedReceiver::Next()
+{
+  std::unique_lock lock(mutex_);
+  for (;;) {
+    if (auto found = pending_.find(next_sequence_); found != pending_.end()) {
+      message msg = std::move(found->second);
+      pending_.erase(found);
+      next_sequence_ += 1;
+      space_.notify_all();
+      return msg;
+    }
+
+    /* The missing frame can still arrive on a connection that is alive,
+     * unless one of them failed. */
+    if (failure_ && (failure_->status == BNET_ERROR || running_ == 0)) {
+      message msg;
+      msg.status = failure_->status;
+      msg.error = failure_->error;
+      return msg;
+    }
+
+    if (closed_) { return std::nullopt; }
+    ready_.wait(lock);
+  }
+}
+
+// Blocks while the message is too far ahead of the expected one
+bool StripedReceiver::Put(std::uint64_t sequence, message msg)
+{
+  std::unique_lock lock(mutex_);
+  space_.wait(lock, [this, sequence] {
+    return closed_ || sequence < next_sequence_ + max_pending_;
+  });
+  if (closed_) { return false; }
+
+  if (sequence < next_sequence_ || !pending_.emplace(sequence, std::move(msg))
+                                          .second) {
+    lock.unlock();
+    Fail(BNET_ERROR, T_("Duplicate frame on striped connection"));
+    return false;
+  }
+
+  ready_.notify_one();
+  return true;
+}
+
+void StripedReceiver::Fail(std::int32_t status, std::string error)
+{
+  {
+    std::unique_lock lock(mutex_);
+    if (!failure_ || failure_->status != BNET_ERROR) {
+      failure_.emplace();
+      failure_->status = status;
+      failure_->error = std::move(error);
+    }
+  }
+  ready_.notify_one();
+}
+
+void StripedReceiver::Receive(BareosSocket* connection)
+{
+  POOLMEM* save = connection->msg;
+
+  for (;;) {
+    {
+      std::unique_lock lock(mutex_);
+      if (closed_) { break; }
+    }
+
+    int res = connection->WaitData(0, 100'000);
+    if (res == BareosSocket::Timeout) { continue; }
+    if (res == BareosSocket::Error) {
+      Fail(BNET_ERROR, connection->bstrerror());
+      break;
+    }
+
+    message msg;
+    connection->msg = msg.data.addr();
+    auto start = PipelineStats::clock::now();
+    std::int32_t n = connection->recv();
+    if (stats_) {
+      stats_->Add(PipelineStage::kReceive, start, PipelineStats::clock::now(),
+                  std::max(n, 0));
+    }
+    // the buffer might have been relocated
+    msg.data.addr() = connection->msg;
+    connection->msg = nullptr;
+
+    if (n == BNET_HARDEOF) {
+      Fail(BNET_HARDEOF, connection->bstrerror());
+      break;
+    }
+    if (n < 0) {
+      Fail(BNET_ERROR, n == BNET_SIGNAL
+                           ? T_("Unexpected signal on striped connection")
+                           : connection->bstrerror());
+      break;
+    }
+
+    striping::trailer trailer;
+    if (static_cast<std::size_t>(n) < sizeof(trailer)) {
+      Fail(BNET_ERROR, T_("Short frame on striped connection"));
+      break;
+    }
+    std::size_t size = n - sizeof(trailer);
+    std::memcpy(&trailer, msg.data.c_str() + size, sizeof(trailer));
+
+    std::int32_t length = trailer.length;
+    if (length >= 0 && static_cast<std::size_t>(length) == size) {
+      msg.status = length;
+      msg.data.c_str()[size] = 0;
+    } else if (length < 0 && size == 0) {
+      msg.status = BNET_SIGNAL;
+      msg.signal = length;
+    } else {
+      Fail(BNET_ERROR, T_("Malformed frame on striped connection"));
+      break;
+    }
+
+    if (!Put(trailer.sequence, std::move(msg))) { break; }
+  }
+
+  connection->msg = save;
+
+  {
+    std::unique_lock lock(mutex_);
+    running_ -= 1;
+  }
+  ready_.notify_one();
+}
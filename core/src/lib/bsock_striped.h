@@ -0,0 +1,145 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_LIB_BSOCK_STRIPED_H_
+#define BAREOS_LIB_BSOCK_STRIPED_H_
+
+/* Striping spreads the data of one job over several connections, so a
+ * single TCP window does not limit the throughput on links with a high
+ * bandwidth delay product.
+ *
+ * Every message becomes one frame which goes out on whichever connection
+ * can take it first.  A frame is a normal bnet packet whose payload is
+ * followed by a trailer:
+ *
+ *   payload | sequence number (u64) | length or signal (i32) | unused (u32)
+ *
+ * The trailer is at the end, so the receiver can use the payload where it
+ * was read to.  A negative length is a signal like BareosSocket::signal()
+ * sends it.  The receiver puts the frames of all connections back into
+ * sequence order. */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/mem_pool.h"
+#include "lib/network_order.h"
+
+class BareosSocket;
+class PipelineStats;
+
+namespace striping {
+struct trailer {
+  network_order::network<std::uint64_t> sequence;
+  network_order::network<std::int32_t> length;
+  network_order::network<std::uint32_t> unused;
+};
+static_assert(sizeof(trailer) == 16);
+
+// a frame has to fit into a single packet of BareosSocketTCP
+inline constexpr std::size_t max_payload
+    = 1'000'000 - sizeof(std::int32_t) - sizeof(trailer);
+}  // namespace striping
+
+class StripedSender {
+ public:
+  /* The connections are not owned by the sender.  Errors, termination and
+   * the bandwidth limit are taken from and reported to the owner, i.e. the
+   * socket whose messages get striped. */
+  StripedSender(BareosSocket* owner, std::vector<BareosSocket*> connections);
+
+  // The owner of the fragments is handed on to the connections.
+  bool Send(std::span<const std::span<const char>> fragments,
+            std::shared_ptr<const void> owner = nullptr);
+  bool Signal(std::int32_t signal);
+
+  std::size_t NumConnections() const { return connections_.size(); }
+
+ private:
+  bool SendFrame(std::span<const std::span<const char>> fragments,
+                 std::int32_t length,
+                 const std::shared_ptr<const void>& owner = nullptr);
+  BareosSocket* NextConnection();
+  bool Failed(BareosSocket* connection);
+
+  std::mutex mutex_;
+  BareosSocket* owner_;
+  std::vector<BareosSocket*> connections_;
+  std::vector<std::span<const char>> parts_;
+  std::uint64_t next_sequence_{0};
+  std::size_t next_connection_{0};
+};
+
+class StripedReceiver {
+ public:
+  struct message {
+    /* Like the result of BareosSocket::recv(): the size of data, or
+     * BNET_SIGNAL, BNET_HARDEOF or BNET_ERROR. */
+    std::int32_t status{};
+    std::int32_t signal{}; /* if status == BNET_SIGNAL */
+    PoolMem data{PM_MESSAGE};
+    std::string error; /* if status < BNET_SIGNAL */
+  };
+
+  /* Starts one reader per connection.  At most max_pending messages are
+   * read ahead of the one that is expected next.  If stats are given, the
+   * time the readers spend reading frames is added to them. */
+  StripedReceiver(std::vector<BareosSocket*> connections,
+                  std::size_t max_pending,
+                  PipelineStats* stats = nullptr);
+  ~StripedReceiver();
+
+  // Returns the next message in sequence order, std::nullopt after Close()
+  std::optional<message> Next();
+  // Stops and joins the readers; the connections stay open
+  void Close();
+
+ private:
+  void Receive(BareosSocket* connection);
+  bool Put(std::uint64_t sequence, message msg);
+  void Fail(std::int32_t status, std::string error);
+
+  std::mutex mutex_;
+  std::condition_variable ready_; /* the consumer waits for data */
+  std::condition_variable space_; /* the readers wait for space */
+  std::map<std::uint64_t, message> pending_;
+  std::uint64_t next_sequence_{0};
+  std::size_t max_pending_;
+  PipelineStats* stats_;
+  std::size_t running_{0};
+  std::optional<message> failure_;
+  bool closed_{false};
+
+  std::vector<BareosSocket*> connections_;
+  // threads_ has to be last, the readers use everything else
+  std::vector<std::thread> threads_;
+};
+
+#endif  // BAREOS_LIB_BSOCK_STRIPED_H_
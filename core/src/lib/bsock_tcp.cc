@@ -37,12 +37,30 @@
 #include "lib/btimers.h"
 #include "lib/tls/openssl.h"
 #include "lib/bsock_tcp.h"
+#include "lib/bsock_striped.h"
 #include "lib/berrno.h"
 
+#include <algorithm>
+#include <climits>
+
 #ifdef HAVE_MSVC
 #  include "mstcpip.h"
 #endif
 
+#if !defined(HAVE_WIN32)
+#  include <poll.h>
+#  include <sys/uio.h>
+#endif
+
+#if defined(HAVE_LINUX_OS) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#  include <linux/errqueue.h>
+#  define HAVE_ZEROCOPY_SEND 1
+#endif
+
+#ifndef IOV_MAX
+#  define IOV_MAX 1024
+#endif
+
 #ifndef ENODATA /* not defined on BSD systems */
 #  define ENODATA EPIPE
 #endif
@@ -483,6 +501,284 @@ bool BareosSocketTCP::SendPacket(int32_t* hdr, int32_t pktsiz)
   return ok;
 }
 
+// Same as above, but the packet is given as a list of parts
+bool BareosSocketTCP::SendPacket(std::span<const std::span<const char>> parts,
+                                 int32_t pktsiz)
+{
+  if (parts.size() == 1) {
+    return SendPacket((int32_t*)parts[0].data(), pktsiz);
+  }
+
+  Enter(400);
+
+  int32_t rc;
+  bool ok = true;
+
+  out_msg_no++; /* increment message number */
+
+  timer_start = watchdog_time; /* start timer */
+  ClearTimedOut();
+
+  if (CanWriteVectored()) {
+    rc = WriteVectored(parts, pktsiz);
+  } else {
+    gather_buffer_.clear();
+    for (auto part : parts) {
+      gather_buffer_.insert(gather_buffer_.end(), part.begin(), part.end());
+    }
+    rc = write_nbytes(gather_buffer_.data(), pktsiz);
+  }
+  timer_start = 0; /* clear timer */
+  if (rc != pktsiz) {
+    ++errors;
+    if (errno == 0) {
+      b_errno = EIO;
+    } else {
+      b_errno = errno;
+    }
+    if (rc < 0) {
+      if (!suppress_error_msgs_) {
+        Qmsg5(jcr_, M_ERROR, 0,
+              T_("Write error sending %d bytes to %s:%s:%d: ERR=%s\n"),
+              pktsiz, who_, host_, port_, this->bstrerror());
+      }
+    } else {
+      Qmsg5(jcr_, M_ERROR, 0,
+            T_("Wrote %d bytes to %s:%s:%d, but only %d accepted.\n"), pktsiz,
+            who_, host_, port_, rc);
+    }
+    ok = false;
+  }
+
+  Leave(400);
+
+  return ok;
+}
+
+/*
+ * Spooling, network dumps and TLS done by the library need the packet in one
+ * buffer.  kTLS encrypts in the kernel, so there we can write the plain data
+ * directly to the socket.
+ */
+bool BareosSocketTCP::CanWriteVectored()
+{
+#if defined(HAVE_WIN32)
+  return false;
+#else
+  if (IsSpooling() || IsBnetDumpEnabled()) { return false; }
+  if (tls_conn && !KtlsForSend()) { return false; }
+  return true;
+#endif
+}
+
+/*
+ * Write all parts with as few system calls as possible.  Big writes
+ * are done with MSG_ZEROCOPY if requested, see WaitForZeroCopyCompletions()
+ * for what this means for the caller.
+ */
+int32_t BareosSocketTCP::WriteVectored(
+    [[maybe_unused]] std::span<const std::span<const char>> parts,
+    [[maybe_unused]] int32_t nbytes)
+{
+#if defined(HAVE_WIN32)
+  errno = ENOSYS;
+  return -1;
+#else
+  std::vector<struct iovec> iov;
+  iov.reserve(parts.size());
+  for (auto part : parts) {
+    if (part.empty()) { continue; }
+    iov.push_back({const_cast<char*>(part.data()), part.size()});
+  }
+
+  bool zerocopy = false;
+#  if defined(HAVE_ZEROCOPY_SEND)
+  zerocopy = zerocopy_ && nbytes >= zerocopy_min_size && EnableZeroCopy();
+#  endif
+
+  std::size_t first = 0;
+  int32_t nleft = nbytes;
+  while (nleft > 0) {
+    struct msghdr mh = {};
+    mh.msg_iov = &iov[first];
+    mh.msg_iovlen = std::min<std::size_t>(iov.size() - first, IOV_MAX);
+
+    int flags = 0;
+#  if defined(HAVE_ZEROCOPY_SEND)
+    if (zerocopy) { flags |= MSG_ZEROCOPY; }
+#  endif
+
+    errno = 0;
+    ssize_t nwritten = ::sendmsg(fd_, &mh, flags);
+    if (IsTimedOut() || IsTerminated()) { return -1; }
+
+    if (nwritten == -1) {
+      if (errno == EINTR) { continue; }
+      if (errno == EAGAIN) {
+        WaitForWritableFd(fd_, 1, false);
+        continue;
+      }
+      if (zerocopy && (errno == ENOBUFS || errno == EOPNOTSUPP)) {
+        BErrNo be;
+        if (errno == ENOBUFS && zerocopy_sent_ != zerocopy_completed_
+            && WaitForZeroCopyCompletions()) {
+          // too many pinned pages, retry once the old ones are released
+          continue;
+        }
+        // e.g. kTLS does not support MSG_ZEROCOPY
+        Dmsg1(250, "MSG_ZEROCOPY not usable on this socket: ERR=%s\n",
+              be.bstrerror());
+        if (be.code() == EOPNOTSUPP) { zerocopy_ = false; }
+        zerocopy = false;
+        continue;
+      }
+      return -1;
+    }
+    if (nwritten == 0) { return -1; }
+
+    if (zerocopy) { zerocopy_sent_++; }
+    nleft -= nwritten;
+    if (UseBwlimit()) { ControlBwlimit(nwritten); }
+
+    // skip what was written
+    while (first < iov.size() && (std::size_t)nwritten >= iov[first].iov_len) {
+      nwritten -= iov[first].iov_len;
+      first++;
+    }
+    if (nwritten > 0) {
+      iov[first].iov_base = (char*)iov[first].iov_base + nwritten;
+      iov[first].iov_len -= nwritten;
+    }
+  }
+
+  return nbytes;
+#endif
+}
+
+bool BareosSocketTCP::EnableZeroCopy()
+{
+#if defined(HAVE_ZEROCOPY_SEND)
+  if (zerocopy_enabled_) { return true; }
+
+  int one = 1;
+  if (setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) < 0) {
+    BErrNo be;
+    Dmsg1(250, "Cannot set SO_ZEROCOPY on socket: ERR=%s\n", be.bstrerror());
+    zerocopy_ = false;
+    return false;
+  }
+  zerocopy_enabled_ = true;
+  return true;
+#else
+  zerocopy_ = false;
+  return false;
+#endif
+}
+
+/*
+ * Read the completion notifications of MSG_ZEROCOPY writes from the error
+ * queue of the socket without blocking.
+ */
+bool BareosSocketTCP::ReadZeroCopyCompletions()
+{
+#if defined(HAVE_ZEROCOPY_SEND)
+  for (;;) {
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+    struct msghdr mh = {};
+    mh.msg_control = control;
+    mh.msg_controllen = sizeof(control);
+
+    if (::recvmsg(fd_, &mh, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+      if (errno == EINTR) { continue; }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&mh); cm;
+         cm = CMSG_NXTHDR(&mh, cm)) {
+      if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR)
+          && !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+        continue;
+      }
+      struct sock_extended_err serr;
+      memcpy(&serr, CMSG_DATA(cm), sizeof(serr));
+      if (serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr.ee_errno != 0) {
+        continue;
+      }
+
+      // notifications cover the range of writes [ee_info, ee_data]
+      zerocopy_completed_ += serr.ee_data - serr.ee_info + 1;
+
+      if (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+        /* The kernel had to copy the data anyway, e.g. on loopback, so
+         * we just pay for the notifications. */
+        Dmsg0(250, "MSG_ZEROCOPY data got copied, not using it anymore\n");
+        zerocopy_ = false;
+      }
+    }
+  }
+#else
+  return true;
+#endif
+}
+
+// Drop the owners of messages whose writes were all reported as completed.
+void BareosSocketTCP::ReleaseCompletedZeroCopyMessages()
+{
+  while (!zerocopy_in_flight_.empty()) {
+    auto& message = zerocopy_in_flight_.front();
+    // the counters wrap around
+    if (static_cast<int32_t>(zerocopy_completed_ - message.last_write) < 0) {
+      break;
+    }
+    zerocopy_bytes_in_flight_ -= message.size;
+    zerocopy_in_flight_.pop_front();
+  }
+}
+
+/*
+ * The kernel sends the data of MSG_ZEROCOPY writes directly from the
+ * caller's buffers, so they must not be changed before it reports that it
+ * is done with them.  Waits until no more than max_in_flight bytes of
+ * messages kept by SendFragments() are outstanding, or for all writes if
+ * max_in_flight is 0.
+ */
+bool BareosSocketTCP::WaitForZeroCopyCompletions(
+    [[maybe_unused]] std::size_t max_in_flight)
+{
+#if defined(HAVE_ZEROCOPY_SEND)
+  for (;;) {
+    uint32_t completed = zerocopy_completed_;
+
+    if (!ReadZeroCopyCompletions()) { return false; }
+    ReleaseCompletedZeroCopyMessages();
+    if (max_in_flight == 0 ? zerocopy_completed_ == zerocopy_sent_
+                           : zerocopy_bytes_in_flight_ <= max_in_flight) {
+      break;
+    }
+    if (zerocopy_completed_ != completed) { continue; }
+    if (IsTimedOut() || IsTerminated()) { return false; }
+
+    // POLLERR is always reported, so there is no need to ask for it
+    struct pollfd pfd = {};
+    pfd.fd = fd_;
+    int status = poll(&pfd, 1, 1000);
+    if (status < 0 && errno != EINTR) { return false; }
+    if (status > 0 && (pfd.revents & POLLERR)) {
+      int error = 0;
+      socklen_t len = sizeof(error);
+      /* The error queue may be empty because of a pending socket error,
+       * which we would otherwise poll for forever. */
+      if (getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &len) == 0
+          && error != 0) {
+        errno = error;
+        return false;
+      }
+    }
+  }
+#endif
+  return true;
+}
+
 bool BareosSocketTCP::KtlsForSend()
 {
   if (!tls_conn) { return false; }
@@ -519,6 +815,12 @@ bool BareosSocketTCP::send()
    * just before msg, So we can store there */
   int32_t* hdr = (int32_t*)(msg - (int)header_length);
 
+  if (striped_sender_) {
+    if (o_msglen <= 0) { return striped_sender_->Signal(o_msglen); }
+    std::span<const char> message{msg, static_cast<std::size_t>(o_msglen)};
+    return striped_sender_->Send({&message, 1});
+  }
+
   if (errors) {
     if (!suppress_error_msgs_) {
       Qmsg4(jcr_, M_ERROR, 0, T_("Socket has errors=%d on call to %s:%s:%d\n"),
@@ -570,6 +872,112 @@ bool BareosSocketTCP::send()
   return ok;
 }
 
+/*
+ * Send the concatenation of the fragments as one message, split into
+ * packets just like send() does.  Headers and payload get written with
+ * one writev-style system call per packet where possible.
+ *
+ * Returns: false on failure
+ *          true  on success
+ */
+bool BareosSocketTCP::SendFragments(
+    std::span<const std::span<const char>> fragments,
+    std::shared_ptr<const void> owner)
+{
+  std::size_t total = 0;
+  for (auto fragment : fragments) { total += fragment.size(); }
+  ASSERT(total <= INT32_MAX);
+
+  if (striped_sender_) {
+    return striped_sender_->Send(fragments, std::move(owner));
+  }
+
+  if (errors) {
+    if (!suppress_error_msgs_) {
+      Qmsg4(jcr_, M_ERROR, 0, T_("Socket has errors=%d on call to %s:%s:%d\n"),
+            errors.load(), who_, host_, port_);
+    }
+    return false;
+  }
+
+  if (IsTerminated()) {
+    if (!suppress_error_msgs_) {
+      Qmsg4(jcr_, M_ERROR, 0,
+            T_("Socket is terminated=%d on call to %s:%s:%d\n"), IsTerminated(),
+            who_, host_, port_);
+    }
+    return false;
+  }
+
+  /* With MSG_ZEROCOPY the kernel may still read the headers after a packet
+   * was written, so every packet needs its own. */
+  std::size_t num_packets
+      = std::max<std::size_t>(1, (total + max_message_len - 1)
+                                     / max_message_len);
+  std::vector<int32_t> headers(num_packets);
+  std::vector<std::span<const char>> parts;
+
+  LockMutex();
+
+  // pick up what completed in the meantime without waiting for it
+  if (!zerocopy_in_flight_.empty()) {
+    ReadZeroCopyCompletions();
+    ReleaseCompletedZeroCopyMessages();
+  }
+  uint32_t sent_before = zerocopy_sent_;
+
+  bool ok = true;
+  auto fragment = fragments.begin();
+  std::size_t offset = 0; /* already sent part of *fragment */
+  std::size_t left = total;
+  for (auto& hdr : headers) {
+    int32_t packet_msglen = std::min<std::size_t>(left, max_message_len);
+    hdr = htonl(packet_msglen);
+
+    parts.clear();
+    parts.emplace_back((const char*)&hdr, header_length);
+    for (std::size_t needed = packet_msglen; needed > 0;) {
+      std::size_t size = std::min(needed, fragment->size() - offset);
+      if (size > 0) { parts.push_back(fragment->subspan(offset, size)); }
+      offset += size;
+      needed -= size;
+      if (offset == fragment->size()) {
+        ++fragment;
+        offset = 0;
+      }
+    }
+
+    ok = SendPacket(parts, header_length + packet_msglen);
+    if (!ok) { break; }
+    left -= packet_msglen;
+  }
+
+  /* Messages with an owner stay in flight, the others have to be done before
+   * we return.  Only when too much data is pinned do we wait for it. */
+  std::size_t max_in_flight = 0;
+  if (zerocopy_sent_ != sent_before && owner) {
+    zerocopy_in_flight_.push_back(ZeroCopyMessage{
+        zerocopy_sent_, total, std::move(owner), std::move(headers)});
+    zerocopy_bytes_in_flight_ += total;
+    max_in_flight = zerocopy_max_in_flight;
+  }
+
+  if (!WaitForZeroCopyCompletions(max_in_flight)) {
+    if (ok) {
+      ++errors;
+      b_errno = errno ? errno : EIO;
+      Qmsg4(jcr_, M_ERROR, 0,
+            T_("Error waiting for zero copy send to %s:%s:%d: ERR=%s\n"),
+            who_, host_, port_, this->bstrerror());
+    }
+    ok = false;
+  }
+
+  UnlockMutex();
+
+  return ok;
+}
+
 /*
  * Receive a message from the other end. Each message consists of
  * two packets. The first is a header that contains the size
@@ -976,6 +1384,10 @@ void BareosSocketTCP::close()
     if (!cloned_) {
       if (IsTimedOut()) { shutdown(fd_, SHUT_RDWR); }
     }
+    // the kernel may still read the data of messages in flight
+    if (!zerocopy_in_flight_.empty()) { WaitForZeroCopyCompletions(); }
+    zerocopy_in_flight_.clear();
+    zerocopy_bytes_in_flight_ = 0;
     socketClose(fd_);
     fd_ = -1;
   }
@@ -24,6 +24,11 @@
 
 #include "lib/bsock.h"
 
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
 class BareosSocketTCP : public BareosSocket {
  public:
   /* the header of a Bareos packet is 32 bit long.
@@ -38,6 +43,27 @@ class BareosSocketTCP : public BareosSocket {
    * so stick to this value to be compatible with older version of bconsole. */
   static const int32_t max_packet_size = 1000000;
   static const int32_t max_message_len = max_packet_size - header_length;
+  /* MSG_ZEROCOPY has to pin the pages and wait for the completion, which
+   * only pays off for larger writes. */
+  static const int32_t zerocopy_min_size = 16 * 1024;
+  /* how much data of MSG_ZEROCOPY writes may wait for its completion before
+   * SendFragments() blocks */
+  static const std::size_t zerocopy_max_in_flight = 16 * 1024 * 1024;
+
+  /* A message sent with MSG_ZEROCOPY whose data the kernel may still read */
+  struct ZeroCopyMessage {
+    uint32_t last_write;               /* zerocopy_sent_ after the message */
+    std::size_t size;
+    std::shared_ptr<const void> owner; /* keeps the data alive */
+    std::vector<int32_t> headers;
+  };
+
+  uint32_t zerocopy_sent_{0};       /* writes done with MSG_ZEROCOPY */
+  uint32_t zerocopy_completed_{0};  /* of those, reported as completed */
+  bool zerocopy_enabled_{false};    /* SO_ZEROCOPY is set on fd_ */
+  std::deque<ZeroCopyMessage> zerocopy_in_flight_;
+  std::size_t zerocopy_bytes_in_flight_{0};
+  std::vector<char> gather_buffer_; /* for sockets without writev() */
 
   /* methods -- in bsock_tcp.c */
   void FinInit(JobControlRecord* jcr,
@@ -59,6 +85,15 @@ class BareosSocketTCP : public BareosSocket {
                     int keepalive_start,
                     int keepalive_interval);
   bool SendPacket(int32_t* hdr, int32_t pktsiz);
+  bool SendPacket(std::span<const std::span<const char>> parts,
+                  int32_t pktsiz);
+  bool CanWriteVectored();
+  int32_t WriteVectored(std::span<const std::span<const char>> parts,
+                        int32_t nbytes);
+  bool EnableZeroCopy();
+  bool ReadZeroCopyCompletions();
+  void ReleaseCompletedZeroCopyMessages();
+  bool WaitForZeroCopyCompletions(std::size_t max_in_flight = 0);
   void DumpNetworkMessageToFile(const char* ptr, int nbytes);
 
  public:
@@ -78,6 +113,8 @@ class BareosSocketTCP : public BareosSocket {
                bool verbose) override;
   int32_t recv() override;
   bool send() override;
+  bool SendFragments(std::span<const std::span<const char>> fragments,
+                     std::shared_ptr<const void> owner = nullptr) override;
   bool fsend(const char*, ...) PRINTF_LIKE(2, 3);
   int32_t read_nbytes(char* ptr, int32_t nbytes) override;
   int32_t write_nbytes(char* ptr, int32_t nbytes) override;
@@ -0,0 +1,154 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "include/bareos.h"
+#include "lib/chunk_manifest.h"
+#include "lib/crypto.h"
+#include "lib/fastcdc.h"
+#include "lib/network_order.h"
+
+#include <cstring>
+
+namespace chunk_manifest {
+namespace {
+using net_u32 = network_order::network<std::uint32_t>;
+
+constexpr std::size_t entry_size = sizeof(net_u32) + fingerprint_size;
+}  // namespace
+
+std::optional<std::vector<chunk>> Build(const FastCdcChunker& chunker,
+                                        const char* data,
+                                        std::size_t size)
+{
+  std::vector<chunk> chunks;
+  chunks.reserve(size / chunker.AverageSize() + 1);
+
+  while (size > 0) {
+    std::size_t cut = chunker.NextCut(data, size);
+
+    DIGEST* digest = crypto_digest_new(nullptr, CRYPTO_DIGEST_SHA256);
+    if (!digest) { return std::nullopt; }
+    chunk& c = chunks.emplace_back();
+    c.size = static_cast<std::uint32_t>(cut);
+    std::uint32_t digest_len = c.digest.size();
+    bool ok = digest->Update(reinterpret_cast<const std::uint8_t*>(data), cut)
+              && digest->Finalize(c.digest.data(), &digest_len);
+    CryptoDigestFree(digest);
+    if (!ok || digest_len != c.digest.size()) { return std::nullopt; }
+
+    data += cut;
+    size -= cut;
+  }
+
+  return chunks;
+}
+
+std::size_t Encode(const batch& records, POOLMEM*& out)
+{
+  std::size_t size = sizeof(net_u32);
+  for (auto& chunks : records) {
+    size += sizeof(net_u32) + chunks.size() * entry_size;
+  }
+  out = CheckPoolMemorySize(out, size);
+
+  char* ptr = out;
+  auto put_u32 = [&ptr](std::size_t value) {
+    net_u32 n{static_cast<std::uint32_t>(value)};
+    std::memcpy(ptr, &n, sizeof(n));
+    ptr += sizeof(n);
+  };
+
+  put_u32(records.size());
+  for (auto& chunks : records) {
+    put_u32(chunks.size());
+    for (auto& c : chunks) {
+      put_u32(c.size);
+      std::memcpy(ptr, c.digest.data(), c.digest.size());
+      ptr += c.digest.size();
+    }
+  }
+
+  return size;
+}
+
+std::optional<batch> Decode(const char* data, std::size_t size)
+{
+  auto get_u32 = [&data, &size]() -> std::optional<std::uint32_t> {
+    net_u32 n;
+    if (size < sizeof(n)) { return std::nullopt; }
+    std::memcpy(&n, data, sizeof(n));
+    data += sizeof(n);
+    size -= sizeof(n);
+    return n.load();
+  };
+
+  auto record_count = get_u32();
+  // every record needs at least its chunk count
+  if (!record_count || size / sizeof(net_u32) < *record_count) {
+    return std::nullopt;
+  }
+
+  batch records(*record_count);
+  for (auto& chunks : records) {
+    auto count = get_u32();
+    if (!count || size / entry_size < *count) { return std::nullopt; }
+
+    chunks.resize(*count);
+    for (auto& c : chunks) {
+      c.size = *get_u32();
+      std::memcpy(c.digest.data(), data, c.digest.size());
+      data += c.digest.size();
+      size -= c.digest.size();
+    }
+  }
+
+  if (size != 0) { return std::nullopt; }
+
+  return records;
+}
+
+std::size_t EncodeKnown(const std::vector<bool>& known, POOLMEM*& out)
+{
+  std::size_t size = (known.size() + 7) / 8;
+  out = CheckPoolMemorySize(out, size);
+  std::memset(out, 0, size);
+
+  for (std::size_t i = 0; i < known.size(); ++i) {
+    if (known[i]) { out[i / 8] |= static_cast<char>(1 << (i % 8)); }
+  }
+
+  return size;
+}
+
+std::optional<std::vector<bool>> DecodeKnown(const char* data,
+                                             std::size_t size,
+                                             std::size_t count)
+{
+  if (size != (count + 7) / 8) { return std::nullopt; }
+
+  std::vector<bool> known(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    known[i] = (static_cast<unsigned char>(data[i / 8]) >> (i % 8)) & 1;
+  }
+
+  return known;
+}
+}  // namespace chunk_manifest
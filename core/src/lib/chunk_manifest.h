@@ -0,0 +1,83 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+// Wire format used for client side deduplication: instead of data records
+// the file daemon sends the list of their chunks (the manifest), the storage
+// daemon answers with the set of chunks it already knows and the file daemon
+// then only sends the data of the remaining chunks.
+//
+// A manifest covers a batch of consecutive records of one data stream.  The
+// file daemon sends the next manifest before it waits for the answer to the
+// previous one, so the round trip is not paid once per record:
+//
+//   fd: BNET_CHUNK_MANIFEST, manifest
+//   sd: known set
+//   fd: BNET_CHUNK_DATA, data (left out if no chunk is missing)
+//
+//   manifest:  u32 records, records * { u32 count, count * chunk }
+//   chunk:     u32 size, u8 sha256[32]
+//   known set: one bit per chunk of the batch (lsb first), set if known
+//   data:      the missing chunks, concatenated in manifest order
+//
+// BNET_CHUNK_DATA always refers to the oldest unanswered manifest.  All
+// integers are in network byte order.
+
+#ifndef BAREOS_LIB_CHUNK_MANIFEST_H_
+#define BAREOS_LIB_CHUNK_MANIFEST_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "lib/mem_pool.h"
+
+class FastCdcChunker;
+
+namespace chunk_manifest {
+inline constexpr std::size_t fingerprint_size = 32;  // sha256
+using fingerprint = std::array<std::uint8_t, fingerprint_size>;
+
+struct chunk {
+  std::uint32_t size;
+  fingerprint digest;
+};
+
+// the chunks of every record of a batch
+using batch = std::vector<std::vector<chunk>>;
+
+// Cuts data into chunks and fingerprints them.  Returns std::nullopt if
+// no sha256 implementation is available.
+std::optional<std::vector<chunk>> Build(const FastCdcChunker& chunker,
+                                        const char* data,
+                                        std::size_t size);
+
+// Both encoders resize out as needed and return the encoded size.
+std::size_t Encode(const batch& records, POOLMEM*& out);
+std::optional<batch> Decode(const char* data, std::size_t size);
+
+std::size_t EncodeKnown(const std::vector<bool>& known, POOLMEM*& out);
+std::optional<std::vector<bool>> DecodeKnown(const char* data,
+                                             std::size_t size,
+                                             std::size_t count);
+}  // namespace chunk_manifest
+
+#endif  // BAREOS_LIB_CHUNK_MANIFEST_H_
@@ -0,0 +1,112 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "lib/fastcdc.h"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// The gear table needs to be the same everywhere as chunk boundaries (and
+// therefore fingerprints) have to be stable across daemons and versions.
+// We generate it with splitmix64 from a fixed seed.
+constexpr std::array<std::uint64_t, 256> MakeGearTable()
+{
+  std::array<std::uint64_t, 256> table{};
+  std::uint64_t state = 0x6261'7265'6f73'4344;  // "bareosCD"
+  for (auto& entry : table) {
+    state += 0x9e37'79b9'7f4a'7c15;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xbf58'476d'1ce4'e5b9;
+    z = (z ^ (z >> 27)) * 0x94d0'49bb'1331'11eb;
+    entry = z ^ (z >> 31);
+  }
+  return table;
+}
+
+constexpr auto gear = MakeGearTable();
+
+constexpr bool IsPowerOfTwo(std::size_t x) { return x && !(x & (x - 1)); }
+
+constexpr unsigned Log2(std::size_t x)
+{
+  unsigned bits = 0;
+  while (x >>= 1) { bits += 1; }
+  return bits;
+}
+
+// The gear hash shifts left, so the upper bits depend on the most bytes.
+constexpr std::uint64_t HighMask(unsigned bits)
+{
+  return ((std::uint64_t{1} << bits) - 1) << (64 - bits);
+}
+}  // namespace
+
+FastCdcChunker::FastCdcChunker(std::size_t avg_size,
+                               std::size_t min_size,
+                               std::size_t max_size)
+    : min_size_{min_size ? min_size : avg_size / 4}
+    , avg_size_{avg_size}
+    , max_size_{max_size ? max_size : avg_size * 4}
+{
+  if (!IsPowerOfTwo(avg_size_) || avg_size_ < 256
+      || avg_size_ > 64 * 1024 * 1024) {
+    throw std::invalid_argument("bad average chunk size "
+                                + std::to_string(avg_size_)
+                                + " (needs to be a power of two in the "
+                                  "range [256, 64M]).");
+  }
+  if (!(min_size_ <= avg_size_ && avg_size_ <= max_size_)) {
+    throw std::invalid_argument(
+        "chunk sizes need to fulfill min <= avg <= max (min = "
+        + std::to_string(min_size_) + ", avg = " + std::to_string(avg_size_)
+        + ", max = " + std::to_string(max_size_) + ").");
+  }
+
+  // normalized chunking: make cuts before the average size less and
+  // cuts after the average size more likely.
+  unsigned bits = Log2(avg_size_);
+  mask_small_ = HighMask(bits + 1);
+  mask_large_ = HighMask(bits - 1);
+}
+
+std::size_t FastCdcChunker::NextCut(const void* data, std::size_t size) const
+{
+  if (size <= min_size_) { return size; }
+
+  auto* src = static_cast<const std::uint8_t*>(data);
+  std::size_t end = size < max_size_ ? size : max_size_;
+  std::size_t normal = end < avg_size_ ? end : avg_size_;
+
+  std::uint64_t fp = 0;
+  std::size_t i = min_size_;
+  for (; i < normal; ++i) {
+    fp = (fp << 1) + gear[src[i]];
+    if (!(fp & mask_small_)) { return i + 1; }
+  }
+  for (; i < end; ++i) {
+    fp = (fp << 1) + gear[src[i]];
+    if (!(fp & mask_large_)) { return i + 1; }
+  }
+
+  return end;
+}
@@ -0,0 +1,56 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+// Content defined chunking based on the FastCDC algorithm (gear hash with
+// normalized chunking).
+
+#ifndef BAREOS_LIB_FASTCDC_H_
+#define BAREOS_LIB_FASTCDC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+class FastCdcChunker {
+ public:
+  static constexpr std::size_t kDefaultAverageSize = 16 * 1024;
+
+  // min/max default to avg/4 and avg*4 if they are 0.
+  // Throws std::invalid_argument if the sizes are not usable.
+  explicit FastCdcChunker(std::size_t avg_size = kDefaultAverageSize,
+                          std::size_t min_size = 0,
+                          std::size_t max_size = 0);
+
+  // Returns the length of the first chunk inside [data, data + size).
+  // The result is always > 0 if size > 0 and never bigger than size.
+  std::size_t NextCut(const void* data, std::size_t size) const;
+
+  std::size_t MinSize() const { return min_size_; }
+  std::size_t AverageSize() const { return avg_size_; }
+  std::size_t MaxSize() const { return max_size_; }
+
+ private:
+  std::size_t min_size_;
+  std::size_t avg_size_;
+  std::size_t max_size_;
+  std::uint64_t mask_small_;
+  std::uint64_t mask_large_;
+};
+
+#endif  // BAREOS_LIB_FASTCDC_H_
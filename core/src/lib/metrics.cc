@@ -0,0 +1,297 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Lock-free metrics and their OpenMetrics text representation
+ */
+
+#include "lib/metrics.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace metrics {
+
+namespace {
+void AppendEscaped(std::string& out, std::string_view value)
+{
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+}
+
+std::string FormatDouble(double value)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return buffer;
+}
+
+std::string FormatBound(double value)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%g", value);
+  return buffer;
+}
+}  // namespace
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_{std::move(bounds)}
+    , buckets_{new std::atomic<std::uint64_t>[bounds_.size() + 1]}
+{
+  std::sort(bounds_.begin(), bounds_.end());
+  for (std::size_t i = 0; i <= bounds_.size(); ++i) { buckets_[i] = 0; }
+}
+
+void Histogram::Observe(double value)
+{
+  auto bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value)
+                - bounds_.begin();
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+  double sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+auto Histogram::Take() const -> Snapshot
+{
+  Snapshot snap;
+  snap.cumulative.reserve(bounds_.size() + 1);
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i <= bounds_.size(); ++i) {
+    total += buckets_[i].load(std::memory_order_relaxed);
+    snap.cumulative.push_back(total);
+  }
+  snap.sum = sum_.load(std::memory_order_relaxed);
+  return snap;
+}
+
+std::vector<double> LatencyBuckets()
+{
+  return {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+          0.05,   0.1,     0.25,   0.5,   1,      2.5,   5,     10};
+}
+
+std::vector<double> WaitBuckets()
+{
+  return {1, 5, 10, 30, 60, 300, 600, 1800, 3600, 7200, 21600, 86400};
+}
+
+void Writer::Family(std::string_view name,
+                    std::string_view type,
+                    std::string_view help)
+{
+  out_ += "# TYPE ";
+  out_ += name;
+  out_ += ' ';
+  out_ += type;
+  out_ += "\n# HELP ";
+  out_ += name;
+  out_ += ' ';
+  AppendEscaped(out_, help);
+  out_ += '\n';
+}
+
+void Writer::SampleName(std::string_view name, const Labels& labels)
+{
+  out_ += name;
+  if (!labels.empty()) {
+    out_ += '{';
+    bool first = true;
+    for (auto& [key, value] : labels) {
+      if (!first) { out_ += ','; }
+      first = false;
+      out_ += key;
+      out_ += "=\"";
+      AppendEscaped(out_, value);
+      out_ += '"';
+    }
+    out_ += '}';
+  }
+  out_ += ' ';
+}
+
+void Writer::Sample(std::string_view name, const Labels& labels, double value)
+{
+  SampleName(name, labels);
+  out_ += FormatDouble(value);
+  out_ += '\n';
+}
+
+void Writer::Sample(std::string_view name,
+                    const Labels& labels,
+                    std::uint64_t value)
+{
+  SampleName(name, labels);
+  out_ += std::to_string(value);
+  out_ += '\n';
+}
+
+void Writer::Sample(std::string_view name,
+                    const Labels& labels,
+                    std::int64_t value)
+{
+  SampleName(name, labels);
+  out_ += std::to_string(value);
+  out_ += '\n';
+}
+
+std::string Writer::Finish()
+{
+  out_ += "# EOF\n";
+  return std::move(out_);
+}
+
+auto Registry::GetFamily(std::string_view name,
+                         std::string_view help,
+                         Type type) -> Family&
+{
+  auto found = families_.find(name);
+  if (found == families_.end()) {
+    found = families_.emplace(std::string{name}, Family{}).first;
+    found->second.type = type;
+    found->second.help = help;
+  }
+  return found->second;
+}
+
+Counter& Registry::GetCounter(std::string_view name,
+                              std::string_view help,
+                              const Labels& labels)
+{
+  std::unique_lock lock(mutex_);
+  auto& family = GetFamily(name, help, Type::kCounter);
+  auto& counter = family.counters[labels];
+  if (!counter) { counter = std::make_unique<Counter>(); }
+  return *counter;
+}
+
+Gauge& Registry::GetGauge(std::string_view name,
+                          std::string_view help,
+                          const Labels& labels)
+{
+  std::unique_lock lock(mutex_);
+  auto& family = GetFamily(name, help, Type::kGauge);
+  auto& gauge = family.gauges[labels];
+  if (!gauge) { gauge = std::make_unique<Gauge>(); }
+  return *gauge;
+}
+
+Histogram& Registry::GetHistogram(std::string_view name,
+                                  std::string_view help,
+                                  const Labels& labels,
+                                  std::vector<double> bounds)
+{
+  std::unique_lock lock(mutex_);
+  auto& family = GetFamily(name, help, Type::kHistogram);
+  auto& histogram = family.histograms[labels];
+  if (!histogram) {
+    histogram = std::make_unique<Histogram>(std::move(bounds));
+  }
+  return *histogram;
+}
+
+std::size_t Registry::AddCollector(Collector collector)
+{
+  std::unique_lock lock(collector_mutex_);
+  auto id = next_collector_++;
+  collectors_.emplace(id, std::move(collector));
+  return id;
+}
+
+void Registry::RemoveCollector(std::size_t id)
+{
+  std::unique_lock lock(collector_mutex_);
+  collectors_.erase(id);
+}
+
+std::string Registry::Render()
+{
+  Writer writer;
+
+  {
+    std::unique_lock lock(mutex_);
+    for (auto& [name, family] : families_) {
+      switch (family.type) {
+        case Type::kCounter: {
+          writer.Family(name, "counter", family.help);
+          std::string sample = name + "_total";
+          for (auto& [labels, counter] : family.counters) {
+            writer.Sample(sample, labels, counter->Value());
+          }
+        } break;
+        case Type::kGauge: {
+          writer.Family(name, "gauge", family.help);
+          for (auto& [labels, gauge] : family.gauges) {
+            writer.Sample(name, labels, gauge->Value());
+          }
+        } break;
+        case Type::kHistogram: {
+          writer.Family(name, "histogram", family.help);
+          std::string bucket = name + "_bucket";
+          for (auto& [labels, histogram] : family.histograms) {
+            auto snap = histogram->Take();
+            auto& bounds = histogram->Bounds();
+            Labels with_le = labels;
+            with_le.emplace_back("le", "");
+            for (std::size_t i = 0; i < snap.cumulative.size(); ++i) {
+              with_le.back().second
+                  = i < bounds.size() ? FormatBound(bounds[i]) : "+Inf";
+              writer.Sample(bucket, with_le, snap.cumulative[i]);
+            }
+            writer.Sample(name + "_count", labels, snap.cumulative.back());
+            writer.Sample(name + "_sum", labels, snap.sum);
+          }
+        } break;
+      }
+    }
+  }
+
+  {
+    std::unique_lock lock(collector_mutex_);
+    for (auto& [id, collector] : collectors_) { collector(writer); }
+  }
+
+  return writer.Finish();
+}
+
+Registry& Global()
+{
+  static Registry registry;
+  return registry;
+}
+
+}  // namespace metrics
@@ -0,0 +1,182 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_LIB_METRICS_H_
+#define BAREOS_LIB_METRICS_H_
+
+/* Process wide metrics in the OpenMetrics text format.
+ *
+ * Counters, gauges and histograms are updated with relaxed atomics only, so
+ * the code paths that update them never wait for a scrape.  Looking up a
+ * metric in the registry takes a lock; code on hot paths looks its metrics
+ * up once and keeps the reference, which stays valid for the lifetime of the
+ * process.
+ *
+ * Values that already exist elsewhere (e.g. the byte counters of running
+ * jobs) are not copied into the registry.  Instead a collector is registered
+ * which reads them whenever the metrics are rendered. */
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+ public:
+  void Add(std::uint64_t amount = 1)
+  {
+    value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+  std::uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<std::uint64_t> value_{0};
+};
+
+class Gauge {
+ public:
+  void Set(std::int64_t value)
+  {
+    value_.store(value, std::memory_order_relaxed);
+  }
+  void Add(std::int64_t amount)
+  {
+    value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+  std::int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<std::int64_t> value_{0};
+};
+
+class Histogram {
+ public:
+  // bounds are the (inclusive) upper bounds of the buckets in ascending
+  // order; the +Inf bucket is added implicitly.
+  explicit Histogram(std::vector<double> bounds);
+
+  void Observe(double value);
+
+  struct Snapshot {
+    std::vector<std::uint64_t> cumulative; /* one per bound, then +Inf */
+    double sum{0};
+  };
+  Snapshot Take() const;
+  const std::vector<double>& Bounds() const { return bounds_; }
+
+ private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+  std::atomic<double> sum_{0};
+};
+
+// Bucket bounds in seconds suited for I/O and query latencies.
+std::vector<double> LatencyBuckets();
+// Bucket bounds in seconds suited for waits of jobs (seconds to a day).
+std::vector<double> WaitBuckets();
+
+// Builds the text of one scrape.  Samples of a family have to follow the
+// Family() call that introduces it.
+class Writer {
+ public:
+  void Family(std::string_view name,
+              std::string_view type,
+              std::string_view help);
+  void Sample(std::string_view name, const Labels& labels, double value);
+  void Sample(std::string_view name,
+              const Labels& labels,
+              std::uint64_t value);
+  void Sample(std::string_view name, const Labels& labels, std::int64_t value);
+
+  std::string Finish();
+
+ private:
+  void SampleName(std::string_view name, const Labels& labels);
+
+  std::string out_;
+};
+
+class Registry {
+ public:
+  using Collector = std::function<void(Writer& writer)>;
+
+  // Returns the metric of the family name with these labels, creating it
+  // (and the family) if necessary.  The type of a family is fixed by its
+  // first use.
+  Counter& GetCounter(std::string_view name,
+                      std::string_view help,
+                      const Labels& labels = {});
+  Gauge& GetGauge(std::string_view name,
+                  std::string_view help,
+                  const Labels& labels = {});
+  Histogram& GetHistogram(std::string_view name,
+                          std::string_view help,
+                          const Labels& labels = {},
+                          std::vector<double> bounds = LatencyBuckets());
+
+  // Collectors are called (in order of registration) on every scrape.
+  std::size_t AddCollector(Collector collector);
+  void RemoveCollector(std::size_t id);
+
+  std::string Render();
+
+ private:
+  enum class Type
+  {
+    kCounter,
+    kGauge,
+    kHistogram
+  };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<Labels, std::unique_ptr<Counter>> counters;
+    std::map<Labels, std::unique_ptr<Gauge>> gauges;
+    std::map<Labels, std::unique_ptr<Histogram>> histograms;
+  };
+
+  Family& GetFamily(std::string_view name, std::string_view help, Type type);
+
+  std::mutex mutex_;
+  std::map<std::string, Family, std::less<>> families_;
+  // separate, so that collectors may look up metrics themselves
+  std::mutex collector_mutex_;
+  std::map<std::size_t, Collector> collectors_;
+  std::size_t next_collector_{0};
+};
+
+// The registry of this process.
+Registry& Global();
+
+}  // namespace metrics
+
+#endif  // BAREOS_LIB_METRICS_H_
@@ -0,0 +1,244 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Minimal HTTP listener serving the metrics of a daemon
+ */
+
+#include "include/bareos.h"
+#include "include/jcr.h"
+#include "lib/address_conf.h"
+#include "lib/berrno.h"
+#include "lib/bnet_server_tcp.h"
+#include "lib/bsock_tcp.h"
+#include "lib/metrics.h"
+#include "lib/metrics_server.h"
+#include "lib/thread_list.h"
+#include "lib/thread_specific_data.h"
+
+#include <string>
+#include <vector>
+
+static ThreadList thread_list;
+static pthread_t metrics_server_tid;
+static bool server_running = false;
+// not the one of the other socket servers, which keep running
+static std::atomic<bool> quit{false};
+static std::atomic<BnetServerState> server_state{BnetServerState::kUndefined};
+static std::size_t job_collector = 0;
+
+static constexpr std::size_t max_request_size = 8192;
+
+static std::string ReadRequestHead(int fd)
+{
+  struct timeval timeout{.tv_sec = 5, .tv_usec = 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (sockopt_val_t)&timeout,
+             sizeof(timeout));
+
+  std::string request;
+  char buffer[1024];
+  while (request.size() < max_request_size
+         && request.find("\r\n\r\n") == std::string::npos) {
+    auto len = recv(fd, buffer, sizeof(buffer), 0);
+    if (len <= 0) { break; }
+    request.append(buffer, len);
+  }
+  return request;
+}
+
+static void SendAll(int fd, const std::string& data)
+{
+  std::size_t sent = 0;
+  while (sent < data.size()) {
+    auto len = send(fd, data.data() + sent, data.size() - sent, 0);
+    if (len < 0 && errno == EINTR) { continue; }
+    if (len <= 0) { break; }
+    sent += len;
+  }
+}
+
+static std::string Response(const char* status,
+                            const char* content_type,
+                            const std::string& body)
+{
+  std::string response = "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: ";
+  response += content_type;
+  response += "\r\nContent-Length: " + std::to_string(body.size());
+  response += "\r\nConnection: close\r\n\r\n";
+  return response + body;
+}
+
+static void* HandleMetricsRequest(ConfigurationParser*, void* arg)
+{
+  auto* bs = static_cast<BareosSocket*>(arg);
+
+  std::string request = ReadRequestHead(bs->fd_);
+  auto line_end = request.find("\r\n");
+  std::string_view line{request.data(), std::min(line_end, request.size())};
+
+  // "<method> <target> HTTP/1.x"
+  auto method_end = line.find(' ');
+  auto target_end = line.find_first_of(" ?", method_end + 1);
+  std::string_view method = line.substr(0, method_end);
+  std::string_view target
+      = method_end == line.npos
+            ? std::string_view{}
+            : line.substr(method_end + 1, target_end - method_end - 1);
+
+  Dmsg3(200, "Metrics request from %s: %s %s\n", bs->host(),
+        std::string{method}.c_str(), std::string{target}.c_str());
+
+  std::string response;
+  if (method != "GET" && method != "HEAD") {
+    response = Response("405 Method Not Allowed", "text/plain",
+                        "only GET is supported\n");
+  } else if (target != "/metrics") {
+    response = Response("404 Not Found", "text/plain",
+                        "metrics are served at /metrics\n");
+  } else {
+    response = Response(
+        "200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8",
+        metrics::Global().Render());
+    if (method == "HEAD") { response.resize(response.find("\r\n\r\n") + 4); }
+  }
+  SendAll(bs->fd_, response);
+
+  bs->close();
+  delete bs;
+  return nullptr;
+}
+
+static void CollectJobs(metrics::Writer& writer)
+{
+  struct job {
+    metrics::Labels labels;
+    std::uint64_t bytes;
+    std::uint64_t files;
+    double elapsed;
+  };
+  std::vector<job> jobs;
+
+  time_t now = time(nullptr);
+  JobControlRecord* jcr;
+  foreach_jcr (jcr) {
+    if (jcr->JobId == 0) { continue; }
+    time_t started = jcr->run_time ? jcr->run_time : jcr->start_time;
+    jobs.push_back(job{{{"jobid", std::to_string(jcr->JobId)},
+                        {"job", jcr->Job}},
+                       jcr->JobBytes,
+                       jcr->JobFiles,
+                       started ? static_cast<double>(now - started) : 0.0});
+  }
+  endeach_jcr(jcr);
+
+  writer.Family("bareos_jobs_running", "gauge", "Jobs running right now");
+  writer.Sample("bareos_jobs_running", {},
+                static_cast<std::uint64_t>(jobs.size()));
+
+  writer.Family("bareos_job_bytes", "counter", "Bytes processed by the job");
+  for (auto& j : jobs) {
+    writer.Sample("bareos_job_bytes_total", j.labels, j.bytes);
+  }
+  writer.Family("bareos_job_files", "counter", "Files processed by the job");
+  for (auto& j : jobs) {
+    writer.Sample("bareos_job_files_total", j.labels, j.files);
+  }
+
+  writer.Family("bareos_job_bytes_per_second", "gauge",
+                "Average byte rate of the job since it started");
+  for (auto& j : jobs) {
+    writer.Sample("bareos_job_bytes_per_second", j.labels,
+                  j.elapsed > 0 ? j.bytes / j.elapsed : 0.0);
+  }
+  writer.Family("bareos_job_files_per_second", "gauge",
+                "Average file rate of the job since it started");
+  for (auto& j : jobs) {
+    writer.Sample("bareos_job_files_per_second", j.labels,
+                  j.elapsed > 0 ? j.files / j.elapsed : 0.0);
+  }
+}
+
+extern "C" void* metrics_server_thread(void* arg)
+{
+  SetJcrInThreadSpecificData(nullptr);
+
+  auto bound_sockets = std::move(*static_cast<std::vector<s_sockfd>*>(arg));
+  if (bound_sockets.size()) {
+    BnetThreadServerTcp(std::move(bound_sockets), thread_list,
+                        HandleMetricsRequest, nullptr, &server_state, nullptr,
+                        nullptr, &quit);
+  } else {
+    server_state = BnetServerState::kError;
+  }
+  return nullptr;
+}
+
+bool StartMetricsServer(dlist<IPADDR>* addrs)
+{
+  auto bound_sockets = OpenAndBindSockets(addrs);
+
+  server_state.store(BnetServerState::kUndefined);
+  if (int status = pthread_create(&metrics_server_tid, nullptr,
+                                  metrics_server_thread, &bound_sockets);
+      status != 0) {
+    BErrNo be;
+    Emsg1(M_ERROR, 0, T_("Cannot create metrics server thread: %s\n"),
+          be.bstrerror(status));
+    return false;
+  }
+  server_running = true;
+
+  // the thread takes over bound_sockets before it reports back
+  int tries = 200;
+  do {
+    Bmicrosleep(0, 100 * 1000);
+    auto current_state = server_state.load();
+    if (current_state == BnetServerState::kStarted
+        || current_state == BnetServerState::kError) {
+      break;
+    }
+  } while (--tries);
+
+  if (server_state != BnetServerState::kStarted) {
+    Emsg0(M_ERROR, 0, T_("Could not start the metrics server.\n"));
+    /* Only wait for a thread that gave up; one that is still starting
+     * would reset the quit flag. */
+    if (server_state == BnetServerState::kError) {
+      pthread_join(metrics_server_tid, nullptr);
+      server_running = false;
+    }
+    return false;
+  }
+
+  job_collector = metrics::Global().AddCollector(CollectJobs);
+  return true;
+}
+
+void StopMetricsServer()
+{
+  if (server_running) {
+    metrics::Global().RemoveCollector(job_collector);
+    BnetStopAndWaitForThreadServerTcp(metrics_server_tid, &quit);
+    server_running = false;
+  }
+}
@@ -0,0 +1,34 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_LIB_METRICS_SERVER_H_
+#define BAREOS_LIB_METRICS_SERVER_H_
+
+template <typename T> class dlist;
+class IPADDR;
+
+/* Answers HTTP requests for /metrics on the given addresses with the
+ * content of metrics::Global().  The server also reports the jobs that are
+ * currently running in this daemon. */
+bool StartMetricsServer(dlist<IPADDR>* addrs);
+void StopMetricsServer();
+
+#endif  // BAREOS_LIB_METRICS_SERVER_H_
@@ -265,29 +265,15 @@ bool ConfigurationParser::AppendToResourcesChain(BareosResource* new_resource,
     return false;
   }
 
-  if (!loaded_configuration->configuration_resources_[rindex]) {
-    loaded_configuration->configuration_resources_[rindex] = new_resource;
-    Dmsg3(900, "Inserting first %s res: %s index=%d\n", ResToStr(rcode),
-          new_resource->resource_name_, rindex);
-  } else {  // append
-    BareosResource* last = nullptr;
-    BareosResource* current
-        = loaded_configuration->configuration_resources_[rindex];
-    do {
-      if (bstrcmp(current->resource_name_, new_resource->resource_name_)) {
-        Emsg2(M_ERROR, 0,
-              T_("Attempt to define second %s resource named \"%s\" is not "
-                 "permitted.\n"),
-              resource_definitions_[rindex].name, new_resource->resource_name_);
-        return false;
-      }
-      last = current;
-      current = last->next_;
-    } while (current);
-    last->next_ = new_resource;
-    Dmsg3(900, T_("Inserting %s res: %s index=%d\n"), ResToStr(rcode),
-          new_resource->resource_name_, rindex);
+  if (!loaded_configuration->AppendResource(rindex, new_resource)) {
+    Emsg2(M_ERROR, 0,
+          T_("Attempt to define second %s resource named \"%s\" is not "
+             "permitted.\n"),
+          resource_definitions_[rindex].name, new_resource->resource_name_);
+    return false;
   }
+  Dmsg3(900, T_("Inserting %s res: %s index=%d\n"), ResToStr(rcode),
+        new_resource->resource_name_, rindex);
   return true;
 }
 
@@ -542,7 +528,6 @@ ConfigurationParser::GetCurrentConfiguration()
 bool ConfigurationParser::RemoveResource(int rcode, const char* name)
 {
   int rindex = rcode;
-  BareosResource* last;
 
   /* Remove resource from list.
    *
@@ -551,30 +536,26 @@ bool ConfigurationParser::RemoveResource(int rcode, const char* name)
    * For a general approach, a check if this resource is referenced by other
    * resource_definitions must be added. If it is referenced, don't remove it.
    */
-  last = nullptr;
-  for (BareosResource* res
-       = loaded_configuration->configuration_resources_[rindex];
-       res; res = res->next_) {
-    if (bstrcmp(res->resource_name_, name)) {
-      if (!last) {
-        Dmsg2(900,
-              T_("removing resource %s, name=%s (first resource in list)\n"),
-              ResToStr(rcode), name);
-        loaded_configuration->configuration_resources_[rindex] = res->next_;
-      } else {
-        Dmsg2(900, T_("removing resource %s, name=%s\n"), ResToStr(rcode),
-              name);
-        last->next_ = res->next_;
-      }
-      res->next_ = nullptr;
-      FreeResourceCb_(res, rcode);
-      return true;
-    }
-    last = res;
+  if (!name) { return false; }
+  BareosResource* res = loaded_configuration->UnlinkResource(rindex, name);
+  if (!res) {
+    // Resource with this name not found
+    return false;
   }
 
-  // Resource with this name not found
-  return false;
+  Dmsg2(900, T_("removing resource %s, name=%s\n"), ResToStr(rcode), name);
+  FreeResourceCb_(res, rcode);
+  return true;
+}
+
+// Change the name of a resource that is already part of the configuration
+void ConfigurationParser::RenameResource(int rcode,
+                                         BareosResource* res,
+                                         const char* name)
+{
+  Dmsg3(900, "renaming resource %s, name=%s to %s\n", ResToStr(rcode),
+        res->resource_name_, name);
+  loaded_configuration->RenameResource(rcode, res, name);
 }
 
 bool ConfigurationParser::DumpResources(bool sendit(void* sock,
@@ -45,6 +45,8 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 struct ResourceItem;
 class ConfigParserStateMachine;
@@ -268,6 +270,7 @@ class ConfigurationParser {
                     std::function<void()> ResourceSpecificInitializer);
   bool AppendToResourcesChain(BareosResource* new_resource, int rcode);
   bool RemoveResource(int rcode, const char* name);
+  void RenameResource(int rcode, BareosResource* res, const char* name);
   bool DumpResources(sender* sendit,
                      void* sock,
                      const std::string& res_type_name,
@@ -453,6 +456,13 @@ class LoadedConfiguration {
    * implicitly as well. */
   std::shared_ptr<LoadedConfiguration> next_ = nullptr;
   FreeResourceCb_t free_res = nullptr;
+  /* For every resource type: all resources of the chain by name (the keys
+   * point into their resource_name_) and the last element of the chain.
+   * This keeps lookups and appends independent of the number of resources,
+   * so both have to be changed via the functions below only. */
+  std::vector<std::unordered_map<std::string_view, BareosResource*>>
+      resource_index_ = {};
+  std::vector<BareosResource*> resource_tails_ = {};
 
  public:
   std::vector<BareosResource*> configuration_resources_ = {};
@@ -460,7 +470,10 @@ class LoadedConfiguration {
   LoadedConfiguration() = default;
   LoadedConfiguration(FreeResourceCb_t resource_freer,
                       std::size_t resource_type_count)
-      : free_res{resource_freer}, configuration_resources_(resource_type_count)
+      : free_res{resource_freer}
+      , resource_index_(resource_type_count)
+      , resource_tails_(resource_type_count)
+      , configuration_resources_(resource_type_count)
   {
     Dmsg1(10, "LoadedConfiguration: new configuration_resources_ %p\n",
           configuration_resources_.data());
@@ -486,6 +499,11 @@ class LoadedConfiguration {
 
   BareosResource* GetNextRes(int rcode, BareosResource* res) const;
   BareosResource* GetResWithName(int rcode, std::string_view name) const;
+  // false if a resource of this type and name exists already
+  bool AppendResource(int rcode, BareosResource* res);
+  // returns the resource that was taken out of the chain, if any
+  BareosResource* UnlinkResource(int rcode, std::string_view name);
+  void RenameResource(int rcode, BareosResource* res, const char* name);
 };
 
 bool PrintMessage(void* sock, const char* fmt, ...) PRINTF_LIKE(2, 3);
@@ -0,0 +1,213 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Per job timing of the stages of the data pipeline
+ */
+
+#include "include/bareos.h"
+#include "lib/pipeline_stats.h"
+#include "include/jcr.h"
+#include "lib/berrno.h"
+#include "lib/edit.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+constexpr const char* stage_names[] = {
+    "metadata",      "read",          "digest",       "compress",
+    "encrypt",       "send",          "receive",      "upstream-wait",
+    "device-write",  "spool-write",   "catalog-queue", "catalog-insert",
+};
+static_assert(sizeof(stage_names) / sizeof(stage_names[0])
+              == static_cast<std::size_t>(PipelineStage::kCount));
+
+// small, stable ids for the threads of a trace
+int ThreadNumber()
+{
+  static std::atomic<int> next{1};
+  thread_local int number = next.fetch_add(1, std::memory_order_relaxed);
+  return number;
+}
+
+std::int64_t Microseconds(std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+}  // namespace
+
+const char* PipelineStageName(PipelineStage stage)
+{
+  return stage_names[static_cast<std::size_t>(stage)];
+}
+
+void PipelineStats::Add(PipelineStage stage,
+                        clock::time_point start,
+                        clock::time_point end,
+                        std::uint64_t bytes,
+                        std::uint64_t items)
+{
+  auto& totals = stages_[static_cast<std::size_t>(stage)];
+  totals.nanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+      std::memory_order_relaxed);
+  totals.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  totals.items.fetch_add(items, std::memory_order_relaxed);
+
+  if (Tracing()) {
+    std::unique_lock lock(trace_mutex_);
+    if (events_.size() < max_events_) {
+      events_.push_back({stage, ThreadNumber(), start, end - start, bytes});
+    } else {
+      dropped_events_++;
+    }
+  }
+}
+
+void PipelineStats::EnableTrace(std::size_t max_events)
+{
+  std::unique_lock lock(trace_mutex_);
+  max_events_ = max_events;
+  tracing_.store(true, std::memory_order_relaxed);
+}
+
+bool PipelineStats::WriteTrace(const char* path,
+                               const char* process_name) const
+{
+  FILE* fp = fopen(path, "w");
+  if (!fp) { return false; }
+
+  std::unique_lock lock(trace_mutex_);
+  clock::time_point origin = events_.empty() ? clock::time_point{}
+                                             : events_.front().start;
+  for (auto& event : events_) { origin = std::min(origin, event.start); }
+
+  fprintf(fp,
+          "{\"traceEvents\":[\n"
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+          "\"args\":{\"name\":\"%s\"}}",
+          process_name);
+  for (auto& event : events_) {
+    fprintf(fp,
+            ",\n{\"name\":\"%s\",\"cat\":\"pipeline\",\"ph\":\"X\","
+            "\"pid\":1,\"tid\":%d,\"ts\":%" PRId64 ",\"dur\":%" PRId64
+            ",\"args\":{\"bytes\":%" PRIu64 "}}",
+            PipelineStageName(event.stage), event.thread,
+            Microseconds(event.start - origin), Microseconds(event.duration),
+            event.bytes);
+  }
+  fprintf(fp, "\n],\"otherData\":{\"dropped_events\":\"%" PRIu64 "\"}}\n",
+          dropped_events_);
+
+  bool ok = !ferror(fp);
+  if (fclose(fp) != 0) { ok = false; }
+  return ok;
+}
+
+PipelineStats::Totals PipelineStats::Get(PipelineStage stage) const
+{
+  auto& totals = stages_[static_cast<std::size_t>(stage)];
+  return {std::chrono::nanoseconds{
+              totals.nanoseconds.load(std::memory_order_relaxed)},
+          totals.bytes.load(std::memory_order_relaxed),
+          totals.items.load(std::memory_order_relaxed)};
+}
+
+bool PipelineStats::Empty() const
+{
+  return std::all_of(stages_.begin(), stages_.end(), [](const Stage& stage) {
+    return stage.items.load(std::memory_order_relaxed) == 0;
+  });
+}
+
+std::string PipelineStats::Report(std::chrono::duration<double> elapsed) const
+{
+  std::string report = "Pipeline stages:\n";
+  char line[256];
+  char ed1[50], ed2[50];
+
+  std::size_t slowest = stages_.size();
+  std::chrono::duration<double> slowest_time{0};
+  for (std::size_t i = 0; i < stages_.size(); ++i) {
+    auto totals = Get(static_cast<PipelineStage>(i));
+    if (totals.items == 0) { continue; }
+
+    std::chrono::duration<double> time = totals.time;
+    // waiting for the previous daemon means the bottleneck is over there
+    if (time > slowest_time && i != static_cast<std::size_t>(
+                                   PipelineStage::kUpstreamWait)) {
+      slowest = i;
+      slowest_time = time;
+    }
+
+    if (totals.bytes > 0) {
+      auto rate = time.count() > 0 ? totals.bytes / time.count() : 0.0;
+      snprintf(line, sizeof(line), "  %-15s %10.3f s %12sB %12sB/s\n",
+               stage_names[i], time.count(),
+               edit_uint64_with_suffix(totals.bytes, ed1),
+               edit_uint64_with_suffix(static_cast<std::uint64_t>(rate), ed2));
+    } else {
+      snprintf(line, sizeof(line), "  %-15s %10.3f s %12s items\n",
+               stage_names[i], time.count(),
+               edit_uint64_with_commas(totals.items, ed1));
+    }
+    report += line;
+  }
+
+  if (slowest < stages_.size()) {
+    /* Stages running in parallel may add up to more than the elapsed
+     * time, so the share is only an indication. */
+    double share = elapsed.count() > 0
+                       ? 100.0 * slowest_time.count() / elapsed.count()
+                       : 100.0;
+    snprintf(line, sizeof(line), "  Bottleneck: %s (%.0f%% of %.3f s)\n",
+             stage_names[slowest], share, elapsed.count());
+    report += line;
+  }
+  return report;
+}
+
+void ReportPipelineStats(JobControlRecord* jcr,
+                         const std::string& trace_directory,
+                         const char* daemon)
+{
+  auto& stats = jcr->pipeline_stats;
+  if (stats.Empty()) { return; }
+
+  Jmsg(jcr, M_INFO, 0, "%s", stats.Report(stats.Elapsed()).c_str());
+
+  if (stats.Tracing() && !trace_directory.empty()) {
+    std::string path
+        = trace_directory + "/" + jcr->Job + "-" + daemon + ".trace.json";
+    std::string process = std::string{"bareos-"} + daemon + " " + jcr->Job;
+    if (stats.WriteTrace(path.c_str(), process.c_str())) {
+      Jmsg(jcr, M_INFO, 0, T_("Pipeline trace written to %s\n"),
+           path.c_str());
+    } else {
+      BErrNo be;
+      Jmsg(jcr, M_WARNING, 0,
+           T_("Could not write pipeline trace %s: ERR=%s\n"), path.c_str(),
+           be.bstrerror());
+    }
+  }
+}
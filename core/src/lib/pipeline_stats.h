@@ -0,0 +1,156 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_LIB_PIPELINE_STATS_H_
+#define BAREOS_LIB_PIPELINE_STATS_H_
+
+/* Time spent per stage of the data pipeline of a job.
+ *
+ * The code of every stage (reading files, digesting, compressing, sending,
+ * writing to the device, inserting into the catalog, ...) is wrapped in a
+ * StageTimer.  The times are summed up per job with relaxed atomics, so
+ * timing a section costs two clock reads.  At the end of the job the sums
+ * are turned into a report that names the stage the job spent most of its
+ * time in.
+ *
+ * Optionally every timed section is also recorded, so that the whole job
+ * can be looked at in a trace viewer (Chrome trace event format). */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class PipelineStage : std::size_t
+{
+  kMetadata,
+  kRead,
+  kDigest,
+  kCompress,
+  kEncrypt,
+  kSend,
+  kReceive,
+  kUpstreamWait, /* waiting for the previous daemon, not a bottleneck */
+  kDeviceWrite,
+  kSpoolWrite,
+  kCatalogQueue,
+  kCatalogInsert,
+  kCount
+};
+
+const char* PipelineStageName(PipelineStage stage);
+
+class PipelineStats {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  // The elapsed time of the job is measured from here.
+  void Start() { started_ = clock::now(); }
+  std::chrono::duration<double> Elapsed() const
+  {
+    return clock::now() - started_;
+  }
+
+  void Add(PipelineStage stage,
+           clock::time_point start,
+           clock::time_point end,
+           std::uint64_t bytes,
+           std::uint64_t items = 1);
+
+  // Record every timed section from now on, at most max_events of them.
+  void EnableTrace(std::size_t max_events = 1'000'000);
+  bool Tracing() const { return tracing_.load(std::memory_order_relaxed); }
+  // Write the recorded sections as Chrome trace events to path.
+  bool WriteTrace(const char* path, const char* process_name) const;
+
+  struct Totals {
+    std::chrono::nanoseconds time{0};
+    std::uint64_t bytes{0};
+    std::uint64_t items{0};
+  };
+  Totals Get(PipelineStage stage) const;
+  bool Empty() const;
+
+  /* Time, amount and throughput of each stage that was used and the stage
+   * that took longest, relative to the elapsed time of the job. */
+  std::string Report(std::chrono::duration<double> elapsed) const;
+
+ private:
+  struct Stage {
+    std::atomic<std::uint64_t> nanoseconds{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> items{0};
+  };
+  struct Event {
+    PipelineStage stage;
+    int thread;
+    clock::time_point start;
+    clock::duration duration;
+    std::uint64_t bytes;
+  };
+
+  std::array<Stage, static_cast<std::size_t>(PipelineStage::kCount)> stages_;
+  clock::time_point started_{clock::now()};
+  std::atomic<bool> tracing_{false};
+  mutable std::mutex trace_mutex_;
+  std::vector<Event> events_;
+  std::size_t max_events_{0};
+  std::uint64_t dropped_events_{0};
+};
+
+// Adds the time between its construction and destruction to a stage.
+class StageTimer {
+ public:
+  StageTimer(PipelineStats& stats, PipelineStage stage)
+      : stats_{stats}, stage_{stage}, start_{PipelineStats::clock::now()}
+  {
+  }
+  ~StageTimer()
+  {
+    stats_.Add(stage_, start_, PipelineStats::clock::now(), bytes_, items_);
+  }
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+  void SetBytes(std::uint64_t bytes) { bytes_ = bytes; }
+  void SetItems(std::uint64_t items) { items_ = items; }
+
+ private:
+  PipelineStats& stats_;
+  PipelineStage stage_;
+  PipelineStats::clock::time_point start_;
+  std::uint64_t bytes_{0};
+  std::uint64_t items_{1};
+};
+
+class JobControlRecord;
+
+/* Sends the report of the stages of this job to the job log and writes the
+ * trace to trace_directory, if one was recorded.  daemon ("fd", "sd", ...)
+ * distinguishes the traces of the daemons taking part in one job. */
+void ReportPipelineStats(JobControlRecord* jcr,
+                         const std::string& trace_directory,
+                         const char* daemon);
+
+#endif  // BAREOS_LIB_PIPELINE_STATS_H_
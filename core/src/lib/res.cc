@@ -2308,21 +2308,78 @@ const char* DatatypeToDescription(int type)
 BareosResource* LoadedConfiguration::GetResWithName(int rcode,
                                                     std::string_view name) const
 {
-  auto& containers = configuration_resources_;
-  if (rcode < 0 || static_cast<std::size_t>(rcode) >= containers.size()) {
+  if (rcode < 0 || static_cast<std::size_t>(rcode) >= resource_index_.size()) {
     return nullptr;
   }
 
-  auto* res = containers[rcode];
+  auto& index = resource_index_[rcode];
+  auto found = index.find(name);
+  if (found == index.end()) { return nullptr; }
+
+  return found->second;
+}
+
+// Append resource to the end of the chain of type rcode
+bool LoadedConfiguration::AppendResource(int rcode, BareosResource* res)
+{
+  ASSERT(rcode >= 0
+         && static_cast<std::size_t>(rcode) < resource_index_.size());
+
+  if (!resource_index_[rcode].emplace(res->resource_name_, res).second) {
+    return false;
+  }
+
+  res->next_ = nullptr;
+  if (BareosResource* last = resource_tails_[rcode]) {
+    last->next_ = res;
+  } else {
+    configuration_resources_[rcode] = res;
+  }
+  resource_tails_[rcode] = res;
+
+  return true;
+}
+
+// Take the resource of type rcode that matches name out of its chain
+BareosResource* LoadedConfiguration::UnlinkResource(int rcode,
+                                                    std::string_view name)
+{
+  BareosResource* res = GetResWithName(rcode, name);
+  if (!res) { return nullptr; }
 
-  while (res) {
-    if (res->resource_name_ == name) { break; }
-    res = res->next_;
+  BareosResource* last = nullptr;
+  for (BareosResource* current = configuration_resources_[rcode];
+       current != res; current = current->next_) {
+    last = current;
   }
 
+  if (last) {
+    last->next_ = res->next_;
+  } else {
+    configuration_resources_[rcode] = res->next_;
+  }
+  if (resource_tails_[rcode] == res) { resource_tails_[rcode] = last; }
+  res->next_ = nullptr;
+  resource_index_[rcode].erase(name);
+
   return res;
 }
 
+// Give a resource in the chain of type rcode a new name
+void LoadedConfiguration::RenameResource(int rcode,
+                                         BareosResource* res,
+                                         const char* name)
+{
+  auto& index = resource_index_[rcode];
+  auto found = index.find(res->resource_name_);
+  if (found != index.end() && found->second == res) { index.erase(found); }
+
+  char* new_name = strdup(name);
+  free(res->resource_name_);
+  res->resource_name_ = new_name;
+  index.emplace(res->resource_name_, res);
+}
+
 /*
  * Return next resource of type rcode. On first
  * call second arg (res) is NULL, on subsequent
@@ -40,6 +40,7 @@
 
 #include "lib/thread_util.h"
 #include "lib/channel.h"
+#include "lib/metrics.h"
 #include "include/baconfig.h"
 
 /* this class is basically std::function<void(void)>; except that
@@ -104,9 +105,25 @@ struct thread_pool {
     for (auto& sync : units) { sync->lock()->close(); }
 
     for (auto& thread : threads) { thread.join(); }
+    ThreadsGauge().Add(-static_cast<std::int64_t>(threads.size()));
   }
 
  private:
+  // shared by all pools of the process
+  static metrics::Gauge& ThreadsGauge()
+  {
+    static metrics::Gauge& gauge = metrics::Global().GetGauge(
+        "bareos_thread_pool_threads", "Threads owned by thread pools");
+    return gauge;
+  }
+  static metrics::Gauge& BusyGauge()
+  {
+    static metrics::Gauge& gauge = metrics::Global().GetGauge(
+        "bareos_thread_pool_busy_threads",
+        "Threads of thread pools that currently run a task");
+    return gauge;
+  }
+
   template <typename ThreadFn>
   void with_free_threads(std::size_t size, ThreadFn f)
   {
@@ -187,6 +204,7 @@ struct thread_pool {
           pool->pool_work(*unit);
         },
         this, sync.get());
+    ThreadsGauge().Add(1);
   }
 
   void pool_work(synchronized<work_unit>& unit)
@@ -201,7 +219,9 @@ struct thread_pool {
       if (locked->is_closed()) { return; }
 
       // state is WORKING
+      BusyGauge().Add(1);
       locked->do_work();
+      BusyGauge().Add(-1);
     }
   }
 };
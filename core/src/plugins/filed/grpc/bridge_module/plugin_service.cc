@@ -32,6 +32,7 @@
 
 #include <sys/sendfile.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <thread>
 #include <variant>
@@ -177,6 +178,38 @@ auto PluginService::Setup(ServerContext*,
   return Status::OK;
 }
 
+auto PluginService::SetupSharedMemory(
+    ServerContext*,
+    const bp::setupSharedMemoryRequest* request,
+    bp::setupSharedMemoryResponse* response) -> Status
+{
+  // do not let the core make us allocate arbitrary amounts of memory
+  constexpr std::size_t max_slot_size = 64 * 1024 * 1024;
+  constexpr std::uint32_t max_slot_count = 64;
+
+  std::size_t slot_size = std::min<std::size_t>(request->slot_size(),
+                                                max_slot_size);
+  std::uint32_t slot_count = std::min(request->slot_count(), max_slot_count);
+
+  ring = SharedRing::Create(slot_size, slot_count);
+  if (!ring) {
+    DebugLog(50, FMT_STRING("could not create shared memory ring: Err={}"),
+             strerror(errno));
+    response->set_slot_count(0);
+    return Status::OK;
+  }
+
+  if (!send_fd(io, ring->fd())) {
+    ring.reset();
+    return Status(grpc::StatusCode::INTERNAL,
+                  "could not send shared memory fd");
+  }
+
+  response->set_slot_size(ring->slot_size());
+  response->set_slot_count(ring->slot_count());
+  return Status::OK;
+}
+
 enum class UnhandledType
 {
   Unknown,
@@ -893,6 +926,27 @@ auto PluginService::FileRead(ServerContext*,
   filedaemon::io_pkt pkt;
   pkt.func = filedaemon::IO_READ;
   pkt.count = request->num_bytes();
+
+  if (ring && request->num_bytes() <= ring->slot_size()) {
+    // let the plugin read directly into the shared memory
+    std::size_t offset = ring->NextSlot();
+    pkt.buf = ring->at(offset);
+
+    if (funcs.pluginIO(ctx, &pkt) != bRC_OK) {
+      return Status(grpc::StatusCode::INTERNAL, "bad response");
+    }
+
+    if (pkt.status < 0) {
+      return Status(grpc::StatusCode::INTERNAL, "plugin read failed");
+    } else if (pkt.status > 0) {
+      bp::fileReadResponse resp;
+      resp.set_size(pkt.status);
+      resp.set_shared_offset(offset);
+      writer->Write(resp);
+    }
+    return Status::OK;
+  }
+
   pkt.buf = buffer(request->num_bytes());
 
   auto res = funcs.pluginIO(ctx, &pkt);
@@ -964,10 +1018,22 @@ auto PluginService::FileWrite(ServerContext*,
   filedaemon::io_pkt pkt;
   pkt.func = filedaemon::IO_WRITE;
   pkt.count = request->bytes_written();
-  pkt.buf = buffer(request->bytes_written());
 
-  if (!full_read(io, pkt.buf, pkt.count)) {
-    return Status(grpc::StatusCode::INTERNAL, "io socket read not successful");
+  if (request->has_shared_offset()) {
+    if (!ring
+        || !ring->Contains(request->shared_offset(),
+                           request->bytes_written())) {
+      return Status(grpc::StatusCode::INVALID_ARGUMENT,
+                    "bad shared memory offset");
+    }
+    pkt.buf = ring->at(request->shared_offset());
+  } else {
+    pkt.buf = buffer(request->bytes_written());
+
+    if (!full_read(io, pkt.buf, pkt.count)) {
+      return Status(grpc::StatusCode::INTERNAL,
+                    "io socket read not successful");
+    }
   }
 
   auto res = funcs.pluginIO(ctx, &pkt);
@@ -29,6 +29,7 @@
 #include "plugin.pb.h"
 
 #include "filed/fd_plugins.h"
+#include "plugins/filed/grpc/shared_memory.h"
 
 namespace bp = bareos::plugin;
 
@@ -84,6 +85,9 @@ class PluginService : public bp::Plugin::Service {
   Status Setup(ServerContext*,
                const bp::SetupRequest*,
                bp::SetupResponse*) override;
+  Status SetupSharedMemory(ServerContext*,
+                           const bp::setupSharedMemoryRequest* request,
+                           bp::setupSharedMemoryResponse* response) override;
 
   Status handlePluginEvent(ServerContext*,
                            const bp::handlePluginEventRequest* request,
@@ -144,6 +148,7 @@ class PluginService : public bp::Plugin::Service {
   std::promise<void> shutdown;
 
   std::vector<char> vec;
+  std::optional<SharedRing> ring;
 
   char* buffer(size_t size)
   {
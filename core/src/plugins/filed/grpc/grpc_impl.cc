@@ -32,6 +32,7 @@
 #include <grpcpp/create_channel_posix.h>
 
 #include "plugins/filed/grpc/grpc_impl.h"
+#include "plugins/filed/grpc/shared_memory.h"
 #include <fcntl.h>
 #include <thread>
 #include <grpcpp/impl/codegen/channel_interface.h>
@@ -1092,6 +1093,27 @@ class PluginClient {
     return bRC_OK;
   }
 
+  // returns false if the plugin does not support a shared memory ring
+  bool SetupSharedMemory(std::size_t slot_size,
+                         std::uint32_t slot_count,
+                         bp::setupSharedMemoryResponse* resp)
+  {
+    bp::setupSharedMemoryRequest req;
+    req.set_slot_size(slot_size);
+    req.set_slot_count(slot_count);
+    grpc::ClientContext ctx;
+
+    auto status = stub_->SetupSharedMemory(&ctx, req, resp);
+
+    if (!status.ok()) {
+      DebugLog(100, FMT_STRING("no shared memory ring {}: {}"),
+               int(status.error_code()), status.error_message());
+      return false;
+    }
+
+    return resp->slot_count() != 0;
+  }
+
   bRC handlePluginEvent(filedaemon::bEventType type,
                         bp::handlePluginEventRequest* req)
   {
@@ -1461,11 +1483,16 @@ class PluginClient {
       reader = stub->FileRead(&ctx, req);
     }
 
-    bool next(size_t* size)
+    bool next(size_t* size, std::optional<uint64_t>* shared_offset)
     {
       bp::fileReadResponse resp;
       if (!reader->Read(&resp)) { return false; }
       *size = resp.size();
+      if (resp.has_shared_offset()) {
+        *shared_offset = resp.shared_offset();
+      } else {
+        shared_offset->reset();
+      }
       return true;
     }
 
@@ -1483,10 +1510,13 @@ class PluginClient {
 
   read_iter FileRead(size_t size) { return read_iter{stub_.get(), size, core}; }
 
-  bRC FileWrite(size_t size, size_t* num_bytes_written)
+  bRC FileWrite(size_t size,
+                size_t* num_bytes_written,
+                std::optional<uint64_t> shared_offset = std::nullopt)
   {
     bp::fileWriteRequest req;
     req.set_bytes_written(size);
+    if (shared_offset) { req.set_shared_offset(*shared_offset); }
 
     bp::fileWriteResponse resp;
     grpc::ClientContext ctx;
@@ -1818,6 +1848,7 @@ struct grpc_connection_members {
   std::vector<std::unique_ptr<grpc::Service>> services;
   std::shared_ptr<grpc::Channel> channel;
   std::unique_ptr<grpc::Server> server;
+  std::optional<SharedRing> ring{};
 
   grpc_connection_members(PluginClient client_,
                           std::vector<std::unique_ptr<grpc::Service>> services_,
@@ -2257,6 +2288,10 @@ struct grpc_connection_builder {
       return std::nullopt;
     }
 
+    if (con->SetupSharedMemory(parent_io.grpc_io.get()) == bRC_Error) {
+      DebugLog(100, FMT_STRING("... unsuccessfully (shared memory)."));
+      return std::nullopt;
+    }
 
     DebugLog(100, FMT_STRING("... successfully."));
 
@@ -2599,11 +2634,24 @@ bRC grpc_connection::pluginIO(filedaemon::io_pkt* pkt, int iosock)
 
       DebugLog(100, FMT_STRING("trying to read {} bytes"), pkt->count);
 
+      std::optional<SharedRing>& ring = members->ring;
       size_t bytes_read = 0;
       size_t current = 0;
-      while (iter.next(&current)) {
+      std::optional<uint64_t> shared_offset;
+      while (iter.next(&current, &shared_offset)) {
         DebugLog(100, FMT_STRING("received {} bytes"), current);
-        if (!full_read(iosock, pkt->buf + bytes_read, current)) {
+        if (shared_offset) {
+          if (!ring || !ring->Contains(*shared_offset, current)
+              || bytes_read + current > (size_t)pkt->count) {
+            JobLog(nullptr, M_FATAL,
+                   FMT_STRING("plugin sent bad shared memory chunk (offset = "
+                              "{}, size = {}, {} of {} bytes already read)"),
+                   *shared_offset, current, bytes_read, pkt->count);
+            pkt->io_errno = EIO;
+            return bRC_Error;
+          }
+          memcpy(pkt->buf + bytes_read, ring->at(*shared_offset), current);
+        } else if (!full_read(iosock, pkt->buf + bytes_read, current)) {
           JobLog(nullptr, M_FATAL,
                  FMT_STRING("could not read additional {} bytes from socket "
                             "({} were already read): Err={}"),
@@ -2631,6 +2679,20 @@ bRC grpc_connection::pluginIO(filedaemon::io_pkt* pkt, int iosock)
       return bRC_OK;
     } break;
     case filedaemon::IO_WRITE: {
+      if (std::optional<SharedRing>& ring = members->ring;
+          ring && (size_t)pkt->count <= ring->slot_size()) {
+        DebugLog(100, FMT_STRING("writing {} bytes into shared memory"),
+                 pkt->count);
+        size_t offset = ring->NextSlot();
+        memcpy(ring->at(offset), pkt->buf, pkt->count);
+
+        size_t bytes_written = 0;
+        auto res = client->FileWrite(pkt->count, &bytes_written, offset);
+        if (res == bRC_Error) { return res; }
+        pkt->status = bytes_written;
+        return res;
+      }
+
       DebugLog(100, FMT_STRING("writing {} bytes into socket"), pkt->count);
 
 
@@ -2738,6 +2800,36 @@ bRC grpc_connection::Setup()
   PluginClient* client = &members->client;
   return client->Setup();
 }
+bRC grpc_connection::SetupSharedMemory(int io_socket)
+{
+  PluginClient* client = &members->client;
+
+  bp::setupSharedMemoryResponse resp;
+  if (!client->SetupSharedMemory(kSharedSlotSize, kSharedSlotCount, &resp)) {
+    DebugLog(100, FMT_STRING("file data is transferred through the io socket"));
+    return bRC_OK;
+  }
+
+  // from here on the plugin expects us to use the ring, so any error is fatal
+  std::optional fd = receive_fd(io_socket, -1);
+  if (!fd) {
+    DebugLog(50, FMT_STRING("plugin did not send the shared memory fd"));
+    return bRC_Error;
+  }
+
+  members->ring = SharedRing::Map(*fd, resp.slot_size(), resp.slot_count());
+  if (!members->ring) {
+    DebugLog(50,
+             FMT_STRING("could not map shared memory ring ({} x {}): Err={}"),
+             resp.slot_count(), resp.slot_size(), strerror(errno));
+    return bRC_Error;
+  }
+
+  DebugLog(100, FMT_STRING("file data is transferred through {} x {} bytes "
+                           "of shared memory"),
+           resp.slot_count(), resp.slot_size());
+  return bRC_OK;
+}
 bRC grpc_connection::checkFile(const char* fname)
 {
   PluginClient* client = &members->client;
@@ -104,6 +104,10 @@ struct OSFile {
 
 struct grpc_connection_members;
 
+// geometry of the shared memory ring the core asks the plugin for
+inline constexpr std::size_t kSharedSlotSize = 4 * 1024 * 1024;
+inline constexpr std::uint32_t kSharedSlotCount = 4;
+
 namespace bareos {
 namespace plugin {
 struct handlePluginEventRequest;
@@ -114,6 +118,10 @@ struct handlePluginEventRequest;
 class grpc_connection {
  public:
   bRC Setup();
+  /* Asks the plugin for a shared memory ring for file data.  Returns
+   * bRC_OK if the plugin does not support it, as pluginIO() then uses the
+   * io socket. */
+  bRC SetupSharedMemory(int io_socket);
 
   bRC handlePluginEvent(filedaemon::bEventType type, void* data);
   bRC handlePluginEvent(filedaemon::bEventType type,
@@ -0,0 +1,153 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_PLUGINS_FILED_GRPC_SHARED_MEMORY_H_
+#define BAREOS_PLUGINS_FILED_GRPC_SHARED_MEMORY_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+/* A memfd backed memory region that is split into slot_count slots of
+ * slot_size bytes each.  The plugin creates it and sends the descriptor to
+ * the core over the io socket (see SetupSharedMemory in plugin.proto).
+ * Afterwards file data is put into the slots and the grpc messages only
+ * carry the offset of the slot that was used.
+ *
+ * Slots are handed out round robin.  Every FileRead/FileWrite call is
+ * finished before the next one starts, so a slot is never reused while the
+ * other side still looks at it. */
+class SharedRing {
+ public:
+  // Creates a new region; on failure errno describes the problem.
+  static std::optional<SharedRing> Create(std::size_t slot_size,
+                                          std::uint32_t slot_count)
+  {
+#if defined(MFD_CLOEXEC)
+    if (slot_size == 0 || slot_count == 0) {
+      errno = EINVAL;
+      return std::nullopt;
+    }
+    int fd = memfd_create("bareos-grpc-io", MFD_CLOEXEC);
+    if (fd < 0) { return std::nullopt; }
+    if (ftruncate(fd, static_cast<off_t>(slot_size * slot_count)) < 0) {
+      int error = errno;
+      close(fd);
+      errno = error;
+      return std::nullopt;
+    }
+    return Map(fd, slot_size, slot_count);
+#else
+    (void)slot_size;
+    (void)slot_count;
+    errno = ENOSYS;
+    return std::nullopt;
+#endif
+  }
+
+  /* Maps a region received from the other side.  Takes ownership of fd,
+   * even on failure. */
+  static std::optional<SharedRing> Map(int fd,
+                                       std::size_t slot_size,
+                                       std::uint32_t slot_count)
+  {
+    SharedRing ring;
+    ring.fd_ = fd;
+    ring.slot_size_ = slot_size;
+    ring.slot_count_ = slot_count;
+
+    struct stat st;
+    if (slot_size == 0 || slot_count == 0) {
+      errno = EINVAL;
+      return std::nullopt;
+    }
+    if (fstat(fd, &st) < 0) { return std::nullopt; }
+    if (static_cast<std::size_t>(st.st_size) < ring.size()) {
+      errno = EINVAL;
+      return std::nullopt;
+    }
+
+    void* base = mmap(nullptr, ring.size(), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) { return std::nullopt; }
+    ring.base_ = static_cast<char*>(base);
+
+    return ring;
+  }
+
+  SharedRing(const SharedRing&) = delete;
+  SharedRing& operator=(const SharedRing&) = delete;
+  SharedRing(SharedRing&& other) { *this = std::move(other); }
+  SharedRing& operator=(SharedRing&& other)
+  {
+    std::swap(fd_, other.fd_);
+    std::swap(base_, other.base_);
+    std::swap(slot_size_, other.slot_size_);
+    std::swap(slot_count_, other.slot_count_);
+    std::swap(next_slot_, other.next_slot_);
+    return *this;
+  }
+
+  ~SharedRing()
+  {
+    if (base_) { munmap(base_, size()); }
+    if (fd_ >= 0) { close(fd_); }
+  }
+
+  int fd() const { return fd_; }
+  std::size_t slot_size() const { return slot_size_; }
+  std::uint32_t slot_count() const { return slot_count_; }
+  std::size_t size() const { return slot_size_ * slot_count_; }
+
+  // Returns the offset of the slot to use for the next transfer.
+  std::size_t NextSlot()
+  {
+    std::size_t offset = next_slot_ * slot_size_;
+    next_slot_ = (next_slot_ + 1) % slot_count_;
+    return offset;
+  }
+
+  // true if [offset, offset + length) lies inside a single slot
+  bool Contains(std::uint64_t offset, std::uint64_t length) const
+  {
+    if (offset >= size() || offset % slot_size_ != 0) { return false; }
+    return length <= slot_size_;
+  }
+
+  char* at(std::size_t offset) const { return base_ + offset; }
+
+ private:
+  SharedRing() = default;
+
+  int fd_{-1};
+  char* base_{nullptr};
+  std::size_t slot_size_{0};
+  std::uint32_t slot_count_{0};
+  std::uint32_t next_slot_{0};
+};
+
+#endif  // BAREOS_PLUGINS_FILED_GRPC_SHARED_MEMORY_H_
@@ -457,14 +457,13 @@ class BareosFdMariabackup(BareosFdPluginBaseclass):
             return bRC_OK
 
         elif IOP.func == IO_READ:
-            IOP.buf = bytearray(IOP.count)
-            IOP.status = self.stream.stdout.readinto(IOP.buf)
+            IOP.status = self.stream.stdout.readinto(IOP.buffer)
             IOP.io_errno = 0
             return bRC_OK
 
         elif IOP.func == IO_WRITE:
             try:
-                self.stream.stdin.write(IOP.buf)
+                self.stream.stdin.write(IOP.buffer)
                 IOP.status = IOP.count
                 IOP.io_errno = 0
             except IOError as msg:
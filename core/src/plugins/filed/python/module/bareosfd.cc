@@ -551,16 +551,17 @@ static inline PyIoPacket* NativeToPyIoPacket(io_pkt* io)
     pIoPkt->filedes = io->filedes;
 #endif
 
-    if (io->func == IO_WRITE && io->count > 0) {
-      /* Only initialize the buffer with read data when we are writing and
-       * there is data.*/
-      pIoPkt->buf = PyByteArray_FromStringAndSize(io->buf, io->count);
-      if (!pIoPkt->buf) {
+    /* The data to write only gets copied into buf when the plugin asks for
+     * it, see PyIoPacket_getbuf(). */
+    pIoPkt->buf = NULL;
+    pIoPkt->buffer = NULL;
+    if ((io->func == IO_READ || io->func == IO_WRITE) && io->count > 0) {
+      pIoPkt->buffer = PyMemoryView_FromMemory(
+          io->buf, io->count, io->func == IO_READ ? PyBUF_WRITE : PyBUF_READ);
+      if (!pIoPkt->buffer) {
         Py_DECREF((PyObject*)pIoPkt);
         return (PyIoPacket*)NULL;
       }
-    } else {
-      pIoPkt->buf = NULL;
     }
     /* These must be set by the Python function but we initialize them to zero
      * to be sure they have some valid setting an not random data.  */
@@ -588,7 +589,11 @@ static inline bool PyIoPacketToNative(PyIoPacket* pIoPkt, io_pkt* io)
 
   if (io->func == IO_READ && io->status > 0) {
     // Only copy back the data when doing a read and there is data.
-    if (PyByteArray_Check(pIoPkt->buf)) {
+    if (!pIoPkt->buf || pIoPkt->buf == Py_None
+        || pIoPkt->buf == pIoPkt->buffer) {
+      // The plugin read into buffer, the data already is in place.
+      if (io->status > io->count) { return false; }
+    } else if (PyByteArray_Check(pIoPkt->buf)) {
       char* buf;
 
       if (PyByteArray_Size(pIoPkt->buf) > io->count || io->status > io->count) {
@@ -606,12 +611,39 @@ static inline bool PyIoPacketToNative(PyIoPacket* pIoPkt, io_pkt* io)
 
       if (!(buf = PyBytes_AsString(pIoPkt->buf))) { return false; }
       memcpy(io->buf, buf, io->status);
+    } else if (PyObject_CheckBuffer(pIoPkt->buf)) {
+      Py_buffer view;
+
+      if (PyObject_GetBuffer(pIoPkt->buf, &view, PyBUF_SIMPLE) < 0) {
+        return false;
+      }
+      bool ok = view.len <= io->count && io->status <= view.len;
+      if (ok && view.buf != io->buf) { memcpy(io->buf, view.buf, io->status); }
+      PyBuffer_Release(&view);
+      if (!ok) { return false; }
     }
   }
 
   return true;
 }
 
+/* The view of the native buffer must not outlive plugin_io(), afterwards it
+ * points to memory the plugin does not own anymore.  Releasing fails when the
+ * plugin still has something exported from it. */
+static inline bool ReleasePyIoBuffer(PyIoPacket* pIoPkt)
+{
+  if (!pIoPkt->buffer) { return true; }
+
+  PyObject *type, *value, *traceback;
+  PyErr_Fetch(&type, &value, &traceback);
+  PyObject* result = PyObject_CallMethod(pIoPkt->buffer, "release", NULL);
+  bool released = result != NULL;
+  Py_XDECREF(result);
+  if (type) { PyErr_Restore(type, value, traceback); }
+
+  return released;
+}
+
 /**
  * Do actual I/O. Bareos calls this after startBackupFile
  * or after startRestoreFile to do the actual file
@@ -636,6 +668,7 @@ static bRC PyPluginIO(PluginContext* plugin_ctx, io_pkt* io)
 
     pRetVal = PyObject_CallFunctionObjArgs(pFunc, (PyObject*)pIoPkt, NULL);
     if (!pRetVal) {
+      ReleasePyIoBuffer(pIoPkt);
       Py_DECREF((PyObject*)pIoPkt);
       goto bail_out;
     } else {
@@ -643,9 +676,15 @@ static bRC PyPluginIO(PluginContext* plugin_ctx, io_pkt* io)
       Py_DECREF(pRetVal);
 
       if (!PyIoPacketToNative(pIoPkt, io)) {
+        ReleasePyIoBuffer(pIoPkt);
         Py_DECREF((PyObject*)pIoPkt);
         goto bail_out;
       }
+      if (!ReleasePyIoBuffer(pIoPkt)) {
+        Py_DECREF((PyObject*)pIoPkt);
+        retval = bRC_Error;
+        goto bail_out;
+      }
     }
     Py_DECREF((PyObject*)pIoPkt);
   } else {
@@ -2322,6 +2361,7 @@ static int PyIoPacket_init(PyIoPacket* self, PyObject* args, PyObject* kwds)
   self->flags = 0;
   self->mode = 0;
   self->buf = NULL;
+  self->buffer = NULL;
   self->fname = NULL;
   self->status = 0;
   self->io_errno = 0;
@@ -2366,9 +2406,32 @@ static int PyIoPacket_init(PyIoPacket* self, PyObject* args, PyObject* kwds)
 static void PyIoPacket_dealloc(PyIoPacket* self)
 {
   if (self->buf) { Py_XDECREF(self->buf); }
+  Py_XDECREF(self->buffer);
   PyObject_Del(self);
 }
 
+// Data to write gets copied only for plugins that still use buf.
+static PyObject* PyIoPacket_getbuf(PyIoPacket* self, void*)
+{
+  if (!self->buf && self->func == IO_WRITE && self->buffer) {
+    self->buf = PyByteArray_FromObject(self->buffer);
+    if (!self->buf) { return NULL; }
+  }
+
+  PyObject* buf = self->buf ? self->buf : Py_None;
+  Py_INCREF(buf);
+  return buf;
+}
+
+static int PyIoPacket_setbuf(PyIoPacket* self, PyObject* value, void*)
+{
+  PyObject* old = self->buf;
+  Py_XINCREF(value);
+  self->buf = value;
+  Py_XDECREF(old);
+  return 0;
+}
+
 // Python specific handlers for PyAclPacket structure mapping.
 
 // Representation.
@@ -384,6 +384,7 @@ typedef struct {
   int32_t flags;               /* Open flags */
   int32_t mode;                /* Permissions for created files */
   PyObject* buf;               /* Read/Write buffer */
+  PyObject* buffer;            /* View of the native Read/Write buffer */
   const char* fname;           /* Open filename */
   int32_t status;              /* Return status */
   int32_t io_errno;            /* Errno code */
@@ -402,11 +403,22 @@ typedef struct {
 static void PyIoPacket_dealloc(PyIoPacket* self);
 static int PyIoPacket_init(PyIoPacket* self, PyObject* args, PyObject* kwds);
 static PyObject* PyIoPacket_repr(PyIoPacket* self);
+static PyObject* PyIoPacket_getbuf(PyIoPacket* self, void* closure);
+static int PyIoPacket_setbuf(PyIoPacket* self, PyObject* value, void* closure);
 
 static PyMethodDef PyIoPacket_methods[] = {
     {} /* Sentinel */
 };
 
+/* buf is a copy of the data, buffer a memoryview of the buffer of the File
+ * daemon itself.  Reading into buffer (e.g. with readinto()) and writing
+ * from it saves a copy of every block, but the view is only valid until
+ * plugin_io() returns. */
+static PyGetSetDef PyIoPacket_getset[]
+    = {{(char*)"buf", (getter)PyIoPacket_getbuf, (setter)PyIoPacket_setbuf,
+        (char*)"Read/write buffer", NULL},
+       {NULL, NULL, NULL, NULL, NULL}};
+
 static PyMemberDef PyIoPacket_members[]
     = {{(char*)"func", T_USHORT, offsetof(PyIoPacket, func), 0,
         (char*)"Function code"},
@@ -416,8 +428,8 @@ static PyMemberDef PyIoPacket_members[]
         (char*)"Open flags"},
        {(char*)"mode", T_INT, offsetof(PyIoPacket, mode), 0,
         (char*)"Permissions for created files"},
-       {(char*)"buf", T_OBJECT, offsetof(PyIoPacket, buf), 0,
-        (char*)"Read/write buffer"},
+       {(char*)"buffer", T_OBJECT, offsetof(PyIoPacket, buffer), READONLY,
+        (char*)"Read/write buffer without copy, valid during plugin_io()"},
        {(char*)"fname", T_STRING, offsetof(PyIoPacket, fname), 0,
         (char*)"Open filename"},
        {(char*)"status", T_INT, offsetof(PyIoPacket, status), 0,
@@ -452,6 +464,7 @@ static PyTypeObject PyIoPacketType = {
     .tp_doc       = "io_pkt object",
     .tp_methods   = PyIoPacket_methods,
     .tp_members   = PyIoPacket_members,
+    .tp_getset    = PyIoPacket_getset,
     .tp_init      = (initproc)PyIoPacket_init,
 };
 /* clang-format on */
@@ -1116,7 +1116,6 @@ class BareosFdPluginPostgreSQL(BareosFdPluginBaseclass):  # noqa
                     f" from file {self.fname}\n"
                 ),
             )
-            IOP.buf = bytearray(IOP.count)
             if self.fname == "ROP":
                 # should never be the case with no_read = True
                 IOP.buf = bytearray()
@@ -1150,7 +1149,7 @@ class BareosFdPluginPostgreSQL(BareosFdPluginBaseclass):  # noqa
                 self.data_stream = io.BytesIO(bdata)
 
             try:
-                IOP.status = self.data_stream.readinto(IOP.buf)
+                IOP.status = self.data_stream.readinto(IOP.buffer)
                 bareosfd.DebugMessage(
                     250,
                     (
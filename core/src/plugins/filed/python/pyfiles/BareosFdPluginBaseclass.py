@@ -350,9 +350,9 @@ class BareosFdPluginBaseclass(object):
             bareosfd.DebugMessage(
                 200, "Reading %d from file %s\n" % (IOP.count, self.FNAME)
             )
-            IOP.buf = bytearray(IOP.count)
             try:
-                IOP.status = self.file.readinto(IOP.buf)
+                # read directly into the buffer of the File Daemon
+                IOP.status = self.file.readinto(IOP.buffer)
                 IOP.io_errno = 0
             except Exception as e:
                 bareosfd.JobMessage(
@@ -375,7 +375,7 @@ class BareosFdPluginBaseclass(object):
     def plugin_io_write(self, IOP):
         bareosfd.DebugMessage(200, "Writing buffer to file %s\n" % (self.FNAME))
         try:
-            self.file.write(IOP.buf)
+            self.file.write(IOP.buffer)
         except Exception as e:
             bareosfd.JobMessage(
                 M_ERROR,
@@ -0,0 +1,44 @@
+#   BAREOS - Backup Archiving REcovery Open Sourced
+#
+#   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+#
+#   This program is Free Software; you can redistribute it and/or
+#   modify it under the terms of version three of the GNU Affero General Public
+#   License as published by the Free Software Foundation and included
+#   in the file LICENSE.
+#
+#   This program is distributed in the hope that it will be useful, but
+#   WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+#   Affero General Public License for more details.
+#
+#   You should have received a copy of the GNU Affero General Public License
+#   along with this program; if not, write to the Free Software
+#   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+#   02110-1301, USA.
+
+# plugin_io() used by python-fd-io-benchmark, reads from /dev/zero and
+# writes to /dev/null either through IOP.buf or through IOP.buffer.
+
+import bareosfd
+
+api = "buf"
+
+source = open("/dev/zero", "rb", buffering=0)
+sink = open("/dev/null", "wb", buffering=0)
+
+
+def plugin_io(IOP):
+    if IOP.func == bareosfd.IO_READ:
+        if api == "buffer":
+            IOP.status = source.readinto(IOP.buffer)
+        else:
+            IOP.buf = bytearray(IOP.count)
+            IOP.status = source.readinto(IOP.buf)
+    elif IOP.func == bareosfd.IO_WRITE:
+        if api == "buffer":
+            sink.write(IOP.buffer)
+        else:
+            sink.write(IOP.buf)
+        IOP.status = IOP.count
+    return bareosfd.bRC_OK
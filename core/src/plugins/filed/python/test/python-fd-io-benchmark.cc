@@ -0,0 +1,168 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation, which is
+   listed in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+/* Measures the throughput of plugin_io() through the python-fd extension
+ * module, with the plugin in bareosfd-io-benchmark.py using IOP.buf (which
+ * copies every block) or IOP.buffer (which does not).
+ *
+ * usage: bareosfd-python3-io-benchmark [block size] [megabytes] */
+
+#include "Python.h"
+#include <inttypes.h>
+class PoolMem;
+typedef off_t boffset_t;
+
+#include "lib/plugins.h"
+#include "filed/fd_plugins.h"
+#include "findlib/find.h"
+#include "../module/bareosfd.h"
+#include "../plugin_private_context.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace filedaemon;
+
+static bRC bareosJobMsg(PluginContext*,
+                        const char* file,
+                        int line,
+                        int type,
+                        utime_t,
+                        const char* fmt,
+                        ...)
+{
+  char buffer[1024]{};
+  va_list arg_ptr;
+  va_start(arg_ptr, fmt);
+  vsnprintf(buffer, sizeof(buffer), fmt, arg_ptr);
+  va_end(arg_ptr);
+  printf("bareosJobMsg %s:%d type:%d %s\n", file, line, type, buffer);
+  return bRC_OK;
+}
+
+static bRC bareosDebugMsg(PluginContext*,
+                          const char* file,
+                          int line,
+                          int level,
+                          const char* fmt,
+                          ...)
+{
+  char buffer[1024]{};
+  va_list arg_ptr;
+  va_start(arg_ptr, fmt);
+  vsnprintf(buffer, sizeof(buffer), fmt, arg_ptr);
+  va_end(arg_ptr);
+  printf("bareosDebugMsg %s:%d level:%d %s\n", file, line, level, buffer);
+  return bRC_OK;
+}
+
+static Plugin plugin
+    = {(char*)"python-fd-io-benchmark", 123, NULL, NULL, NULL, NULL};
+
+// Returns MB/s or a negative value on error.
+static double Run(PluginContext* ctx,
+                  PyObject* module_dict,
+                  const char* api,
+                  int32_t func,
+                  std::vector<char>& block,
+                  long iterations)
+{
+  PyObject* value = PyUnicode_FromString(api);
+  PyDict_SetItemString(module_dict, "api", value);
+  Py_DECREF(value);
+
+  io_pkt io{};
+  io.func = func;
+  io.count = static_cast<int32_t>(block.size());
+  io.buf = block.data();
+
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; ++i) {
+    io.status = 0;
+    if (Bareosfd_PyPluginIO(ctx, &io) != bRC_OK || io.status != io.count) {
+      return -1;
+    }
+  }
+  std::chrono::duration<double> elapsed
+      = std::chrono::steady_clock::now() - start;
+
+  return static_cast<double>(block.size()) * iterations / elapsed.count()
+         / (1024 * 1024);
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t block_size = argc > 1 ? std::atol(argv[1]) : 64 * 1024;
+  long megabytes = argc > 2 ? std::atol(argv[2]) : 4096;
+  if (block_size == 0 || megabytes <= 0) {
+    fprintf(stderr, "usage: %s [block size] [megabytes]\n", argv[0]);
+    return 1;
+  }
+  long iterations = megabytes * 1024 * 1024 / block_size;
+
+  Py_Initialize();
+  if (!PyImport_ImportModule("bareosfd")) {
+    PyErr_Print();
+    return 1;
+  }
+  import_bareosfd();
+
+  CoreFunctions core_functions{};
+  core_functions.size = sizeof(core_functions);
+  core_functions.version = FD_PLUGIN_INTERFACE_VERSION;
+  core_functions.JobMessage = bareosJobMsg;
+  core_functions.DebugMessage = bareosDebugMsg;
+  Bareosfd_set_bareos_core_functions(&core_functions);
+
+  PyObject* module = PyImport_ImportModule("bareosfd-io-benchmark");
+  if (!module) {
+    PyErr_Print();
+    return 1;
+  }
+
+  plugin_private_context private_context{};
+  private_context.pyModuleFunctionsDict = PyModule_GetDict(module);
+  PluginContext ctx{0, &plugin, &private_context, NULL};
+  Bareosfd_set_plugin_context(&ctx);
+
+  std::vector<char> block(block_size);
+  printf("%zu byte blocks, %ld MB per run\n", block_size, megabytes);
+  for (const char* api : {"buf", "buffer"}) {
+    for (auto [name, func] : {std::pair{"read", IO_READ},
+                              std::pair{"write", IO_WRITE}}) {
+      double rate = Run(&ctx, private_context.pyModuleFunctionsDict, api, func,
+                        block, iterations);
+      if (rate < 0) {
+        if (PyErr_Occurred()) { PyErr_Print(); }
+        fprintf(stderr, "plugin_io() %s through IOP.%s failed\n", name, api);
+        return 1;
+      }
+      printf("%-5s IOP.%-6s %10.1f MB/s\n", name, api, rate);
+    }
+  }
+
+  Py_DECREF(module);
+  Py_Finalize();
+  return 0;
+}
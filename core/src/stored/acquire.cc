@@ -44,6 +44,7 @@
 #include "include/jcr.h"
 #include "stored/block.h"
 #include "stored/stored_jcr_impl.h"
+#include "stored/volume_index.h"
 #include "lib/bpipe.h"
 
 #include <algorithm>
@@ -75,6 +76,7 @@ DeviceControlRecord::DeviceControlRecord()
 static int const rdebuglevel = 100;
 
 /* Forward referenced functions */
+static void FreeExtentBlocks(DeviceControlRecord* dcr);
 static void AttachDcrToDev(DeviceControlRecord* dcr);
 static void DetachDcrFromDev(DeviceControlRecord* dcr);
 static void SetDcrFromVol(DeviceControlRecord* dcr, VolumeList* vol);
@@ -503,6 +505,10 @@ bool ReleaseDevice(DeviceControlRecord* dcr)
    * A previous implementation did the flush inside dev->close(),
    * which resulted in various locking problems. */
   if (!jcr->IsJobCanceled()) {
+    if (!dcr->FlushBlocks()) {
+      Jmsg(jcr, M_FATAL, 0, "Failed to write kept back blocks to device %s.\n",
+           dev->print_name());
+    }
     if (!dev->d_flush(dcr)) {
       Jmsg(jcr, M_FATAL, 0, "Failed to flush device %s.\n", dev->print_name());
     }
@@ -561,6 +567,7 @@ bool ReleaseDevice(DeviceControlRecord* dcr)
           dev->weof(1);
           WriteAnsiIbmLabels(dcr, ANSI_EOF_LABEL, dev->VolHdr.VolumeName);
         }
+        FlushVolumeIndex(dev);
         if (!dev->AtWeot()) {
           dev->VolCatInfo.VolCatFiles = dev->file; /* set number of files */
 
@@ -691,6 +698,7 @@ void SetupNewDcrDevice(JobControlRecord* jcr,
 
     if (dcr->block) { FreeBlock(dcr->block); }
     dcr->block = new_block(dev);
+    FreeExtentBlocks(dcr);
 
     if (dcr->rec) {
       FreeRecord(dcr->rec);
@@ -721,6 +729,15 @@ void SetupNewDcrDevice(JobControlRecord* jcr,
   }
 }
 
+// Blocks kept back for an extent are lost, FlushBlocks() writes them.
+static void FreeExtentBlocks(DeviceControlRecord* dcr)
+{
+  for (DeviceBlock* block : dcr->extent_blocks) { FreeBlock(block); }
+  dcr->extent_blocks.clear();
+  for (DeviceBlock* block : dcr->spare_blocks) { FreeBlock(block); }
+  dcr->spare_blocks.clear();
+}
+
 static void AttachDcrToDev(DeviceControlRecord* dcr)
 {
   Device* dev;
@@ -790,6 +807,7 @@ void FreeDeviceControlRecord(DeviceControlRecord* dcr)
   LockedDetachDcrFromDev(dcr);
 
   if (dcr->block) { FreeBlock(dcr->block); }
+  FreeExtentBlocks(dcr);
 
   if (dcr->rec) { FreeRecord(dcr->rec); }
 
@@ -27,15 +27,20 @@
 
 #include "stored/append.h"
 #include "stored/askdir.h"
+#include "stored/bandwidth.h"
 #include "stored/stored.h"
 #include "stored/acquire.h"
 #include "stored/checkpoint_handler.h"
+#include "stored/chunk_index.h"
+#include "stored/data_connections.h"
 #include "stored/fd_cmds.h"
 #include "stored/stored_globals.h"
 #include "stored/stored_jcr_impl.h"
 #include "stored/label.h"
 #include "stored/spool.h"
 #include "lib/bget_msg.h"
+#include "lib/bsock_striped.h"
+#include "lib/chunk_manifest.h"
 #include "lib/edit.h"
 #include "include/jcr.h"
 #include "include/streams.h"
@@ -50,6 +55,7 @@
 #include <deque>
 #include <utility>
 #include <condition_variable>
+#include <cstring>
 #include "lib/channel.h"
 
 namespace {
@@ -144,8 +150,12 @@ class MessageHandler {
 
   using result_type = std::variant<signal_type, message_type, error_type>;
 
-  MessageHandler(BareosSocket* t_fd)
-      : MessageHandler{t_fd,
+  /* If there are stripes, the messages are read from them instead of t_fd.
+   * The time spent reading them is added to stats as receive stage. */
+  MessageHandler(BareosSocket* t_fd,
+                 std::vector<BareosSocket*> stripes,
+                 PipelineStats& t_stats)
+      : MessageHandler{t_fd, std::move(stripes), t_stats,
                        // 500 msg reserves at most 256MB in size
                        // probably much less because of signals
                        channel::CreateBufferedChannel<result_type>(500)}
@@ -163,15 +173,26 @@ class MessageHandler {
   BareosSocket* close_and_get_sock()
   {
     output.close();
+    if (striped) { striped->Close(); }
     receive_thread.join();
     return fd;
   }
 
  private:
+  // messages that arrived out of order and wait for their predecessors
+  static constexpr std::size_t max_reordered = 256;
+
   MessageHandler(BareosSocket* t_fd,
+                 std::vector<BareosSocket*> stripes,
+                 PipelineStats& t_stats,
                  std::pair<channel::input<result_type>,
                            channel::output<result_type>> chan_pair)
       : fd{t_fd}
+      , stats{t_stats}
+      , striped{stripes.empty() ? nullptr
+                                : std::make_unique<StripedReceiver>(
+                                    std::move(stripes), max_reordered,
+                                    &t_stats)}
       , input{std::move(chan_pair.first)}
       , output{std::move(chan_pair.second)}
       , receive_thread{enlist, this}
@@ -179,6 +200,8 @@ class MessageHandler {
   }
 
   BareosSocket* fd;
+  PipelineStats& stats;
+  std::unique_ptr<StripedReceiver> striped;
   channel::input<result_type> input;
   channel::output<result_type> output;
 
@@ -186,8 +209,46 @@ class MessageHandler {
   // The thread created will try to access this class immediately after
   // being created!  As such everything else has to be initialized.
   std::thread receive_thread;
+
+  /* Signals are handled like BgetMsg() does, except for polls: their
+   * answers could overtake data that is still in flight. */
+  void receive_striped()
+  {
+    while (auto msg = striped->Next()) {
+      result_type result;
+      bool cont = true;
+      if (msg->status >= 0) {
+        std::size_t length = msg->status;
+        result = message_type{length, std::move(msg->data)};
+      } else if (msg->status == BNET_SIGNAL) {
+        if (msg->signal == BNET_HEARTBEAT || msg->signal == BNET_HB_RESPONSE) {
+          continue;
+        }
+        if (msg->signal == BNET_TERMINATE) { fd->SetTerminated(); }
+        result = signal_type{msg->signal};
+      } else {
+        auto type = msg->status == BNET_HARDEOF
+                        ? error_type::type::HARDEOF
+                        : error_type::type::INTERNAL_ERROR;
+        result = error_type{type, std::move(msg->error)};
+        cont = false;
+      }
+
+      if (!input.emplace(std::move(result)) || !cont || input.closed()) {
+        break;
+      }
+    }
+
+    input.close();
+  }
+
   void do_work()
   {
+    if (striped) {
+      receive_striped();
+      return;
+    }
+
     POOLMEM* save = fd->msg;
     bool cont = true;
     for (int res = 0; cont; res = fd->WaitData(0, 100'000)) {
@@ -195,7 +256,10 @@ class MessageHandler {
         PoolMem msg(PM_MESSAGE);
         fd->msg = msg.addr();
         result_type result;
+        auto start = PipelineStats::clock::now();
         int n = BgetMsg(fd);
+        stats.Add(PipelineStage::kReceive, start, PipelineStats::clock::now(),
+                  std::max(n, 0));
         // fd->msg might have been relocated
         msg.addr() = fd->msg;
         if (n < 0) {
@@ -243,6 +307,227 @@ class MessageHandler {
   static void enlist(MessageHandler* handler) { handler->do_work(); }
 };
 
+/* Receives the data records that the daemon sends as chunk manifests (see
+ * lib/chunk_manifest.h): tells it which chunks we already have, receives the
+ * missing ones and puts the records back together.  Known chunks are
+ * referenced as soon as they are looked up, so that they cannot be collected
+ * before their records are rebuilt.
+ *
+ * The rebuilt records go through the normal block (and spool) path, whose
+ * checksums cover the record data, so known chunks are still read from the
+ * index.  Their references are kept until the blocks are likely written:
+ * the device then takes them over while the chunks are in its read cache,
+ * instead of chunking the data and updating the index once more. */
+class ChunkedRecordReceiver {
+ public:
+  using message_type = MessageHandler::message_type;
+  using result_type = MessageHandler::result_type;
+
+  ChunkedRecordReceiver(JobControlRecord* jcr,
+                        MessageHandler& handler,
+                        BareosSocket* bs,
+                        const char* what)
+      : jcr_{jcr}
+      , handler_{handler}
+      , bs_{bs}
+      , what_{what}
+      , index_{jcr->sd_impl->chunk_index}
+  {
+  }
+  ~ChunkedRecordReceiver()
+  {
+    for (auto& batch : pending_) { index_->Release(Pinned(batch)); }
+    while (!rebuilt_.empty()) { ReleaseOldestRebuilt(); }
+  }
+  ChunkedRecordReceiver(const ChunkedRecordReceiver&) = delete;
+  ChunkedRecordReceiver& operator=(const ChunkedRecordReceiver&) = delete;
+
+  // BNET_CHUNK_MANIFEST: look up and answer the next manifest
+  bool ReceiveManifest();
+  // BNET_CHUNK_DATA: rebuild the records of the oldest manifest
+  bool ReceiveData();
+
+  // Records that were put back together, in stream order
+  std::optional<result_type> NextRecord()
+  {
+    if (ready_.empty()) { return std::nullopt; }
+    result_type record{std::move(ready_.front())};
+    ready_.pop_front();
+    return record;
+  }
+  bool Idle() const { return pending_.empty() && ready_.empty(); }
+
+ private:
+  struct pending_batch {
+    chunk_manifest::batch records;
+    // one entry per chunk; set if the chunk is known (and referenced)
+    std::vector<std::optional<std::uint64_t>> ids;
+    std::size_t missing_size{0};
+  };
+
+  JobControlRecord* jcr_;
+  MessageHandler& handler_;
+  BareosSocket* bs_;
+  const char* what_;
+  ChunkIndex* index_;
+  std::deque<pending_batch> pending_;
+  std::deque<message_type> ready_;
+
+  // the device only takes references over while it still caches the chunks
+  static constexpr std::size_t max_rebuilt_size = 64 * 1024 * 1024;
+  struct rebuilt_batch {
+    std::vector<std::uint64_t> pinned;
+    std::size_t size;
+  };
+  std::deque<rebuilt_batch> rebuilt_;
+  std::size_t rebuilt_size_{0};
+
+  void ReleaseOldestRebuilt()
+  {
+    index_->Release(rebuilt_.front().pinned);
+    rebuilt_size_ -= rebuilt_.front().size;
+    rebuilt_.pop_front();
+  }
+
+  std::optional<message_type> NextMessage()
+  {
+    auto msg = handler_.get_msg();
+    if (!msg) { return std::nullopt; }
+    if (auto* content = std::get_if<message_type>(&msg.value())) {
+      return std::move(*content);
+    }
+    return std::nullopt;
+  }
+
+  bool Rebuild(const pending_batch& batch);
+
+  static std::vector<std::uint64_t> Pinned(const pending_batch& batch)
+  {
+    std::vector<std::uint64_t> pinned;
+    for (auto& id : batch.ids) {
+      if (id) { pinned.push_back(*id); }
+    }
+    return pinned;
+  }
+};
+
+bool ChunkedRecordReceiver::ReceiveManifest()
+{
+  auto manifest = NextMessage();
+  if (!manifest) {
+    Jmsg1(jcr_, M_FATAL, 0, T_("Did not receive chunk manifest from %s.\n"),
+          what_);
+    return false;
+  }
+
+  auto records = chunk_manifest::Decode(manifest->data.c_str(), manifest->size);
+  if (!records) {
+    Jmsg1(jcr_, M_FATAL, 0, T_("Malformed chunk manifest from %s.\n"), what_);
+    return false;
+  }
+
+  // records are never bigger than a single network packet
+  constexpr std::size_t max_record_size = 1'000'000;
+  for (auto& chunks : *records) {
+    std::size_t record_size = 0;
+    for (auto& chunk : chunks) { record_size += chunk.size; }
+    if (record_size > max_record_size) {
+      Jmsg2(jcr_, M_FATAL, 0,
+            T_("Chunk manifest from %s too big (%" PRIuz ").\n"), what_,
+            record_size);
+      return false;
+    }
+  }
+
+  pending_batch& batch = pending_.emplace_back();
+  batch.records = std::move(records).value();
+
+  std::vector<bool> known;
+  for (auto& chunks : batch.records) {
+    for (auto& chunk : chunks) {
+      auto& id = batch.ids.emplace_back(
+          index_->Reference(chunk.digest, chunk.size));
+      known.push_back(id.has_value());
+      if (!id) { batch.missing_size += chunk.size; }
+    }
+  }
+
+  bs_->message_length = chunk_manifest::EncodeKnown(known, bs_->msg);
+  if (!bs_->send()) {
+    Jmsg2(jcr_, M_FATAL, 0, T_("Network send error to %s. ERR=%s\n"), what_,
+          bs_->bstrerror());
+    return false;
+  }
+
+  return true;
+}
+
+bool ChunkedRecordReceiver::ReceiveData()
+{
+  if (pending_.empty()) {
+    Jmsg1(jcr_, M_FATAL, 0, T_("Unexpected chunk data from %s.\n"), what_);
+    return false;
+  }
+
+  pending_batch batch = std::move(pending_.front());
+  pending_.pop_front();
+
+  if (!Rebuild(batch)) {
+    index_->Release(Pinned(batch));
+    return false;
+  }
+
+  std::size_t size = 0;
+  for (auto& chunks : batch.records) {
+    for (auto& chunk : chunks) { size += chunk.size; }
+  }
+  rebuilt_.push_back(rebuilt_batch{Pinned(batch), size});
+  rebuilt_size_ += size;
+  while (rebuilt_size_ > max_rebuilt_size) { ReleaseOldestRebuilt(); }
+  return true;
+}
+
+bool ChunkedRecordReceiver::Rebuild(const pending_batch& batch)
+{
+  std::optional<message_type> missing;
+  if (batch.missing_size > 0) {
+    missing = NextMessage();
+    if (!missing || missing->size != batch.missing_size) {
+      Jmsg1(jcr_, M_FATAL, 0, T_("Did not receive missing chunks from %s.\n"),
+            what_);
+      return false;
+    }
+  }
+
+  const char* src = missing ? missing->data.c_str() : nullptr;
+  std::size_t total_size = 0;
+  std::size_t i = 0;
+  for (auto& chunks : batch.records) {
+    std::size_t record_size = 0;
+    for (auto& chunk : chunks) { record_size += chunk.size; }
+
+    PoolMem record(PM_MESSAGE);
+    char* dest = record.check_size(record_size);
+    for (auto& chunk : chunks) {
+      auto& id = batch.ids[i++];
+      if (!id) {
+        std::memcpy(dest, src, chunk.size);
+        src += chunk.size;
+      } else if (!index_->Read(*id, dest, chunk.size)) {
+        Jmsg0(jcr_, M_FATAL, 0, T_("Could not read chunk from chunk index.\n"));
+        return false;
+      }
+      dest += chunk.size;
+    }
+
+    ready_.push_back(message_type{record_size, std::move(record)});
+    total_size += record_size;
+  }
+
+  jcr_->sd_impl->dedup_bytes += total_size - batch.missing_size;
+  return true;
+}
+
 static bool SetupDCR(JobControlRecord* jcr,
                      std::int64_t& volid,
                      uint32_t& blocknum)
@@ -330,8 +615,12 @@ static bool SetupDCR(JobControlRecord* jcr,
   return true;
 }
 
-// Append Data sent from File daemon
-bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
+/* Append Data sent from File daemon.  If data_connections is not 0, the
+ * data is striped over that many additional connections. */
+bool DoAppendData(JobControlRecord* jcr,
+                  BareosSocket* bs,
+                  const char* what,
+                  uint32_t data_connections)
 {
   int32_t n, file_index, stream, last_file_index, job_elapsed;
   bool ok = true;
@@ -366,6 +655,20 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
     }
   }
 
+  std::vector<BareosSocket*> stripes;
+  if (data_connections > 0) {
+    stripes = WaitForDataConnections(jcr, data_connections);
+    if (stripes.empty()) {
+      Jmsg2(jcr, M_FATAL, 0, T_("Did not get %u data connections from %s.\n"),
+            data_connections, what);
+      CloseDataConnections(jcr);
+      return false;
+    }
+    Jmsg2(jcr, M_INFO, 0, T_("Receiving data over %u connections from %s.\n"),
+          data_connections, what);
+    for (auto* stripe : stripes) { ScheduleBandwidth(jcr, stripe); }
+  }
+
   // Tell daemon to send data
   if (!bs->fsend(OK_data)) {
     BErrNo be;
@@ -410,7 +713,18 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
           cloned->fd_, cloned->errmsg);
     return false;
   }
-  MessageHandler handler(cloned);
+  ScheduleBandwidth(jcr, cloned);
+
+  auto& stats = jcr->pipeline_stats;
+  stats.Start();
+  if (!me->pipeline_trace_directory.empty()) { stats.EnableTrace(); }
+  MessageHandler handler(cloned, std::move(stripes), stats);
+
+  // the messages are read by the handler, here we only wait for them
+  auto receive = [&handler, &stats]() {
+    StageTimer timer(stats, PipelineStage::kUpstreamWait);
+    return handler.get_msg();
+  };
 
   for (last_file_index = 0; ok && !jcr->IsJobCanceled();) {
     /* Read Stream header from the daemon.
@@ -420,7 +734,7 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
      * - stream     (Bareos number to distinguish parts of data)
      * - info       (Info for Storage daemon -- compressed, encrypted, ...)
      *               info is not currently used, so is read, but ignored! */
-    auto msg = handler.get_msg();
+    auto msg = receive();
     if (!msg) {
       Jmsg2(jcr, M_FATAL, 0,
             T_("Internal Error reading data header from %s.\n"), what);
@@ -490,8 +804,10 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
      * We save the original data pointer from the record so we can restore
      * that after the loop ends. */
     POOLMEM* rec_data = nullptr;
+    ChunkedRecordReceiver chunked(jcr, handler, bs, what);
     while (!jcr->IsJobCanceled()) {
-      auto msg2 = handler.get_msg();
+      auto msg2 = chunked.NextRecord();
+      if (!msg2) { msg2 = receive(); }
 
       if (!msg2) {
         Jmsg2(jcr, M_FATAL, 0, T_("Internal Error reading data from %s.\n"),
@@ -508,11 +824,28 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
         break;
       }
 
+      if (auto* signal = std::get_if<signal_type>(&msg2.value());
+          signal && jcr->sd_impl->chunk_index
+          && (*signal == BNET_CHUNK_MANIFEST || *signal == BNET_CHUNK_DATA)) {
+        if (!(*signal == BNET_CHUNK_MANIFEST ? chunked.ReceiveManifest()
+                                             : chunked.ReceiveData())) {
+          ok = false;
+          break;
+        }
+        continue;
+      }
+
       if (auto* signal = std::get_if<signal_type>(&msg2.value())) {
         if (*signal != BNET_EOD) {
           Jmsg2(jcr, M_FATAL, 0, T_("Unexpected signal from %s: %d\n"), what,
                 *signal);
           ok = false;
+        } else if (!chunked.Idle()) {
+          Jmsg1(jcr, M_FATAL, 0,
+                T_("Data stream from %s ended with unanswered chunk "
+                   "manifests.\n"),
+                what);
+          ok = false;
         }
         break;
       }
@@ -621,6 +954,13 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
     copy->close();
     delete copy;
   }
+  CloseDataConnections(jcr);
+
+  if (jcr->sd_impl->chunk_index) {
+    Jmsg(jcr, M_INFO, 0,
+         T_("Client side deduplication: %s bytes were already stored.\n"),
+         edit_uint64_with_commas(jcr->sd_impl->dedup_bytes, ec));
+  }
 
   // Create Job status for end of session label
   jcr->setJobStatusWithPriorityCheck(ok ? JS_Terminated : JS_ErrorTerminated);
@@ -658,7 +998,8 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
       Dmsg0(90, "back from write_end_session_label()\n");
 
       // Flush out final partial block of this session
-      if (!jcr->sd_impl->dcr->WriteBlockToDevice()) {
+      if (!jcr->sd_impl->dcr->WriteBlockToDevice()
+          || !jcr->sd_impl->dcr->FlushBlocks()) {
         // Print only if ok and not cancelled to avoid spurious messages
         if (ok && !jcr->IsJobCanceled()) {
           Jmsg2(jcr, M_FATAL, 0,
@@ -708,6 +1049,7 @@ bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what)
        T_("Elapsed time=%02d:%02d:%02d, Transfer rate=%s Bytes/second\n"),
        job_elapsed / 3600, job_elapsed % 3600 / 60, job_elapsed % 60,
        edit_uint64_with_suffix(jcr->JobBytes / job_elapsed, ec));
+  ReportPipelineStats(jcr, me->pipeline_trace_directory, "sd");
 
   if ((!ok || jcr->IsJobCanceled()) && !jcr->is_JobStatus(JS_Incomplete)) {
     DiscardAttributeSpool(jcr);
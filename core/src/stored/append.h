@@ -61,7 +61,10 @@ class ProcessedFile {
   std::vector<ProcessedFileData> attributes_;
 };
 
-bool DoAppendData(JobControlRecord* jcr, BareosSocket* bs, const char* what);
+bool DoAppendData(JobControlRecord* jcr,
+                  BareosSocket* bs,
+                  const char* what,
+                  uint32_t data_connections);
 bool IsAttribute(DeviceRecord* record);
 bool SendAttrsToDir(JobControlRecord* jcr, DeviceRecord* rec);
 }  // namespace storagedaemon
@@ -202,6 +202,41 @@ bool AuthenticateFiledaemon(JobControlRecord* jcr)
   return true;
 }
 
+/**
+ * Authenticate an additional data connection of a striped transfer from a
+ * File daemon or a replicating Storage daemon.
+ */
+bool AuthenticateDataConnection(JobControlRecord* jcr,
+                                BareosSocket* bs,
+                                bool from_storage)
+{
+  s_password password;
+
+  password.encoding = p_encoding_md5;
+  password.value = jcr->sd_auth_key;
+  const char* identity = from_storage ? "* replicate *" : jcr->client_name;
+
+  return bs->AuthenticateInboundConnection(nullptr, my_config, identity,
+                                           password, me);
+}
+
+/**
+ * Authenticate with a remote storage daemon on an additional data connection.
+ *
+ * This is used for striped SD-SD replication of data.
+ */
+bool AuthenticateWithDataConnection(JobControlRecord* jcr, BareosSocket* sd)
+{
+  s_password password;
+
+  password.encoding = p_encoding_md5;
+  password.value = jcr->sd_auth_key;
+
+  return sd->AuthenticateOutboundConnection(
+      nullptr, my_config->CreateOwnQualifiedNameForNetworkDump(),
+      "* replicate *", password, me);
+}
+
 /**
  * Authenticate with a remote file daemon.
  *
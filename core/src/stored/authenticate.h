@@ -29,6 +29,10 @@ bool AuthenticateStoragedaemon(JobControlRecord* jcr);
 bool AuthenticateWithStoragedaemon(JobControlRecord* jcr);
 bool AuthenticateFiledaemon(JobControlRecord* jcr);
 bool AuthenticateWithFiledaemon(JobControlRecord* jcr);
+bool AuthenticateDataConnection(JobControlRecord* jcr,
+                                BareosSocket* bs,
+                                bool from_storage);
+bool AuthenticateWithDataConnection(JobControlRecord* jcr, BareosSocket* sd);
 
 } /* namespace storagedaemon */
 
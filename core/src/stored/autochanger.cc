@@ -30,6 +30,8 @@
 #include "stored/stored.h"
 #include "stored/stored_globals.h"
 #include "stored/autochanger.h"
+#include "stored/autochanger_resource.h"
+#include "stored/changer_inventory.h"
 #include "stored/device_control_record.h"
 #include "stored/wait.h"
 #include "lib/berrno.h"
@@ -46,6 +48,11 @@ namespace storagedaemon {
 /* Forward referenced functions */
 static bool LockChanger(DeviceControlRecord* dcr);
 static bool UnlockChanger(DeviceControlRecord* dcr);
+static ChangerInventory* GetInventory(DeviceControlRecord* dcr);
+static bool RefreshInventory(DeviceControlRecord* dcr);
+static void EndInventoryMove(ChangerInventory* inventory,
+                             drive_number_t drive,
+                             std::optional<slot_number_t> loaded);
 static Device* FindDriveForSlot(DeviceControlRecord* dcr, slot_number_t slot);
 static char* transfer_edit_device_codes(DeviceControlRecord* dcr,
                                         POOLMEM*& omsg,
@@ -185,6 +192,9 @@ int AutoloadDevice(DeviceControlRecord* dcr, int writing, BareosSocket* dir)
     uint32_t timeout = dcr->device_resource->max_changer_wait;
     int status;
     slot_number_t loaded_slot;
+    ChangerInventory* inventory = GetInventory(dcr);
+    bool concurrent = inventory
+                      && dcr->device_resource->changer_res->concurrent_moves;
 
     // Attempt to load the Volume
     loaded_slot = GetAutochangerLoadedSlot(dcr);
@@ -196,12 +206,37 @@ int AutoloadDevice(DeviceControlRecord* dcr, int writing, BareosSocket* dir)
         goto bail_out;
       }
 
-      // Unload anything in our drive
-      if (!UnloadAutochanger(dcr, loaded_slot, true)) {
+      /* Unload anything in our drive. With concurrent moves this is done
+       * after the changer lock was released. */
+      if (!concurrent && !UnloadAutochanger(dcr, loaded_slot, true)) {
         UnlockChanger(dcr);
         goto bail_out;
       }
 
+      // The wanted cartridge may just be on its way into another drive
+      if (inventory) {
+        int retries = 0;
+        while (retries < 3 && inventory->SlotMoving(wanted_slot)) {
+          UnlockChanger(dcr);
+          WaitForDevice(dcr->jcr, retries);
+          if (!LockChanger(dcr)) {
+            rtn_stat = -2;
+            goto bail_out;
+          }
+        }
+
+        if (inventory->SlotMoving(wanted_slot)) {
+          Jmsg(dcr->jcr, M_WARNING, 0,
+               T_("Volume \"%s\" wanted on %s is being moved by the "
+                  "autochanger\n"),
+               dcr->VolumeName, dcr->dev->print_name());
+          VolumeUnused(dcr);
+
+          UnlockChanger(dcr);
+          goto bail_out;
+        }
+      }
+
       auto* other_device = FindDriveForSlot(dcr, wanted_slot);
       if (other_device) {
         int retries = 0;
@@ -247,12 +282,33 @@ int AutoloadDevice(DeviceControlRecord* dcr, int writing, BareosSocket* dir)
            T_("3304 Issuing autochanger \"load slot %hd, drive %hd\" "
               "command.\n"),
            wanted_slot, drive);
+      if (concurrent) {
+        if (!inventory->BeginMove(dcr->dev->drive_index,
+                                  {wanted_slot, loaded_slot})) {
+          UnlockChanger(dcr);
+          goto bail_out;
+        }
+        UnlockChanger(dcr);
+
+        if (!UnloadAutochanger(dcr, loaded_slot, true)) {
+          EndInventoryMove(inventory, dcr->dev->drive_index, std::nullopt);
+          goto bail_out;
+        }
+      }
+
       dcr->VolCatInfo.Slot = wanted_slot; /* slot to be loaded */
       changer = edit_device_codes(
           dcr, changer, dcr->device_resource->changer_command, "load");
       dcr->dev->close(dcr);
       Dmsg1(200, "Run program=%s\n", changer);
       status = RunProgramFullOutput(changer, timeout, results.addr());
+      if (inventory) {
+        if (status == 0) {
+          inventory->SetLoaded(dcr->dev->drive_index, wanted_slot);
+        } else {
+          inventory->Invalidate(dcr->dev->drive_index);
+        }
+      }
       if (status == 0) {
         Jmsg(jcr, M_INFO, 0,
              T_("3305 Autochanger \"load slot %hd, drive %hd\", status is "
@@ -284,7 +340,14 @@ int AutoloadDevice(DeviceControlRecord* dcr, int writing, BareosSocket* dir)
         dcr->dev->SetSlotNumber(-1); /* mark unknown */
       }
       Dmsg2(100, "load slot %hd status=%d\n", wanted_slot, status);
-      UnlockChanger(dcr);
+      if (concurrent) {
+        EndInventoryMove(inventory, dcr->dev->drive_index,
+                         status == 0
+                             ? std::optional<slot_number_t>{wanted_slot}
+                             : std::nullopt);
+      } else {
+        UnlockChanger(dcr);
+      }
     } else {
       status = 0;                           /* we got what we want */
       dcr->dev->SetSlotNumber(wanted_slot); /* set currently loaded slot */
@@ -330,12 +393,33 @@ slot_number_t GetAutochangerLoadedSlot(DeviceControlRecord* dcr, bool lock_set)
   // Virtual disk autochanger
   if (dcr->device_resource->changer_command[0] == 0) { return 1; }
 
+  ChangerInventory* inventory = GetInventory(dcr);
+  if (inventory && dcr->device_resource->changer_res->inventory_cache) {
+    if (auto cached = inventory->LoadedSlot(dev->drive_index)) {
+      Dmsg2(100, "Inventory: drive %hd holds slot %hd\n", dev->drive_index,
+            *cached);
+      dev->SetSlotNumber(*cached);
+      return *cached;
+    }
+  }
+
   /* Only lock the changer if the lock_set is false e.g. changer not locked by
    * calling function. */
   if (!lock_set) {
     if (!LockChanger(dcr)) { return kInvalidSlotNumber; }
   }
 
+  /* One "listall" tells about all drives of the changer, so the next drive
+   * asking does not need to run the changer command again. */
+  if (inventory && dcr->device_resource->changer_res->inventory_cache
+      && RefreshInventory(dcr)) {
+    if (auto cached = inventory->LoadedSlot(dev->drive_index)) {
+      dev->SetSlotNumber(*cached);
+      if (!lock_set) { UnlockChanger(dcr); }
+      return *cached;
+    }
+  }
+
   /* Find out what is loaded, zero means device is unloaded
    * Suppress info when polling */
   if (!dev->poll && debug_level >= 1) {
@@ -373,6 +457,7 @@ slot_number_t GetAutochangerLoadedSlot(DeviceControlRecord* dcr, bool lock_set)
       }
       dev->SetSlotNumber(0);
     }
+    if (inventory) { inventory->SetLoaded(dev->drive_index, dev->GetSlot()); }
   } else {
     BErrNo be;
     be.SetErrno(status);
@@ -436,6 +521,57 @@ static bool UnlockChanger(DeviceControlRecord* dcr)
   return true;
 }
 
+// The inventory of the autochanger the device belongs to, if any
+static ChangerInventory* GetInventory(DeviceControlRecord* dcr)
+{
+  AutochangerResource* changer_res = dcr->device_resource->changer_res;
+
+  return changer_res ? changer_res->inventory : nullptr;
+}
+
+/**
+ * Read what is loaded in all drives of the autochanger with a single
+ * "listall" changer command. Called with the changer locked.
+ */
+static bool RefreshInventory(DeviceControlRecord* dcr)
+{
+  ChangerInventory* inventory = GetInventory(dcr);
+  uint32_t timeout = dcr->device_resource->max_changer_wait;
+  PoolMem results(PM_MESSAGE);
+  int status;
+
+  if (!inventory || !inventory->ListallSupported()) { return false; }
+
+  POOLMEM* changer = GetPoolMemory(PM_FNAME);
+  changer = edit_device_codes(dcr, changer,
+                              dcr->device_resource->changer_command, "listall");
+  Dmsg1(100, "Run program=%s\n", changer);
+  status = RunProgramFullOutput(changer, timeout, results.addr());
+  FreePoolMemory(changer);
+
+  if (status != 0 || !inventory->Update(results.c_str())) {
+    Dmsg2(100, "No inventory from \"listall\" stat=%d result=%s\n", status,
+          results.c_str());
+    // Drives are queried one by one from now on.
+    inventory->SetListallUnsupported();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * A move of the autochanger has finished, jobs waiting for one of the
+ * cartridges or the drive involved can go on.
+ */
+static void EndInventoryMove(ChangerInventory* inventory,
+                             drive_number_t drive,
+                             std::optional<slot_number_t> loaded)
+{
+  inventory->EndMove(drive, loaded);
+  ReleaseDeviceCond();
+}
+
 /**
  * Unload the volume, if any, in this drive
  * On entry: loaded_slot == 0                   -- nothing to do
@@ -505,6 +641,13 @@ bool UnloadAutochanger(DeviceControlRecord* dcr,
     } else {
       dev->SetSlotNumber(0); /* nothing loaded */
     }
+    if (ChangerInventory* inventory = GetInventory(dcr)) {
+      if (status == 0) {
+        inventory->SetLoaded(dev->drive_index, 0);
+      } else {
+        inventory->Invalidate(dev->drive_index);
+      }
+    }
 
     FreePoolMemory(changer);
   }
@@ -536,6 +679,11 @@ static Device* FindDriveForSlot(DeviceControlRecord* dcr, slot_number_t slot)
   for (auto* device_resource : changer->device_resources) {
     dev = device_resource->dev;
     if (!dev) { continue; }
+    // A drive in the middle of a move is taken care of by its owner
+    if (changer->inventory
+        && changer->inventory->DriveMoving(dev->drive_index)) {
+      continue;
+    }
     dev_save = dcr->dev;
     dcr->SetDev(dev);
 
@@ -620,6 +768,13 @@ bool UnloadDev(DeviceControlRecord* dcr, Device* dev, bool lock_set)
   status = RunProgramFullOutput(ChangerCmd, timeout, results.addr());
   dcr->VolCatInfo.Slot = save_slot;
   dcr->SetDev(save_dev);
+  if (ChangerInventory* inventory = GetInventory(dcr)) {
+    if (status == 0) {
+      inventory->SetLoaded(dev->drive_index, 0);
+    } else {
+      inventory->Invalidate(dev->drive_index);
+    }
+  }
   if (status != 0) {
     BErrNo be;
     be.SetErrno(status);
@@ -682,6 +837,9 @@ bool AutochangerCmd(DeviceControlRecord* dcr,
 
   // If listing, reprobe changer
   if (bstrcmp(cmd, "list") || bstrcmp(cmd, "listall")) {
+    if (ChangerInventory* inventory = GetInventory(dcr)) {
+      inventory->Invalidate();
+    }
     dcr->dev->SetSlotNumber(0);
     GetAutochangerLoadedSlot(dcr);
   }
@@ -58,6 +58,9 @@ AutochangerResource& AutochangerResource::operator=(
   changer_name = rhs.changer_name;
   changer_command = rhs.changer_command;
   changer_lock = rhs.changer_lock;
+  inventory_cache = rhs.inventory_cache;
+  concurrent_moves = rhs.concurrent_moves;
+  inventory = rhs.inventory;
   return *this;
 }
 
@@ -32,6 +32,7 @@
 template <typename T> class alist;
 
 namespace storagedaemon {
+class ChangerInventory;
 class DeviceResource;
 
 class AutochangerResource : public BareosResource {
@@ -54,6 +55,9 @@ class AutochangerResource : public BareosResource {
   char* changer_name{nullptr};    /**< Changer device name */
   char* changer_command{nullptr}; /**< Changer command  -- external program */
   brwlock_t changer_lock;         /**< One changer operation at a time */
+  bool inventory_cache{false};    /**< Answer drive queries from inventory */
+  bool concurrent_moves{false};   /**< Move to several drives at once */
+  ChangerInventory* inventory{nullptr}; /**< What is loaded in the drives */
  private:
   bool implicitly_created_{false};
 };
@@ -0,0 +1,877 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+extern "C" {
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+}
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include "chunk_store.h"
+#include "lib/crypto.h"
+#include "lib/util.h"
+
+#if defined(HAVE_LMDB)
+#  include "lmdb/lmdb.h"
+#endif
+
+namespace dedup {
+
+auto chunk_store::compute_fingerprint(const char* data, std::size_t size)
+    -> fingerprint
+{
+  fingerprint fp;
+  DIGEST* digester = crypto_digest_new(nullptr, CRYPTO_DIGEST_SHA256);
+  if (!digester) { throw std::runtime_error("Could not create sha256 digest"); }
+  std::uint32_t fp_size = fp.size();
+  bool ok = digester->Update(reinterpret_cast<const std::uint8_t*>(data), size)
+            && digester->Finalize(fp.data(), &fp_size);
+  CryptoDigestFree(digester);
+  if (!ok || fp_size != fp.size()) {
+    throw std::runtime_error("Could not compute chunk fingerprint");
+  }
+  return fp;
+}
+
+chunk_store::write_session::write_session(std::shared_ptr<chunk_store> store)
+    : store_{std::move(store)}
+{
+  if (store_) { store_->writers += 1; }
+}
+
+auto chunk_store::write_session::operator=(write_session&& other)
+    -> write_session&
+{
+  if (this != &other) {
+    if (store_) { store_->writers -= 1; }
+    store_ = std::move(other.store_);
+  }
+  return *this;
+}
+
+chunk_store::write_session::~write_session()
+{
+  if (store_) { store_->writers -= 1; }
+}
+
+#if defined(HAVE_LMDB)
+namespace {
+struct chunk_entry {
+  net_u64 Offset;   /* offset into the container */
+  net_u64 RefCount; /* number of volume parts referencing this chunk */
+  net_u32 Container;
+  net_u32 Size;
+  std::uint8_t Digest[chunk_store::digest_size];
+};
+
+constexpr const char* next_chunk_key = "next chunk";
+constexpr const char* next_container_key = "next container";
+
+[[noreturn]] void throw_lmdb(int err, const char* context)
+{
+  throw std::runtime_error(std::string{context} + ": " + mdb_strerror(err));
+}
+
+[[noreturn]] void throw_errno(const std::string& context)
+{
+  throw std::system_error(errno, std::generic_category(), context);
+}
+
+class txn_guard {
+ public:
+  txn_guard(MDB_env* env, bool read_only)
+  {
+    if (int err = mdb_txn_begin(env, nullptr, read_only ? MDB_RDONLY : 0, &t);
+        err) {
+      throw_lmdb(err, "Could not start transaction");
+    }
+  }
+  txn_guard(const txn_guard&) = delete;
+  txn_guard& operator=(const txn_guard&) = delete;
+  ~txn_guard()
+  {
+    if (t) { mdb_txn_abort(t); }
+  }
+
+  MDB_txn* get() { return t; }
+
+  void commit()
+  {
+    int err = mdb_txn_commit(std::exchange(t, nullptr));
+    if (err) { throw_lmdb(err, "Could not commit transaction"); }
+  }
+
+ private:
+  MDB_txn* t{nullptr};
+};
+
+net_u64 key_of(std::uint64_t id) { return net_u64{id}; }
+
+template <typename T> MDB_val as_val(T& obj)
+{
+  return MDB_val{sizeof(obj), const_cast<void*>(static_cast<const void*>(&obj))};
+}
+
+std::optional<chunk_entry> get_entry(MDB_txn* txn,
+                                     MDB_dbi dbi,
+                                     std::uint64_t id)
+{
+  auto key = key_of(id);
+  MDB_val k = as_val(key);
+  MDB_val v;
+  if (int err = mdb_get(txn, dbi, &k, &v); err == MDB_NOTFOUND) {
+    return std::nullopt;
+  } else if (err) {
+    throw_lmdb(err, "Could not read chunk entry");
+  }
+  if (v.mv_size != sizeof(chunk_entry)) {
+    throw std::runtime_error("Bad chunk entry for chunk "
+                             + std::to_string(id));
+  }
+  chunk_entry entry;
+  std::memcpy(&entry, v.mv_data, sizeof(entry));
+  return entry;
+}
+
+void put_entry(MDB_txn* txn,
+               MDB_dbi dbi,
+               std::uint64_t id,
+               const chunk_entry& entry)
+{
+  auto key = key_of(id);
+  MDB_val k = as_val(key);
+  MDB_val v = as_val(entry);
+  if (int err = mdb_put(txn, dbi, &k, &v, 0); err) {
+    throw_lmdb(err, "Could not write chunk entry");
+  }
+}
+
+// allocates a new number from the counter stored under key
+std::uint64_t next_number(MDB_txn* txn, MDB_dbi dbi, const char* key)
+{
+  MDB_val k{std::strlen(key), const_cast<char*>(key)};
+  MDB_val v;
+  net_u64 current{1};
+  if (int err = mdb_get(txn, dbi, &k, &v); err == 0) {
+    if (v.mv_size != sizeof(current)) {
+      throw std::runtime_error(std::string{"bad counter "} + key);
+    }
+    std::memcpy(&current, v.mv_data, sizeof(current));
+  } else if (err != MDB_NOTFOUND) {
+    throw_lmdb(err, "Could not read counter");
+  }
+
+  std::uint64_t result = current;
+  net_u64 next{result + 1};
+  MDB_val nv = as_val(next);
+  if (int err = mdb_put(txn, dbi, &k, &nv, 0); err) {
+    throw_lmdb(err, "Could not update counter");
+  }
+  return result;
+}
+
+void write_all(int fd, const char* data, std::size_t size, std::uint64_t off)
+{
+  while (size > 0) {
+    auto res = pwrite(fd, data, size, off);
+    if (res < 0) {
+      if (errno == EINTR) { continue; }
+      throw_errno("while writing chunk");
+    }
+    data += res;
+    size -= res;
+    off += res;
+  }
+}
+
+void read_all(int fd, char* data, std::size_t size, std::uint64_t off)
+{
+  while (size > 0) {
+    auto res = pread(fd, data, size, off);
+    if (res < 0) {
+      if (errno == EINTR) { continue; }
+      throw_errno("while reading chunk");
+    } else if (res == 0) {
+      throw std::runtime_error("unexpected end of container");
+    }
+    data += res;
+    size -= res;
+    off += res;
+  }
+}
+
+std::mutex open_stores_mut;
+std::unordered_map<std::string, std::weak_ptr<chunk_store>> open_stores;
+}  // namespace
+
+std::shared_ptr<chunk_store> chunk_store::open(const std::string& path,
+                                               std::uint64_t container_size)
+{
+  std::unique_lock lock(open_stores_mut);
+  auto& weak = open_stores[path];
+  if (auto store = weak.lock()) { return store; }
+
+  auto store = std::make_shared<chunk_store>(path, container_size);
+  weak = store;
+  return store;
+}
+
+chunk_store::chunk_store(const std::string& path, std::uint64_t container_size)
+    : store_path{path}, max_container_size{container_size}
+{
+  if (mkdir(path.c_str(), 0750) < 0 && errno != EEXIST) {
+    throw_errno("Cannot create chunk store '" + path + "'");
+  }
+  std::string containers = path + "/containers";
+  if (mkdir(containers.c_str(), 0750) < 0 && errno != EEXIST) {
+    throw_errno("Cannot create '" + containers + "'");
+  }
+
+  if (int err = mdb_env_create(&env); err) {
+    throw_lmdb(err, "Unable to create MDB environment");
+  }
+
+  try {
+    // this is only address space; the index file grows as needed
+    mdb_size_t mapsize = (sizeof(void*) >= 8) ? (1ull << 40) : (1ull << 30);
+    if (int err = mdb_env_set_mapsize(env, mapsize); err) {
+      throw_lmdb(err, "Unable to set MDB mapsize");
+    }
+    if (int err = mdb_env_set_maxdbs(env, 3); err) {
+      throw_lmdb(err, "Unable to set MDB maxdbs");
+    }
+
+    // Durability is established explicitly in flush(), which is called
+    // whenever the device gets flushed.
+    std::string index = path + "/index";
+    if (int err = mdb_env_open(env, index.c_str(),
+                               MDB_NOSUBDIR | MDB_NOTLS | MDB_NOSYNC, 0640);
+        err) {
+      throw_lmdb(err, ("Unable to open chunk index " + index).c_str());
+    }
+
+    txn_guard txn{env, false};
+    if (int err = mdb_dbi_open(txn.get(), "fingerprints", MDB_CREATE,
+                               &fingerprints);
+        err) {
+      throw_lmdb(err, "Unable to open fingerprint table");
+    }
+    if (int err = mdb_dbi_open(txn.get(), "chunks", MDB_CREATE, &chunks); err) {
+      throw_lmdb(err, "Unable to open chunk table");
+    }
+    if (int err = mdb_dbi_open(txn.get(), "meta", MDB_CREATE, &meta); err) {
+      throw_lmdb(err, "Unable to open meta table");
+    }
+    txn.commit();
+  } catch (...) {
+    mdb_env_close(env);
+    throw;
+  }
+}
+
+chunk_store::~chunk_store()
+{
+  try {
+    flush();
+  } catch (const std::exception&) {
+    // nothing we can do here
+  }
+  mdb_env_close(env);
+}
+
+std::string chunk_store::container_path(std::uint32_t number) const
+{
+  char name[32];
+  snprintf(name, sizeof(name), "/containers/%08" PRIx32, number);
+  return store_path + name;
+}
+
+// Needs mut.  Without a transaction the container number gets its own.
+auto chunk_store::writable_container(MDB_txn* txn, std::size_t needed)
+    -> std::shared_ptr<container>
+{
+  if (active
+      && (active->size == 0 || active->size + needed <= max_container_size)) {
+    return active;
+  }
+
+  if (active) {
+    if (active.use_count() == 1) {
+      fdatasync(active->fd.fileno());
+    } else {
+      // chunks are still written to it, flush() syncs it
+      unsynced.push_back(std::move(active));
+    }
+  }
+
+  std::uint64_t number;
+  if (txn) {
+    number = next_number(txn, meta, next_container_key);
+  } else {
+    txn_guard own{env, false};
+    number = next_number(own.get(), meta, next_container_key);
+    own.commit();
+  }
+  if (number > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("chunk store ran out of container numbers");
+  }
+
+  /* Tells the garbage collector that this container is still being written.
+   * The lock is taken before the container appears under its real name, as
+   * the garbage collector removes empty containers that are not locked. */
+  auto path = container_path(number);
+  auto new_path = store_path + "/new-container-" + std::to_string(number);
+  raii_fd fd{::open(new_path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0640)};
+  if (!fd) { throw_errno("Cannot create container '" + new_path + "'"); }
+  if (flock(fd.fileno(), LOCK_EX | LOCK_NB) < 0
+      || rename(new_path.c_str(), path.c_str()) < 0) {
+    int error = errno;
+    unlink(new_path.c_str());
+    errno = error;
+    throw_errno("Cannot create container '" + path + "'");
+  }
+
+  active = std::make_shared<container>(
+      container{static_cast<std::uint32_t>(number), std::move(fd), 0});
+  return active;
+}
+
+// Needs mut, only used by the garbage collector.
+std::uint64_t chunk_store::append(MDB_txn* txn,
+                                  const char* data,
+                                  std::size_t size,
+                                  std::uint32_t* number)
+{
+  auto con = writable_container(txn, size);
+  auto offset = con->size;
+  write_all(con->fd.fileno(), data, size, offset);
+  con->size += size;
+  *number = con->number;
+  return offset;
+}
+
+// Needs mut.  The descriptor stays usable after the lock is released.
+std::shared_ptr<raii_fd> chunk_store::read_fd(std::uint32_t number)
+{
+  if (auto found = read_fds.find(number); found != read_fds.end()) {
+    return found->second;
+  }
+
+  auto path = container_path(number);
+  raii_fd fd{::open(path.c_str(), O_RDONLY)};
+  if (!fd) { return nullptr; }
+  auto shared = std::make_shared<raii_fd>(std::move(fd));
+  read_fds.emplace(number, shared);
+  return shared;
+}
+
+std::size_t chunk_store::recent_key(const char* data, std::size_t size)
+{
+  // only used to find candidates, which get compared in full afterwards
+  constexpr std::size_t sample = 64;
+  std::string_view head{data, std::min(size, sample)};
+  std::string_view tail{data + size - head.size(), head.size()};
+  auto h = std::hash<std::string_view>{};
+  return hash_combine(hash_combine(size, h(head)), h(tail));
+}
+
+void chunk_store::cache_read_chunk(std::uint64_t id,
+                                   const char* data,
+                                   std::size_t size)
+{
+  if (writers.load() == 0 || size > recent_cache_size) { return; }
+
+  auto key = recent_key(data, size);
+  if (auto found = recent_by_key.find(key); found != recent_by_key.end()) {
+    recent_bytes -= found->second->data.size();
+    recent.erase(found->second);
+    recent_by_key.erase(found);
+  }
+
+  while (recent_bytes + size > recent_cache_size) {
+    auto& oldest = recent.back();
+    recent_bytes -= oldest.data.size();
+    recent_by_key.erase(oldest.key);
+    recent.pop_back();
+  }
+
+  recent.push_front(recent_chunk{key, id, {data, data + size}});
+  recent_by_key.emplace(key, recent.begin());
+  recent_bytes += size;
+}
+
+std::optional<std::uint64_t> chunk_store::reference_cached(const char* data,
+                                                           std::size_t size)
+{
+  if (recent.empty()) { return std::nullopt; }
+
+  auto found = recent_by_key.find(recent_key(data, size));
+  if (found == recent_by_key.end()) { return std::nullopt; }
+
+  auto& chunk = *found->second;
+  if (chunk.data.size() != size
+      || std::memcmp(chunk.data.data(), data, size) != 0) {
+    return std::nullopt;
+  }
+
+  auto id = chunk.id;
+  if (auto token = lent.find(id); token != lent.end()) {
+    // the lent reference keeps the chunk alive, we simply take it over
+    lent.erase(token);
+    bytes_unfingerprinted += size;
+    return id;
+  }
+
+  txn_guard txn{env, false};
+  auto entry = get_entry(txn.get(), chunks, id);
+  if (!entry || entry->Size != size) {
+    // the chunk was collected in the meantime
+    recent_bytes -= chunk.data.size();
+    recent.erase(found->second);
+    recent_by_key.erase(found);
+    return std::nullopt;
+  }
+  entry->RefCount = entry->RefCount + 1;
+  put_entry(txn.get(), chunks, id, *entry);
+  txn.commit();
+
+  bytes_unfingerprinted += size;
+  return id;
+}
+
+std::uint64_t chunk_store::insert(const char* data, std::size_t size)
+{
+  if (size > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::invalid_argument("chunk too big");
+  }
+
+  {
+    std::unique_lock lock(mut);
+    if (auto id = reference_cached(data, size)) { return *id; }
+  }
+
+  auto fp = compute_fingerprint(data, size);
+  std::shared_lock in_progress(writing);
+  {
+    txn_guard txn{env, false};
+    if (auto id = reference_existing(txn.get(), fp, size)) {
+      txn.commit();
+      return *id;
+    }
+  }
+
+  std::shared_ptr<container> con;
+  std::uint64_t offset;
+  {
+    std::unique_lock lock(mut);
+    con = writable_container(nullptr, size);
+    offset = con->size;
+    con->size += size;
+  }
+  write_all(con->fd.fileno(), data, size, offset);
+
+  txn_guard txn{env, false};
+  /* The same chunk may have been inserted in the meantime, the space just
+   * written is then reclaimed by the garbage collector. */
+  if (auto id = reference_existing(txn.get(), fp, size)) {
+    txn.commit();
+    return *id;
+  }
+
+  MDB_val k{fp.size(), fp.data()};
+  std::uint64_t id = next_number(txn.get(), meta, next_chunk_key);
+  chunk_entry entry{};
+  entry.Offset = offset;
+  entry.Container = con->number;
+  entry.Size = static_cast<std::uint32_t>(size);
+  entry.RefCount = 1;
+  std::memcpy(entry.Digest, fp.data(), fp.size());
+  put_entry(txn.get(), chunks, id, entry);
+
+  auto nid = key_of(id);
+  MDB_val idv = as_val(nid);
+  if (int err = mdb_put(txn.get(), fingerprints, &k, &idv, 0); err) {
+    throw_lmdb(err, "Could not add fingerprint");
+  }
+  txn.commit();
+  return id;
+}
+
+// Takes a reference on a stored chunk with this fingerprint.
+std::optional<std::uint64_t> chunk_store::reference_existing(
+    MDB_txn* txn,
+    const fingerprint& fp,
+    std::size_t size)
+{
+  MDB_val k{fp.size(), const_cast<std::uint8_t*>(fp.data())};
+  MDB_val v;
+  if (int err = mdb_get(txn, fingerprints, &k, &v); err == MDB_NOTFOUND) {
+    return std::nullopt;
+  } else if (err) {
+    throw_lmdb(err, "Could not look up fingerprint");
+  }
+
+  net_u64 id;
+  if (v.mv_size != sizeof(id)) {
+    throw std::runtime_error("Bad fingerprint entry");
+  }
+  std::memcpy(&id, v.mv_data, sizeof(id));
+  auto entry = get_entry(txn, chunks, id);
+  if (!entry) {
+    throw std::runtime_error("Fingerprint references missing chunk "
+                             + std::to_string(id.load()));
+  }
+  if (entry->Size != size) {
+    throw std::runtime_error("Fingerprint collision for chunk "
+                             + std::to_string(id.load()));
+  }
+  entry->RefCount = entry->RefCount + 1;
+  put_entry(txn, chunks, id, *entry);
+  return id.load();
+}
+
+std::optional<std::uint64_t> chunk_store::reference(const fingerprint& fp,
+                                                    std::size_t size)
+{
+  txn_guard txn{env, false};
+
+  MDB_val k{fp.size(), const_cast<std::uint8_t*>(fp.data())};
+  MDB_val v;
+  if (int err = mdb_get(txn.get(), fingerprints, &k, &v); err == MDB_NOTFOUND) {
+    return std::nullopt;
+  } else if (err) {
+    throw_lmdb(err, "Could not look up fingerprint");
+  }
+
+  net_u64 id;
+  if (v.mv_size != sizeof(id)) {
+    throw std::runtime_error("Bad fingerprint entry");
+  }
+  std::memcpy(&id, v.mv_data, sizeof(id));
+  auto entry = get_entry(txn.get(), chunks, id);
+  if (!entry || entry->Size != size) { return std::nullopt; }
+
+  entry->RefCount = entry->RefCount + 1;
+  put_entry(txn.get(), chunks, id, *entry);
+  txn.commit();
+  return id.load();
+}
+
+void chunk_store::read(std::uint64_t id, char* data, std::size_t size)
+{
+  // the garbage collector might move the chunk between our index lookup
+  // and opening its container; in that case simply look it up again.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    std::optional<chunk_entry> entry;
+    {
+      txn_guard txn{env, true};
+      entry = get_entry(txn.get(), chunks, id);
+    }
+    if (!entry) {
+      throw std::runtime_error("Chunk " + std::to_string(id)
+                               + " does not exist");
+    }
+    if (entry->Size != size) {
+      throw std::runtime_error("Chunk " + std::to_string(id) + " has size "
+                               + std::to_string(entry->Size.load())
+                               + " but " + std::to_string(size)
+                               + " was requested");
+    }
+
+    std::shared_ptr<raii_fd> fd;
+    {
+      std::unique_lock lock(mut);
+      fd = read_fd(entry->Container);
+    }
+    if (!fd) {
+      if (errno == ENOENT) { continue; }
+      throw_errno("Cannot open container "
+                  + container_path(entry->Container));
+    }
+    read_all(fd->fileno(), data, size, entry->Offset);
+
+    std::unique_lock lock(mut);
+    cache_read_chunk(id, data, size);
+    return;
+  }
+
+  throw std::runtime_error("Container of chunk " + std::to_string(id)
+                           + " vanished");
+}
+
+void chunk_store::release(const std::vector<std::uint64_t>& ids)
+{
+  if (ids.empty()) { return; }
+
+  txn_guard txn{env, false};
+  for (auto id : ids) {
+    auto entry = get_entry(txn.get(), chunks, id);
+    if (!entry) {
+      throw std::runtime_error("Trying to release unknown chunk "
+                               + std::to_string(id));
+    }
+    if (entry->RefCount == 0) {
+      throw std::runtime_error("Trying to release unreferenced chunk "
+                               + std::to_string(id));
+    }
+    entry->RefCount = entry->RefCount - 1;
+    put_entry(txn.get(), chunks, id, *entry);
+  }
+  txn.commit();
+}
+
+std::optional<std::uint64_t> chunk_store::lend(const fingerprint& fp,
+                                               std::size_t size)
+{
+  auto id = reference(fp, size);
+  if (id) {
+    std::unique_lock lock(mut);
+    lent.insert(*id);
+  }
+  return id;
+}
+
+void chunk_store::take_back(const std::vector<std::uint64_t>& ids)
+{
+  std::vector<std::uint64_t> unused;
+  {
+    std::unique_lock lock(mut);
+    for (auto id : ids) {
+      if (auto token = lent.find(id); token != lent.end()) {
+        lent.erase(token);
+        unused.push_back(id);
+      }
+    }
+  }
+  release(unused);
+}
+
+void chunk_store::flush()
+{
+  std::unique_lock no_writes(writing);
+  std::unique_lock lock(mut);
+  if (active && fdatasync(active->fd.fileno()) < 0) {
+    throw_errno("Could not sync container");
+  }
+  for (auto& con : unsynced) {
+    if (fdatasync(con->fd.fileno()) < 0) {
+      throw_errno("Could not sync container");
+    }
+  }
+  unsynced.clear();
+  if (int err = mdb_env_sync(env, 1); err) {
+    throw_lmdb(err, "Could not sync chunk index");
+  }
+}
+
+auto chunk_store::stats() -> statistics
+{
+  statistics s;
+
+  std::unique_lock lock(mut);
+  txn_guard txn{env, true};
+  MDB_cursor* cursor;
+  if (int err = mdb_cursor_open(txn.get(), chunks, &cursor); err) {
+    throw_lmdb(err, "Could not open chunk cursor");
+  }
+  MDB_val k, v;
+  for (int err = mdb_cursor_get(cursor, &k, &v, MDB_FIRST); err == 0;
+       err = mdb_cursor_get(cursor, &k, &v, MDB_NEXT)) {
+    chunk_entry entry;
+    std::memcpy(&entry, v.mv_data, sizeof(entry));
+    s.chunks += 1;
+    s.stored_bytes += entry.Size;
+    s.referenced_bytes += std::uint64_t{entry.Size} * entry.RefCount;
+    if (entry.RefCount == 0) { s.unreferenced_chunks += 1; }
+  }
+  mdb_cursor_close(cursor);
+
+  std::string containers = store_path + "/containers";
+  for (auto& dirent : std::filesystem::directory_iterator{containers}) {
+    s.containers += 1;
+    s.container_bytes += dirent.file_size();
+  }
+
+  return s;
+}
+
+auto chunk_store::CollectGarbage(double min_live_ratio, bool dry_run)
+    -> gc_result
+{
+  gc_result result;
+
+  std::unique_lock lock(mut);
+
+  // live chunks of every container referenced from the index
+  std::map<std::uint32_t, std::vector<std::uint64_t>> live;
+  std::map<std::uint32_t, std::uint64_t> live_bytes;
+
+  {
+    txn_guard txn{env, dry_run};
+    MDB_cursor* cursor;
+    if (int err = mdb_cursor_open(txn.get(), chunks, &cursor); err) {
+      throw_lmdb(err, "Could not open chunk cursor");
+    }
+
+    MDB_val k, v;
+    for (int err = mdb_cursor_get(cursor, &k, &v, MDB_FIRST); err == 0;
+         err = mdb_cursor_get(cursor, &k, &v, MDB_NEXT)) {
+      chunk_entry entry;
+      std::memcpy(&entry, v.mv_data, sizeof(entry));
+      net_u64 id;
+      std::memcpy(&id, k.mv_data, sizeof(id));
+
+      if (entry.RefCount > 0) {
+        live[entry.Container].push_back(id);
+        live_bytes[entry.Container] += entry.Size;
+        continue;
+      }
+
+      result.chunks_removed += 1;
+      if (dry_run) { continue; }
+
+      MDB_val fk{sizeof(entry.Digest), entry.Digest};
+      if (int del = mdb_del(txn.get(), fingerprints, &fk, nullptr);
+          del && del != MDB_NOTFOUND) {
+        mdb_cursor_close(cursor);
+        throw_lmdb(del, "Could not delete fingerprint");
+      }
+      if (int del = mdb_cursor_del(cursor, 0); del) {
+        mdb_cursor_close(cursor);
+        throw_lmdb(del, "Could not delete chunk");
+      }
+    }
+    mdb_cursor_close(cursor);
+
+    if (!dry_run) { txn.commit(); }
+  }
+
+  std::string containers = store_path + "/containers";
+  std::vector<std::pair<std::uint32_t, std::uint64_t>> candidates;
+  for (auto& dirent : std::filesystem::directory_iterator{containers}) {
+    auto name = dirent.path().filename().string();
+    std::uint32_t number = std::stoul(name, nullptr, 16);
+    if (active && active->number == number) { continue; }
+    candidates.emplace_back(number, dirent.file_size());
+  }
+
+  for (auto [number, file_size] : candidates) {
+    auto used = live_bytes[number];
+    if (file_size > 0 && double(used) / double(file_size) >= min_live_ratio) {
+      continue;
+    }
+
+    auto path = container_path(number);
+    raii_fd fd{::open(path.c_str(), O_RDONLY)};
+    if (!fd) { continue; }
+    // containers that are still written to are locked by their writer
+    if (flock(fd.fileno(), LOCK_EX | LOCK_NB) < 0) { continue; }
+
+    if (used > 0) {
+      result.containers_compacted += 1;
+      result.bytes_moved += used;
+      if (!dry_run) {
+        std::vector<char> buffer;
+        txn_guard txn{env, false};
+        for (auto id : live[number]) {
+          auto entry = get_entry(txn.get(), chunks, id);
+          if (!entry) { continue; }
+          buffer.resize(entry->Size);
+          read_all(fd.fileno(), buffer.data(), buffer.size(), entry->Offset);
+          std::uint32_t new_number;
+          entry->Offset
+              = append(txn.get(), buffer.data(), buffer.size(), &new_number);
+          entry->Container = new_number;
+          put_entry(txn.get(), chunks, id, *entry);
+        }
+        if (active && fdatasync(active->fd.fileno()) < 0) {
+          throw_errno("Could not sync container");
+        }
+        txn.commit();
+        if (int err = mdb_env_sync(env, 1); err) {
+          throw_lmdb(err, "Could not sync chunk index");
+        }
+      }
+    } else {
+      result.containers_removed += 1;
+    }
+
+    result.bytes_freed += file_size - used;
+    if (!dry_run) {
+      read_fds.erase(number);
+      if (unlink(path.c_str()) < 0) {
+        throw_errno("Could not remove container '" + path + "'");
+      }
+    }
+  }
+
+  return result;
+}
+
+#else
+
+std::shared_ptr<chunk_store> chunk_store::open(const std::string&,
+                                               std::uint64_t)
+{
+  throw std::runtime_error(
+      "chunk stores are not available (compiled without LMDB support)");
+}
+
+chunk_store::chunk_store(const std::string&, std::uint64_t)
+{
+  throw std::runtime_error(
+      "chunk stores are not available (compiled without LMDB support)");
+}
+chunk_store::~chunk_store() = default;
+std::uint64_t chunk_store::insert(const char*, std::size_t) { return 0; }
+std::optional<std::uint64_t> chunk_store::reference(const fingerprint&,
+                                                    std::size_t)
+{
+  return std::nullopt;
+}
+void chunk_store::read(std::uint64_t, char*, std::size_t) {}
+void chunk_store::release(const std::vector<std::uint64_t>&) {}
+std::optional<std::uint64_t> chunk_store::lend(const fingerprint&,
+                                               std::size_t)
+{
+  return std::nullopt;
+}
+void chunk_store::take_back(const std::vector<std::uint64_t>&) {}
+void chunk_store::flush() {}
+auto chunk_store::CollectGarbage(double, bool) -> gc_result { return {}; }
+auto chunk_store::stats() -> statistics { return {}; }
+
+#endif
+
+};  // namespace dedup
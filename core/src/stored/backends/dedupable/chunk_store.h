@@ -0,0 +1,214 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_STORED_BACKENDS_DEDUPABLE_CHUNK_STORE_H_
+#define BAREOS_STORED_BACKENDS_DEDUPABLE_CHUNK_STORE_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "util.h"
+
+struct MDB_env;
+struct MDB_txn;
+
+namespace dedup {
+
+/* A chunk store keeps content addressed chunks that are shared between all
+ * volumes which reference it.  Its layout on disk is
+ *
+ *   <store>/index             LMDB: fingerprint -> chunk id,
+ *                                   chunk id -> location + reference count
+ *   <store>/containers/<n>    append only data files holding the chunks
+ *
+ * Chunks are only ever appended.  Space of unreferenced chunks is reclaimed
+ * by CollectGarbage(), which removes them from the index and rewrites
+ * containers whose live data falls below a threshold.
+ *
+ * Multiple processes (the storage daemon and dedup-gc) can use the same
+ * store at the same time; LMDB serializes all index updates and every
+ * writer appends to its own container, which it keeps flock()ed.  New
+ * containers are locked before they get their name, so the garbage
+ * collector never sees one that is not locked yet.  The chunk data itself
+ * is written and read without holding any lock.
+ *
+ * While a volume writes to the store, the data of chunks read from it is
+ * kept in a small cache (recent_cache_size).  When data is copied between
+ * two volumes of the same store (e.g. when consolidating jobs into a
+ * virtual full) every record is still read from the source and written to
+ * the destination volume; only the chunks found in the cache skip the
+ * fingerprinting and the index lookup and get another reference right
+ * away.  This saves CPU time, not I/O: a copy-free synthesis, in which the
+ * new job references the record ranges of the old ones, is not done. */
+class chunk_store {
+ public:
+  static constexpr std::size_t digest_size = 32;  // sha256
+  static constexpr std::uint64_t default_container_size
+      = 1024ull * 1024ull * 1024ull;
+  // upper bound for the data of recently read chunks that is kept in memory
+  static constexpr std::size_t recent_cache_size = 64 * 1024 * 1024;
+
+  using fingerprint = std::array<std::uint8_t, digest_size>;
+
+  struct statistics {
+    std::uint64_t chunks{0};
+    std::uint64_t stored_bytes{0};      // size of all indexed chunks
+    std::uint64_t referenced_bytes{0};  // sum of size * refcount
+    std::uint64_t unreferenced_chunks{0};
+    std::uint64_t containers{0};
+    std::uint64_t container_bytes{0};  // size of all container files
+  };
+
+  struct gc_result {
+    std::uint64_t chunks_removed{0};
+    std::uint64_t containers_removed{0};
+    std::uint64_t containers_compacted{0};
+    std::uint64_t bytes_moved{0};
+    std::uint64_t bytes_freed{0};
+  };
+
+  // Keeps the cache of recently read chunks enabled while it is alive.
+  class write_session {
+   public:
+    write_session() = default;
+    explicit write_session(std::shared_ptr<chunk_store> store);
+    write_session(write_session&& other) = default;
+    write_session& operator=(write_session&& other);
+    ~write_session();
+
+   private:
+    std::shared_ptr<chunk_store> store_;
+  };
+
+  // Opens (and if necessary creates) the store at path.  Stores are shared
+  // inside one process, so calling this twice with the same path returns
+  // the same object.
+  static std::shared_ptr<chunk_store> open(
+      const std::string& path,
+      std::uint64_t container_size = default_container_size);
+
+  chunk_store(const std::string& path, std::uint64_t container_size);
+  ~chunk_store();
+  chunk_store(const chunk_store&) = delete;
+  chunk_store& operator=(const chunk_store&) = delete;
+
+  const std::string& path() const { return store_path; }
+
+  // Stores the chunk if it is not known yet and takes a reference on it.
+  std::uint64_t insert(const char* data, std::size_t size);
+  // Takes a reference on the chunk with this fingerprint and size, if there
+  // is one, and returns its id.  Lookup and reference are a single index
+  // transaction, so the garbage collector cannot remove the chunk in between.
+  std::optional<std::uint64_t> reference(const fingerprint& fp,
+                                         std::size_t size);
+  /* Like reference(), but a writer that inserts the same data while it is
+   * cached takes the reference over instead of adding one of its own.
+   * Used for chunks that are only read to put records back together, which
+   * are then written to a volume of this store again. */
+  std::optional<std::uint64_t> lend(const fingerprint& fp, std::size_t size);
+  // Drops the lent references that were not taken over by a writer.
+  void take_back(const std::vector<std::uint64_t>& ids);
+  // Copies the chunk into data.  size has to match the stored size.
+  void read(std::uint64_t id, char* data, std::size_t size);
+  // Drops one reference for every id (ids may be repeated).
+  void release(const std::vector<std::uint64_t>& ids);
+  // Makes all inserted chunks and index changes durable.
+  void flush();
+
+  gc_result CollectGarbage(double min_live_ratio, bool dry_run);
+  statistics stats();
+  /* Number of bytes inserted without computing their fingerprint, because
+   * they were found in the cache of recently read chunks. */
+  std::uint64_t unfingerprinted_bytes() const { return bytes_unfingerprinted.load(); }
+
+  static fingerprint compute_fingerprint(const char* data, std::size_t size);
+
+ private:
+  struct container {
+    std::uint32_t number{0};
+    raii_fd fd{};
+    std::uint64_t size{0};
+  };
+
+  std::string store_path;
+  std::uint64_t max_container_size;
+
+  MDB_env* env{nullptr};
+  unsigned int fingerprints{0};
+  unsigned int chunks{0};
+  unsigned int meta{0};
+
+  std::mutex mut;
+  std::shared_ptr<container> active;
+  // containers written to since the last flush(), besides the active one
+  std::vector<std::shared_ptr<container>> unsynced;
+  std::map<std::uint32_t, std::shared_ptr<raii_fd>> read_fds;
+  // held shared while chunks are written, flush() waits for them
+  std::shared_mutex writing;
+
+  struct recent_chunk {
+    std::size_t key;
+    std::uint64_t id;
+    std::vector<char> data;
+  };
+
+  std::atomic<int> writers{0};
+  std::atomic<std::uint64_t> bytes_unfingerprinted{0};
+  // most recently read chunk first
+  std::list<recent_chunk> recent;
+  std::unordered_map<std::size_t, std::list<recent_chunk>::iterator>
+      recent_by_key;
+  std::size_t recent_bytes{0};
+  // references handed out by lend() that no writer took over yet
+  std::unordered_multiset<std::uint64_t> lent;
+
+  static std::size_t recent_key(const char* data, std::size_t size);
+  void cache_read_chunk(std::uint64_t id, const char* data, std::size_t size);
+  std::optional<std::uint64_t> reference_cached(const char* data,
+                                                std::size_t size);
+
+  std::string container_path(std::uint32_t number) const;
+  std::shared_ptr<container> writable_container(MDB_txn* txn,
+                                                std::size_t needed);
+  std::uint64_t append(MDB_txn* txn,
+                       const char* data,
+                       std::size_t size,
+                       std::uint32_t* number);
+  std::optional<std::uint64_t> reference_existing(MDB_txn* txn,
+                                                  const fingerprint& fp,
+                                                  std::size_t size);
+  std::shared_ptr<raii_fd> read_fd(std::uint32_t number);
+};
+
+};  // namespace dedup
+
+#endif  // BAREOS_STORED_BACKENDS_DEDUPABLE_CHUNK_STORE_H_
@@ -56,6 +56,41 @@ auto device_option_parser::parse(std::string_view str) -> parse_result
         + std::to_string(result.options.blocksize) + ").");
   }
 
+  if (auto iter = options.find("chunkstore"); iter != options.end()) {
+    result.options.chunk_store = iter->second;
+    options.erase(iter);
+  }
+
+  if (auto iter = options.find("chunksize"); iter != options.end()) {
+    auto& val = iter->second;
+
+    std::uint64_t chunksize;
+    if (!size_to_uint64(val.data(), &chunksize)) {
+      throw std::invalid_argument("bad chunk size: " + val);
+    }
+    if (chunksize == 0 || (chunksize & (chunksize - 1)) != 0) {
+      throw std::invalid_argument("chunk size needs to be a power of two: "
+                                  + val);
+    }
+
+    result.options.chunk_size = chunksize;
+
+    options.erase(iter);
+  }
+
+  if (auto iter = options.find("containersize"); iter != options.end()) {
+    auto& val = iter->second;
+
+    std::uint64_t containersize;
+    if (!size_to_uint64(val.data(), &containersize)) {
+      throw std::invalid_argument("bad container size: " + val);
+    }
+
+    result.options.container_size = containersize;
+
+    options.erase(iter);
+  }
+
   if (options.size() > 0) {
     std::string unknown = "Unknown options: ";
     for (auto [opt, _] : options) {
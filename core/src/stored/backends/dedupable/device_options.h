@@ -29,6 +29,12 @@
 namespace dedup {
 struct device_options {
   std::size_t blocksize{4096};
+
+  // if set, record payloads are split into content defined chunks which are
+  // stored (once) inside the chunk store at this path.
+  std::string chunk_store{};
+  std::size_t chunk_size{16 * 1024};
+  std::size_t container_size{1024 * 1024 * 1024};
 };
 
 struct device_option_parser {
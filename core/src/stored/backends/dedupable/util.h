@@ -57,6 +57,16 @@ class chunked_writer {
     return true;
   }
 
+  // reserves size bytes which the caller has to fill itself
+  char* get(std::size_t size)
+  {
+    ASSERT(begin <= end);
+    if (static_cast<std::size_t>(end - begin) < size) { return nullptr; }
+
+    begin += size;
+    return begin - size;
+  }
+
   bool finished() const { return begin == end; }
   std::size_t leftover() const { return end - begin; }
 
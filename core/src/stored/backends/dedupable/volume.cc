@@ -146,6 +146,31 @@ raii_fd OpenRelative(open_context ctx, const char* path)
   return raii_fd{fd};
 }
 
+// the chunk store configuration is kept as a simple text file:
+//   <path of the chunk store>\n<average chunk size>\n
+std::vector<char> chunk_config_serialize(const chunk_config& chunking)
+{
+  std::string content = chunking.store_path + "\n"
+                        + std::to_string(chunking.chunk_size) + "\n";
+  return std::vector<char>(content.begin(), content.end());
+}
+
+chunk_config chunk_config_deserialize(const std::vector<char>& content)
+{
+  std::string_view str{content.data(), content.size()};
+  auto first = str.find('\n');
+  auto second = (first == str.npos) ? str.npos : str.find('\n', first + 1);
+  if (second == str.npos || first == 0) {
+    throw std::runtime_error("bad chunkstore file");
+  }
+
+  chunk_config chunking;
+  chunking.store_path = std::string{str.substr(0, first)};
+  chunking.chunk_size
+      = std::stoull(std::string{str.substr(first + 1, second - first - 1)});
+  return chunking;
+}
+
 block to_dedup(block_header header, std::uint64_t Begin, std::uint32_t Count)
 {
   return block{
@@ -172,7 +197,8 @@ block_header from_dedup(block b)
 }
 };  // namespace
 
-volume::volume(open_type type, const char* path) : sys_path{path}
+volume::volume(open_type type, const char* path, std::uint64_t container_size)
+    : sys_path{path}
 {
   bool read_only = type == open_type::ReadOnly;
   int flags = (read_only) ? O_RDONLY : O_RDWR;
@@ -208,6 +234,19 @@ volume::volume(open_type type, const char* path) : sys_path{path}
           .dird = dird.fileno(),
       },
       conf);
+
+  if (raii_fd chunk_fd{openat(dird.fileno(), "chunkstore", O_RDONLY)};
+      chunk_fd) {
+    auto chunking = chunk_config_deserialize(LoadFile(chunk_fd.fileno()));
+    store = chunk_store::open(chunking.store_path, container_size);
+    chunker.emplace(chunking.chunk_size);
+    if (!read_only) { store_session = chunk_store::write_session{store}; }
+  } else if (errno != ENOENT) {
+    std::string errctx = "Cannot open '";
+    errctx += path;
+    errctx += "/chunkstore'";
+    throw std::system_error(errno, std::generic_category(), errctx);
+  }
 }
 
 data::data(open_context ctx, const config& conf)
@@ -302,6 +341,7 @@ save_state volume::BeginBlock(block_header header)
   for (auto& vec : backing->datafiles) { s.data_sizes.push_back(vec.size()); }
 
   current_block.emplace(header);
+  block_chunks.clear();
 
   return s;
 }
@@ -327,6 +367,7 @@ void volume::CommitBlock(save_state&& s)
   save_state discard = std::move(s);
   static_cast<void>(discard);
   current_block.reset();
+  block_chunks.clear();
 }
 
 void volume::AbortBlock(save_state s)
@@ -340,6 +381,16 @@ void volume::AbortBlock(save_state s)
   }
 
   if (current_block) { current_block.reset(); }
+
+  if (store) {
+    try {
+      store->release(block_chunks);
+    } catch (const std::exception&) {
+      // we cannot do anything about it here; at worst the chunks are kept
+      // around until the store gets checked.
+    }
+    block_chunks.clear();
+  }
 }
 
 auto volume::reserve_parts(record_header header) -> std::vector<reserved_part>
@@ -393,23 +444,15 @@ void volume::PushRecord(record_header header,
   }
 
   // first write the header ...
-  {
-    auto it = backing->bsize_to_idx.find(1);
-    if (it == backing->bsize_to_idx.end()) {
-      throw std::runtime_error(
-          "Bad dedup volume: no data file with blocksize 1.");
-    }
-
-    auto& vec = backing->datafiles[backing->idx_to_dfile[it->second]];
+  push_unaligned(reinterpret_cast<const char*>(&header), sizeof(header));
 
-    char* start = vec.alloc_uninit(sizeof(header));
-    std::memcpy(start, &header, sizeof(header));
-    backing->parts.push_back(part{.FileIdx = it->second,
-                                  .Size = SafeCast(sizeof(header)),
-                                  .Begin = (start - vec.data())});
+  if (store) {
+    // split records are simply chunked piece by piece, so there is nothing
+    // to reserve for their continuations.
+    push_chunked(data, size);
+    return;
   }
 
-
   // ... then reserve space for the data ...
   auto reserved_parts = reserve_parts(header);
 
@@ -447,9 +490,46 @@ void volume::PushRecord(record_header header,
   }
 }
 
+void volume::push_unaligned(const char* data, std::size_t size)
+{
+  auto it = backing->bsize_to_idx.find(1);
+  if (it == backing->bsize_to_idx.end()) {
+    throw std::runtime_error("Bad dedup volume: no data file with blocksize 1.");
+  }
+
+  auto& vec = backing->datafiles[backing->idx_to_dfile[it->second]];
+
+  char* start = vec.alloc_uninit(size);
+  std::memcpy(start, data, size);
+  backing->parts.push_back(part{.FileIdx = it->second,
+                                .Size = SafeCast(size),
+                                .Begin = (start - vec.data())});
+}
+
+void volume::push_chunked(const char* data, std::size_t size)
+{
+  while (size > 0) {
+    auto cut = chunker->NextCut(data, size);
+
+    if (cut < chunker->MinSize()) {
+      // not worth an index entry
+      push_unaligned(data, cut);
+    } else {
+      auto id = store->insert(data, cut);
+      block_chunks.push_back(id);
+      backing->parts.push_back(
+          part{.FileIdx = chunk_file_idx, .Size = SafeCast(cut), .Begin = id});
+    }
+
+    data += cut;
+    size -= cut;
+  }
+}
+
 void volume::create_new(int creation_mode,
                         const char* path,
-                        std::size_t blocksize)
+                        std::size_t blocksize,
+                        std::optional<chunk_config> chunking)
 {
   int dir_mode
       = creation_mode | S_IXUSR;  // directories need execute permissions
@@ -521,10 +601,31 @@ void volume::create_new(int creation_mode,
       throw std::system_error(errno, std::generic_category(), errctx);
     }
   }
+
+  if (chunking) {
+    raii_fd chunk_fd{
+        openat(dird.fileno(), "chunkstore", flags | O_TRUNC, creation_mode)};
+    if (!chunk_fd) {
+      std::string errctx = "Cannot open '";
+      errctx += path;
+      errctx += "/chunkstore'";
+      throw std::system_error(errno, std::generic_category(), errctx);
+    }
+    WriteFile(chunk_fd.fileno(), chunk_config_serialize(*chunking));
+  }
 }
 
 void volume::reset()
 {
+  if (store) {
+    std::vector<std::uint64_t> referenced;
+    for (std::size_t i = 0; i < backing->parts.size(); ++i) {
+      auto p = backing->parts[i];
+      if (p.FileIdx == chunk_file_idx) { referenced.push_back(p.Begin); }
+    }
+    store->release(referenced);
+  }
+
   backing->blocks.clear();
   backing->parts.clear();
   for (auto& vec : backing->datafiles) { vec.clear(); }
@@ -542,6 +643,8 @@ void volume::truncate()
 
 void volume::flush()
 {
+  // chunks have to be durable before the parts referencing them
+  if (store) { store->flush(); }
   backing->blocks.flush();
   backing->parts.flush();
   for (auto& vec : backing->datafiles) { vec.flush(); }
@@ -584,6 +687,18 @@ std::size_t volume::ReadBlock(std::size_t blocknum,
 
     auto didx = part.FileIdx.load();
 
+    if (didx == chunk_file_idx) {
+      if (!store) {
+        throw std::runtime_error(
+            "Volume references chunks but has no chunk store.");
+      }
+      auto dsize = part.Size.load();
+      char* dest = stream.get(dsize);
+      if (!dest) { return 0; }
+      store->read(part.Begin.load(), dest, dsize);
+      continue;
+    }
+
     auto dfile = backing->idx_to_dfile.find(didx);
     if (dfile == backing->idx_to_dfile.end()) {
       throw std::runtime_error("Trying to read from unknown file index "
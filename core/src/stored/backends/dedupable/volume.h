@@ -29,9 +29,13 @@
 #include <map>
 #include <utility>
 #include <vector>
+#include <limits>
+#include <memory>
 #include "fvec.h"
 #include "util.h"
+#include "chunk_store.h"
 #include "lib/util.h"
+#include "lib/fastcdc.h"
 
 #include "lib/network_order.h"
 
@@ -70,6 +74,16 @@ struct part {
 
 class volume;
 
+// parts with this file index do not live inside the volume but reference
+// the chunk with id Begin inside the chunk store of the volume.
+inline constexpr std::uint32_t chunk_file_idx
+    = std::numeric_limits<std::uint32_t>::max();
+
+struct chunk_config {
+  std::string store_path;
+  std::size_t chunk_size;
+};
+
 struct save_state {
   std::size_t block_size{0};
   std::size_t part_size{0};
@@ -169,14 +183,18 @@ class volume {
     ReadOnly
   };
 
-  volume(open_type type, const char* path);
+  volume(open_type type,
+         const char* path,
+         std::uint64_t container_size = chunk_store::default_container_size);
 
   const char* path() const { return sys_path.c_str(); }
   int fileno() const { return dird.fileno(); }
+  bool is_chunked() const { return store != nullptr; }
 
   static void create_new(int creation_mode,
                          const char* path,
-                         std::size_t blocksize);
+                         std::size_t blocksize,
+                         std::optional<chunk_config> chunking = std::nullopt);
 
 
   // writing interface
@@ -217,6 +235,15 @@ class volume {
   std::unordered_map<urid, std::vector<reserved_part>, urid_hash> unfinished;
 
   std::vector<reserved_part> reserve_parts(record_header header);
+
+  std::shared_ptr<chunk_store> store;
+  chunk_store::write_session store_session;
+  std::optional<FastCdcChunker> chunker;
+  // chunks referenced by the current block; released if it gets aborted
+  std::vector<std::uint64_t> block_chunks;
+
+  void push_unaligned(const char* data, std::size_t size);
+  void push_chunked(const char* data, std::size_t size);
 };
 };  // namespace dedup
 
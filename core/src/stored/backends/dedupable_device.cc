@@ -38,6 +38,7 @@
 #include <stdexcept>
 #include <cstring>
 #include <filesystem>
+#include <type_traits>
 
 namespace storagedaemon {
 
@@ -57,6 +58,62 @@ constexpr std::pair<std::uint32_t, std::uint32_t> file_block(
   return {file, block};
 }
 
+std::optional<dedup::chunk_config> chunking(
+    const dedup::device_options& options)
+{
+  if (options.chunk_store.empty()) { return std::nullopt; }
+
+  return dedup::chunk_config{options.chunk_store, options.chunk_size};
+}
+
+class store_index : public ChunkIndex {
+ public:
+  store_index(std::shared_ptr<dedup::chunk_store> store, std::size_t chunk_size)
+      : store_{std::move(store)}, chunk_size_{chunk_size}
+  {
+  }
+
+  std::size_t ChunkSize() const override { return chunk_size_; }
+
+  std::optional<std::uint64_t> Reference(const fingerprint& fp,
+                                         std::size_t size) override
+  {
+    try {
+      return store_->lend(fp, size);
+    } catch (const std::exception& ex) {
+      Dmsg1(50, "Chunk lookup failed. ERR=%s\n", ex.what());
+      return std::nullopt;
+    }
+  }
+
+  bool Read(std::uint64_t id, char* data, std::size_t size) override
+  {
+    try {
+      store_->read(id, data, size);
+      return true;
+    } catch (const std::exception& ex) {
+      Dmsg1(50, "Chunk read failed. ERR=%s\n", ex.what());
+      return false;
+    }
+  }
+
+  void Release(const std::vector<std::uint64_t>& ids) override
+  {
+    try {
+      store_->take_back(ids);
+    } catch (const std::exception& ex) {
+      Dmsg1(50, "Chunk release failed. ERR=%s\n", ex.what());
+    }
+  }
+
+ private:
+  std::shared_ptr<dedup::chunk_store> store_;
+  std::size_t chunk_size_;
+};
+
+static_assert(std::is_same_v<ChunkIndex::fingerprint,
+                             dedup::chunk_store::fingerprint>);
+
 constexpr bool check_open_mode(DeviceMode open_mode)
 {
   switch (open_mode) {
@@ -72,6 +129,26 @@ constexpr bool check_open_mode(DeviceMode open_mode)
 }
 };  // namespace
 
+ChunkIndex* dedup_device::GetChunkIndex()
+{
+  if (chunk_index) { return chunk_index.get(); }
+
+  try {
+    auto parsed = dedup::device_option_parser::parse(dev_options ?: "");
+    if (parsed.options.chunk_store.empty()) { return nullptr; }
+
+    chunk_index = std::make_unique<store_index>(
+        dedup::chunk_store::open(parsed.options.chunk_store,
+                                 parsed.options.container_size),
+        parsed.options.chunk_size);
+  } catch (const std::exception& ex) {
+    Emsg0(M_ERROR, 0, T_("Could not open chunk store. ERR=%s\n"), ex.what());
+    return nullptr;
+  }
+
+  return chunk_index.get();
+}
+
 // Mount the device. Timeout is ignored.
 bool dedup_device::MountBackend(DeviceControlRecord*, int)
 {
@@ -127,7 +204,8 @@ int dedup_device::d_open(const char* path, int, int mode)
       //       even though it knows that it already exists.
       //       E.g. when relabeling because of a truncate command.
       try {
-        dedup::volume::create_new(mode, path, parsed.options.blocksize);
+        dedup::volume::create_new(mode, path, parsed.options.blocksize,
+                                  chunking(parsed.options));
       } catch (const std::exception& ex) {
         Dmsg3(200,
               "Could not create new volume %s while opening as %s. "
@@ -140,9 +218,10 @@ int dedup_device::d_open(const char* path, int, int mode)
     }
 
     auto& opened_volume
-        = (read_only)
-              ? openvol.emplace(dedup::volume::open_type::ReadOnly, path)
-              : openvol.emplace(dedup::volume::open_type::ReadWrite, path);
+        = (read_only) ? openvol.emplace(dedup::volume::open_type::ReadOnly, path,
+                                        parsed.options.container_size)
+                      : openvol.emplace(dedup::volume::open_type::ReadWrite,
+                                        path, parsed.options.container_size);
 
     return opened_volume.fileno();
   } catch (const std::exception& ex) {
@@ -358,6 +437,11 @@ bool dedup_device::d_truncate(DeviceControlRecord* dcr)
     return false;
   }
 
+  if (openvol->is_chunked()) {
+    // drop the references into the chunk store before the volume is gone
+    if (!ResetOpenVolume()) { return false; }
+  }
+
   openvol.reset();
 
   try {
@@ -391,9 +475,11 @@ bool dedup_device::d_truncate(DeviceControlRecord* dcr)
     // them to be executable), so we always remove the executable bit
 
     dedup::volume::create_new(s.st_mode & ~S_IXUSR, path.c_str(),
-                              parsed.options.blocksize);
+                              parsed.options.blocksize,
+                              chunking(parsed.options));
     auto& opened_volume
-        = openvol.emplace(dedup::volume::open_type::ReadWrite, path.c_str());
+        = openvol.emplace(dedup::volume::open_type::ReadWrite, path.c_str(),
+                          parsed.options.container_size);
     Device::fd = opened_volume.fileno();
   } catch (const std::exception& ex) {
     Emsg0(M_ERROR, 0, T_("Could not recreate %s. ERR=%s\n"), path.c_str(),
@@ -23,8 +23,10 @@
 #define BAREOS_STORED_BACKENDS_DEDUPABLE_DEVICE_H_
 
 #include "stored/dev.h"
+#include "stored/chunk_index.h"
 #include "dedupable/volume.h"
 
+#include <memory>
 #include <optional>
 
 namespace storagedaemon {
@@ -37,6 +39,7 @@ class dedup_device : public Device {
   // Interface from Device
   SeekMode GetSeekMode() const override { return SeekMode::FILE_BLOCK; }
   bool CanReadConcurrently() const override { return false; }
+  ChunkIndex* GetChunkIndex() override;
   bool MountBackend(DeviceControlRecord* dcr, int timeout) override;
   bool UnmountBackend(DeviceControlRecord* dcr, int timeout) override;
   bool ScanForVolumeImpl(DeviceControlRecord* dcr) override;
@@ -60,6 +63,7 @@ class dedup_device : public Device {
  private:
   bool mounted{false};
   std::optional<dedup::volume> openvol;
+  std::unique_ptr<ChunkIndex> chunk_index;
 
   std::size_t current_block();
   bool ResetOpenVolume();
@@ -399,6 +399,50 @@ ssize_t DropletCompatibleDevice::RemoteVolumeSize()
   return total_size;
 }
 
+/* The record index of a volume is stored as an extra object next to its
+ * chunks. is_chunk_name() does not match it, so it does not count towards
+ * the volume size. */
+static constexpr std::string_view volume_index_name{"index"};
+
+bool DropletCompatibleDevice::LoadVolumeIndex(const char* volume_name,
+                                              std::vector<char>& data)
+{
+  if (!setup()) { return false; }
+  auto obj_stat = m_storage.stat(volume_name, volume_index_name);
+  if (!obj_stat) { return false; }
+  data.resize(obj_stat->size);
+  auto obj_data = m_storage.download(volume_name, volume_index_name,
+                                     {data.data(), data.size()});
+  if (!obj_data) {
+    utl::Dfmt(debug_info, FMT_STRING("Could not read index of {}: {}"),
+              volume_name, obj_data.error());
+    return false;
+  }
+  data.resize(obj_data->size_bytes());
+  return true;
+}
+
+bool DropletCompatibleDevice::StoreVolumeIndex(const char* volume_name,
+                                               const std::vector<char>& data)
+{
+  if (!setup()) { return false; }
+  std::vector<char> copy{data};
+  if (auto result = m_storage.upload(volume_name, volume_index_name,
+                                     {copy.data(), copy.size()});
+      !result) {
+    utl::Dfmt(debug_info, FMT_STRING("Could not store index of {}: {}"),
+              volume_name, result.error());
+    return false;
+  }
+  return true;
+}
+
+bool DropletCompatibleDevice::RemoveVolumeIndex(const char* volume_name)
+{
+  if (!setup()) { return false; }
+  if (!m_storage.stat(volume_name, volume_index_name)) { return true; }
+  return m_storage.remove(volume_name, volume_index_name).has_value();
+}
 
 bool DropletCompatibleDevice::d_flush(DeviceControlRecord*)
 {
@@ -60,6 +60,11 @@ class DropletCompatibleDevice : public ChunkedDevice {
   ssize_t d_write(int fd, const void* buffer, size_t count) override;
   bool d_truncate(DeviceControlRecord* dcr) override;
   bool d_flush(DeviceControlRecord* dcr) override;
+  bool LoadVolumeIndex(const char* volume_name,
+                       std::vector<char>& data) override;
+  bool StoreVolumeIndex(const char* volume_name,
+                        const std::vector<char>& data) override;
+  bool RemoveVolumeIndex(const char* volume_name) override;
 };
 } /* namespace storagedaemon */
 #endif  // BAREOS_STORED_BACKENDS_DPLCOMPAT_DEVICE_H_
@@ -317,6 +317,67 @@ bail_out:
   return true;
 }
 
+// The record index of a volume is kept next to it as <volume>.idx
+std::string unix_file_device::VolumeIndexPath(const char* volume_name) const
+{
+  std::string path{archive_device_string};
+  if (!path.empty() && !IsPathSeparator(path.back())) { path += '/'; }
+  path += volume_name;
+  path += ".idx";
+  return path;
+}
+
+bool unix_file_device::LoadVolumeIndex(const char* volume_name,
+                                       std::vector<char>& data)
+{
+  std::string path = VolumeIndexPath(volume_name);
+  int index_fd = ::open(path.c_str(), O_RDONLY | O_BINARY);
+  if (index_fd < 0) { return false; }
+
+  struct stat st;
+  bool ok = fstat(index_fd, &st) == 0;
+  if (ok) {
+    data.resize(st.st_size);
+    ok = ::read(index_fd, data.data(), data.size())
+         == static_cast<ssize_t>(data.size());
+  }
+  ::close(index_fd);
+  return ok;
+}
+
+/* Written to a temporary file first, so a crash never leaves a truncated
+ * index behind. */
+bool unix_file_device::StoreVolumeIndex(const char* volume_name,
+                                        const std::vector<char>& data)
+{
+  std::string path = VolumeIndexPath(volume_name);
+  std::string tmp_path = path + ".tmp";
+  int index_fd
+      = ::open(tmp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_BINARY, 0640);
+  if (index_fd < 0) {
+    BErrNo be;
+    Dmsg2(100, "Could not create %s: ERR=%s\n", tmp_path.c_str(),
+          be.bstrerror());
+    return false;
+  }
+
+  bool ok = ::write(index_fd, data.data(), data.size())
+            == static_cast<ssize_t>(data.size());
+  if (::close(index_fd) != 0) { ok = false; }
+  if (ok && rename(tmp_path.c_str(), path.c_str()) == 0) { return true; }
+
+  BErrNo be;
+  Dmsg2(100, "Could not write %s: ERR=%s\n", path.c_str(), be.bstrerror());
+  unlink(tmp_path.c_str());
+  return false;
+}
+
+bool unix_file_device::RemoveVolumeIndex(const char* volume_name)
+{
+  std::string path = VolumeIndexPath(volume_name);
+  return unlink(path.c_str()) == 0 || errno == ENOENT;
+}
+
 REGISTER_SD_BACKEND(file, unix_file_device);
 
 } /* namespace storagedaemon  */
@@ -52,6 +52,14 @@ class unix_file_device : public Device {
   ssize_t d_read(int fd, void* buffer, size_t count) override;
   ssize_t d_write(int fd, const void* buffer, size_t count) override;
   bool d_truncate(DeviceControlRecord* dcr) override;
+  bool LoadVolumeIndex(const char* volume_name,
+                       std::vector<char>& data) override;
+  bool StoreVolumeIndex(const char* volume_name,
+                        const std::vector<char>& data) override;
+  bool RemoveVolumeIndex(const char* volume_name) override;
+
+ private:
+  std::string VolumeIndexPath(const char* volume_name) const;
 };
 
 } /* namespace storagedaemon */
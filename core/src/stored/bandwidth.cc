@@ -0,0 +1,142 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Bandwidth shared by all jobs of the Storage daemon.
+ */
+
+#include "include/bareos.h"
+#include "stored/stored.h"
+#include "stored/bandwidth.h"
+#include "stored/stored_globals.h"
+#include "stored/stored_jcr_impl.h"
+#include "lib/bandwidth_scheduler.h"
+#include "lib/bsock.h"
+#include "lib/edit.h"
+#include "include/jcr.h"
+
+#include <optional>
+#include <string>
+
+namespace storagedaemon {
+
+/* Dual stack sockets report IPv4 peers as IPv4-mapped IPv6 addresses
+ * (::ffff:a.b.c.d), so they are matched as the plain IPv4 address.  Other
+ * IPv6 addresses are brought into their canonical notation. */
+static std::string CanonicalAddress(const std::string& address)
+{
+  struct in6_addr in6 {};
+  if (inet_pton(AF_INET6, address.c_str(), &in6) != 1) { return address; }
+
+  char buf[INET6_ADDRSTRLEN];
+  if (IN6_IS_ADDR_V4MAPPED(&in6)) {
+    struct in_addr in4 {};
+    memcpy(&in4, in6.s6_addr + 12, sizeof(in4));
+    inet_ntop(AF_INET, &in4, buf, sizeof(buf));
+  } else {
+    inet_ntop(AF_INET6, &in6, buf, sizeof(buf));
+  }
+  return buf;
+}
+
+static std::optional<std::string> LocalAddress(BareosSocket* bs)
+{
+  struct sockaddr_storage address {};
+  socklen_t length = sizeof(address);
+  if (bs->fd_ < 0
+      || getsockname(bs->fd_, reinterpret_cast<sockaddr*>(&address), &length)
+             != 0) {
+    return std::nullopt;
+  }
+
+  char buf[256];
+  SockaddrToAscii(&address, buf, sizeof(buf));
+  return CanonicalAddress(buf);
+}
+
+// Entries of MaximumInterfaceBandwidth look like "<address> <speed>".
+bool ConfigureBandwidthSchedulers()
+{
+  bool ok = true;
+
+  DaemonBandwidthScheduler().SetRate(me->max_bandwidth);
+  for (auto& entry : me->max_interface_bandwidth) {
+    auto end = entry.find_first_of(" \t");
+    auto speed = entry.find_first_not_of(" \t", end);
+    uint64_t rate = 0;
+    if (end == 0 || speed == std::string::npos
+        || !speed_to_uint64(entry.c_str() + speed, &rate)) {
+      Jmsg1(nullptr, M_ERROR, 0,
+            T_("Invalid MaximumInterfaceBandwidth \"%s\", expected "
+               "\"<address> <speed>\".\n"),
+            entry.c_str());
+      ok = false;
+      continue;
+    }
+    InterfaceBandwidthScheduler(CanonicalAddress(entry.substr(0, end)))
+        .SetRate(rate);
+  }
+
+  return ok;
+}
+
+/* All connections of a job draw from the same flow, so a job striped over
+ * many connections does not get a larger share than one using a single
+ * connection. */
+static std::shared_ptr<BandwidthScheduler::Flow> JobFlow(
+    JobControlRecord* jcr,
+    BandwidthScheduler& scheduler)
+{
+  auto flows = jcr->sd_impl->bandwidth_flows.lock();
+  for (auto& flow : *flows) {
+    if (&flow->Scheduler() == &scheduler) { return flow; }
+  }
+  return flows->emplace_back(std::make_shared<BandwidthScheduler::Flow>(
+      scheduler, BandwidthWeightFromPriority(jcr->JobPriority)));
+}
+
+void ScheduleBandwidth(JobControlRecord* jcr, BareosSocket* bs)
+{
+  if (!bs) { return; }
+
+  bs->AddBandwidthFlow(JobFlow(jcr, DaemonBandwidthScheduler()));
+  if (auto address = LocalAddress(bs)) {
+    bs->AddBandwidthFlow(JobFlow(jcr, InterfaceBandwidthScheduler(*address)));
+  }
+  Dmsg2(100, "Job %s draws shared bandwidth via %d\n", jcr->Job, bs->fd_);
+}
+
+/* Without an address the limit of the whole daemon is changed.  The
+ * schedulers keep the current limits, the configured ones are only used at
+ * startup. */
+bool SetSharedBandwidth(int64_t rate, const char* address)
+{
+  if (rate < 0) { return false; }
+
+  if (address && *address) {
+    InterfaceBandwidthScheduler(CanonicalAddress(address)).SetRate(rate);
+  } else {
+    DaemonBandwidthScheduler().SetRate(rate);
+  }
+  return true;
+}
+
+} /* namespace storagedaemon */
@@ -0,0 +1,41 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#ifndef BAREOS_STORED_BANDWIDTH_H_
+#define BAREOS_STORED_BANDWIDTH_H_
+
+#include <cstdint>
+
+class BareosSocket;
+class JobControlRecord;
+
+namespace storagedaemon {
+
+/* All data connections draw from the shared bandwidth schedulers of this
+ * daemon, see lib/bandwidth_scheduler.h: one for the whole daemon and one
+ * for the local address the connection uses. */
+
+bool ConfigureBandwidthSchedulers();
+void ScheduleBandwidth(JobControlRecord* jcr, BareosSocket* bs);
+bool SetSharedBandwidth(int64_t rate, const char* address);
+
+} /* namespace storagedaemon */
+
+#endif  // BAREOS_STORED_BANDWIDTH_H_
@@ -38,11 +38,14 @@
 #include "stored/label.h"
 #include "stored/socket_server.h"
 #include "stored/spool.h"
+#include "stored/volume_index.h"
 #include "lib/berrno.h"
 #include "lib/edit.h"
 #include "include/jcr.h"
 #include "lib/serial.h"
 
+#include <optional>
+
 namespace storagedaemon {
 
 static bool TerminateWritingVolume(DeviceControlRecord* dcr);
@@ -454,6 +457,7 @@ static bool TerminateWritingVolume(DeviceControlRecord* dcr)
     ok = false;
   }
   dcr->block->write_failed = true;
+  FlushVolumeIndex(dev);
   if (!dev->weof(1)) { /* end the tape */
     dev->VolCatInfo.VolCatErrors++;
     Jmsg(
@@ -851,6 +855,10 @@ bool DeviceControlRecord::WriteBlockToDev()
     dev->file = dcr->EndFile;
   }
   dcr->WroteVol = true;
+  if (!block_seek) {
+    UpdateVolumeIndex(dev, dev->VolHdr.VolumeName, block, dev->file_addr,
+                      dev->file_addr + wlen);
+  }
   dev->file_addr += wlen; /* update file address */
   dev->file_size += wlen;
 
@@ -861,26 +869,48 @@ bool DeviceControlRecord::WriteBlockToDev()
 }
 
 /**
- * Write a block to the device, with locking and unlocking
- *
- * Returns: true  on success
- *        : false on failure
+ * With "Job Extent Blocks" set, full blocks of a job are kept back until
+ * that many are collected and are then written in one go.  Concurrent jobs
+ * on a disk device so get contiguous extents on the volume instead of
+ * taking turns block by block, which is what restores and copies of a
+ * single job have to read through.
  *
+ * Returns: true  if the block was kept back
+ *          false if it has to be written now
  */
-bool DeviceControlRecord::WriteBlockToDevice()
+static bool KeepBlockForExtent(DeviceControlRecord* dcr)
 {
-  bool status = true;
-  DeviceControlRecord* dcr = this;
+  Device* dev = dcr->dev;
+  DeviceBlock* block = dcr->block;
+  uint32_t extent_size
+      = dcr->device_resource ? dcr->device_resource->job_extent_blocks : 0;
 
-  if (dcr->spooling) {
-    status = WriteBlockToSpoolFile(dcr);
-    return status;
+  if (extent_size <= 1 || dcr->IsDevLocked() || dcr->despooling
+      || dev->GetSeekMode() != SeekMode::BYTES
+      || block->binbuf <= WRITE_BLKHDR_LENGTH
+      || dcr->extent_blocks.size() + 1 >= extent_size) {
+    return false;
   }
 
-  if (!dcr->IsDevLocked()) { /* device already locked? */
-    // Note, do not change this to dcr->r_dlock
-    dev->rLock(); /* no, lock it */
+  DeviceBlock* next;
+  if (dcr->spare_blocks.empty()) {
+    next = new_block(dev);
+  } else {
+    next = dcr->spare_blocks.back();
+    dcr->spare_blocks.pop_back();
   }
+  next->BlockNumber = block->BlockNumber + 1;
+
+  dcr->extent_blocks.push_back(block);
+  dcr->block = next;
+  return true;
+}
+
+// Write the current block of the dcr, the device must be locked.
+static bool WriteBlockLocked(DeviceControlRecord* dcr)
+{
+  JobControlRecord* jcr = dcr->jcr;
+  Device* dev = dcr->dev;
 
   /* If a new volume has been mounted since our last write
    * Create a JobMedia record for the previous volume written,
@@ -889,9 +919,8 @@ bool DeviceControlRecord::WriteBlockToDevice()
    * The same applies for if we are in a new file. */
   if (dcr->NewVol || dcr->NewFile) {
     if (jcr->IsJobCanceled()) {
-      status = false;
       Dmsg0(100, "Canceled\n");
-      goto bail_out;
+      return false;
     }
     /* Create a jobmedia record for this job */
     if (!dcr->DirCreateJobmediaRecord(false)) {
@@ -900,9 +929,8 @@ bool DeviceControlRecord::WriteBlockToDevice()
             T_("Could not create JobMedia record for Volume=\"%s\" Job=%s\n"),
             dcr->getVolCatName(), jcr->Job);
       SetNewVolumeParameters(dcr);
-      status = false;
       Dmsg0(100, "cannot create media record\n");
-      goto bail_out;
+      return false;
     }
     if (dcr->NewVol) {
       // Note, setting a new volume also handles any pending new file
@@ -914,13 +942,97 @@ bool DeviceControlRecord::WriteBlockToDevice()
 
   if (!dcr->WriteBlockToDev()) {
     if (jcr->IsJobCanceled() || jcr->is_JobType(JT_SYSTEM)) {
-      status = false;
+      return false;
     } else {
-      status = FixupDeviceBlockWriteError(dcr);
+      return FixupDeviceBlockWriteError(dcr);
+    }
+  }
+  return true;
+}
+
+/* If another job wrote to the volume since the last block of this one,
+ * end the JobMedia record there and start a new one with the extent.  A
+ * restore of the job then skips the foreign extents instead of reading
+ * through them. */
+static bool StartExtentJobMedia(DeviceControlRecord* dcr)
+{
+  Device* dev = dcr->dev;
+
+  // nothing written yet or the JobMedia record is done anyway
+  if (!dcr->WroteVol || dcr->VolFirstIndex == 0 || dcr->NewVol
+      || dcr->NewFile) {
+    return true;
+  }
+
+  uint64_t last_end = (static_cast<uint64_t>(dcr->EndFile) << 32)
+                      | dcr->EndBlock;
+  if (dev->file_addr == last_end + 1) { return true; }
+
+  if (!dcr->DirCreateJobmediaRecord(false)) {
+    Jmsg(dcr->jcr, M_FATAL, 0,
+         T_("Could not create JobMedia record for Volume=\"%s\" Job=%s\n"),
+         dcr->getVolCatName(), dcr->jcr->Job);
+    return false;
+  }
+  dcr->VolFirstIndex = dcr->VolLastIndex;
+  dcr->StartFile = static_cast<uint32_t>(dev->file_addr >> 32);
+  dcr->StartBlock = static_cast<uint32_t>(dev->file_addr);
+  return true;
+}
+
+// Write the blocks kept back for the extent, the device must be locked.
+static bool WriteKeptBlocks(DeviceControlRecord* dcr)
+{
+  DeviceBlock* current = dcr->block;
+  bool ok = dcr->extent_blocks.empty() || StartExtentJobMedia(dcr);
+
+  for (DeviceBlock* kept : dcr->extent_blocks) {
+    if (ok) {
+      dcr->block = kept;
+      ok = WriteBlockLocked(dcr);
     }
+    EmptyBlock(kept);
+    dcr->spare_blocks.push_back(kept);
+  }
+  dcr->block = current;
+  dcr->extent_blocks.clear();
+  return ok;
+}
+
+/**
+ * Write a block to the device, with locking and unlocking
+ *
+ * Returns: true  on success
+ *        : false on failure
+ *
+ */
+bool DeviceControlRecord::WriteBlockToDevice()
+{
+  bool status = true;
+  DeviceControlRecord* dcr = this;
+
+  std::optional<StageTimer> timer;
+  if (jcr) {
+    timer.emplace(jcr->pipeline_stats, dcr->spooling
+                                           ? PipelineStage::kSpoolWrite
+                                           : PipelineStage::kDeviceWrite);
+    timer->SetBytes(block->binbuf);
   }
 
-bail_out:
+  if (dcr->spooling) {
+    status = WriteBlockToSpoolFile(dcr);
+    return status;
+  }
+
+  if (KeepBlockForExtent(dcr)) { return true; }
+
+  if (!dcr->IsDevLocked()) { /* device already locked? */
+    // Note, do not change this to dcr->r_dlock
+    dev->rLock(); /* no, lock it */
+  }
+
+  status = WriteKeptBlocks(dcr) && WriteBlockLocked(dcr);
+
   if (!dcr->IsDevLocked()) { /* did we lock dev above? */
     // Note, do not change this to dcr->dunlock
     dev->Unlock(); /* unlock it now */
@@ -928,6 +1040,23 @@ bail_out:
   return status;
 }
 
+/**
+ * Write the blocks kept back for the current extent (see
+ * KeepBlockForExtent()), e.g. at the end of a session.
+ *
+ * Returns: true  on success
+ *        : false on failure
+ */
+bool DeviceControlRecord::FlushBlocks()
+{
+  if (extent_blocks.empty()) { return true; }
+
+  if (!IsDevLocked()) { dev->rLock(); }
+  bool status = WriteKeptBlocks(this);
+  if (!IsDevLocked()) { dev->Unlock(); }
+  return status;
+}
+
 // Read block with locking
 DeviceControlRecord::ReadStatus DeviceControlRecord::ReadBlockFromDevice(
     bool check_block_numbers)
@@ -45,6 +45,7 @@
 #include "stored/match_bsr.h"
 #include "stored/mount.h"
 #include "stored/read_record.h"
+#include "stored/volume_index.h"
 #include "findlib/match.h"
 #include "lib/address_conf.h"
 #include "lib/attribs.h"
@@ -63,6 +64,8 @@ extern bool ParseSdConfig(const char* configfile, int exit_code);
 using namespace storagedaemon;
 
 static void DoBlocks(char* infname);
+static void DoIndex();
+static void DoRebuildIndex();
 static void do_jobs(char* infname);
 static void do_ls(char* fname);
 static void do_close(JobControlRecord* jcr);
@@ -184,6 +187,14 @@ int main(int argc, char* argv[])
                    "List blocks.\n"
                    "If neither -j or -k specified, list saved files.");
 
+  bool list_index = false;
+  bls_app.add_flag("-i,--list-index", list_index,
+                   "List the record index stored with the volumes.");
+
+  bool rebuild_index = false;
+  bls_app.add_flag("-I,--rebuild-index", rebuild_index,
+                   "Read the volumes and store a new record index for them.");
+
   bls_app.add_flag("-L,--dump-labels", dump_label, "Dump labels.");
 
 
@@ -277,6 +288,10 @@ int main(int argc, char* argv[])
 
     if (list_blocks) {
       DoBlocks(device.data());
+    } else if (list_index) {
+      DoIndex();
+    } else if (rebuild_index) {
+      DoRebuildIndex();
     } else if (list_jobs) {
       do_jobs(device.data());
     } else {
@@ -375,6 +390,73 @@ static void DoBlocks(char*)
   return;
 }
 
+static void DoIndex()
+{
+  do {
+    const char* volume_name = dev->VolHdr.VolumeName;
+    std::vector<char> data;
+    if (!dev->LoadVolumeIndex(volume_name, data)) {
+      printf(T_("Volume \"%s\" has no index.\n"), volume_name);
+      continue;
+    }
+    std::optional index = VolumeIndex::Deserialize(volume_name, data);
+    if (!index) {
+      printf(T_("Index of Volume \"%s\" is damaged.\n"), volume_name);
+      continue;
+    }
+
+    printf(T_("Volume \"%s\": %zu entries covering %" PRIu64 " bytes\n"),
+           volume_name, index->Entries().size(), index->CoveredUntil());
+    for (const VolumeIndex::Entry& entry : index->Entries()) {
+      printf(T_("Addr=%" PRIu64 " SessId=%" PRIu32 " SessTim=%" PRIu32
+                " FI=%" PRId32 "-%" PRId32 "\n"),
+             entry.address, entry.VolSessionId, entry.VolSessionTime,
+             entry.FirstIndex, entry.LastIndex);
+    }
+  } while (MountNextReadVolume(dcr));
+}
+
+static void FinishIndex(VolumeIndexBuilder& builder)
+{
+  if (builder.Finish(dev)) {
+    printf(T_("Stored index of Volume \"%s\".\n"), dev->VolHdr.VolumeName);
+  } else {
+    printf(T_("Could not index Volume \"%s\".\n"), dev->VolHdr.VolumeName);
+  }
+}
+
+static void DoRebuildIndex()
+{
+  DeviceBlock* block = dcr->block;
+  VolumeIndexBuilder builder;
+  for (;;) {
+    switch (dcr->ReadBlockFromDevice(NO_BLOCK_NUMBER_CHECK)) {
+      case DeviceControlRecord::ReadStatus::Ok:
+        break;
+      case DeviceControlRecord::ReadStatus::EndOfTape:
+        FinishIndex(builder);
+        if (!MountNextReadVolume(dcr)) { return; }
+        // Read and discard Volume label
+        dcr->ReadBlockFromDevice(NO_BLOCK_NUMBER_CHECK);
+        continue;
+      case DeviceControlRecord::ReadStatus::EndOfFile:
+        continue;
+      default:
+        Dmsg1(100, "!read_block(): ERR=%s\n", dev->bstrerror());
+        printf(T_("Could not index Volume \"%s\": ERR=%s\n"),
+               dev->VolHdr.VolumeName, dev->bstrerror());
+        return;
+    }
+
+    // Reading all records fills in the FileIndex range of the block
+    DeviceRecord* record = new_record();
+    block->FirstIndex = block->LastIndex = 0;
+    while (ReadRecordFromBlock(dcr, record)) {}
+    FreeRecord(record);
+    builder.AddBlock(dev, block);
+  }
+}
+
 // We are only looking for labels or in particular Job Session records
 static bool jobs_cb(DeviceControlRecord* t_dcr, DeviceRecord* t_rec)
 {
@@ -57,6 +57,11 @@
 #include "lib/version.h"
 #include "lib/compression.h"
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
 /* Dummy functions */
 namespace storagedaemon {
 extern bool ParseSdConfig(const char* configfile, int exit_code);
@@ -97,6 +102,9 @@ static bool UpdateDigestRecord(BareosDb* db,
                                char* digest,
                                DeviceRecord* rec,
                                int type);
+static bool FlushPendingFile(JobId_t JobId);
+static void FinishBatchInsert();
+static void ReportProgress(bool final);
 
 /* Local variables */
 static Device* dev = nullptr;
@@ -131,6 +139,38 @@ static int num_media = 0;
 static int num_files = 0;
 static int num_restoreobjects = 0;
 
+static uint64_t total_bytes = 0;
+static time_t scan_start = 0;
+static time_t last_report = 0;
+
+/* File attributes are streamed into the batch table of the catalog (COPY on
+ * PostgreSQL) instead of being inserted row by row. The attributes of the
+ * last file of each job are held back until its digest record was seen, as
+ * batch inserted rows have no FileId that could be updated later on. */
+struct PendingFile {
+  std::string fname;
+  std::string link;
+  std::string attr;
+  std::string digest;
+  uint32_t FileIndex{};
+  uint32_t Stream{};
+  int DigestType{};
+  DBId_t ClientId{};
+};
+
+static bool batch_insert = false;
+static bool no_batch_insert = false;
+static uint32_t batch_size = BATCH_FLUSH;
+static std::unordered_map<JobId_t, PendingFile> pending_files;
+
+/* Two batch tables on separate connections. A full one is moved into the
+ * File table by a background thread while scanning fills the other one. */
+static JobControlRecord* batch_jcrs[2]{};
+static uint32_t batch_rows[2]{};
+static int cur_batch = 0;
+static std::thread batch_flusher;
+static std::atomic<bool> batch_failed{false};
+
 int main(int argc, char* argv[])
 {
   setlocale(LC_ALL, "");
@@ -211,11 +251,23 @@ int main(int argc, char* argv[])
   bscan_app.add_flag("-r,--list-records", list_records, "List records.");
 
   bscan_app.add_flag("-S,--show-progress", showProgress,
-                     "Show scan progress periodically.");
+                     "Show scan progress and throughput periodically.");
 
   bscan_app.add_flag("-s,--update-db", update_db,
                      "Synchronize or store in database.");
 
+  bscan_app
+      .add_option("--batch-size", batch_size,
+                  "Number of file records collected in a batch before it is "
+                  "written to the catalog.")
+      ->check(CLI::Range(1000u, static_cast<uint32_t>(BATCH_FLUSH)))
+      ->type_name("<files>")
+      ->capture_default_str();
+
+  bscan_app.add_flag("--no-batch-insert", no_batch_insert,
+                     "Insert file records one by one instead of using the "
+                     "batch insert.");
+
   std::string volumes;
   bscan_app
       .add_option("-V,--volumes", volumes,
@@ -328,7 +380,11 @@ int main(int argc, char* argv[])
           db_user.c_str());
   }
 
+  batch_insert = update_db && !no_batch_insert && db->BatchInsertAvailable();
+
+  scan_start = last_report = time(nullptr);
   do_scan();
+  if (showProgress) { ReportProgress(true); }
   if (update_db) {
     printf(
         "Records added or updated in the catalog:\n%7d Media\n"
@@ -424,9 +480,7 @@ static void do_scan()
   // Detach bscan's jcr as we are not a real Job on the tape
   ReadRecords(bjcr->sd_impl->read_dcr, RecordCb, BscanMountNextReadVolume);
 
-  if (update_db) {
-    db->WriteBatchFileRecords(bjcr); /* used by bulk batch file insert */
-  }
+  if (batch_insert) { FinishBatchInsert(); }
 
   FreeAttr(attr);
 }
@@ -487,6 +541,7 @@ static bool RecordCb(DeviceControlRecord* dcr, DeviceRecord* rec)
   if (rec->data_len > 0) {
     mr.VolBytes
         += rec->data_len + WRITE_RECHDR_LENGTH; /* Accumulate Volume bytes */
+    total_bytes += rec->data_len + WRITE_RECHDR_LENGTH;
     if (showProgress && currentVolumeSize > 0) {
       int pct = (mr.VolBytes * 100) / currentVolumeSize;
       if (pct != last_pct) {
@@ -495,6 +550,7 @@ static bool RecordCb(DeviceControlRecord* dcr, DeviceRecord* rec)
         last_pct = pct;
       }
     }
+    if (showProgress) { ReportProgress(false); }
   }
 
   if (list_records) {
@@ -695,6 +751,8 @@ static bool RecordCb(DeviceControlRecord* dcr, DeviceRecord* rec)
             break;
           }
 
+          if (!FlushPendingFile(mjcr->JobId)) { batch_failed = true; }
+
           // Do the final update to the Job record
           UpdateJobRecord(db, &jr, &elabel, rec);
 
@@ -720,6 +778,7 @@ static bool RecordCb(DeviceControlRecord* dcr, DeviceRecord* rec)
           for (auto mdcr : my_dev->attached_dcrs) {
             JobControlRecord* mjcr2 = mdcr->jcr;
             if (!mjcr2 || mjcr2->JobId == 0) { continue; }
+            if (!FlushPendingFile(mjcr2->JobId)) { batch_failed = true; }
             jr.JobId = mjcr2->JobId;
             jr.JobStatus = JS_ErrorTerminated; /* Mark Job as Error Terimined */
             jr.JobFiles = mjcr2->JobFiles;
@@ -801,7 +860,7 @@ static bool RecordCb(DeviceControlRecord* dcr, DeviceRecord* rec)
                                &rop)) {
         Emsg0(M_ERROR_TERM, 0, T_("Cannot continue.\n"));
       }
-      rop.FileIndex = mjcr->FileId;
+      rop.FileIndex = rec->FileIndex;
       rop.JobId = mjcr->JobId;
       rop.FileType = FT_RESTORE_FIRST;
 
@@ -1050,6 +1109,18 @@ static bool CreateFileAttributesRecord(BareosDb* t_db,
 
   if (!update_db) { return true; }
 
+  if (batch_insert) {
+    if (!FlushPendingFile(mjcr->JobId)) { return false; }
+    PendingFile& pf = pending_files[mjcr->JobId];
+    pf.fname = fname;
+    pf.link = lname;
+    pf.attr = ap;
+    pf.FileIndex = ar.FileIndex;
+    pf.Stream = ar.Stream;
+    pf.ClientId = ar.ClientId;
+    return true;
+  }
+
   if (DbLocker _{t_db}; !t_db->CreateFileAttributesRecord(bjcr, &ar)) {
     Pmsg1(0, T_("Could not create File Attributes record. ERR=%s\n"),
           t_db->strerror());
@@ -1415,6 +1486,15 @@ static bool UpdateDigestRecord(BareosDb* t_db,
     return false;
   }
 
+  if (batch_insert) {
+    if (auto it = pending_files.find(mjcr->JobId); it != pending_files.end()) {
+      it->second.digest = digest;
+      it->second.DigestType = type;
+    }
+    FreeJcr(mjcr);
+    return true;
+  }
+
   if (!update_db || mjcr->FileId == 0) {
     FreeJcr(mjcr);
     return true;
@@ -1434,6 +1514,133 @@ static bool UpdateDigestRecord(BareosDb* t_db,
   return true;
 }
 
+// Create the JobControlRecord owning one of the batch connections
+static JobControlRecord* CreateBatchJcr()
+{
+  JobControlRecord* jcr = new_jcr(BscanFreeJcr);
+  jcr->sd_impl = new StoredJcrImpl;
+  register_jcr(jcr);
+  bstrncpy(jcr->Job, "bscan-batch", sizeof(jcr->Job));
+
+  return jcr;
+}
+
+// Move the content of a batch table into the File table
+/* A batch mixes the files of all jobs on the volume, the partitions of all
+ * of them (on a partitioned File table) are created while it is written. */
+static void WriteBatch(JobControlRecord* jcr)
+{
+  if (!jcr->db_batch->WriteBatchFileRecords(jcr)) {
+    Pmsg1(0, T_("Could not write batch of File records. ERR=%s\n"),
+          jcr->db_batch->strerror());
+    batch_failed = true;
+  }
+}
+
+static void WaitForBatchWrite()
+{
+  if (batch_flusher.joinable()) { batch_flusher.join(); }
+}
+
+/**
+ * Hand the held back file record of a job to the batch insert. A full
+ * batch is written to the catalog in the background.
+ *
+ * Returns: true  if OK
+ *          false if error
+ */
+static bool FlushPendingFile(JobId_t JobId)
+{
+  auto it = pending_files.find(JobId);
+  if (it == pending_files.end()) { return true; }
+  PendingFile pf = std::move(it->second);
+  pending_files.erase(it);
+
+  AttributesDbRecord file_ar;
+  file_ar.fname = pf.fname.data();
+  file_ar.link = pf.link.data();
+  file_ar.attr = pf.attr.data();
+  file_ar.FileIndex = pf.FileIndex;
+  file_ar.Stream = pf.Stream;
+  file_ar.JobId = JobId;
+  file_ar.ClientId = pf.ClientId;
+  if (!pf.digest.empty()) {
+    file_ar.Digest = pf.digest.data();
+    file_ar.DigestType = pf.DigestType;
+  }
+
+  if (!batch_jcrs[cur_batch]) { batch_jcrs[cur_batch] = CreateBatchJcr(); }
+  JobControlRecord* jcr = batch_jcrs[cur_batch];
+  if (!db->CreateAttributesRecord(jcr, &file_ar)) {
+    Pmsg1(0, T_("Could not create File Attributes record. ERR=%s\n"),
+          jcr->db_batch ? jcr->db_batch->strerror() : db->strerror());
+    return false;
+  }
+  if (g_verbose > 1) {
+    Pmsg1(000, T_("Queued File record: %s\n"), file_ar.fname);
+  }
+
+  if (++batch_rows[cur_batch] >= batch_size) {
+    /* The other batch is reused as soon as its last write finished. */
+    WaitForBatchWrite();
+    batch_flusher = std::thread(WriteBatch, jcr);
+    batch_rows[cur_batch] = 0;
+    cur_batch ^= 1;
+  }
+
+  return true;
+}
+
+// Write out everything still queued and release the batch connections
+static void FinishBatchInsert()
+{
+  while (!pending_files.empty()) {
+    if (!FlushPendingFile(pending_files.begin()->first)) {
+      batch_failed = true;
+    }
+  }
+
+  WaitForBatchWrite();
+  if (batch_jcrs[cur_batch]) { WriteBatch(batch_jcrs[cur_batch]); }
+
+  for (auto& jcr : batch_jcrs) {
+    if (!jcr) { continue; }
+    if (jcr->db_batch) {
+      jcr->db_batch->CloseDatabase(jcr);
+      jcr->db_batch = nullptr;
+    }
+    FreeJcr(jcr);
+    jcr = nullptr;
+  }
+
+  if (batch_failed) {
+    Pmsg0(0, T_("Not all File records could be written to the catalog.\n"));
+  }
+}
+
+/**
+ * Print the amount of data and files scanned so far together with the
+ * throughput. Intermediate reports are printed at most every 10 seconds.
+ */
+static void ReportProgress(bool final)
+{
+  time_t now = time(nullptr);
+  if (!final && now - last_report < 10) { return; }
+  last_report = now;
+
+  uint64_t elapsed = std::max<time_t>(now - scan_start, 1);
+  char ed1[50], ed2[50], ed3[50], ed4[50], ed5[50];
+  fprintf(stdout,
+          T_("%s %s bytes, %s files in %s sec: %s KB/s, %s files/s\n"),
+          final ? T_("Scanned") : T_("Progress:"),
+          edit_uint64_with_commas(total_bytes, ed1),
+          edit_uint64_with_commas(num_files, ed2),
+          edit_uint64_with_commas(elapsed, ed3),
+          edit_uint64_with_commas(total_bytes / 1024 / elapsed, ed4),
+          edit_uint64_with_commas(num_files / elapsed, ed5));
+  fflush(stdout);
+}
+
 // Create a JobControlRecord as if we are really starting the job
 static JobControlRecord* create_jcr(JobDbRecord* t_jr,
                                     DeviceRecord* rec,
@@ -42,6 +42,7 @@
 #include "stored/device_control_record.h"
 #include "stored/stored_jcr_impl.h"
 #include "stored/stored.h"
+#include "stored/volume_index.h"
 #include "include/jcr.h"
 
 namespace storagedaemon {
@@ -758,6 +759,52 @@ uint64_t GetBsrStartAddr(BootStrapRecord* bsr, uint32_t* file, uint32_t* block)
   return bsr_addr;
 }
 
+/* Where the first record wanted by this bsr is according to the index, or
+ * 0 if the index can not tell. */
+static uint64_t LookupBsrInIndex(BootStrapRecord* bsr, const VolumeIndex& index)
+{
+  // larger session ranges are not worth the lookups
+  static constexpr uint32_t max_sessions = 64;
+
+  if (!bsr->sessid || !bsr->sesstime || !bsr->FileIndex) { return 0; }
+
+  std::optional<uint64_t> first;
+  uint32_t sessions = 0;
+  for (BsrSessionId* sid = bsr->sessid; sid; sid = sid->next) {
+    sessions += sid->sessid2 - sid->sessid + 1;
+    if (sid->sessid2 < sid->sessid || sessions > max_sessions) { return 0; }
+    for (uint32_t id = sid->sessid; id <= sid->sessid2; ++id) {
+      for (BsrSessionTime* stime = bsr->sesstime; stime; stime = stime->next) {
+        if (stime->done) { continue; }
+        for (BsrFileIndex* fi = bsr->FileIndex; fi; fi = fi->next) {
+          if (fi->done) { continue; }
+          std::optional address
+              = index.Lookup(id, stime->sesstime, fi->findex, fi->findex2);
+          if (!address) { return 0; }
+          if (!first || *address < *first) { first = address; }
+        }
+      }
+    }
+  }
+  return first.value_or(0);
+}
+
+uint64_t GetIndexedStartAddr(BootStrapRecord* root_bsr,
+                             Device* dev,
+                             const VolumeIndex& index)
+{
+  std::optional<uint64_t> start;
+  for (BootStrapRecord* bsr = root_bsr; bsr; bsr = bsr->next) {
+    if (bsr->done || !MatchVolume(bsr, bsr->volume, &dev->VolHdr, 1)) {
+      continue;
+    }
+    uint64_t addr = std::max(GetBsrStartAddr(bsr, nullptr, nullptr),
+                             LookupBsrInIndex(bsr, index));
+    if (!start || addr < *start) { start = addr; }
+  }
+  return start.value_or(0);
+}
+
 /* ****************************************************************
  * Routines for handling volumes
  */
@@ -0,0 +1,209 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * In-memory inventory of the drives of an autochanger
+ */
+
+#include "stored/changer_inventory.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace storagedaemon {
+
+namespace {
+template <typename T> bool ParseNumber(std::string_view field, T& value)
+{
+  auto [ptr, ec]
+      = std::from_chars(field.data(), field.data() + field.size(), value);
+  return ec == std::errc{} && ptr == field.data() + field.size();
+}
+
+std::vector<std::string_view> SplitFields(std::string_view line)
+{
+  std::vector<std::string_view> fields;
+  for (;;) {
+    auto pos = line.find(':');
+    fields.push_back(line.substr(0, pos));
+    if (pos == line.npos) { break; }
+    line.remove_prefix(pos + 1);
+  }
+  return fields;
+}
+}  // namespace
+
+bool ChangerInventory::Update(std::string_view listall_output)
+{
+  std::map<drive_number_t, slot_number_t> drives;
+
+  while (!listall_output.empty()) {
+    auto eol = listall_output.find('\n');
+    std::string_view line = listall_output.substr(0, eol);
+    listall_output.remove_prefix(eol == listall_output.npos
+                                     ? listall_output.size()
+                                     : eol + 1);
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.remove_suffix(1);
+    }
+
+    // D:<drive>:E or D:<drive>:F:<slot>[:<volume>]
+    auto fields = SplitFields(line);
+    if (fields.size() < 3 || fields[0] != "D") { continue; }
+
+    drive_number_t drive;
+    if (!ParseNumber(fields[1], drive)) { continue; }
+    if (fields[2] == "E") {
+      drives[drive] = 0;
+    } else if (fields[2] == "F" && fields.size() >= 4) {
+      slot_number_t slot;
+      if (ParseNumber(fields[3], slot) && IsSlotNumberValid(slot)) {
+        drives[drive] = slot;
+      }
+    }
+  }
+
+  if (drives.empty()) { return false; }
+
+  std::lock_guard l(mutex_);
+  // What the changer reports for a drive in the middle of a move is stale.
+  for (auto& move : moves_) { drives.erase(move.first); }
+  drives_ = std::move(drives);
+  return true;
+}
+
+void ChangerInventory::Invalidate()
+{
+  std::lock_guard l(mutex_);
+  drives_.clear();
+}
+
+void ChangerInventory::Invalidate(drive_number_t drive)
+{
+  std::lock_guard l(mutex_);
+  drives_.erase(drive);
+}
+
+std::optional<slot_number_t> ChangerInventory::LoadedSlot(
+    drive_number_t drive) const
+{
+  std::lock_guard l(mutex_);
+  if (auto it = drives_.find(drive); it != drives_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<drive_number_t> ChangerInventory::DriveHoldingSlot(
+    slot_number_t slot) const
+{
+  if (!IsSlotNumberValid(slot)) { return std::nullopt; }
+
+  std::lock_guard l(mutex_);
+  for (auto [drive, loaded] : drives_) {
+    if (loaded == slot) { return drive; }
+  }
+  return std::nullopt;
+}
+
+void ChangerInventory::SetLoaded(drive_number_t drive, slot_number_t slot)
+{
+  std::lock_guard l(mutex_);
+  // The outcome of a move is recorded when it ends.
+  if (moves_.count(drive)) { return; }
+
+  // A cartridge can only be in one drive.
+  if (IsSlotNumberValid(slot)) {
+    for (auto& [other, loaded] : drives_) {
+      if (other != drive && loaded == slot) { loaded = 0; }
+    }
+  }
+  drives_[drive] = slot;
+}
+
+bool ChangerInventory::BeginMove(drive_number_t drive,
+                                 std::initializer_list<slot_number_t> slots)
+{
+  std::lock_guard l(mutex_);
+  if (moves_.count(drive)) { return false; }
+
+  std::vector<slot_number_t> moving;
+  for (auto slot : slots) {
+    if (!IsSlotNumberValid(slot)) { continue; }
+    if (SlotMovingLocked(slot)) { return false; }
+    moving.push_back(slot);
+  }
+
+  moves_.emplace(drive, std::move(moving));
+  // Until the move is finished nobody knows what is in the drive.
+  drives_.erase(drive);
+  return true;
+}
+
+void ChangerInventory::EndMove(drive_number_t drive,
+                               std::optional<slot_number_t> loaded)
+{
+  {
+    std::lock_guard l(mutex_);
+    moves_.erase(drive);
+  }
+  if (loaded) {
+    SetLoaded(drive, *loaded);
+  } else {
+    Invalidate(drive);
+  }
+}
+
+bool ChangerInventory::DriveMoving(drive_number_t drive) const
+{
+  std::lock_guard l(mutex_);
+  return moves_.count(drive) > 0;
+}
+
+bool ChangerInventory::SlotMoving(slot_number_t slot) const
+{
+  std::lock_guard l(mutex_);
+  return SlotMovingLocked(slot);
+}
+
+bool ChangerInventory::ListallSupported() const
+{
+  std::lock_guard l(mutex_);
+  return listall_supported_;
+}
+
+void ChangerInventory::SetListallUnsupported()
+{
+  std::lock_guard l(mutex_);
+  listall_supported_ = false;
+}
+
+bool ChangerInventory::SlotMovingLocked(slot_number_t slot) const
+{
+  for (auto& [drive, slots] : moves_) {
+    if (std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} /* namespace storagedaemon */
@@ -0,0 +1,88 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_STORED_CHANGER_INVENTORY_H_
+#define BAREOS_STORED_CHANGER_INVENTORY_H_
+
+#include "include/baconfig.h"
+
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace storagedaemon {
+
+/* In-memory model of what is loaded in the drives of an autochanger.
+ *
+ * It is filled from the output of the "listall" changer command, which
+ * reports all drives at once, and kept up to date by the loads and unloads
+ * the storage daemon does itself.  Drives are identified by their physical
+ * drive index (%d of the changer command), slots are numbered from 1 and
+ * an empty drive holds slot 0.
+ *
+ * Moves in progress are tracked as well, so that the changer lock does not
+ * need to be held while the robot moves a cartridge: a drive or a slot that
+ * takes part in a move cannot be used by another one. */
+class ChangerInventory {
+ public:
+  // Replace the model by the content of a "listall" output.  Returns false
+  // (and leaves the model unchanged) if no drive could be parsed from it.
+  bool Update(std::string_view listall_output);
+  // Forget everything, e.g. after the cartridges were moved by hand.
+  void Invalidate();
+  void Invalidate(drive_number_t drive);
+
+  // The slot loaded in the drive, 0 if it is empty and nothing if unknown.
+  std::optional<slot_number_t> LoadedSlot(drive_number_t drive) const;
+  // The drive that holds the cartridge of the slot, if known.
+  std::optional<drive_number_t> DriveHoldingSlot(slot_number_t slot) const;
+  // Record the result of a load (slot) or an unload (0).
+  void SetLoaded(drive_number_t drive, slot_number_t slot);
+
+  // Reserve the drive and the slots (the one to unload and the one to
+  // load) for a move; fails if any of them is part of another move.  While
+  // the move is running the drive is unknown.
+  bool BeginMove(drive_number_t drive,
+                 std::initializer_list<slot_number_t> slots);
+  // Release the reservation; loaded is what the drive holds now, if known.
+  void EndMove(drive_number_t drive, std::optional<slot_number_t> loaded);
+  bool DriveMoving(drive_number_t drive) const;
+  bool SlotMoving(slot_number_t slot) const;
+
+  // Changer commands that do not know "listall" are not asked again.
+  bool ListallSupported() const;
+  void SetListallUnsupported();
+
+ private:
+  bool SlotMovingLocked(slot_number_t slot) const;
+
+  mutable std::mutex mutex_;
+  std::map<drive_number_t, slot_number_t> drives_;
+  std::map<drive_number_t, std::vector<slot_number_t>> moves_;
+  bool listall_supported_{true};
+};
+
+} /* namespace storagedaemon */
+
+#endif  // BAREOS_STORED_CHANGER_INVENTORY_H_
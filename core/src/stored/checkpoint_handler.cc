@@ -1,7 +1,7 @@
 /*
    BAREOS® - Backup Archiving REcovery Open Sourced
 
-Copyright (C) 2023-2025 Bareos GmbH & Co. KG
+Copyright (C) 2023-2026 Bareos GmbH & Co. KG
 
 This program is Free Software; you can redistribute it and/or
 modify it under the terms of version three of the GNU Affero General Public
@@ -63,6 +63,12 @@ void CheckpointHandler::UpdateJobrecord(JobControlRecord* jcr)
 void CheckpointHandler::DoBackupCheckpoint(JobControlRecord* jcr)
 {
   Dmsg0(100, T_("Checkpoint: Syncing current backup status to catalog\n"));
+  // the catalog must not refer to blocks that were not written yet
+  if (!jcr->sd_impl->dcr->FlushBlocks()) {
+    Jmsg0(jcr, M_ERROR, 0,
+          T_("Checkpoint skipped, kept back blocks could not be written.\n"));
+    return;
+  }
   UpdateJobrecord(jcr);
   UpdateFileList(jcr);
   UpdateJobmediaRecord(jcr);
@@ -0,0 +1,61 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_STORED_CHUNK_INDEX_H_
+#define BAREOS_STORED_CHUNK_INDEX_H_
+
+#include "lib/chunk_manifest.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace storagedaemon {
+
+/* Devices that store data as content addressed chunks can expose their
+ * fingerprint index.  File daemons use it to skip sending chunks that the
+ * storage daemon already holds (see lib/chunk_manifest.h). */
+class ChunkIndex {
+ public:
+  using fingerprint = chunk_manifest::fingerprint;
+
+  virtual ~ChunkIndex() = default;
+
+  // The average chunk size clients should cut their data into, so that
+  // their chunks line up with the ones in the index.
+  virtual std::size_t ChunkSize() const = 0;
+  // Takes a reference on the chunk, so that it stays available until it is
+  // released again.  Returns its id, or std::nullopt if it is not known.
+  // When the chunk is written to the device before that, the device takes
+  // the reference over instead of looking the data up again.
+  virtual std::optional<std::uint64_t> Reference(const fingerprint& fp,
+                                                 std::size_t size)
+      = 0;
+  // Copies a referenced chunk into data; returns false on errors.
+  virtual bool Read(std::uint64_t id, char* data, std::size_t size) = 0;
+  // Drops the references taken by Reference() that were not taken over.
+  virtual void Release(const std::vector<std::uint64_t>& ids) = 0;
+};
+
+} /* namespace storagedaemon */
+
+#endif  // BAREOS_STORED_CHUNK_INDEX_H_
@@ -0,0 +1,206 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Additional connections for striped data transfers.
+ */
+
+#include "include/bareos.h"
+#include "stored/stored.h"
+#include "stored/authenticate.h"
+#include "stored/data_connections.h"
+#include "stored/stored_globals.h"
+#include "stored/stored_jcr_impl.h"
+#include "lib/bsock_tcp.h"
+#include "lib/global_resource.h"
+#include "include/jcr.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace storagedaemon {
+
+/* The client announces its data connections only after they got
+ * authenticated, so they show up here almost immediately. */
+static constexpr auto data_connection_wait = std::chrono::seconds(60);
+
+// Returns the number of data connections we use, 0 if we do not stripe.
+uint32_t AcceptDataConnections(JobControlRecord* jcr, uint32_t offered)
+{
+  uint32_t accepted = std::min(offered, me->max_data_connections);
+  if (accepted <= 1) { accepted = 0; }
+
+  jcr->sd_impl->data_connections.lock()->accepted = accepted;
+  return accepted;
+}
+
+/**
+ * After receiving a connection (in socket_server.cc) that announces itself
+ * as data connection, this routine is called.  The socket is kept with the
+ * job until the striped transfer is over.
+ */
+void* HandleDataConnection(BareosSocket* bs,
+                           char* job_name,
+                           uint32_t index,
+                           bool from_storage)
+{
+  JobControlRecord* jcr = get_jcr_by_full_name(job_name);
+  if (!jcr) {
+    Jmsg1(nullptr, M_FATAL, 0,
+          T_("Data connection failed: Job name not found: %s\n"), job_name);
+    bs->close();
+    delete bs;
+    return nullptr;
+  }
+
+  Dmsg2(50, "Data connection %u for Job %s\n", index, job_name);
+
+  if (jcr->sd_impl->data_connections.lock()->accepted == 0
+      || !AuthenticateDataConnection(jcr, bs, from_storage)) {
+    Jmsg2(jcr, M_ERROR, 0, T_("Refused data connection %u from %s\n"), index,
+          bs->who());
+    bs->close();
+    delete bs;
+    FreeJcr(jcr);
+    return nullptr;
+  }
+
+  bs->SetJcr(jcr);
+  {
+    auto locked = jcr->sd_impl->data_connections.lock();
+    if (locked->sockets.size() < locked->accepted) {
+      locked->sockets.push_back(bs);
+      bs = nullptr;
+    }
+  }
+  jcr->sd_impl->data_connection_added.notify_all();
+
+  if (bs) {
+    Jmsg1(jcr, M_ERROR, 0, T_("Too many data connections from %s\n"),
+          bs->who());
+    bs->close();
+    delete bs;
+  }
+
+  FreeJcr(jcr);
+  return nullptr;
+}
+
+/* Wait until the client's count data connections are there.  Returns them,
+ * or nothing if they did not show up in time. */
+std::vector<BareosSocket*> WaitForDataConnections(JobControlRecord* jcr,
+                                                  uint32_t count)
+{
+  auto timeout = std::chrono::system_clock::now() + data_connection_wait;
+  auto locked = jcr->sd_impl->data_connections.lock();
+
+  if (count > locked->accepted) { return {}; }
+
+  locked.wait_until(jcr->sd_impl->data_connection_added, timeout,
+                    [jcr, count](const DataConnections& connections) {
+                      return connections.sockets.size() >= count
+                             || jcr->IsJobCanceled();
+                    });
+
+  if (locked->sockets.size() < count) { return {}; }
+  return locked->sockets;
+}
+
+// Closes the data connections and refuses new ones.
+void CloseDataConnections(JobControlRecord* jcr)
+{
+  std::vector<BareosSocket*> sockets;
+  {
+    auto locked = jcr->sd_impl->data_connections.lock();
+    locked->accepted = 0;
+    sockets.swap(locked->sockets);
+  }
+
+  for (auto* bs : sockets) {
+    bs->close();
+    delete bs;
+  }
+}
+
+static BareosSocket* OpenReplicationDataConnection(JobControlRecord* jcr,
+                                                   uint32_t index)
+{
+  ReplicationTarget& target = jcr->sd_impl->replication_target;
+  BareosSocket* sd = new BareosSocketTCP;
+
+  sd->SetSourceAddress(me->SDsrc_addr);
+  if (!sd->connect(jcr, 1, (int)me->SDConnectTimeout, me->heartbeat_interval,
+                   T_("Storage daemon"), target.address.data(), nullptr,
+                   target.port, false)) {
+    delete sd;
+    return nullptr;
+  }
+
+  bool ok = true;
+  if (jcr->sd_tls_policy == TlsPolicy::kBnetTlsAuto) {
+    std::string qualified_resource_name = global_resource::QualifiedName(
+        global_resource::Type::Job, target.job.c_str());
+
+    sd->SetEnableKtls(me->enable_ktls);
+    ok = sd->DoTlsHandshake(TlsPolicy::kBnetTlsAuto, me, false,
+                            qualified_resource_name.c_str(), jcr->sd_auth_key,
+                            jcr);
+  }
+
+  if (ok) {
+    sd->fsend("Hello Start Storage Job %s DataConnection=%u\n",
+              target.job.c_str(), index);
+    ok = AuthenticateWithDataConnection(jcr, sd);
+  }
+
+  if (!ok) {
+    sd->close();
+    delete sd;
+    return nullptr;
+  }
+
+  sd->SetJcr(jcr);
+  return sd;
+}
+
+/* Open the data connections to the storage daemon we replicate to.  If some
+ * of them fail, the data is striped over the others.  Returns the number of
+ * opened connections. */
+uint32_t OpenReplicationDataConnections(JobControlRecord* jcr, uint32_t count)
+{
+  auto locked = jcr->sd_impl->data_connections.lock();
+  for (uint32_t i = 1; i <= count; ++i) {
+    BareosSocket* sd = OpenReplicationDataConnection(jcr, i);
+    if (!sd) {
+      Jmsg(jcr, M_WARNING, 0,
+           T_("Could not open data connection %u of %u to Storage daemon "
+              "%s:%d\n"),
+           i, count, jcr->sd_impl->replication_target.address.c_str(),
+           jcr->sd_impl->replication_target.port);
+      break;
+    }
+    locked->sockets.push_back(sd);
+  }
+
+  return locked->sockets.size();
+}
+
+} /* namespace storagedaemon */
@@ -0,0 +1,47 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#ifndef BAREOS_STORED_DATA_CONNECTIONS_H_
+#define BAREOS_STORED_DATA_CONNECTIONS_H_
+
+#include <vector>
+
+namespace storagedaemon {
+
+/* Besides its main connection a File daemon or a replicating Storage daemon
+ * may open more connections to stripe the data of a job over, see
+ * lib/bsock_striped.h.  Their number is agreed on when the session gets
+ * opened. */
+
+uint32_t AcceptDataConnections(JobControlRecord* jcr, uint32_t offered);
+void* HandleDataConnection(BareosSocket* bs,
+                           char* job_name,
+                           uint32_t index,
+                           bool from_storage);
+std::vector<BareosSocket*> WaitForDataConnections(JobControlRecord* jcr,
+                                                  uint32_t count);
+void CloseDataConnections(JobControlRecord* jcr);
+
+uint32_t OpenReplicationDataConnections(JobControlRecord* jcr,
+                                        uint32_t count);
+
+} /* namespace storagedaemon */
+
+#endif  // BAREOS_STORED_DATA_CONNECTIONS_H_
@@ -320,6 +320,20 @@ static void InitiateDevice(JobControlRecord* jcr, Device* dev)
     Jmsg0(jcr, M_ERROR_TERM, 0, "%s", dev->errmsg);
   }
 
+  metrics::Labels labels{{"device", dev->device_resource->resource_name_}};
+  auto& registry = metrics::Global();
+  dev->io_metrics.reset(new Device::IoMetrics{
+      registry.GetCounter("bareos_device_read_bytes",
+                          "Bytes read from the device", labels),
+      registry.GetCounter("bareos_device_write_bytes",
+                          "Bytes written to the device", labels),
+      registry.GetHistogram("bareos_device_read_duration_seconds",
+                            "Duration of single reads from the device",
+                            labels),
+      registry.GetHistogram("bareos_device_write_duration_seconds",
+                            "Duration of single writes to the device",
+                            labels)});
+
   dev->ClearOpened();
   dev->attached_dcrs.clear();
   Dmsg2(100, "FactoryCreateDevice: tape=%d archive_device_string=%s\n",
@@ -387,6 +401,23 @@ bool DoubleDevWaitTime(Device* dev)
   return true;
 }
 
+void GetFileArchiveName(const DeviceResource* device,
+                        const char* volume_name,
+                        PoolMem& archive_name)
+{
+  PmStrcpy(archive_name, device->archive_device_string);
+  if (device->changer_res && device->changer_command
+      && device->changer_command[0]) {
+    return;
+  }
+
+  if (!IsPathSeparator(
+          archive_name.c_str()[strlen(archive_name.c_str()) - 1])) {
+    PmStrcat(archive_name, "/");
+  }
+  PmStrcat(archive_name, volume_name);
+}
+
 /**
  * Set the block size of the device.
  * If the volume block size is zero, we set the max block size to what is
@@ -593,28 +624,21 @@ void Device::OpenDevice(DeviceControlRecord* dcr, DeviceMode omode)
 
   GetAutochangerLoadedSlot(dcr);
 
-  // Handle opening of File Archive (not a tape)
-  PmStrcpy(archive_name, archive_device_string);
-
   /* If this is a virtual autochanger (i.e. changer_res != NULL) we simply use
    * the device name, assuming it has been appropriately setup by the
    * "autochanger". */
-  if (!device_resource->changer_res
-      || device_resource->changer_command[0] == 0) {
-    if (VolCatInfo.VolCatName[0] == 0) {
-      Mmsg(errmsg, T_("Could not open file device %s. No Volume name given.\n"),
-           print_name());
-      ClearOpened();
-      return;
-    }
-
-    if (!IsPathSeparator(
-            archive_name.c_str()[strlen(archive_name.c_str()) - 1])) {
-      PmStrcat(archive_name, "/");
-    }
-    PmStrcat(archive_name, getVolCatName());
+  if ((!device_resource->changer_res
+       || device_resource->changer_command[0] == 0)
+      && VolCatInfo.VolCatName[0] == 0) {
+    Mmsg(errmsg, T_("Could not open file device %s. No Volume name given.\n"),
+         print_name());
+    ClearOpened();
+    return;
   }
 
+  // Handle opening of File Archive (not a tape)
+  GetFileArchiveName(device_resource, getVolCatName(), archive_name);
+
   mount(dcr, 1); /* do mount if required */
 
   open_mode = omode;
@@ -1112,6 +1136,11 @@ ssize_t Device::read(void* buf, size_t len)
     DevReadBytes += read_len;
   }
 
+  if (io_metrics) {
+    if (read_len > 0) { io_metrics->read_bytes.Add(read_len); }
+    io_metrics->read_latency.Observe(last_tick / 1e6);
+  }
+
   return read_len;
 }
 
@@ -1133,6 +1162,11 @@ ssize_t Device::write(const void* buf, size_t len)
     DevWriteBytes += write_len;
   }
 
+  if (io_metrics) {
+    if (write_len > 0) { io_metrics->write_bytes.Add(write_len); }
+    io_metrics->write_latency.Observe(last_tick / 1e6);
+  }
+
   return write_len;
 }
 
@@ -65,15 +65,20 @@
 #include "stored/volume_catalog_info.h"
 #include "stored/io_direction.h"
 #include "lib/btimers.h"
+#include "lib/metrics.h"
 
 #include <vector>
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 template <typename T> class dlist;
 
 namespace storagedaemon {
 
 struct DeviceStatusInformation;
+class ChunkIndex;
+class VolumeIndex;
 
 class DeviceResource;
 class DeviceControlRecord;
@@ -288,6 +293,8 @@ class Device {
 
   VolumeCatalogInfo VolCatInfo;       /**< Volume Catalog Information */
   Volume_Label VolHdr;                /**< Actual volume label */
+  std::shared_ptr<VolumeIndex> volume_index{}; /**< Record index */
+  std::mutex volume_index_mutex{};             /**< Protects volume_index */
   char pool_name[MAX_NAME_LENGTH]{};  /**< Pool name */
   char pool_type[MAX_NAME_LENGTH]{};  /**< Pool type */
 
@@ -309,6 +316,15 @@ class Device {
   uint64_t DevWriteBytes{};
   uint64_t DevReadBytes{};
 
+  /* Exported through the metrics server */
+  struct IoMetrics {
+    metrics::Counter& read_bytes;
+    metrics::Counter& write_bytes;
+    metrics::Histogram& read_latency;
+    metrics::Histogram& write_latency;
+  };
+  std::unique_ptr<IoMetrics> io_metrics;
+
   /* Methods */
   btime_t GetTimerCount(); /**< Return the last timer interval (ms) */
 
@@ -473,6 +489,18 @@ public:
   virtual bool DeviceStatus(DeviceStatusInformation*) { return false; }
   virtual SeekMode GetSeekMode() const = 0;
   virtual bool CanReadConcurrently() const { return false; }
+  virtual ChunkIndex* GetChunkIndex() { return nullptr; }
+  /* Storage of the sidecar record index of a volume (see volume_index.h).
+   * Devices that can not keep one return false. */
+  virtual bool LoadVolumeIndex(const char*, std::vector<char>&)
+  {
+    return false;
+  }
+  virtual bool StoreVolumeIndex(const char*, const std::vector<char>&)
+  {
+    return false;
+  }
+  virtual bool RemoveVolumeIndex(const char*) { return false; }
 
   // Low level operations
   virtual int d_ioctl(int fd, ioctl_req_t request, char* mt_com = NULL) = 0;
@@ -546,6 +574,12 @@ JobControlRecord* next_attached_jcr(Device* dev, JobControlRecord* jcr);
 void InitDeviceWaitTimers(DeviceControlRecord* dcr);
 void InitJcrDeviceWaitTimers(JobControlRecord* jcr);
 bool DoubleDevWaitTime(Device* dev);
+/* Where a file device finds volume_name: in the archive device directory,
+ * unless the device belongs to a virtual autochanger, which makes the
+ * loaded volume appear as the archive device itself. */
+void GetFileArchiveName(const DeviceResource* device,
+                        const char* volume_name,
+                        PoolMem& archive_name);
 
 /*
  * Get some definition of function to position to the end of the medium in
@@ -54,6 +54,7 @@
 #include "stored/device_control_record.h"
 #include "stored/stored_jcr_impl.h"
 #include "stored/match_bsr.h"
+#include "stored/volume_index.h"
 #include "lib/edit.h"
 #include "include/jcr.h"
 #include "lib/berrno.h"
@@ -291,6 +292,34 @@ bail_out:
   return ok;
 }
 
+/**
+ * Start address of the next bsr to read.  The catalog only knows where a
+ * job starts on the volume, the record index of the volume may know where
+ * the wanted files start.
+ */
+static uint64_t GetStartAddr(JobControlRecord* jcr,
+                             Device* dev,
+                             BootStrapRecord* bsr,
+                             uint32_t* file,
+                             uint32_t* block)
+{
+  uint64_t bsr_addr = GetBsrStartAddr(bsr, file, block);
+  if (!bsr) { return bsr_addr; }
+
+  if (std::shared_ptr index = GetVolumeIndex(dev)) {
+    uint64_t indexed_addr
+        = GetIndexedStartAddr(jcr->sd_impl->read_session.bsr, dev, *index);
+    if (indexed_addr > bsr_addr) {
+      Dmsg2(100, "Volume index moves start from %" PRIu64 " to %" PRIu64 "\n",
+            bsr_addr, indexed_addr);
+      bsr_addr = indexed_addr;
+      *file = static_cast<uint32_t>(bsr_addr >> 32);
+      *block = static_cast<uint32_t>(bsr_addr);
+    }
+  }
+  return bsr_addr;
+}
+
 // Position to the first file on this volume
 BootStrapRecord* PositionDeviceToFirstFile(JobControlRecord* jcr,
                                            DeviceControlRecord* dcr)
@@ -303,7 +332,7 @@ BootStrapRecord* PositionDeviceToFirstFile(JobControlRecord* jcr,
   if (jcr->sd_impl->read_session.bsr) {
     jcr->sd_impl->read_session.bsr->Reposition = true;
     bsr = find_next_bsr(jcr->sd_impl->read_session.bsr, dev);
-    if (GetBsrStartAddr(bsr, &file, &block) > 0) {
+    if (GetStartAddr(jcr, dev, bsr, &file, &block) > 0) {
       Jmsg(jcr, M_INFO, 0,
            T_("Forward spacing Volume \"%s\" to file:block %u:%u.\n"),
            dev->VolHdr.VolumeName, file, block);
@@ -347,7 +376,7 @@ bool TryDeviceRepositioning(JobControlRecord* jcr,
     uint32_t block, file;
     /* TODO: use dev->file_addr ? */
     uint64_t dev_addr = (((uint64_t)dev->file) << 32) | dev->block_num;
-    uint64_t bsr_addr = GetBsrStartAddr(bsr, &file, &block);
+    uint64_t bsr_addr = GetStartAddr(jcr, dev, bsr, &file, &block);
 
     if (dev_addr > bsr_addr) { return false; }
     Dmsg4(500, "Try_Reposition from (file:block) %u:%u to %u:%u\n", dev->file,
@@ -42,6 +42,8 @@
 #include "stored/io_direction.h"
 #include "stored/volume_catalog_info.h"
 
+#include <vector>
+
 namespace storagedaemon {
 
 #define CHECK_BLOCK_NUMBERS true
@@ -81,6 +83,8 @@ class DeviceControlRecord {
   Device* dev{};          /**< Pointer to device */
   DeviceResource* device_resource{};    /**< Pointer to device resource */
   DeviceBlock* block{};            /**< Pointer to current block */
+  std::vector<DeviceBlock*> extent_blocks{}; /**< Full blocks kept back (Job Extent Blocks) */
+  std::vector<DeviceBlock*> spare_blocks{};  /**< Unused blocks for the extent */
   DeviceRecord* rec{};             /**< Pointer to record being processed */
   DeviceRecord* before_rec{};      /**< Pointer to record before translation */
   DeviceRecord* after_rec{};       /**< Pointer to record after translation */
@@ -197,6 +201,7 @@ class DeviceControlRecord {
   // Methods in block.c
   bool WriteBlockToDevice();
   bool WriteBlockToDev();
+  bool FlushBlocks();
 
   enum ReadStatus
   {
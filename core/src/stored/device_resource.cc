@@ -80,6 +80,7 @@ DeviceResource::DeviceResource(const DeviceResource& other)
   max_block_size = other.max_block_size;
   max_network_buffer_size = other.max_network_buffer_size;
   max_concurrent_jobs = other.max_concurrent_jobs;
+  job_extent_blocks = other.job_extent_blocks;
   autodeflate_algorithm = other.autodeflate_algorithm;
   autodeflate_level = other.autodeflate_level;
   autodeflate = other.autodeflate;
@@ -134,6 +135,7 @@ DeviceResource& DeviceResource::operator=(const DeviceResource& rhs)
   max_block_size = rhs.max_block_size;
   max_network_buffer_size = rhs.max_network_buffer_size;
   max_concurrent_jobs = rhs.max_concurrent_jobs;
+  job_extent_blocks = rhs.job_extent_blocks;
   autodeflate_algorithm = rhs.autodeflate_algorithm;
   autodeflate_level = rhs.autodeflate_level;
   autodeflate = rhs.autodeflate;
@@ -70,6 +70,7 @@ class DeviceResource : public BareosResource {
   uint32_t max_block_size{1024 * 1024}; /**< Current Maximum block size */
   uint32_t max_network_buffer_size{0};  /**< Max network buf size */
   uint32_t max_concurrent_jobs{0};   /**< Maximum concurrent jobs this drive */
+  uint32_t job_extent_blocks{0};     /**< Blocks a job writes in a row */
   uint32_t autodeflate_algorithm{0}; /**< Compression algorithm to use for
                                      compression */
   uint16_t autodeflate_level{6}; /**< Compression level to use for compression
@@ -41,6 +41,7 @@
 
 #include "include/bareos.h"
 #include "stored/append.h"
+#include "stored/bandwidth.h"
 #include "stored/stored.h"
 #include "stored/acquire.h"
 #include "stored/authenticate.h"
@@ -85,6 +86,9 @@ extern void terminate_child();
 namespace {
 /* Commands received from director that need scanning */
 inline constexpr const char setbandwidth[] = "setbandwidth=%lld Job=%127s";
+inline constexpr const char setsharedbandwidth[] = "setbandwidth=%lld Shared";
+inline constexpr const char setinterfacebandwidth[]
+    = "setbandwidth=%lld Shared Interface=%127s";
 inline constexpr const char setdebugv0cmd[] = "setdebug=%d trace=%d";
 inline constexpr const char setdebugv1cmd[]
     = "setdebug=%d trace=%d timestamp=%d";
@@ -355,6 +359,19 @@ static bool SetbandwidthCmd(JobControlRecord* jcr)
   char Job[MAX_NAME_LENGTH];
 
   *Job = 0;
+  // limits shared by all jobs
+  char address[MAX_NAME_LENGTH];
+  *address = 0;
+  if (bsscanf(dir->msg, setinterfacebandwidth, &bw, address) == 2
+      || bsscanf(dir->msg, setsharedbandwidth, &bw) == 1) {
+    if (!SetSharedBandwidth(bw, address)) {
+      PmStrcpy(jcr->errmsg, dir->msg);
+      dir->fsend(T_("2991 Bad setbandwidth command: %s\n"), jcr->errmsg);
+      return false;
+    }
+    return dir->fsend(OKBandwidth);
+  }
+
   if (bsscanf(dir->msg, setbandwidth, &bw, Job) != 2 || bw < 0) {
     PmStrcpy(jcr->errmsg, dir->msg);
     dir->fsend(T_("2991 Bad setbandwidth command: %s\n"), jcr->errmsg);
@@ -1627,6 +1644,9 @@ static bool ReplicateCmd(JobControlRecord* jcr)
   }
 
   SetStorageAuthKeyAndTlsPolicy(jcr, sd_auth_key.c_str(), tls_policy);
+  jcr->sd_impl->replication_target.address = stored_addr;
+  jcr->sd_impl->replication_target.port = stored_port;
+  jcr->sd_impl->replication_target.job = JobName;
 
   Dmsg3(110, "Open storage: %s:%d ssl=%u\n", stored_addr, stored_port,
         tls_policy);
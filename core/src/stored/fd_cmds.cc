@@ -36,6 +36,8 @@
 #include "stored/stored.h"
 #include "stored/append.h"
 #include "stored/authenticate.h"
+#include "stored/chunk_index.h"
+#include "stored/data_connections.h"
 #include "stored/device_control_record.h"
 #include "stored/fd_cmds.h"
 #include "stored/stored_jcr_impl.h"
@@ -82,6 +84,10 @@ namespace {
 /* Commands from the File daemon that require additional scanning */
 inline constexpr const char read_open[]
     = "read open session = %127s %ld %ld %ld %ld %ld %ld\n";
+inline constexpr const char append_open_streams[]
+    = "append open session streams=%u";
+inline constexpr const char append_data_streams[]
+    = "append data %u streams=%u";
 
 /* Responses sent to the File daemon */
 inline constexpr const char NO_open[] = "3901 Error session already open\n";
@@ -89,6 +95,10 @@ inline constexpr const char NOT_opened[] = "3902 Error session not opened\n";
 inline constexpr const char OK_end[] = "3000 OK end\n";
 inline constexpr const char OK_close[] = "3000 OK close Status = %d\n";
 inline constexpr const char OK_open[] = "3000 OK open ticket = %" PRIu32 "\n";
+inline constexpr const char OK_open_dedup[]
+    = "3000 OK open ticket = %" PRIu32 " dedup chunksize = %" PRIu32 "\n";
+inline constexpr const char OK_open_streams[]
+    = "3000 OK open ticket = %" PRIu32 " streams = %" PRIu32 "\n";
 inline constexpr const char ERROR_append[] = "3903 Error append data\n";
 
 /* Responses sent to the Director */
@@ -260,7 +270,11 @@ static bool AppendDataCmd(JobControlRecord* jcr)
   if (jcr->sd_impl->session_opened) {
     Dmsg1(110, "<filed: %s", fd->msg);
     jcr->setJobType(JT_BACKUP);
-    if (DoAppendData(jcr, fd, "FD")) {
+
+    uint32_t ticket = 0, streams = 0;
+    bsscanf(fd->msg, append_data_streams, &ticket, &streams);
+
+    if (DoAppendData(jcr, fd, "FD", streams)) {
       return true;
     } else {
       PmStrcpy(jcr->errmsg, T_("Append data error.\n"));
@@ -301,8 +315,30 @@ static bool AppendOpenSession(JobControlRecord* jcr)
 
   jcr->sd_impl->session_opened = true;
 
+  /* The File daemon offers to send its data as chunk manifests.  We can only
+   * accept that if the reserved device keeps an index of its chunks. */
+  ChunkIndex* index = nullptr;
+  if (strstr(fd->msg, " dedup") && jcr->sd_impl->dcr
+      && jcr->sd_impl->dcr->dev) {
+    index = jcr->sd_impl->dcr->dev->GetChunkIndex();
+  }
+  jcr->sd_impl->chunk_index = index;
+
+  // The File daemon offers to stripe its data over several connections.
+  uint32_t streams = 0;
+  if (!index && bsscanf(fd->msg, append_open_streams, &streams) == 1) {
+    streams = AcceptDataConnections(jcr, streams);
+  }
+
   /* Send "Ticket" to File Daemon */
-  fd->fsend(OK_open, jcr->VolSessionId);
+  if (index) {
+    fd->fsend(OK_open_dedup, jcr->VolSessionId,
+              static_cast<uint32_t>(index->ChunkSize()));
+  } else if (streams > 0) {
+    fd->fsend(OK_open_streams, jcr->VolSessionId, streams);
+  } else {
+    fd->fsend(OK_open, jcr->VolSessionId);
+  }
   Dmsg1(110, ">filed: %s", fd->msg);
 
   return true;
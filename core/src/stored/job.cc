@@ -30,6 +30,7 @@
 #include "stored/stored.h"
 #include "stored/bsr.h"
 #include "stored/acquire.h"
+#include "stored/data_connections.h"
 #include "stored/fd_cmds.h"
 #include "stored/stored_jcr_impl.h"
 #include "stored/ndmp_tape.h"
@@ -55,6 +56,8 @@ inline constexpr const char jobcmd[]
       "SpoolData=%d PreferMountedVols=%d SpoolSize=%127s "
       "rerunning=%d VolSessionId=%d VolSessionTime=%d Quota=%llu "
       "Protocol=%d BackupFormat=%127s\n";
+// Appended by newer Directors, used to share the bandwidth between jobs.
+inline constexpr const char jobpriority[] = " Priority=%d";
 
 /* Responses sent to Director daemon */
 inline constexpr const char OK_job[]
@@ -108,6 +111,9 @@ bool job_cmd(JobControlRecord* jcr)
 
   jcr->rerunning = (rerunning) ? true : false;
   jcr->setJobProtocol(protocol);
+  if (const char* priority = strstr(dir->msg, " Priority=")) {
+    bsscanf(priority, jobpriority, &jcr->JobPriority);
+  }
 
   Dmsg4(100,
         "rerunning=%d VolSesId=%" PRIu32 " VolSesTime=%" PRIu32
@@ -389,6 +395,8 @@ void StoredFreeJcr(JobControlRecord* jcr)
     jcr->file_bsock = NULL;
   }
 
+  CloseDataConnections(jcr);
+
   if (jcr->sd_impl->job_name) { FreePoolMemory(jcr->sd_impl->job_name); }
 
   if (jcr->client_name) {
@@ -33,6 +33,8 @@
 #include "stored/acquire.h"
 #include "stored/bsr.h"
 #include "stored/append.h"
+#include "stored/bandwidth.h"
+#include "stored/data_connections.h"
 #include "stored/device.h"
 #include "stored/device_control_record.h"
 #include "stored/stored_jcr_impl.h"
@@ -41,9 +43,11 @@
 #include "stored/read_record.h"
 #include "stored/sd_stats.h"
 #include "stored/spool.h"
+#include "stored/volume_prefetch.h"
 #include "lib/bget_msg.h"
 #include "lib/bnet.h"
 #include "lib/bsock.h"
+#include "lib/bsock_striped.h"
 #include "lib/edit.h"
 #include "include/jcr.h"
 
@@ -56,13 +60,19 @@ inline constexpr const char Job_end[]
 // Responses received from Storage Daemon
 inline constexpr const char OK_start_replicate[]
     = "3000 OK start replicate ticket = %ld\n";
+inline constexpr const char OK_start_replicate_streams[]
+    = "3000 OK start replicate ticket = %ld streams = %u\n";
 inline constexpr const char OK_replicate[] = "3000 OK replicate data\n";
 inline constexpr const char OK_end_replicate[] = "3000 OK end replicate\n";
 inline constexpr const char OK_data[] = "3000 OK data\n";
 
 // Commands sent to Storage Daemon
 inline constexpr const char start_replicate[] = "start replicate\n";
+inline constexpr const char start_replicate_streams[]
+    = "start replicate streams=%u\n";
 inline constexpr const char ReplicateData[] = "replicate data %" PRId32 "\n";
+inline constexpr const char ReplicateDataStreams[]
+    = "replicate data %" PRId32 " streams=%u\n";
 inline constexpr const char end_replicate[] = "end replicate\n";
 }  // namespace
 
@@ -447,6 +457,39 @@ static inline void CheckAutoXflation(JobControlRecord* jcr)
   }
 }
 
+static bool MountNextReadVolumeAndPrefetch(DeviceControlRecord* dcr)
+{
+  if (!MountNextReadVolume(dcr)) { return false; }
+
+  JobControlRecord* jcr = dcr->jcr;
+  if (jcr->sd_impl->prefetcher) {
+    jcr->sd_impl->prefetcher->Advance(jcr->sd_impl->CurReadVolume - 1);
+  }
+  return true;
+}
+
+/* Read all records of the source volumes, while the next volumes are read
+ * ahead in the background. */
+static bool ReadSourceRecords(JobControlRecord* jcr,
+                              bool RecordCb(DeviceControlRecord* dcr,
+                                            DeviceRecord* rec,
+                                            cb_data* data),
+                              cb_data* data)
+{
+  auto prefetcher = StartVolumePrefetch(jcr);
+  jcr->sd_impl->prefetcher = prefetcher.get();
+
+  bool ok = ReadRecords(jcr->sd_impl->read_dcr, RecordCb,
+                        MountNextReadVolumeAndPrefetch, data);
+
+  jcr->sd_impl->prefetcher = nullptr;
+  if (prefetcher) {
+    Dmsg1(100, "Requested read ahead of %" PRIu64 " bytes of the source "
+          "volumes\n", prefetcher->BytesRequested());
+  }
+  return ok;
+}
+
 // Read Data and commit to new job.
 bool DoMacRun(JobControlRecord* jcr)
 {
@@ -531,15 +574,26 @@ bool DoMacRun(JobControlRecord* jcr)
       ok = false;
       goto bail_out;
     }
+    ScheduleBandwidth(jcr, sd);
 
     // Let the remote SD know we are about to start the replication.
-    sd->fsend(start_replicate);
+    if (me->data_connections > 1) {
+      sd->fsend(start_replicate_streams, me->data_connections);
+    } else {
+      sd->fsend(start_replicate);
+    }
     Dmsg1(110, ">stored: %s", sd->msg);
 
     // Expect to receive back the Ticket number.
+    uint32_t streams = 0;
     if (BgetMsg(sd) >= 0) {
       Dmsg1(110, "<stored: %s", sd->msg);
-      if (bsscanf(sd->msg, OK_start_replicate, &jcr->sd_impl->Ticket) != 1) {
+      if (bsscanf(sd->msg, OK_start_replicate_streams, &jcr->sd_impl->Ticket,
+                  &streams)
+          == 2) {
+        streams = OpenReplicationDataConnections(jcr, streams);
+      } else if (bsscanf(sd->msg, OK_start_replicate, &jcr->sd_impl->Ticket)
+                 != 1) {
         Jmsg(jcr, M_FATAL, 0, T_("Bad response to start replicate: %s\n"),
              sd->msg);
         goto bail_out;
@@ -552,7 +606,11 @@ bool DoMacRun(JobControlRecord* jcr)
     }
 
     // Let the remote SD know we are now really going to send the data.
-    sd->fsend(ReplicateData, jcr->sd_impl->Ticket);
+    if (streams > 0) {
+      sd->fsend(ReplicateDataStreams, jcr->sd_impl->Ticket, streams);
+    } else {
+      sd->fsend(ReplicateData, jcr->sd_impl->Ticket);
+    }
     Dmsg1(110, ">stored: %s", sd->msg);
 
     // Expect to get response to the replicate data cmd from Storage daemon
@@ -561,6 +619,19 @@ bool DoMacRun(JobControlRecord* jcr)
       goto bail_out;
     }
 
+    // Stripe the data over the data connections, if we could open any.
+    std::optional<StripedSender> striped_sender;
+    if (streams > 0) {
+      auto stripes = jcr->sd_impl->data_connections.lock()->sockets;
+      for (auto* stripe : stripes) {
+        stripe->SetBufferSize(me->max_network_buffer_size, BNET_SETBUF_WRITE);
+      }
+      striped_sender.emplace(sd, std::move(stripes));
+      sd->SetStripedSender(&striped_sender.value());
+      Jmsg(jcr, M_INFO, 0, T_("Striping data over %u connections.\n"),
+           streams);
+    }
+
     // Update the initial Job Statistics.
     now = (utime_t)time(NULL);
     UpdateJobStatistics(jcr, now);
@@ -573,12 +644,14 @@ bool DoMacRun(JobControlRecord* jcr)
 
     cb_data data{};
     // Read all data and send it to remote SD.
-    ok = ReadRecords(jcr->sd_impl->read_dcr, CloneRecordToRemoteSd,
-                     MountNextReadVolume, &data);
+    ok = ReadSourceRecords(jcr, CloneRecordToRemoteSd, &data);
 
     /* Send the last EOD to close the last data transfer and a next EOD to
      * signal the remote we are done. */
-    if (!sd->signal(BNET_EOD) || !sd->signal(BNET_EOD)) {
+    bool sent_eod = sd->signal(BNET_EOD) && sd->signal(BNET_EOD);
+    sd->SetStripedSender(nullptr);
+    CloseDataConnections(jcr);
+    if (!sent_eod) {
       if (!jcr->IsJobCanceled()) {
         Jmsg1(jcr, M_FATAL, 0, T_("Network send error to SD. ERR=%s\n"),
               sd->bstrerror());
@@ -670,8 +743,7 @@ bool DoMacRun(JobControlRecord* jcr)
 
     cb_data data{};
     // Read all data and make a local clone of it.
-    ok = ReadRecords(jcr->sd_impl->read_dcr, CloneRecordInternally,
-                     MountNextReadVolume, &data);
+    ok = ReadSourceRecords(jcr, CloneRecordInternally, &data);
   }
 
 bail_out:
@@ -709,7 +781,8 @@ bail_out:
         jcr->setJobStatusWithPriorityCheck(currentJobStatus);
       }
       // Flush out final partial block of this session
-      if (!jcr->sd_impl->dcr->WriteBlockToDevice()) {
+      if (!jcr->sd_impl->dcr->WriteBlockToDevice()
+          || !jcr->sd_impl->dcr->FlushBlocks()) {
         Jmsg2(jcr, M_FATAL, 0, T_("Fatal append error on device %s: ERR=%s\n"),
               dev->print_name(), dev->bstrerror());
         Dmsg0(100, T_("Set ok=FALSE after WriteBlockToDevice.\n"));
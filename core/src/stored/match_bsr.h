@@ -23,6 +23,8 @@
 
 namespace storagedaemon {
 
+class VolumeIndex;
+
 int MatchBsr(BootStrapRecord* bsr,
              DeviceRecord* rec,
              Volume_Label* volrec,
@@ -34,6 +36,9 @@ bool IsThisBsrDone(BootStrapRecord* bsr, DeviceRecord* rec);
 uint64_t GetBsrStartAddr(BootStrapRecord* bsr,
                          uint32_t* file = NULL,
                          uint32_t* block = NULL);
+uint64_t GetIndexedStartAddr(BootStrapRecord* root_bsr,
+                             Device* dev,
+                             const VolumeIndex& index);
 
 } /* namespace storagedaemon */
 
@@ -33,6 +33,7 @@
 #include "stored/device_control_record.h"
 #include "stored/stored_jcr_impl.h"
 #include "stored/label.h"
+#include "stored/volume_index.h"
 #include "lib/edit.h"
 #include "include/jcr.h"
 #include "lib/bsock.h"
@@ -328,6 +329,7 @@ read_volume:
       Dmsg0(100, "goto mount_next_vol\n");
       goto mount_next_vol;
     }
+    AttachVolumeIndex(dev, VolumeName);
 
     dev->VolCatInfo.VolCatMounts++; /* Update mounts */
     Dmsg1(150, "update volinfo mounts=%" PRIu32 "\n",
@@ -29,6 +29,7 @@
 #include "include/bareos.h"
 #include "stored/stored.h"
 #include "stored/acquire.h"
+#include "stored/bandwidth.h"
 #include "stored/bsr.h"
 #include "stored/device_control_record.h"
 #include "stored/stored_jcr_impl.h"
@@ -64,6 +65,7 @@ bool DoReadData(JobControlRecord* jcr)
   if (!BnetSetBufferSize(fd, me->max_network_buffer_size, BNET_SETBUF_WRITE)) {
     return false;
   }
+  ScheduleBandwidth(jcr, fd);
 
   if (jcr->sd_impl->NumReadVolumes == 0) {
     Jmsg(jcr, M_FATAL, 0, T_("No Volume names found for restore.\n"));
@@ -36,6 +36,7 @@
 #include "stored/stored_globals.h"
 #include "stored/append.h"
 #include "stored/authenticate.h"
+#include "stored/data_connections.h"
 #include "stored/stored_jcr_impl.h"
 #include "stored/sd_stats.h"
 #include "stored/sd_stats.h"
@@ -81,6 +82,14 @@ inline constexpr const char ERROR_replicate[] = "3903 Error replicate data\n";
 inline constexpr const char OK_end_replicate[] = "3000 OK end replicate\n";
 inline constexpr const char OK_start_replicate[]
     = "3000 OK start replicate ticket = %" PRIu32 "\n";
+inline constexpr const char OK_start_replicate_streams[]
+    = "3000 OK start replicate ticket = %" PRIu32 " streams = %" PRIu32 "\n";
+
+// Commands from the Remote Storage daemon that require additional scanning
+inline constexpr const char start_replicate_streams[]
+    = "start replicate streams=%u";
+inline constexpr const char replicate_data_streams[]
+    = "replicate data %u streams=%u";
 
 // Responses sent to the Director
 inline constexpr const char Job_start[] = "3010 Job %s start\n";
@@ -286,8 +295,18 @@ static bool StartReplicationSession(JobControlRecord* jcr)
 
   jcr->sd_impl->session_opened = true;
 
+  // The Storage daemon offers to stripe its data over several connections.
+  uint32_t streams = 0;
+  if (bsscanf(sd->msg, start_replicate_streams, &streams) == 1) {
+    streams = AcceptDataConnections(jcr, streams);
+  }
+
   // Send "Ticket" to Storage Daemon
-  sd->fsend(OK_start_replicate, jcr->VolSessionId);
+  if (streams > 0) {
+    sd->fsend(OK_start_replicate_streams, jcr->VolSessionId, streams);
+  } else {
+    sd->fsend(OK_start_replicate, jcr->VolSessionId);
+  }
   Dmsg1(110, ">stored: %s", sd->msg);
 
   return true;
@@ -311,7 +330,11 @@ static bool ReplicateData(JobControlRecord* jcr)
     UpdateJobStatistics(jcr, now);
 
     Dmsg1(110, "<stored: %s", sd->msg);
-    if (DoAppendData(jcr, sd, "SD")) {
+
+    uint32_t ticket = 0, streams = 0;
+    bsscanf(sd->msg, replicate_data_streams, &ticket, &streams);
+
+    if (DoAppendData(jcr, sd, "SD", streams)) {
       return true;
     } else {
       PmStrcpy(jcr->errmsg, T_("Replicate data error.\n"));
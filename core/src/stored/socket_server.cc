@@ -35,6 +35,7 @@
 #include "stored/autochanger.h"
 #include "stored/stored.h"
 #include "stored/stored_globals.h"
+#include "stored/data_connections.h"
 #include "stored/dir_cmd.h"
 #include "stored/fd_cmds.h"
 #include "stored/sd_cmds.h"
@@ -109,11 +110,39 @@ void* HandleConnectionRequest(ConfigurationParser* config, void* arg)
   unsigned major = 0;
   unsigned minor = 0;
   unsigned patch = 0;
+  uint32_t index = 0;
+
+  /* Data connections have to be checked first, their hellos start just like
+   * the ones of the main connections. */
+  const bool fd_data_connection
+      = bsscanf(bs->msg, "Hello Start Job %127s DataConnection=%u", name,
+                &index)
+        == 2;
+  const bool sd_data_connection
+      = !fd_data_connection
+        && bsscanf(bs->msg, "Hello Start Storage Job %127s DataConnection=%u",
+                   name, &index)
+               == 2;
+
+  if (fd_data_connection || sd_data_connection) {
+    Dmsg1(110, "Got a data connection at %s\n",
+          bstrftimes(tbuf, sizeof(tbuf), (utime_t)time(NULL)));
+
+    if (std::optional error = tls_secret_provider.check_job_name(name)) {
+      Emsg2(M_ERROR, 0, "Invalid connection from %s: ERR=%s\n", bs->who(),
+            error->c_str());
+      Bmicrosleep(5, 0); /* make user wait 5 seconds */
+      bs->signal(BNET_TERMINATE);
+      bs->close();
+      delete bs;
+      return NULL;
+    }
 
-  if (bsscanf(bs->msg, "Hello Start Job %127s Version=\"%u.%u.%u\"", name,
-              &major, &minor, &patch)
-          == 4
-      || bsscanf(bs->msg, "Hello Start Job %127s", name) == 1) {
+    return HandleDataConnection(bs, name, index, sd_data_connection);
+  } else if (bsscanf(bs->msg, "Hello Start Job %127s Version=\"%u.%u.%u\"",
+                     name, &major, &minor, &patch)
+                 == 4
+             || bsscanf(bs->msg, "Hello Start Job %127s", name) == 1) {
     bs->remote_version = VERSION_HEX(major, minor, patch);
     Dmsg1(110, "Got a FD connection at %s\n",
           bstrftimes(tbuf, sizeof(tbuf), (utime_t)time(NULL)));
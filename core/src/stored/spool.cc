@@ -37,6 +37,7 @@
 #include "lib/berrno.h"
 #include "lib/bsock.h"
 #include "lib/edit.h"
+#include "lib/metrics.h"
 #include "lib/status_packet.h"
 #include "lib/util.h"
 #include "include/jcr.h"
@@ -116,6 +117,33 @@ void ListSpoolStats(StatusPacket* sp)
   }
 }
 
+void RegisterSpoolMetrics()
+{
+  metrics::Global().AddCollector([](metrics::Writer& writer) {
+    lock_mutex(mutex);
+    spool_stats_t stats = spool_stats;
+    unlock_mutex(mutex);
+
+    writer.Family("bareos_spool_jobs", "gauge", "Jobs currently spooling");
+    writer.Sample("bareos_spool_jobs", {{"kind", "data"}},
+                  std::uint64_t{stats.data_jobs});
+    writer.Sample("bareos_spool_jobs", {{"kind", "attr"}},
+                  std::uint64_t{stats.attr_jobs});
+    writer.Family("bareos_spool_bytes", "gauge",
+                  "Bytes currently held in spool files");
+    writer.Sample("bareos_spool_bytes", {{"kind", "data"}},
+                  std::int64_t{stats.data_size});
+    writer.Sample("bareos_spool_bytes", {{"kind", "attr"}},
+                  std::int64_t{stats.attr_size});
+    writer.Family("bareos_spool_max_bytes", "gauge",
+                  "Largest spool size of a single job so far");
+    writer.Sample("bareos_spool_max_bytes", {{"kind", "data"}},
+                  std::int64_t{stats.max_data_size});
+    writer.Sample("bareos_spool_max_bytes", {{"kind", "attr"}},
+                  std::int64_t{stats.max_attr_size});
+  });
+}
+
 bool BeginDataSpool(DeviceControlRecord* dcr)
 {
   bool status = true;
@@ -34,6 +34,7 @@ bool DiscardAttributeSpool(JobControlRecord* jcr);
 bool CommitAttributeSpool(JobControlRecord* jcr);
 bool WriteBlockToSpoolFile(DeviceControlRecord* dcr);
 void ListSpoolStats(StatusPacket* sp);
+void RegisterSpoolMetrics();
 
 } /* namespace storagedaemon */
 
@@ -34,6 +34,7 @@
 #include "stored/stored_jcr_impl.h"
 #include "stored/spool.h"
 #include "stored/status.h"
+#include "lib/bandwidth_scheduler.h"
 #include "lib/status_packet.h"
 #include "lib/edit.h"
 #include "include/jcr.h"
@@ -60,6 +61,7 @@ static void ListTerminatedJobs(StatusPacket* sp);
 static void ListRunningJobs(StatusPacket* sp);
 static void ListJobsWaitingOnReservation(StatusPacket* sp);
 static void ListStatusHeader(StatusPacket* sp);
+static void ListBandwidth(StatusPacket* sp);
 static void ListDevices(JobControlRecord* jcr,
                         StatusPacket* sp,
                         const char* devicenames);
@@ -97,6 +99,12 @@ static void OutputStatus(JobControlRecord* jcr,
     len = PmStrcpy(msg, "====\n\n");
     sp->send(msg, len);
   }
+
+  ListBandwidth(sp);
+  if (!sp->api) {
+    len = PmStrcpy(msg, "====\n\n");
+    sp->send(msg, len);
+  }
 }
 
 static bool NeedToListDevice(const char* devicenames, const char* devicename)
@@ -632,6 +640,51 @@ static void SendDeviceStatus(Device* dev, StatusPacket* sp)
   sp->send(msg, len);
 }
 
+static void SendBandwidthStatistics(StatusPacket* sp,
+                                    const char* name,
+                                    const BandwidthScheduler::statistics& stats)
+{
+  PoolMem msg(PM_MESSAGE);
+  int len;
+  char b1[50], b2[50], b3[50], b4[50];
+
+  if (stats.rate) {
+    len = Mmsg(msg,
+               T_(" %s: limit=%skB/s current=%skB/s utilization=%" PRIu64
+                  "%% flows=%" PRIuz " bytes=%s waited=%ss\n"),
+               name, edit_uint64_with_commas(stats.rate / 1024, b1),
+               edit_uint64_with_commas(stats.throughput / 1024, b2),
+               stats.throughput * 100 / stats.rate, stats.flows,
+               edit_uint64_with_commas(stats.bytes, b3),
+               edit_uint64_with_commas(stats.waited_ms / 1000, b4));
+  } else {
+    len = Mmsg(msg,
+               T_(" %s: limit=none current=%skB/s flows=%" PRIuz
+                  " bytes=%s\n"),
+               name, edit_uint64_with_commas(stats.throughput / 1024, b1),
+               stats.flows, edit_uint64_with_commas(stats.bytes, b2));
+  }
+  sp->send(msg, len);
+}
+
+// Usage of the bandwidth shared by all jobs, see stored/bandwidth.h
+static void ListBandwidth(StatusPacket* sp)
+{
+  PoolMem msg(PM_MESSAGE);
+  int len;
+
+  if (!sp->api) {
+    len = Mmsg(msg, T_("Bandwidth:\n"));
+    sp->send(msg, len);
+  }
+
+  SendBandwidthStatistics(sp, T_("Daemon"),
+                          DaemonBandwidthScheduler().Statistics());
+  for (auto& [address, stats] : InterfaceBandwidthStatistics()) {
+    SendBandwidthStatistics(sp, address.c_str(), stats);
+  }
+}
+
 static void ListRunningJobs(StatusPacket* sp)
 {
   JobControlRecord* jcr;
@@ -987,6 +1040,9 @@ bool DotstatusCmd(JobControlRecord* jcr)
   } else if (Bstrcasecmp(cmd.c_str(), "spooling")) {
     sp.api = true;
     ListSpoolStats(&sp);
+  } else if (Bstrcasecmp(cmd.c_str(), "bandwidth")) {
+    sp.api = true;
+    ListBandwidth(&sp);
   } else if (Bstrcasecmp(cmd.c_str(), "terminated")) {
     sp.api = true;
     ListTerminatedJobs(&sp);
@@ -37,6 +37,7 @@
 #include "lib/crypto_cache.h"
 #include "stored/acquire.h"
 #include "stored/autochanger.h"
+#include "stored/bandwidth.h"
 #include "stored/bsr.h"
 #include "stored/device.h"
 #include "stored/stored_jcr_impl.h"
@@ -46,6 +47,7 @@
 #include "stored/sd_backends.h"
 #include "stored/sd_device_control_record.h"
 #include "stored/sd_stats.h"
+#include "stored/spool.h"
 #include "stored/socket_server.h"
 #include "stored/stored_globals.h"
 #include "stored/wait.h"
@@ -54,6 +56,7 @@
 #include "lib/bnet_network_dump.h"
 #include "lib/cli.h"
 #include "lib/daemon.h"
+#include "lib/metrics_server.h"
 #include "lib/bsignal.h"
 #include "lib/parse_conf.h"
 #include "lib/thread_specific_data.h"
@@ -309,6 +312,11 @@ int main(int argc, char* argv[])
   if (me->ndmp_enable) { StartNdmpThreadServer(me->NDMPaddrs); }
 #endif
 
+  if (me->metrics_enable) {
+    RegisterSpoolMetrics();
+    StartMetricsServer(me->metrics_addrs);
+  }
+
   // Single server used for Director/Storage and File daemon
   StartSocketServer(me->SDaddrs);
 
@@ -375,6 +383,7 @@ static int CheckResources()
   }
 
   if (OK) { OK = InitAutochangers(); }
+  if (OK) { OK = ConfigureBandwidthSchedulers(); }
 
   if (OK) {
     CloseMsg(nullptr);              /* close temp message handler */
@@ -580,6 +589,7 @@ static
 #if HAVE_NDMP
   if (me->ndmp_enable) { StopNdmpThreadServer(); }
 #endif
+  if (me->metrics_enable) { StopMetricsServer(); }
   StopSocketServer();
 
   StopWatchdog();
@@ -31,6 +31,7 @@
 
 #include "stored/stored_conf.h"
 #include "stored/autochanger_resource.h"
+#include "stored/changer_inventory.h"
 #include "stored/device_resource.h"
 #include "stored/stored.h"
 #include "stored/stored_globals.h"
@@ -100,6 +101,8 @@ static const ResourceItem store_items[] = {
   { "ClientConnectWait", CFG_TYPE_TIME, ITEM(res_store, client_wait), {config::DefaultValue{"1800"}}},
   { "VerId", CFG_TYPE_STR, ITEM(res_store, verid), {}},
   { "MaximumBandwidthPerJob", CFG_TYPE_SPEED, ITEM(res_store, max_bandwidth_per_job), {}},
+  { "MaximumBandwidth", CFG_TYPE_SPEED, ITEM(res_store, max_bandwidth), {config::IntroducedIn{26, 0, 0}, config::Description{"Bandwidth all data connections of this Storage Daemon share.  Running jobs get a share of it proportional to their priority."}}},
+  { "MaximumInterfaceBandwidth", CFG_TYPE_STR_VECTOR, ITEM(res_store, max_interface_bandwidth), {config::IntroducedIn{26, 0, 0}, config::Description{"Bandwidth the data connections on one local address share, given as \"<address> <speed>\".  Can be given multiple times."}}},
   { "AllowBandwidthBursting", CFG_TYPE_BOOL, ITEM(res_store, allow_bw_bursting), {config::DefaultValue{"false"}}},
   { "NdmpEnable", CFG_TYPE_BOOL, ITEM(res_store, ndmp_enable), {config::DefaultValue{"false"}}},
   { "NdmpSnooping", CFG_TYPE_BOOL, ITEM(res_store, ndmp_snooping), {config::DefaultValue{"false"}}},
@@ -107,6 +110,10 @@ static const ResourceItem store_items[] = {
   { "NdmpAddress", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_store, NDMPaddrs), {config::DefaultValue{"10000"}}},
   { "NdmpAddresses", CFG_TYPE_ADDRESSES, ITEM(res_store, NDMPaddrs), {config::DefaultValue{"10000"}}},
   { "NdmpPort", CFG_TYPE_ADDRESSES_PORT, ITEM(res_store, NDMPaddrs), {config::DefaultValue{"10000"}}},
+  { "MetricsEnable", CFG_TYPE_BOOL, ITEM(res_store, metrics_enable), {config::DefaultValue{"false"}, config::IntroducedIn{26, 0, 0}, config::Description{"Serve metrics in the OpenMetrics text format via HTTP on the metrics addresses."}}},
+  { "MetricsAddress", CFG_TYPE_ADDRESSES_ADDRESS, ITEM(res_store, metrics_addrs), {config::DefaultValue{"9123"}, config::IntroducedIn{26, 0, 0}}},
+  { "MetricsAddresses", CFG_TYPE_ADDRESSES, ITEM(res_store, metrics_addrs), {config::DefaultValue{"9123"}, config::IntroducedIn{26, 0, 0}}},
+  { "MetricsPort", CFG_TYPE_ADDRESSES_PORT, ITEM(res_store, metrics_addrs), {config::DefaultValue{"9123"}, config::IntroducedIn{26, 0, 0}}},
   { "AutoXFlateOnReplication", CFG_TYPE_BOOL, ITEM(res_store, autoxflateonreplication), {config::IntroducedIn{13, 4, 0}, config::DefaultValue{"false"}}},
   { "AbsoluteJobTimeout", CFG_TYPE_PINT32, ITEM(res_store, jcr_watchdog_time), {config::IntroducedIn{14, 2, 0}, config::Description{"Absolute time after which a Job gets terminated regardless of its progress"}}},
   { "CollectDeviceStatistics", CFG_TYPE_BOOL, ITEM(res_store, collect_dev_stats), {config::DeprecatedSince{22, 0, 0}, config::DefaultValue{"false"}}},
@@ -117,6 +124,11 @@ static const ResourceItem store_items[] = {
   { "SecureEraseCommand", CFG_TYPE_STR, ITEM(res_store, secure_erase_cmdline), {config::IntroducedIn{15, 2, 1}, config::Description{"Specify command that will be called when bareos unlinks files."}}},
   { "LogTimestampFormat", CFG_TYPE_STR, ITEM(res_store, log_timestamp_format), {config::IntroducedIn{15, 2, 3}, config::DefaultValue{"%d-%b %H:%M"}}},
   { "EnableKtls", CFG_TYPE_BOOL, ITEM(res_store, enable_ktls), {config::DefaultValue{"false"}, config::Description{"If set to \"yes\", Bareos will allow the SSL implementation to use Kernel TLS."}, config::IntroducedIn{23, 0, 0}}},
+  { "MaximumDataConnections", CFG_TYPE_PINT32, ITEM(res_store, max_data_connections), {config::DefaultValue{"8"}, config::Description{"Maximum number of network connections a File Daemon or a replicating Storage Daemon may stripe the data of one job over.  Set to 1 to not allow striping."}, config::IntroducedIn{26, 0, 0}}},
+  { "DataConnections", CFG_TYPE_PINT32, ITEM(res_store, data_connections), {config::DefaultValue{"1"}, config::Description{"Number of network connections the data of a replication job is striped over when sending it to another Storage Daemon."}, config::IntroducedIn{26, 0, 0}}},
+  { "ReadAheadVolumes", CFG_TYPE_PINT32, ITEM(res_store, read_ahead_volumes), {config::DefaultValue{"0"}, config::Description{"Number of upcoming source volumes of a copy, migration or virtual full job for which the kernel is asked to read ahead (posix_fadvise WILLNEED) into the page cache while the job reads the current one, so that volumes on different disks are read in parallel.  This only helps if the page cache can hold the read ahead data.  0 disables the read ahead."}, config::IntroducedIn{26, 0, 0}}},
+  { "ReadAheadSize", CFG_TYPE_SIZE64, ITEM(res_store, read_ahead_size), {config::DefaultValue{"1g"}, config::Description{"Maximum amount of data of each source volume that is requested to be read ahead."}, config::IntroducedIn{26, 0, 0}}},
+  { "PipelineTraceDirectory", CFG_TYPE_STDSTRDIR, ITEM(res_store, pipeline_trace_directory), {config::Description{"If set, every job that writes data records the timing of its network receives and device writes and writes it as Chrome trace event file <Job>-sd.trace.json into this directory."}, config::IntroducedIn{26, 0, 0}}},
     TLS_COMMON_CONFIG(res_store),
     TLS_CERT_CONFIG(res_store),
   {}
@@ -191,6 +203,7 @@ static const ResourceItem dev_items[] = {
   { "MaximumFileSize", CFG_TYPE_SIZE64, ITEM(res_dev, max_file_size), {config::DefaultValue{"1000000000"}}},
   { "VolumeCapacity", CFG_TYPE_SIZE64, ITEM(res_dev, volume_capacity), {}},
   { "MaximumConcurrentJobs", CFG_TYPE_PINT32, ITEM(res_dev, max_concurrent_jobs), {config::DefaultValue{"1"}}},
+  { "JobExtentBlocks", CFG_TYPE_PINT32, ITEM(res_dev, job_extent_blocks), {config::DefaultValue{"0"}, config::IntroducedIn{26, 0, 0}, config::Description{"Number of blocks each job writes in a row on disk and object storage devices.  Concurrent jobs then occupy contiguous extents of the volume instead of interleaving block by block.  Every extent that does not directly follow the previous one of the job starts a new JobMedia record, so restoring or copying a single job skips the extents of the other jobs.  Every job keeps up to this many blocks in memory.  0 or 1 writes every block right away."}}},
   { "SpoolDirectory", CFG_TYPE_DIR, ITEM(res_dev, spool_directory), {}},
   { "MaximumSpoolSize", CFG_TYPE_SIZE64, ITEM(res_dev, max_spool_size), {}},
   { "MaximumJobSpoolSize", CFG_TYPE_SIZE64, ITEM(res_dev, max_job_spool_size), {}},
@@ -219,6 +232,8 @@ static const ResourceItem autochanger_items[] = {
   { "Device", CFG_TYPE_ALIST_RES, ITEM(res_changer, device_resources), {config::Required{}, config::Code{R_DEVICE}}},
   { "ChangerDevice", CFG_TYPE_STRNAME, ITEM(res_changer, changer_name), {config::Required{}}},
   { "ChangerCommand", CFG_TYPE_STRNAME, ITEM(res_changer, changer_command), {config::Required{}}},
+  { "InventoryCache", CFG_TYPE_BOOL, ITEM(res_changer, inventory_cache), {config::DefaultValue{"No"}, config::IntroducedIn{26, 0, 0}, config::Description{"Keep track of the cartridges loaded in the drives of this autochanger in memory.  Unknown drives are queried all at once with the \"listall\" changer command instead of one \"loaded\" command per drive.  If the changer command gives no usable \"listall\" output, drives are queried one by one again."}}},
+  { "ConcurrentMoves", CFG_TYPE_BOOL, ITEM(res_changer, concurrent_moves), {config::DefaultValue{"No"}, config::IntroducedIn{26, 0, 0}, config::Description{"Do not hold the autochanger lock while a cartridge is loaded into or unloaded from a drive, so that loads of different drives can overlap.  Only enable this if the changer command can run several times in parallel."}}},
   {}
 };
 
@@ -492,10 +507,8 @@ static void MultiplyDevice(DeviceResource& original,
   // device and the implicit autochanger have the same name, both will be used
   // if specified in a Director -> Storage resource. However, we only want the
   // implicit autochanger to be used so we give the device a different name.
-  char* prefixed_resource_name
-      = strdup(("$" + std::string{original.resource_name_}).c_str());
-  free(original.resource_name_);
-  original.resource_name_ = prefixed_resource_name;
+  config.RenameResource(R_DEVICE, &original,
+                        ("$" + std::string{original.resource_name_}).c_str());
 }
 
 static void MultiplyConfiguredDevices(ConfigurationParser& config)
@@ -789,6 +802,7 @@ static bool SaveResource(int type, const ResourceItem* items, int pass)
           p->plugin_names = res_store->plugin_names;
           p->messages = res_store->messages;
           p->backend_directories = res_store->backend_directories;
+          p->max_interface_bandwidth = res_store->max_interface_bandwidth;
           p->tls_cert_.allowed_certificate_common_names_ = std::move(
               res_store->tls_cert_.allowed_certificate_common_names_);
         }
@@ -811,6 +825,7 @@ static bool SaveResource(int type, const ResourceItem* items, int pass)
             Jmsg1(NULL, M_ERROR_TERM, 0, T_("Unable to init lock: ERR=%s\n"),
                   be.bstrerror(errstat));
           }
+          p->inventory = new ChangerInventory;
         }
         break;
       }
@@ -917,6 +932,7 @@ static void FreeResource(BareosResource* res, int type)
       if (p->changer_command) { free(p->changer_command); }
       if (p->device_resources) { delete p->device_resources; }
       RwlDestroy(&p->changer_lock);
+      if (p->inventory) { delete p->inventory; }
       delete p;
       break;
     }
@@ -926,6 +942,7 @@ static void FreeResource(BareosResource* res, int type)
       if (p->SDaddrs) { FreeAddresses(p->SDaddrs); }
       if (p->SDsrc_addr) { FreeAddresses(p->SDsrc_addr); }
       if (p->NDMPaddrs) { FreeAddresses(p->NDMPaddrs); }
+      if (p->metrics_addrs) { FreeAddresses(p->metrics_addrs); }
       if (p->working_directory) { free(p->working_directory); }
       if (p->plugin_directory) { free(p->plugin_directory); }
       if (p->plugin_names) { delete p->plugin_names; }
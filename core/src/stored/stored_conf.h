@@ -89,6 +89,7 @@ class StorageResource
   dlist<IPADDR>* SDsrc_addr
       = nullptr; /**< Address to source connections from */
   dlist<IPADDR>* NDMPaddrs = nullptr;
+  dlist<IPADDR>* metrics_addrs = nullptr;
   char* working_directory = nullptr; /**< Working directory for checkpoints */
   char* plugin_directory = nullptr;  /**< Plugin directory */
   alist<const char*>* plugin_names = nullptr;
@@ -112,6 +113,7 @@ class StorageResource
   bool allow_bw_bursting = false; /**< Allow bursting with bandwidth limiting */
   bool ndmp_enable = false;       /**< Enable NDMP protocol listener */
   bool ndmp_snooping = false;     /**< Enable NDMP protocol snooping */
+  bool metrics_enable = false;    /**< Enable OpenMetrics listener */
   bool collect_dev_stats = false; /**< Collect Device Statistics */
   bool collect_job_stats = false; /**< Collect Job Statistics */
   bool device_reserve_by_mediatype = false; /**< Allow device reservation based
@@ -124,10 +126,17 @@ class StorageResource
   char* log_timestamp_format = nullptr; /**< Timestamp format to use in generic
                                  logging messages */
   uint64_t max_bandwidth_per_job = 0;   /**< Bandwidth limitation (global) */
+  uint64_t max_bandwidth = 0; /**< Bandwidth shared by all jobs */
+  std::vector<std::string> max_interface_bandwidth; /**< Per local address */
 
   bool just_in_time_reservation{false};
 
   bool enable_ktls{false};
+  uint32_t max_data_connections{8}; /**< Max striped connections per job */
+  uint32_t data_connections{1};     /**< Striped connections for replication */
+  uint32_t read_ahead_volumes{0};   /**< Source volumes prefetched at once */
+  uint64_t read_ahead_size{0};      /**< Bytes prefetched per volume */
+  std::string pipeline_trace_directory{}; /**< Where to write traces */
 
   StorageResource() = default;
   virtual ~StorageResource() = default;
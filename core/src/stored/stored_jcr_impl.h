@@ -3,7 +3,7 @@
 
    Copyright (C) 2000-2012 Free Software Foundation Europe e.V.
    Copyright (C) 2011-2012 Planets Communications B.V.
-   Copyright (C) 2013-2024 Bareos GmbH & Co. KG
+   Copyright (C) 2013-2026 Bareos GmbH & Co. KG
 
    This program is Free Software; you can redistribute it and/or
    modify it under the terms of version three of the GNU Affero General Public
@@ -28,8 +28,10 @@
 #include "stored/stored_conf.h"
 #include "lib/thread_util.h"
 #include "stored/reserve.h"
+#include "lib/bandwidth_scheduler.h"
 
 template <typename T> class alist;
+class BareosSocket;
 
 namespace storagedaemon {
 
@@ -38,6 +40,8 @@ class DeviceControlRecord;
 class DirectorResource;
 struct BootStrapRecord;
 struct director_storage;
+class ChunkIndex;
+class VolumePrefetcher;
 
 struct ReadSession {
   READ_CTX* rctx{};
@@ -51,6 +55,17 @@ struct ReadSession {
   uint32_t read_EndBlock{};
 };
 
+struct DataConnections {
+  uint32_t accepted{};                  /**< Number agreed on with the client */
+  std::vector<BareosSocket*> sockets{}; /**< Authenticated connections */
+};
+
+struct ReplicationTarget {
+  std::string address{};
+  int port{};
+  std::string job{}; /**< Job name on the remote storage daemon */
+};
+
 struct DeviceWaitTimes {
   int32_t min_wait{};
   int32_t max_wait{};
@@ -80,9 +95,16 @@ struct StoredJcrImpl {
   int32_t NumWriteVolumes{};      /**< Number of volumes written */
   int32_t NumReadVolumes{};       /**< Total number of volumes to read */
   int32_t CurReadVolume{};        /**< Current read volume number */
+  storagedaemon::VolumePrefetcher* prefetcher{}; /**< Read ahead of the next volumes */
   int32_t label_errors{};         /**< Count of label errors */
   bool session_opened{};
+  storagedaemon::ChunkIndex* chunk_index{}; /**< Set if the client sends chunk manifests */
+  uint64_t dedup_bytes{};         /**< Bytes the client did not have to send */
   bool remote_replicate{};        /**< Replicate data to remote SD */
+  storagedaemon::ReplicationTarget replication_target{}; /**< Remote SD to replicate to */
+  synchronized<storagedaemon::DataConnections> data_connections{}; /**< Connections the data is striped over */
+  std::condition_variable data_connection_added{}; /**< Signaled for each new data connection */
+  synchronized<std::vector<std::shared_ptr<BandwidthScheduler::Flow>>> bandwidth_flows{}; /**< Shared by all connections of the job */
   int32_t Ticket{};               /**< Ticket for this job */
   bool ignore_label_errors{};     /**< Ignore Volume label errors */
   bool spool_attributes{};        /**< Set if spooling attributes */
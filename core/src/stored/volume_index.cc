@@ -0,0 +1,297 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "include/bareos.h"
+#include "stored/volume_index.h"
+#include "stored/block.h"
+#include "stored/dev.h"
+#include "lib/serial.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace storagedaemon {
+
+static const int debuglevel = 150;
+
+static constexpr char index_magic[] = "BVIX";
+static constexpr uint32_t index_version = 1;
+static constexpr std::size_t header_length = 4 + 4 + 8 + 4;
+static constexpr std::size_t entry_length = 4 + 4 + 4 + 4 + 8;
+
+bool VolumeIndex::Append(const Entry& entry)
+{
+  if (entry.FirstIndex <= 0 || entry.LastIndex < entry.FirstIndex) {
+    return false;
+  }
+
+  std::vector<uint32_t>& positions
+      = sessions_[SessionKey(entry.VolSessionId, entry.VolSessionTime)];
+  if (!positions.empty()
+      && entries_[positions.back()].LastIndex >= entry.LastIndex) {
+    // only continues a file that is already indexed
+    return false;
+  }
+
+  positions.push_back(static_cast<uint32_t>(entries_.size()));
+  entries_.push_back(entry);
+  return true;
+}
+
+bool VolumeIndex::AddBlock(uint32_t VolSessionId,
+                           uint32_t VolSessionTime,
+                           int32_t FirstIndex,
+                           int32_t LastIndex,
+                           uint64_t address,
+                           uint64_t end)
+{
+  if (address != covered_until_ || end <= address) { return false; }
+  covered_until_ = end;
+  dirty_ = true;
+
+  Append(Entry{VolSessionId, VolSessionTime, FirstIndex, LastIndex, address});
+  return true;
+}
+
+std::optional<uint64_t> VolumeIndex::Lookup(uint32_t VolSessionId,
+                                            uint32_t VolSessionTime,
+                                            int32_t FirstIndex,
+                                            int32_t LastIndex) const
+{
+  auto found = sessions_.find(SessionKey(VolSessionId, VolSessionTime));
+  if (found == sessions_.end()) { return std::nullopt; }
+
+  /* The first indexed block whose LastIndex reaches FirstIndex.  Blocks
+   * before it, indexed or not, only hold smaller FileIndexes. */
+  const std::vector<uint32_t>& positions = found->second;
+  auto pos = std::partition_point(positions.begin(), positions.end(),
+                                  [this, FirstIndex](uint32_t i) {
+                                    return entries_[i].LastIndex < FirstIndex;
+                                  });
+  if (pos == positions.end()) { return std::nullopt; }
+
+  const Entry& entry = entries_[*pos];
+  if (entry.FirstIndex > LastIndex) { return std::nullopt; }
+  return entry.address;
+}
+
+std::vector<char> VolumeIndex::Serialize() const
+{
+  std::vector<char> data(header_length + entries_.size() * entry_length);
+  ser_declare;
+
+  SerBegin(data.data(), data.size());
+  SerBytes(index_magic, 4);
+  ser_uint32(index_version);
+  ser_uint64(covered_until_);
+  ser_uint32(static_cast<uint32_t>(entries_.size()));
+  for (const Entry& entry : entries_) {
+    ser_uint32(entry.VolSessionId);
+    ser_uint32(entry.VolSessionTime);
+    ser_int32(entry.FirstIndex);
+    ser_int32(entry.LastIndex);
+    ser_uint64(entry.address);
+  }
+  SerEnd(data.data(), data.size());
+
+  return data;
+}
+
+std::optional<VolumeIndex> VolumeIndex::Deserialize(
+    std::string volume_name,
+    const std::vector<char>& data)
+{
+  if (data.size() < header_length
+      || memcmp(data.data(), index_magic, 4) != 0) {
+    return std::nullopt;
+  }
+
+  VolumeIndex index{std::move(volume_name)};
+  uint32_t version, count;
+  unser_declare;
+
+  UnserBegin(data.data() + 4, data.size() - 4);
+  unser_uint32(version);
+  unser_uint64(index.covered_until_);
+  unser_uint32(count);
+  if (version != index_version
+      || data.size() != header_length + std::size_t{count} * entry_length) {
+    return std::nullopt;
+  }
+
+  index.entries_.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    Entry entry;
+    unser_uint32(entry.VolSessionId);
+    unser_uint32(entry.VolSessionTime);
+    unser_int32(entry.FirstIndex);
+    unser_int32(entry.LastIndex);
+    unser_uint64(entry.address);
+
+    if (entry.address >= index.covered_until_
+        || (!index.entries_.empty()
+            && entry.address <= index.entries_.back().address)
+        || !index.Append(entry)) {
+      return std::nullopt;
+    }
+  }
+
+  return index;
+}
+
+void VolumeIndexBuilder::AddBlock(Device* dev, const DeviceBlock* block)
+{
+  if (dev->GetSeekMode() != SeekMode::BYTES) { return; }
+
+  uint64_t end = dev->file_addr;
+  uint64_t address = end - block->read_len;
+
+  if (!index_ || index_->VolumeName() != dev->VolHdr.VolumeName) {
+    index_.emplace(dev->VolHdr.VolumeName);
+    broken_ = false;
+    if (address != 0) {
+      /* The label of the first volume is read while it is mounted, so the
+       * first block we see is the one directly following it. */
+      broken_ = block->BlockNumber != 1
+                || !index_->AddBlock(0, 0, 0, 0, 0, address);
+    }
+  }
+  if (broken_) { return; }
+
+  if (!index_->AddBlock(block->VolSessionId, block->VolSessionTime,
+                        block->FirstIndex, block->LastIndex, address, end)) {
+    Dmsg2(debuglevel, "gap in volume %s at %" PRIu64 "\n",
+          index_->VolumeName().c_str(), address);
+    broken_ = true;
+  }
+}
+
+bool VolumeIndexBuilder::Finish(Device* dev)
+{
+  bool ok = index_ && !broken_
+            && dev->StoreVolumeIndex(index_->VolumeName().c_str(),
+                                     index_->Serialize());
+  index_.reset();
+  return ok;
+}
+
+/* Without a usable stored index an empty one is returned, so the device is
+ * not asked again for the same volume. */
+static std::shared_ptr<VolumeIndex> LoadVolumeIndex(Device* dev,
+                                                    const char* volume_name)
+{
+  std::vector<char> data;
+  if (!dev->LoadVolumeIndex(volume_name, data)) {
+    return std::make_shared<VolumeIndex>(volume_name);
+  }
+
+  std::optional index = VolumeIndex::Deserialize(volume_name, data);
+  if (!index) {
+    Dmsg1(debuglevel, "ignoring damaged index of volume %s\n", volume_name);
+    return std::make_shared<VolumeIndex>(volume_name);
+  }
+  return std::make_shared<VolumeIndex>(std::move(*index));
+}
+
+static void FlushLocked(Device* dev)
+{
+  VolumeIndex* index = dev->volume_index.get();
+  if (!index || !index->Dirty()) { return; }
+
+  if (dev->StoreVolumeIndex(index->VolumeName().c_str(), index->Serialize())) {
+    index->SetClean();
+  } else {
+    Dmsg1(debuglevel, "could not store index of volume %s\n",
+          index->VolumeName().c_str());
+  }
+}
+
+void UpdateVolumeIndex(Device* dev,
+                       const char* volume_name,
+                       const DeviceBlock* block,
+                       uint64_t address,
+                       uint64_t end)
+{
+  std::lock_guard lock(dev->volume_index_mutex);
+
+  if (address == 0) {
+    // a new label, whatever was indexed before is gone
+    FlushLocked(dev);
+    dev->RemoveVolumeIndex(volume_name);
+    dev->volume_index = std::make_shared<VolumeIndex>(volume_name);
+  }
+
+  VolumeIndex* index = dev->volume_index.get();
+  if (!index || index->VolumeName() != volume_name) { return; }
+
+  if (!index->AddBlock(block->VolSessionId, block->VolSessionTime,
+                       block->FirstIndex, block->LastIndex, address, end)) {
+    Dmsg3(debuglevel,
+          "volume %s: block at %" PRIu64 " does not follow %" PRIu64
+          ", index dropped\n",
+          volume_name, address, index->CoveredUntil());
+    dev->RemoveVolumeIndex(volume_name);
+    dev->volume_index.reset();
+  }
+}
+
+void AttachVolumeIndex(Device* dev, const char* volume_name)
+{
+  if (dev->GetSeekMode() != SeekMode::BYTES) { return; }
+
+  std::lock_guard lock(dev->volume_index_mutex);
+
+  if (!dev->volume_index || dev->volume_index->VolumeName() != volume_name) {
+    FlushLocked(dev);
+    dev->volume_index = LoadVolumeIndex(dev, volume_name);
+  }
+  if (dev->volume_index
+      && dev->volume_index->CoveredUntil() != dev->file_addr) {
+    /* Data was written without being indexed.  The index still describes
+     * the start of the volume correctly, but can not be extended. */
+    Dmsg3(debuglevel, "index of volume %s covers %" PRIu64 " of %" PRIu64
+          " bytes, not extending it\n",
+          volume_name, dev->volume_index->CoveredUntil(), dev->file_addr);
+    dev->volume_index.reset();
+  }
+}
+
+void FlushVolumeIndex(Device* dev)
+{
+  std::lock_guard lock(dev->volume_index_mutex);
+  FlushLocked(dev);
+}
+
+std::shared_ptr<const VolumeIndex> GetVolumeIndex(Device* dev)
+{
+  if (dev->GetSeekMode() != SeekMode::BYTES) { return nullptr; }
+
+  const char* volume_name = dev->VolHdr.VolumeName;
+  std::lock_guard lock(dev->volume_index_mutex);
+
+  if (!dev->volume_index || dev->volume_index->VolumeName() != volume_name) {
+    FlushLocked(dev);
+    dev->volume_index = LoadVolumeIndex(dev, volume_name);
+  }
+  return dev->volume_index;
+}
+
+} /* namespace storagedaemon */
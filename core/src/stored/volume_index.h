@@ -0,0 +1,142 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_STORED_VOLUME_INDEX_H_
+#define BAREOS_STORED_VOLUME_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace storagedaemon {
+
+class Device;
+struct DeviceBlock;
+
+/* Sidecar record index of a volume.
+ *
+ * Every block belongs to exactly one session, so the index stores the
+ * session, the first and last FileIndex and the address of every block
+ * that starts a new FileIndex of its session.  Blocks that only continue
+ * a file are left out.  Given a (VolSessionId, VolSessionTime, FileIndex)
+ * this yields the address of the first block holding that file without
+ * scanning from the JobMedia start.
+ *
+ * An index always covers the volume from its start up to CoveredUntil();
+ * blocks have to be added in volume order without gaps.  Addresses are
+ * byte offsets, so only devices with SeekMode::BYTES keep an index.  The
+ * index is stored by the device itself (see Device::StoreVolumeIndex()),
+ * no catalog is involved. */
+class VolumeIndex {
+ public:
+  struct Entry {
+    uint32_t VolSessionId;
+    uint32_t VolSessionTime;
+    int32_t FirstIndex;
+    int32_t LastIndex;
+    uint64_t address;
+  };
+
+  explicit VolumeIndex(std::string volume_name)
+      : volume_name_{std::move(volume_name)}
+  {
+  }
+
+  const std::string& VolumeName() const { return volume_name_; }
+  const std::vector<Entry>& Entries() const { return entries_; }
+  uint64_t CoveredUntil() const { return covered_until_; }
+  bool Dirty() const { return dirty_; }
+  void SetClean() { dirty_ = false; }
+
+  /* Adds the block stored at [address, end).  FirstIndex and LastIndex
+   * are 0 for blocks without file records.  Returns false if the block
+   * does not directly follow the part of the volume that is covered. */
+  bool AddBlock(uint32_t VolSessionId,
+                uint32_t VolSessionTime,
+                int32_t FirstIndex,
+                int32_t LastIndex,
+                uint64_t address,
+                uint64_t end);
+
+  /* Address of the first block holding a record of the given session with
+   * a FileIndex in [FirstIndex, LastIndex], if the index knows it. */
+  std::optional<uint64_t> Lookup(uint32_t VolSessionId,
+                                 uint32_t VolSessionTime,
+                                 int32_t FirstIndex,
+                                 int32_t LastIndex) const;
+
+  std::vector<char> Serialize() const;
+  static std::optional<VolumeIndex> Deserialize(std::string volume_name,
+                                                const std::vector<char>& data);
+
+ private:
+  // adds entry unless it only continues a file that is already indexed
+  bool Append(const Entry& entry);
+
+  static uint64_t SessionKey(uint32_t VolSessionId, uint32_t VolSessionTime)
+  {
+    return (static_cast<uint64_t>(VolSessionTime) << 32) | VolSessionId;
+  }
+
+  std::string volume_name_;
+  std::vector<Entry> entries_;
+  // positions in entries_ per session, ordered by address and LastIndex
+  std::unordered_map<uint64_t, std::vector<uint32_t>> sessions_;
+  uint64_t covered_until_{0};
+  bool dirty_{false};
+};
+
+/* Rebuilds the index of volumes from the blocks read from them (see
+ * bls --rebuild-index). */
+class VolumeIndexBuilder {
+ public:
+  /* Called for every block read, after all its records were read so that
+   * the FirstIndex and LastIndex of the block are known. */
+  void AddBlock(Device* dev, const DeviceBlock* block);
+  // Stores the index of the volume read so far; false if it was incomplete.
+  bool Finish(Device* dev);
+
+ private:
+  std::optional<VolumeIndex> index_;
+  bool broken_{false};
+};
+
+// Called for every block written; starts, extends or drops the index.
+void UpdateVolumeIndex(Device* dev,
+                       const char* volume_name,
+                       const DeviceBlock* block,
+                       uint64_t address,
+                       uint64_t end);
+/* Called once a volume is positioned at its end for appending; keeps
+ * extending the stored index if it covers the whole volume. */
+void AttachVolumeIndex(Device* dev, const char* volume_name);
+// Stores the index of the volume being written if it changed.
+void FlushVolumeIndex(Device* dev);
+// The index of the mounted volume, if there is one.
+std::shared_ptr<const VolumeIndex> GetVolumeIndex(Device* dev);
+
+} /* namespace storagedaemon */
+
+#endif  // BAREOS_STORED_VOLUME_INDEX_H_
@@ -0,0 +1,265 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+/**
+ * @file
+ * Read ahead of the source volumes of copy, migration and virtual full jobs
+ */
+
+#include "include/fcntl_def.h"
+#include "include/bareos.h"
+#include "stored/stored.h"
+#include "stored/stored_globals.h"
+#include "stored/stored_jcr_impl.h"
+#include "stored/bsr.h"
+#include "stored/volume_prefetch.h"
+#include "lib/berrno.h"
+#include "lib/parse_conf.h"
+
+#include <algorithm>
+
+namespace storagedaemon {
+
+static const int debuglevel = 150;
+
+// read ahead is requested in pieces of this size; it is also the slack
+// added to the end of a bsr address range, which points to the start of the
+// last block.
+static constexpr std::size_t read_chunk = 1024 * 1024;
+
+VolumePrefetcher::VolumePrefetcher(std::vector<Volume> volumes,
+                                   std::size_t parallel,
+                                   std::uint64_t window)
+    : volumes_{std::move(volumes)}, parallel_{parallel}, window_{window}
+{
+  auto count = std::min(parallel_, volumes_.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    workers_.emplace_back(&VolumePrefetcher::Work, this);
+  }
+}
+
+VolumePrefetcher::~VolumePrefetcher()
+{
+  {
+    std::unique_lock lock(mutex_);
+    stop_ = true;
+  }
+  changed_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) { worker.join(); }
+  }
+}
+
+void VolumePrefetcher::Advance(std::size_t current)
+{
+  {
+    std::unique_lock lock(mutex_);
+    current_ = std::max(current_, current);
+    next_ = std::max(next_, current_ + 1);
+  }
+  changed_.notify_all();
+}
+
+void VolumePrefetcher::Finish()
+{
+  {
+    std::unique_lock lock(mutex_);
+    finish_ = true;
+  }
+  changed_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) { worker.join(); }
+  }
+}
+
+std::uint64_t VolumePrefetcher::BytesRequested() const
+{
+  std::unique_lock lock(mutex_);
+  return bytes_requested_;
+}
+
+void VolumePrefetcher::Work()
+{
+  for (;;) {
+    std::size_t idx;
+    {
+      std::unique_lock lock(mutex_);
+      // at most parallel_ volumes ahead of the job are kept in memory
+      auto claimable = [this] {
+        return next_ < volumes_.size() && next_ <= current_ + parallel_;
+      };
+      changed_.wait(lock, [this, &claimable] {
+        return stop_ || finish_ || next_ >= volumes_.size() || claimable();
+      });
+      if (stop_ || !claimable()) { return; }
+      idx = next_++;
+    }
+    Prefetch(idx);
+  }
+}
+
+// Starts reading the range into the page cache, without waiting for it.
+static bool ReadAhead(int fd, std::uint64_t offset, std::uint64_t size)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+  return posix_fadvise(fd, offset, size, POSIX_FADV_WILLNEED) == 0;
+#else
+  // without a way to ask the kernel, the data has to pass through us
+  std::vector<char> buffer(size);
+  if (lseek(fd, offset, SEEK_SET) < 0) { return false; }
+  return read(fd, buffer.data(), size) > 0;
+#endif
+}
+
+bool VolumePrefetcher::Superseded(std::size_t idx)
+{
+  std::unique_lock lock(mutex_);
+  return stop_ || idx <= current_;
+}
+
+void VolumePrefetcher::Prefetch(std::size_t idx)
+{
+  const Volume& volume = volumes_[idx];
+  if (volume.path.empty()) { return; }
+
+  int fd = open(volume.path.c_str(), O_RDONLY | O_BINARY);
+  if (fd < 0) {
+    BErrNo be;
+    Dmsg2(debuglevel, "Cannot prefetch %s: ERR=%s\n", volume.path.c_str(),
+          be.bstrerror());
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return;
+  }
+  auto volume_size = static_cast<std::uint64_t>(st.st_size);
+
+  std::vector<Range> ranges = volume.ranges;
+  if (ranges.empty()) { ranges.push_back(Range{0, volume_size}); }
+
+  std::uint64_t budget = window_;
+  for (auto& range : ranges) {
+    std::uint64_t offset = range.start;
+    std::uint64_t end = std::min(range.end, volume_size);
+    while (offset < end && budget > 0) {
+      if (Superseded(idx)) {
+        close(fd);
+        return;
+      }
+
+      std::uint64_t size
+          = std::min<std::uint64_t>({read_chunk, end - offset, budget});
+      if (!ReadAhead(fd, offset, size)) { break; }
+
+      offset += size;
+      budget -= size;
+      std::unique_lock lock(mutex_);
+      bytes_requested_ += size;
+    }
+  }
+
+  Dmsg2(debuglevel, "Requested read ahead of %" PRIu64 " bytes of %s\n",
+        window_ - budget, volume.path.c_str());
+  close(fd);
+}
+
+static std::string VolumePath(const VolumeList* vol)
+{
+  // prefer the device the volume was written with
+  for (bool by_name : {true, false}) {
+    if (by_name && !vol->device[0]) { continue; }
+
+    DeviceResource* device = nullptr;
+    foreach_res (device, R_DEVICE) {
+      if (by_name && !bstrcmp(device->resource_name_, vol->device)) {
+        continue;
+      }
+      if (!bstrcmp(device->media_type, vol->MediaType)) { continue; }
+      // virtual autochangers map volumes to devices on their own
+      if (device->device_type != DeviceType::B_FILE_DEV
+          || (device->changer_res && device->changer_command
+              && device->changer_command[0])) {
+        continue;
+      }
+
+      PoolMem archive_name(PM_FNAME);
+      GetFileArchiveName(device, vol->VolumeName, archive_name);
+      return archive_name.c_str();
+    }
+  }
+  return {};
+}
+
+static std::vector<VolumePrefetcher::Range> VolumeRanges(
+    BootStrapRecord* root,
+    const char* VolumeName)
+{
+  std::vector<VolumePrefetcher::Range> ranges;
+  for (BootStrapRecord* bsr = root; bsr; bsr = bsr->next) {
+    bool matches = false;
+    for (BsrVolume* volume = bsr->volume; volume; volume = volume->next) {
+      if (bstrcmp(volume->VolumeName, VolumeName)) { matches = true; }
+    }
+    if (!matches) { continue; }
+
+    // without addresses we do not know which part of the volume is needed
+    if (!bsr->voladdr) { return {}; }
+    for (auto* addr = bsr->voladdr; addr; addr = addr->next) {
+      ranges.push_back(
+          VolumePrefetcher::Range{addr->saddr, addr->eaddr + read_chunk});
+    }
+  }
+
+  std::sort(ranges.begin(), ranges.end(),
+            [](auto& l, auto& r) { return l.start < r.start; });
+  return ranges;
+}
+
+std::unique_ptr<VolumePrefetcher> StartVolumePrefetch(JobControlRecord* jcr)
+{
+  if (me->read_ahead_volumes == 0 || jcr->sd_impl->NumReadVolumes < 2) {
+    return nullptr;
+  }
+
+  std::vector<VolumePrefetcher::Volume> volumes;
+  bool any = false;
+  {
+    ResLocker _{my_config};
+    for (VolumeList* vol = jcr->sd_impl->VolList; vol; vol = vol->next) {
+      auto& volume = volumes.emplace_back();
+      volume.path = VolumePath(vol);
+      volume.ranges = VolumeRanges(jcr->sd_impl->read_session.bsr,
+                                   vol->VolumeName);
+      // the first volume is read by the job itself
+      if (volumes.size() > 1 && !volume.path.empty()) { any = true; }
+    }
+  }
+  if (!any) { return nullptr; }
+
+  Dmsg2(debuglevel, "Prefetching %zu volumes, %" PRIu32 " at a time\n",
+        volumes.size() - 1, me->read_ahead_volumes);
+  return std::make_unique<VolumePrefetcher>(
+      std::move(volumes), me->read_ahead_volumes, me->read_ahead_size);
+}
+
+} /* namespace storagedaemon */
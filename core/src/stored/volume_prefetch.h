@@ -0,0 +1,102 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_STORED_VOLUME_PREFETCH_H_
+#define BAREOS_STORED_VOLUME_PREFETCH_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class JobControlRecord;
+
+namespace storagedaemon {
+
+/* Asks the kernel to read the volumes a job is going to read next into the
+ * page cache.
+ *
+ * Copy, migration and virtual full jobs read their source volumes strictly
+ * one after the other, in the order the output job needs the records.  If
+ * these volumes live on different disks, all but one of them are idle.  The
+ * prefetcher keeps up to `parallel` of the upcoming volumes busy at the same
+ * time, with at most `window` bytes of each, so that the job finds their
+ * data in memory once it gets there.  The data itself is never copied to
+ * us, posix_fadvise(POSIX_FADV_WILLNEED) only starts the reads. */
+class VolumePrefetcher {
+ public:
+  struct Range {
+    std::uint64_t start;
+    std::uint64_t end; /* exclusive */
+  };
+
+  struct Volume {
+    std::string path;
+    std::vector<Range> ranges; /* empty means the whole volume */
+  };
+
+  VolumePrefetcher(std::vector<Volume> volumes,
+                   std::size_t parallel,
+                   std::uint64_t window);
+  // Stops all prefetching, even if it is not finished yet.
+  ~VolumePrefetcher();
+  VolumePrefetcher(const VolumePrefetcher&) = delete;
+  VolumePrefetcher& operator=(const VolumePrefetcher&) = delete;
+
+  // The job started reading volume current (counted from 0).  Volumes up to
+  // this one are not prefetched anymore.
+  void Advance(std::size_t current);
+  // Waits until every volume that may be prefetched right now is done.
+  void Finish();
+
+  // What the kernel was asked to read ahead so far.
+  std::uint64_t BytesRequested() const;
+
+ private:
+  void Work();
+  void Prefetch(std::size_t idx);
+  bool Superseded(std::size_t idx);
+
+  std::vector<Volume> volumes_;
+  std::size_t parallel_;
+  std::uint64_t window_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::size_t current_{0};
+  std::size_t next_{1};
+  bool stop_{false};
+  bool finish_{false};
+  std::uint64_t bytes_requested_{0};
+  std::vector<std::thread> workers_;
+};
+
+// Sets up prefetching of the volumes the job reads according to the read
+// ahead settings of the storage daemon.  Returns nothing if there is no
+// volume worth prefetching.
+std::unique_ptr<VolumePrefetcher> StartVolumePrefetch(JobControlRecord* jcr);
+
+} /* namespace storagedaemon */
+
+#endif  // BAREOS_STORED_VOLUME_PREFETCH_H_
@@ -0,0 +1,148 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "filed/accurate_state.h"
+#include "tests/temporary_directory.h"
+
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace filedaemon;
+
+namespace {
+using Entry = std::tuple<std::string, std::string, std::int32_t>;
+
+class AccurateState : public TemporaryDirectoryTest {
+ protected:
+  void SetUp() override
+  {
+    TemporaryDirectoryTest::SetUp();
+    path = AccurateStatePath(dir.c_str(), "bareos-dir", "Backup Client1");
+  }
+
+  std::vector<Entry> ReadAll()
+  {
+    std::vector<Entry> entries;
+    EXPECT_TRUE(ReadAccurateState(
+        path, [&entries](char* fname, char* lstat, std::int32_t delta_seq) {
+          entries.emplace_back(fname, lstat, delta_seq);
+          return true;
+        }));
+    return entries;
+  }
+
+  std::string path;
+};
+}  // namespace
+
+TEST_F(AccurateState, CommitReplacesState)
+{
+  AccurateStateWriter writer(path, "1,5", true);
+  ASSERT_TRUE(writer.Open());
+  writer.Add("/etc/", "P0A", 0);
+  writer.Add("/etc/file with\nnewline", "P0B", 2);
+  EXPECT_FALSE(fs::exists(path));
+  ASSERT_TRUE(writer.Commit());
+
+  auto count = PeekAccurateState(path, "1,5");
+  ASSERT_TRUE(count.has_value());
+  EXPECT_EQ(*count, 2u);
+  EXPECT_EQ(ReadAll(), (std::vector<Entry>{{"/etc/", "P0A", 0},
+                                           {"/etc/file with\nnewline", "P0B",
+                                            2}}));
+}
+
+TEST_F(AccurateState, OnlyMatchingChainIsUsed)
+{
+  AccurateStateWriter writer(path, "1,5", false);
+  ASSERT_TRUE(writer.Open());
+  writer.Add("/etc/", "P0A", 0);
+  ASSERT_TRUE(writer.Commit());
+
+  EXPECT_FALSE(PeekAccurateState(path, "1").has_value());
+  EXPECT_FALSE(PeekAccurateState(path, "1,5,7").has_value());
+  EXPECT_FALSE(PeekAccurateState(path + ".missing", "1,5").has_value());
+}
+
+TEST_F(AccurateState, AbortKeepsPreviousState)
+{
+  {
+    AccurateStateWriter writer(path, "1", false);
+    ASSERT_TRUE(writer.Open());
+    writer.Add("/a", "P0A", 0);
+    ASSERT_TRUE(writer.Commit());
+  }
+  {
+    AccurateStateWriter writer(path, "1,2", false);
+    ASSERT_TRUE(writer.Open());
+    writer.Add("/b", "P0B", 0);
+    // job failed, the writer is destroyed without commit
+  }
+  EXPECT_FALSE(fs::exists(path + ".2.tmp"));
+  EXPECT_TRUE(PeekAccurateState(path, "1").has_value());
+  EXPECT_EQ(ReadAll(), (std::vector<Entry>{{"/a", "P0A", 0}}));
+}
+
+TEST_F(AccurateState, ConcurrentRunsUseTheirOwnFile)
+{
+  AccurateStateWriter first(path, "1,2", false);
+  AccurateStateWriter second(path, "1,3", false);
+  ASSERT_TRUE(first.Open());
+  ASSERT_TRUE(second.Open());
+  first.Add("/a", "P0A", 0);
+  second.Add("/b", "P0B", 0);
+
+  ASSERT_TRUE(second.Commit());
+  ASSERT_TRUE(first.Commit());
+  EXPECT_TRUE(PeekAccurateState(path, "1,2").has_value());
+  EXPECT_EQ(ReadAll(), (std::vector<Entry>{{"/a", "P0A", 0}}));
+}
+
+TEST_F(AccurateState, TracksNamesOnlyIfAsked)
+{
+  AccurateStateWriter tracking(path, "1", true);
+  ASSERT_TRUE(tracking.Open());
+  tracking.Add("/a", "P0A", 0);
+  EXPECT_TRUE(tracking.Contains("/a"));
+  EXPECT_FALSE(tracking.Contains("/b"));
+
+  AccurateStateWriter full(path + ".full", "2", false);
+  ASSERT_TRUE(full.Open());
+  full.Add("/a", "P0A", 0);
+  EXPECT_FALSE(full.Contains("/a"));
+}
+
+TEST_F(AccurateState, TruncatedStateIsRejected)
+{
+  AccurateStateWriter writer(path, "1", false);
+  ASSERT_TRUE(writer.Open());
+  writer.Add("/a", "P0A", 0);
+  writer.Add("/b", "P0B", 0);
+  ASSERT_TRUE(writer.Commit());
+
+  fs::resize_file(path, fs::file_size(path) - 6);
+  EXPECT_FALSE(ReadAccurateState(
+      path, [](char*, char*, std::int32_t) { return true; }));
+}
@@ -0,0 +1,78 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "dird/ua.h"
+
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+using directordaemon::AclMatcher;
+
+static std::optional<bool> Find(const std::vector<std::string>& list,
+                                const char* item)
+{
+  return AclMatcher(list).Find(directordaemon::Job_ACL, item, strlen(item));
+}
+
+TEST(acl_matcher, empty_list_matches_nothing)
+{
+  EXPECT_EQ(Find({}, "job"), std::nullopt);
+}
+
+TEST(acl_matcher, literals_are_case_insensitive)
+{
+  EXPECT_EQ(Find({"BackupJob"}, "backupjob"), true);
+  EXPECT_EQ(Find({"!BackupJob"}, "BACKUPJOB"), false);
+  EXPECT_EQ(Find({"BackupJob"}, "RestoreJob"), std::nullopt);
+}
+
+TEST(acl_matcher, all_matches_everything)
+{
+  EXPECT_EQ(Find({"*all*"}, "job"), true);
+  EXPECT_EQ(Find({"!*ALL*"}, "job"), false);
+}
+
+TEST(acl_matcher, first_matching_entry_decides)
+{
+  EXPECT_EQ(Find({"!job", "*all*"}, "job"), false);
+  EXPECT_EQ(Find({"*all*", "!job"}, "job"), true);
+  EXPECT_EQ(Find({"job", "!job"}, "job"), true);
+  EXPECT_EQ(Find({"!backup.*", "backup-fd"}, "backup-fd"), false);
+  EXPECT_EQ(Find({"backup-fd", "!backup.*"}, "backup-fd"), true);
+  EXPECT_EQ(Find({"other", "!backup.*", "*all*"}, "restore"), true);
+}
+
+TEST(acl_matcher, regex_has_to_match_the_whole_item)
+{
+  EXPECT_EQ(Find({"backup.*"}, "Backup-Client"), true);
+  EXPECT_EQ(Find({"back"}, "backup"), std::nullopt);
+  EXPECT_EQ(Find({"b.ck"}, "backup"), std::nullopt);
+  EXPECT_EQ(Find({"b.ck.*"}, "backup"), true);
+}
+
+TEST(acl_matcher, invalid_regex_is_compared_literally)
+{
+  EXPECT_EQ(Find({"job("}, "job("), true);
+  EXPECT_EQ(Find({"job("}, "job"), std::nullopt);
+}
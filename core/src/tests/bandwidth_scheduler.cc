@@ -0,0 +1,161 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+
+#include "lib/bandwidth_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(BandwidthScheduler, UnlimitedDoesNotWait)
+{
+  BandwidthScheduler scheduler;
+  BandwidthScheduler::Flow flow(scheduler, 1);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 1000; ++i) { flow.Acquire(1024 * 1024); }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+  auto stats = scheduler.Statistics();
+  EXPECT_EQ(stats.rate, 0u);
+  EXPECT_EQ(stats.bytes, 1000u * 1024 * 1024);
+  EXPECT_EQ(stats.flows, 1u);
+}
+
+TEST(BandwidthScheduler, UnlimitedCountsThroughput)
+{
+  std::atomic<BandwidthScheduler::clock::time_point> now{
+      BandwidthScheduler::clock::time_point{} + 100s};
+  BandwidthScheduler scheduler(0, [&] { return now.load(); });
+
+  auto send = [&] {
+    BandwidthScheduler::Flow flow(scheduler, 1);
+    for (int i = 0; i < 1000; ++i) { flow.Acquire(1000); }
+  };
+  auto first = std::async(std::launch::async, send);
+  auto second = std::async(std::launch::async, send);
+  first.get();
+  second.get();
+
+  // only completed seconds count
+  EXPECT_EQ(scheduler.Statistics().throughput, 0u);
+  now = now.load() + 1s;
+  EXPECT_EQ(scheduler.Statistics().throughput, 2000000u / 5);
+
+  // the slot of that second is reused once it left the window
+  now = now.load() + 5s;
+  EXPECT_EQ(scheduler.Statistics().throughput, 0u);
+  send();
+  now = now.load() + 1s;
+  EXPECT_EQ(scheduler.Statistics().throughput, 1000000u / 5);
+  EXPECT_EQ(scheduler.Statistics().bytes, 3000000u);
+}
+
+TEST(BandwidthScheduler, LimitsRate)
+{
+  BandwidthScheduler scheduler(4 * 1024 * 1024);
+  BandwidthScheduler::Flow flow(scheduler, 1);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 32; ++i) { flow.Acquire(64 * 1024); }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // the first chunk is sent right away, the others at 4 MiB/s
+  EXPECT_GE(elapsed, 400ms);
+  EXPECT_LT(elapsed, 5s);
+}
+
+TEST(BandwidthScheduler, SharesByWeight)
+{
+  constexpr std::uint64_t rate = 64 * 1024 * 1024;
+  constexpr std::size_t chunk = 64 * 1024;
+  // a little more than the time for one chunk, against rounding
+  constexpr auto chunk_time
+      = std::chrono::nanoseconds(1s) * chunk / rate + 1us;
+
+  // time only passes when the test says so, one chunk at a time
+  std::atomic<BandwidthScheduler::clock::time_point> now{
+      BandwidthScheduler::clock::now()};
+  BandwidthScheduler scheduler(rate, [&] { return now.load(); });
+
+  // the bucket is empty, so nothing is sent before both flows are waiting
+  BandwidthScheduler::Flow first(scheduler, 1);
+  first.Acquire(chunk);
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> light{0}, heavy{0};
+  auto run = [&](std::uint32_t weight, std::atomic<int>& chunks) {
+    BandwidthScheduler::Flow flow(scheduler, weight);
+    while (!stop) {
+      flow.Acquire(chunk);
+      chunks += 1;
+    }
+  };
+  auto light_sender = std::async(std::launch::async, run, 1, std::ref(light));
+  auto heavy_sender = std::async(std::launch::async, run, 3, std::ref(heavy));
+
+  auto both_waiting = [&](int sent) {
+    while (light + heavy < sent || scheduler.Statistics().waiting < 2) {
+      std::this_thread::yield();
+    }
+  };
+  both_waiting(0);
+  for (int sent = 1; sent <= 40; ++sent) {
+    now = now.load() + chunk_time;
+    both_waiting(sent);
+  }
+
+  EXPECT_EQ(light, 10);
+  EXPECT_EQ(heavy, 30);
+
+  stop = true;
+  scheduler.SetRate(0);
+  light_sender.get();
+  heavy_sender.get();
+}
+
+TEST(BandwidthScheduler, RaisingTheLimitWakesWaiters)
+{
+  BandwidthScheduler scheduler(1024);
+  BandwidthScheduler::Flow flow(scheduler, 1);
+
+  // goes into debt for about 1000 seconds
+  flow.Acquire(1024 * 1024);
+  auto waiting = std::async(std::launch::async, [&] { flow.Acquire(1); });
+  EXPECT_EQ(waiting.wait_for(100ms), std::future_status::timeout);
+
+  scheduler.SetRate(0);
+  EXPECT_EQ(waiting.wait_for(5s), std::future_status::ready);
+}
+
+TEST(BandwidthScheduler, WeightFromPriority)
+{
+  EXPECT_EQ(BandwidthWeightFromPriority(10), 100u);
+  EXPECT_EQ(BandwidthWeightFromPriority(1), 1000u);
+  EXPECT_EQ(BandwidthWeightFromPriority(0), 1000u);
+  EXPECT_EQ(BandwidthWeightFromPriority(5000), 1u);
+  EXPECT_GT(BandwidthWeightFromPriority(5), BandwidthWeightFromPriority(10));
+}
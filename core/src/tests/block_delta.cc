@@ -0,0 +1,136 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "filed/block_delta.h"
+#include "tests/temporary_directory.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace filedaemon;
+
+namespace {
+class BlockDelta : public TemporaryDirectoryTest {
+ protected:
+  BlockMap MakeMap(std::int64_t size)
+  {
+    BlockMap map;
+    map.job_id = 42;
+    map.delta_seq = 3;
+    map.size = size;
+    map.mtime = 1000;
+    map.ctime = 2000;
+    std::size_t blocks = (size + map.block_size - 1) / map.block_size;
+    for (std::size_t i = 0; i < blocks; ++i) {
+      BlockHash hash{};
+      hash[0] = static_cast<std::uint8_t>(i);
+      hash[15] = 0xaa;
+      map.hashes.push_back(hash);
+    }
+    return map;
+  }
+};
+}  // namespace
+
+TEST_F(BlockDelta, MapPathIsInWorkingDirectory)
+{
+  std::string path
+      = BlockMapPath("/var/lib/bareos", "dir", "job.2026-01-02_03.04.05_06",
+                     "/srv/disk.img");
+  EXPECT_EQ(path.rfind("/var/lib/bareos/block-delta/", 0), 0u);
+  EXPECT_EQ(path.substr(path.size() - 4), ".map");
+
+  // every run of a job uses the same map, other jobs have their own
+  EXPECT_EQ(path, BlockMapPath("/var/lib/bareos", "dir",
+                               "job.2026-02-03_04.05.06_07", "/srv/disk.img"));
+  EXPECT_NE(path,
+            BlockMapPath("/var/lib/bareos", "dir",
+                         "other.2026-01-02_03.04.05_06", "/srv/disk.img"));
+  EXPECT_NE(path, BlockMapPath("/var/lib/bareos", "dir2",
+                               "job.2026-01-02_03.04.05_06", "/srv/disk.img"));
+}
+
+TEST_F(BlockDelta, MapRoundTrip)
+{
+  BlockMap map = MakeMap(5 * kBlockDeltaBlockSize + 17);
+  std::string path = (dir / "block-delta" / "file.map").string();
+  ASSERT_TRUE(map.Write(path));
+  EXPECT_FALSE(fs::exists(path + ".tmp"));
+
+  auto read = BlockMap::Read(path);
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(read->job_id, map.job_id);
+  EXPECT_EQ(read->block_size, map.block_size);
+  EXPECT_EQ(read->delta_seq, map.delta_seq);
+  EXPECT_EQ(read->size, map.size);
+  EXPECT_EQ(read->mtime, map.mtime);
+  EXPECT_EQ(read->ctime, map.ctime);
+  EXPECT_EQ(read->hashes, map.hashes);
+}
+
+TEST_F(BlockDelta, TruncatedMapIsRejected)
+{
+  BlockMap map = MakeMap(3 * kBlockDeltaBlockSize);
+  std::string path = (dir / "block-delta" / "file.map").string();
+  ASSERT_TRUE(map.Write(path));
+
+  fs::resize_file(path, fs::file_size(path) - 1);
+  EXPECT_FALSE(BlockMap::Read(path).has_value());
+  EXPECT_FALSE(BlockMap::Read((dir / "missing.map").string()).has_value());
+}
+
+TEST_F(BlockDelta, MapDescribesOnlyTheCatalogVersion)
+{
+  BlockMap map = MakeMap(2 * kBlockDeltaBlockSize);
+  struct stat st{};
+  st.st_size = map.size;
+  st.st_mtime = map.mtime;
+  st.st_ctime = map.ctime;
+
+  EXPECT_TRUE(map.Describes(st, 3, 42));
+  EXPECT_FALSE(map.Describes(st, 2, 42));
+
+  // written by another backup than the last one of the job, or unknown
+  EXPECT_FALSE(map.Describes(st, 3, 43));
+  EXPECT_FALSE(map.Describes(st, 3, 0));
+
+  st.st_mtime++;
+  EXPECT_FALSE(map.Describes(st, 3, 42));
+  st.st_mtime--;
+  st.st_size++;
+  EXPECT_FALSE(map.Describes(st, 3, 42));
+}
+
+TEST_F(BlockDelta, UnchangedComparesBlockHashes)
+{
+  BlockMap map = MakeMap(2 * kBlockDeltaBlockSize);
+  BlockHash other = map.hashes[0];
+  other[1] ^= 1;
+
+  EXPECT_TRUE(map.Unchanged(0, map.hashes[0]));
+  EXPECT_FALSE(map.Unchanged(0, other));
+  EXPECT_FALSE(map.Unchanged(1, map.hashes[0]));
+  // blocks appended to the file are always changed
+  EXPECT_FALSE(map.Unchanged(2, map.hashes[1]));
+}
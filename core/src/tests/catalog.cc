@@ -21,6 +21,7 @@
 
 #include "include/bareos.h"
 #include "cats/cats.h"
+#include "cats/sql.h"
 #include "cats/sql_pooling.h"
 #include "dird/get_database_connection.h"
 #include "dird/dird_conf.h"
@@ -30,6 +31,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "include/bareos.h"
+#include "include/filetypes.h"
+#include "include/streams.h"
 #include "lib/parse_conf.h"
 #include "lib/util.h"
 #include "dird/jcr_util.h"
@@ -39,6 +42,7 @@
 
 using directordaemon::InitDirConfig;
 using directordaemon::my_config;
+using namespace std::string_literals;
 
 class CatalogTest : public ::testing::Test {
  protected:
@@ -156,3 +160,76 @@ TEST_F(CatalogTest, database)
 
   EXPECT_EQ(time_converted, StrToUtime("2019-11-27 15:04:49"));
 }
+
+TEST_F(CatalogTest, partitioned_file_table)
+{
+  uint32_t partitioned = 0;
+  ASSERT_TRUE(db->SqlQuery("SELECT COUNT(*) FROM pg_partitioned_table"
+                           " WHERE partrelid = to_regclass('file')",
+                           DbIntHandler, &partitioned));
+  if (!partitioned) { GTEST_SKIP() << "File table is not partitioned."; }
+
+  auto count = [this](const std::string& query) {
+    uint32_t result = 0;
+    EXPECT_TRUE(db->SqlQuery(query.c_str(), DbIntHandler, &result)) << query;
+    return result;
+  };
+
+  // the first two jobs end up in different partitions
+  for (JobId_t jobid : {5001, 12001, 23001}) {
+    std::string job_query{
+        "INSERT INTO Job (JobId, Job, Name, Type, Level, ClientId, JobStatus,"
+        " SchedTime) VALUES ("
+        + std::to_string(jobid) + ", 'partitioned." + std::to_string(jobid)
+        + "', 'partitioned', 'B', 'F', 1, 'T', '2026-01-01 00:00:00')"};
+    ASSERT_TRUE(db->SqlExec(job_query.c_str()));
+  }
+
+  std::string lstat{"P0A V9T EHt C A A A 4 BAA A BWDNS/ BWDNS/ BWDNS/ A A C"};
+  std::string digest{"0"};
+  auto attributes = [&lstat, &digest](JobId_t jobid, std::string& fname) {
+    AttributesDbRecord ar;
+    ar.fname = fname.data();
+    ar.attr = lstat.data();
+    ar.Digest = digest.data();
+    ar.FileIndex = 1;
+    ar.Stream = STREAM_UNIX_ATTRIBUTES;
+    ar.FileType = FT_REG;
+    ar.JobId = jobid;
+    return ar;
+  };
+
+  // one batch with the files of two jobs
+  std::string first{"/partitioned/first"};
+  std::string second{"/partitioned/second"};
+  auto ar1 = attributes(5001, first);
+  auto ar2 = attributes(12001, second);
+  ASSERT_TRUE(db->CreateAttributesRecord(jcr, &ar1));
+  ASSERT_TRUE(db->CreateAttributesRecord(jcr, &ar2));
+  if (jcr->batch_started) {
+    ASSERT_TRUE(jcr->db_batch->WriteBatchFileRecords(jcr));
+  }
+
+  // and a record that is inserted on its own
+  std::string third{"/partitioned/third"};
+  auto ar3 = attributes(23001, third);
+  ASSERT_TRUE(db->CreateFileAttributesRecord(jcr, &ar3));
+
+  for (auto jobid : {"5001", "12001", "23001"}) {
+    EXPECT_EQ(count("SELECT COUNT(*) FROM File WHERE JobId="s + jobid), 1u)
+        << "JobId " << jobid;
+    EXPECT_EQ(count("SELECT COUNT(*) FROM FilePartition WHERE "s + jobid
+                    + " >= FromJobId AND "s + jobid + " < ToJobId"),
+              1u)
+        << "JobId " << jobid;
+  }
+
+  // purging the first two jobs drops their partitions
+  db->PurgeFiles("5001,12001");
+  EXPECT_EQ(count("SELECT COUNT(*) FROM FilePartition"
+                  " WHERE FromJobId <= 12001 AND ToJobId > 5001"),
+            0u);
+  EXPECT_EQ(count("SELECT COUNT(*) FROM File WHERE JobId IN (5001,12001)"),
+            0u);
+  EXPECT_EQ(count("SELECT COUNT(*) FROM File WHERE JobId=23001"), 1u);
+}
@@ -0,0 +1,153 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "lib/util.h"
+
+#include "stored/changer_inventory.h"
+#include "tests/temporary_directory.h"
+
+#include <filesystem>
+#include <fstream>
+
+using storagedaemon::ChangerInventory;
+
+namespace {
+// What mtx-changer prints for "listall"
+constexpr const char* kListall
+    = "D:0:F:2:vol2\n"
+      "D:1:E\n"
+      "D:3:F:42:vol42\n"
+      "S:1:F:vol1\n"
+      "S:2:E\n"
+      "S:42:E\n"
+      "I:50:F:vol50\n";
+}  // namespace
+
+class FakeChanger : public TemporaryDirectoryTest {
+ protected:
+  // Writes a changer script that prints output and returns its path.
+  std::string Script(const std::string& output)
+  {
+    auto script = dir / "fake-changer";
+    std::ofstream(script) << "#!/bin/sh\ncat <<'EOF'\n" << output << "EOF\n";
+    std::filesystem::permissions(script, std::filesystem::perms::owner_all);
+    return script.string();
+  }
+};
+
+TEST(ChangerInventory, ParsesListall)
+{
+  ChangerInventory inventory;
+  ASSERT_TRUE(inventory.Update(kListall));
+
+  EXPECT_EQ(inventory.LoadedSlot(0), 2);
+  EXPECT_EQ(inventory.LoadedSlot(1), 0);
+  EXPECT_EQ(inventory.LoadedSlot(3), 42);
+  EXPECT_FALSE(inventory.LoadedSlot(2));
+
+  EXPECT_EQ(inventory.DriveHoldingSlot(42), 3);
+  EXPECT_FALSE(inventory.DriveHoldingSlot(1));
+  EXPECT_FALSE(inventory.DriveHoldingSlot(0));
+}
+
+TEST(ChangerInventory, KeepsModelOnUnusableOutput)
+{
+  ChangerInventory inventory;
+  ASSERT_TRUE(inventory.Update(kListall));
+
+  EXPECT_FALSE(inventory.Update(""));
+  EXPECT_FALSE(inventory.Update("S:1:F:vol1\nD:x:E\nD:4:F:0\n"));
+  EXPECT_EQ(inventory.LoadedSlot(0), 2);
+}
+
+TEST(ChangerInventory, TracksLoadsAndUnloads)
+{
+  ChangerInventory inventory;
+  ASSERT_TRUE(inventory.Update(kListall));
+
+  inventory.SetLoaded(1, 2);
+  EXPECT_EQ(inventory.LoadedSlot(1), 2);
+  EXPECT_EQ(inventory.LoadedSlot(0), 0);
+
+  inventory.SetLoaded(3, 0);
+  EXPECT_FALSE(inventory.DriveHoldingSlot(42));
+
+  inventory.Invalidate(1);
+  EXPECT_FALSE(inventory.LoadedSlot(1));
+  inventory.Invalidate();
+  EXPECT_FALSE(inventory.LoadedSlot(3));
+}
+
+TEST(ChangerInventory, MovesExcludeEachOther)
+{
+  ChangerInventory inventory;
+  ASSERT_TRUE(inventory.Update(kListall));
+
+  // drive 3 swaps slot 42 for slot 7
+  ASSERT_TRUE(inventory.BeginMove(3, {7, 42}));
+  EXPECT_FALSE(inventory.LoadedSlot(3));
+  EXPECT_TRUE(inventory.DriveMoving(3));
+  EXPECT_TRUE(inventory.SlotMoving(7));
+  EXPECT_TRUE(inventory.SlotMoving(42));
+  EXPECT_FALSE(inventory.BeginMove(1, {7}));
+  EXPECT_FALSE(inventory.BeginMove(1, {42}));
+  EXPECT_FALSE(inventory.BeginMove(3, {8}));
+  EXPECT_TRUE(inventory.BeginMove(1, {8, 0}));
+
+  // stale reports for a drive that is being loaded are ignored
+  inventory.SetLoaded(3, 0);
+  ASSERT_TRUE(inventory.Update("D:3:F:42\nD:0:F:2\n"));
+  EXPECT_FALSE(inventory.LoadedSlot(3));
+
+  inventory.EndMove(3, 7);
+  EXPECT_EQ(inventory.LoadedSlot(3), 7);
+  EXPECT_FALSE(inventory.SlotMoving(7));
+  EXPECT_FALSE(inventory.SlotMoving(42));
+
+  inventory.EndMove(1, std::nullopt);
+  EXPECT_FALSE(inventory.LoadedSlot(1));
+  EXPECT_TRUE(inventory.BeginMove(1, {8}));
+}
+
+TEST(ChangerInventory, RemembersMissingListall)
+{
+  ChangerInventory inventory;
+  EXPECT_TRUE(inventory.ListallSupported());
+
+  inventory.SetListallUnsupported();
+  EXPECT_FALSE(inventory.ListallSupported());
+  inventory.Invalidate();
+  EXPECT_FALSE(inventory.ListallSupported());
+}
+
+TEST_F(FakeChanger, InventoryFromListall)
+{
+  auto script = Script(kListall);
+  PoolMem results(PM_MESSAGE);
+
+  ASSERT_EQ(RunProgramFullOutput(script.data(), 10, results.addr()), 0);
+
+  ChangerInventory inventory;
+  ASSERT_TRUE(inventory.Update(results.c_str()));
+  EXPECT_EQ(inventory.LoadedSlot(0), 2);
+  EXPECT_EQ(inventory.LoadedSlot(3), 42);
+}
@@ -0,0 +1,427 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "gtest/gtest.h"
+#include "lib/fastcdc.h"
+#include "stored/backends/dedupable/chunk_store.h"
+#include "stored/backends/dedupable/volume.h"
+#include "tests/temporary_directory.h"
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace dedup;
+
+namespace {
+std::vector<char> RandomData(std::size_t size, std::uint32_t seed)
+{
+  std::mt19937 gen(seed);
+  std::vector<char> data(size);
+  for (auto& c : data) { c = static_cast<char>(gen()); }
+  return data;
+}
+
+std::vector<std::size_t> Cuts(const FastCdcChunker& chunker,
+                              const std::vector<char>& data,
+                              std::size_t offset = 0)
+{
+  std::vector<std::size_t> cuts;
+  const char* ptr = data.data() + offset;
+  std::size_t left = data.size() - offset;
+  while (left > 0) {
+    auto cut = chunker.NextCut(ptr, left);
+    ptr += cut;
+    left -= cut;
+    cuts.push_back(data.size() - left);
+  }
+  return cuts;
+}
+}  // namespace
+
+class ChunkStore : public TemporaryDirectoryTest {};
+class ChunkedVolume : public TemporaryDirectoryTest {};
+
+TEST(FastCdc, RejectsBadSizes)
+{
+  EXPECT_THROW(FastCdcChunker(1000), std::invalid_argument);
+  EXPECT_THROW(FastCdcChunker(4096, 8192, 0), std::invalid_argument);
+  EXPECT_THROW(FastCdcChunker(4096, 0, 2048), std::invalid_argument);
+}
+
+TEST(FastCdc, ChunksStayInsideBounds)
+{
+  FastCdcChunker chunker(4096);
+  auto data = RandomData(1024 * 1024, 1);
+
+  std::size_t last = 0;
+  auto cuts = Cuts(chunker, data);
+  for (std::size_t i = 0; i < cuts.size(); ++i) {
+    auto len = cuts[i] - last;
+    EXPECT_LE(len, chunker.MaxSize());
+    if (i + 1 != cuts.size()) { EXPECT_GE(len, chunker.MinSize()); }
+    last = cuts[i];
+  }
+  EXPECT_EQ(last, data.size());
+
+  // the average should be roughly what we asked for
+  auto avg = data.size() / cuts.size();
+  EXPECT_GT(avg, chunker.AverageSize() / 2);
+  EXPECT_LT(avg, chunker.AverageSize() * 2);
+}
+
+TEST(FastCdc, BoundariesSurviveInsertions)
+{
+  FastCdcChunker chunker(4096);
+  auto data = RandomData(512 * 1024, 2);
+  auto shifted = data;
+  shifted.insert(shifted.begin() + 1000, 17, 'x');
+
+  auto original_cuts = Cuts(chunker, data);
+  auto shifted_cuts = Cuts(chunker, shifted);
+
+  std::set<std::size_t> expected;
+  for (auto cut : original_cuts) {
+    if (cut > 1000) { expected.insert(cut + 17); }
+  }
+  std::size_t common = 0;
+  for (auto cut : shifted_cuts) { common += expected.count(cut); }
+
+  // only the chunks around the insertion point are allowed to change
+  EXPECT_GE(common + 3, expected.size());
+}
+
+TEST_F(ChunkStore, DeduplicatesAndReads)
+{
+  auto store = chunk_store::open((dir / "store").string());
+
+  auto a = RandomData(8000, 3);
+  auto b = RandomData(9000, 4);
+
+  auto id_a = store->insert(a.data(), a.size());
+  auto id_b = store->insert(b.data(), b.size());
+  auto id_a2 = store->insert(a.data(), a.size());
+
+  EXPECT_EQ(id_a, id_a2);
+  EXPECT_NE(id_a, id_b);
+
+  std::vector<char> read(a.size());
+  store->read(id_a, read.data(), read.size());
+  EXPECT_EQ(read, a);
+
+  EXPECT_THROW(store->read(id_b, read.data(), read.size()),
+               std::runtime_error);
+
+  auto stats = store->stats();
+  EXPECT_EQ(stats.chunks, 2u);
+  EXPECT_EQ(stats.stored_bytes, a.size() + b.size());
+  EXPECT_EQ(stats.referenced_bytes, 2 * a.size() + b.size());
+}
+
+TEST_F(ChunkStore, SameStoreIsShared)
+{
+  auto first = chunk_store::open((dir / "store").string());
+  auto second = chunk_store::open((dir / "store").string());
+  EXPECT_EQ(first.get(), second.get());
+}
+
+TEST_F(ChunkStore, WritersSkipFingerprintOfRecentlyReadChunks)
+{
+  auto store = chunk_store::open((dir / "store").string());
+
+  auto a = RandomData(8000, 9);
+  auto id_a = store->insert(a.data(), a.size());
+
+  std::vector<char> read(a.size());
+  store->read(id_a, read.data(), read.size());
+  // nobody writes, so nothing is remembered
+  EXPECT_EQ(store->insert(read.data(), read.size()), id_a);
+  EXPECT_EQ(store->unfingerprinted_bytes(), 0u);
+
+  {
+    chunk_store::write_session session{store};
+    store->read(id_a, read.data(), read.size());
+    EXPECT_EQ(store->insert(read.data(), read.size()), id_a);
+    EXPECT_EQ(store->unfingerprinted_bytes(), a.size());
+
+    // same size and sample, but different content
+    auto changed = read;
+    changed[a.size() / 2] ^= 1;
+    EXPECT_NE(store->insert(changed.data(), changed.size()), id_a);
+    EXPECT_EQ(store->unfingerprinted_bytes(), a.size());
+  }
+
+  auto stats = store->stats();
+  EXPECT_EQ(stats.chunks, 2u);
+  EXPECT_EQ(stats.referenced_bytes, 4 * a.size());
+}
+
+TEST_F(ChunkStore, WritersTakeOverLentReferences)
+{
+  auto store = chunk_store::open((dir / "store").string());
+
+  auto a = RandomData(8000, 10);
+  auto id_a = store->insert(a.data(), a.size());
+  auto fp = chunk_store::compute_fingerprint(a.data(), a.size());
+
+  // nobody wrote the chunk again, so the lent reference is dropped
+  EXPECT_EQ(store->lend(fp, a.size()), id_a);
+  EXPECT_EQ(store->stats().referenced_bytes, 2 * a.size());
+  store->take_back({id_a});
+  EXPECT_EQ(store->stats().referenced_bytes, a.size());
+
+  {
+    chunk_store::write_session session{store};
+    EXPECT_EQ(store->lend(fp, a.size()), id_a);
+    std::vector<char> read(a.size());
+    store->read(id_a, read.data(), read.size());
+    EXPECT_EQ(store->insert(read.data(), read.size()), id_a);
+    // the writer took the lent reference, so there is nothing to take back
+    EXPECT_EQ(store->stats().referenced_bytes, 2 * a.size());
+    store->take_back({id_a});
+    EXPECT_EQ(store->stats().referenced_bytes, 2 * a.size());
+  }
+}
+
+TEST_F(ChunkStore, GarbageCollection)
+{
+  // tiny containers so that every chunk gets its own container
+  auto store = chunk_store::open((dir / "store").string(), 1);
+
+  auto a = RandomData(5000, 5);
+  auto b = RandomData(6000, 6);
+  auto c = RandomData(7000, 7);
+
+  auto id_a = store->insert(a.data(), a.size());
+  auto id_b = store->insert(b.data(), b.size());
+  auto id_c = store->insert(c.data(), c.size());
+
+  store->release({id_a, id_b});
+
+  auto dry = store->CollectGarbage(0.5, true);
+  EXPECT_EQ(dry.chunks_removed, 2u);
+  EXPECT_EQ(store->stats().chunks, 3u);
+
+  auto res = store->CollectGarbage(0.5, false);
+  EXPECT_EQ(res.chunks_removed, 2u);
+  EXPECT_EQ(res.containers_removed, 2u);
+  EXPECT_EQ(res.bytes_freed, a.size() + b.size());
+
+  auto stats = store->stats();
+  EXPECT_EQ(stats.chunks, 1u);
+  EXPECT_EQ(stats.unreferenced_chunks, 0u);
+
+  std::vector<char> read(c.size());
+  store->read(id_c, read.data(), read.size());
+  EXPECT_EQ(read, c);
+
+  // released data can be stored again
+  auto id_a2 = store->insert(a.data(), a.size());
+  EXPECT_NE(id_a, id_a2);
+}
+
+TEST_F(ChunkStore, ConcurrentInserts)
+{
+  // small containers, so the writers often need a new one
+  auto store = chunk_store::open((dir / "store").string(), 64 * 1024);
+
+  constexpr int threads = 4;
+  constexpr int chunks = 50;
+  std::vector<std::vector<std::uint64_t>> ids(threads);
+  std::vector<std::thread> writers;
+  for (int t = 0; t < threads; ++t) {
+    writers.emplace_back([&, t] {
+      // every thread inserts the same chunks
+      for (int i = 0; i < chunks; ++i) {
+        auto data = RandomData(4000 + i, i);
+        ids[t].push_back(store->insert(data.data(), data.size()));
+      }
+    });
+  }
+  for (auto& writer : writers) { writer.join(); }
+  store->flush();
+
+  for (int i = 0; i < chunks; ++i) {
+    auto data = RandomData(4000 + i, i);
+    std::vector<char> read(data.size());
+    store->read(ids[0][i], read.data(), read.size());
+    EXPECT_EQ(read, data);
+    for (int t = 1; t < threads; ++t) { EXPECT_EQ(ids[t][i], ids[0][i]); }
+  }
+
+  auto stats = store->stats();
+  EXPECT_EQ(stats.chunks, std::uint64_t{chunks});
+  EXPECT_EQ(stats.unreferenced_chunks, 0u);
+  // new containers are created outside of the container directory
+  for (auto& entry : std::filesystem::directory_iterator{dir / "store"}) {
+    EXPECT_EQ(entry.path().filename().string().rfind("new-", 0),
+              std::string::npos);
+  }
+}
+
+TEST_F(ChunkStore, ReferencedChunksSurviveGarbageCollection)
+{
+  auto store = chunk_store::open((dir / "store").string(), 1);
+
+  auto a = RandomData(5000, 8);
+  auto b = RandomData(6000, 9);
+  auto fp_a = chunk_store::compute_fingerprint(a.data(), a.size());
+  auto fp_b = chunk_store::compute_fingerprint(b.data(), b.size());
+
+  EXPECT_FALSE(store->reference(fp_a, a.size()));
+
+  auto id_a = store->insert(a.data(), a.size());
+  auto id_b = store->insert(b.data(), b.size());
+  store->release({id_a, id_b});
+
+  // unreferenced chunks can still be picked up until they are collected
+  auto pinned = store->reference(fp_a, a.size());
+  ASSERT_TRUE(pinned);
+  EXPECT_EQ(*pinned, id_a);
+  EXPECT_FALSE(store->reference(fp_a, a.size() - 1));
+
+  auto res = store->CollectGarbage(0.5, false);
+  EXPECT_EQ(res.chunks_removed, 1u);
+  EXPECT_FALSE(store->reference(fp_b, b.size()));
+
+  std::vector<char> read(a.size());
+  store->read(*pinned, read.data(), read.size());
+  EXPECT_EQ(read, a);
+
+  store->release({*pinned});
+  EXPECT_EQ(store->CollectGarbage(0.5, false).chunks_removed, 1u);
+  EXPECT_FALSE(store->reference(fp_a, a.size()));
+}
+
+TEST_F(ChunkedVolume, RoundTripAndRelease)
+{
+  std::string store_path = (dir / "store").string();
+  std::string vol_path = (dir / "vol").string();
+  chunk_config chunking{store_path, 4096};
+
+  volume::create_new(0640, vol_path.c_str(), 4096, chunking);
+
+  auto payload = RandomData(64 * 1024, 8);
+  std::vector<char> written;
+  {
+    volume vol{volume::open_type::ReadWrite, vol_path.c_str()};
+    ASSERT_TRUE(vol.is_chunked());
+
+    for (std::uint32_t blocknum = 0; blocknum < 2; ++blocknum) {
+      record_header rec{};
+      rec.FileIndex = 1;
+      rec.Stream = 2;
+      rec.DataSize = payload.size();
+
+      block_header hdr{};
+      hdr.BlockSize = sizeof(hdr) + sizeof(rec) + payload.size();
+      hdr.BlockNumber = blocknum;
+      hdr.VolSessionId = 1;
+      hdr.VolSessionTime = 2;
+
+      auto save = vol.BeginBlock(hdr);
+      vol.PushRecord(rec, payload.data(), payload.size());
+      vol.CommitBlock(std::move(save));
+
+      if (blocknum == 0) {
+        written.resize(hdr.BlockSize);
+        char* out = written.data();
+        std::memcpy(out, &hdr, sizeof(hdr));
+        std::memcpy(out + sizeof(hdr), &rec, sizeof(rec));
+        std::memcpy(out + sizeof(hdr) + sizeof(rec), payload.data(),
+                    payload.size());
+      }
+    }
+    vol.flush();
+  }
+
+  auto store = chunk_store::open(store_path);
+  auto stats = store->stats();
+  // both blocks carry the same payload, so it is only stored once
+  EXPECT_LT(stats.stored_bytes, payload.size() + 1);
+  EXPECT_GT(stats.referenced_bytes, stats.stored_bytes);
+
+  {
+    volume vol{volume::open_type::ReadOnly, vol_path.c_str()};
+    std::vector<char> read(written.size());
+    ASSERT_EQ(vol.ReadBlock(0, read.data(), read.size()), written.size());
+    EXPECT_EQ(read, written);
+  }
+
+  {
+    volume vol{volume::open_type::ReadWrite, vol_path.c_str()};
+    vol.reset();
+  }
+
+  EXPECT_EQ(store->stats().referenced_bytes, 0u);
+}
+
+TEST_F(ChunkedVolume, CopyBetweenVolumesSkipsFingerprints)
+{
+  std::string store_path = (dir / "store").string();
+  std::string source_path = (dir / "source").string();
+  std::string target_path = (dir / "target").string();
+  chunk_config chunking{store_path, 4096};
+
+  volume::create_new(0640, source_path.c_str(), 4096, chunking);
+  volume::create_new(0640, target_path.c_str(), 4096, chunking);
+
+  auto payload = RandomData(64 * 1024, 10);
+  record_header rec{};
+  rec.FileIndex = 1;
+  rec.Stream = 2;
+  rec.DataSize = payload.size();
+
+  block_header hdr{};
+  hdr.BlockSize = sizeof(hdr) + sizeof(rec) + payload.size();
+  hdr.VolSessionId = 1;
+  hdr.VolSessionTime = 2;
+
+  {
+    volume source{volume::open_type::ReadWrite, source_path.c_str()};
+    auto save = source.BeginBlock(hdr);
+    source.PushRecord(rec, payload.data(), payload.size());
+    source.CommitBlock(std::move(save));
+    source.flush();
+  }
+
+  auto store = chunk_store::open(store_path);
+  auto stored = store->stats().stored_bytes;
+
+  volume source{volume::open_type::ReadOnly, source_path.c_str()};
+  volume target{volume::open_type::ReadWrite, target_path.c_str()};
+
+  std::vector<char> block(hdr.BlockSize);
+  ASSERT_EQ(source.ReadBlock(0, block.data(), block.size()), block.size());
+
+  hdr.VolSessionId = 3;
+  auto save = target.BeginBlock(hdr);
+  target.PushRecord(rec, block.data() + sizeof(hdr) + sizeof(rec),
+                    payload.size());
+  target.CommitBlock(std::move(save));
+  target.flush();
+
+  // all chunks were taken from the read cache; nothing new got stored
+  EXPECT_GT(store->unfingerprinted_bytes(), payload.size() / 2);
+  EXPECT_EQ(store->stats().stored_bytes, stored);
+}
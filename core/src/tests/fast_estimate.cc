@@ -0,0 +1,168 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "filed/fast_estimate.h"
+#include "lib/thread_pool.h"
+#include "tests/temporary_directory.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace filedaemon;
+
+namespace {
+class FastEstimateTest : public TemporaryDirectoryTest {
+ protected:
+  void MakeFile(const fs::path& path, std::size_t size)
+  {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << std::string(size, 'x');
+  }
+
+  FastEstimateOptions Options(std::size_t workers = 4)
+  {
+    FastEstimateOptions options;
+    options.sets.emplace_back();
+    options.sets.back().paths.push_back(dir.string());
+    options.workers = workers;
+    return options;
+  }
+
+  thread_pool pool;
+};
+
+class RejectLogs : public EstimateFilter {
+ public:
+  bool Accept(std::size_t, const char* path, const struct stat&) override
+  {
+    std::string name = fs::path(path).filename().string();
+    return name != "skip" && fs::path(path).extension() != ".log";
+  }
+};
+}  // namespace
+
+TEST_F(FastEstimateTest, CountsFilesAndBytes)
+{
+  MakeFile(dir / "a" / "one", 100);
+  MakeFile(dir / "a" / "b" / "two", 20);
+  MakeFile(dir / "three", 3);
+  fs::create_hard_link(dir / "three", dir / "a" / "b" / "link");
+  fs::create_symlink("one", dir / "a" / "symlink");
+
+  for (std::size_t workers : {1, 4}) {
+    auto result = FastEstimate(Options(workers), pool);
+    // dir, a, b, one, two, three, link, symlink
+    EXPECT_EQ(result.files, 8u);
+    EXPECT_EQ(result.bytes, 123u);
+    EXPECT_EQ(result.directories_read, 3u);
+    EXPECT_FALSE(result.Sampled());
+    EXPECT_EQ(result.estimated_files, 8.0);
+    EXPECT_EQ(result.estimated_bytes, 123.0);
+  }
+}
+
+TEST_F(FastEstimateTest, AppliesTheFilter)
+{
+  MakeFile(dir / "keep", 10);
+  MakeFile(dir / "debug.log", 1000);
+  MakeFile(dir / "skip" / "inside", 1000);
+
+  auto options = Options();
+  options.make_filter = [] { return std::make_unique<RejectLogs>(); };
+  auto result = FastEstimate(options, pool);
+  EXPECT_EQ(result.files, 2u);
+  EXPECT_EQ(result.bytes, 10u);
+  EXPECT_EQ(result.directories_read, 1u);
+}
+
+TEST_F(FastEstimateTest, IgnoredirAndNoRecursion)
+{
+  MakeFile(dir / "ignored" / ".nobackup", 0);
+  MakeFile(dir / "ignored" / "data", 1000);
+  MakeFile(dir / "sub" / "data", 1000);
+  MakeFile(dir / "file", 1);
+
+  auto options = Options();
+  options.sets[0].ignoredir.push_back(".nobackup");
+  options.sets[0].recurse = false;
+  auto result = FastEstimate(options, pool);
+  // dir, sub, file
+  EXPECT_EQ(result.files, 3u);
+  EXPECT_EQ(result.bytes, 1u);
+}
+
+TEST_F(FastEstimateTest, CountsOnlyChangedFiles)
+{
+  MakeFile(dir / "old", 10);
+  MakeFile(dir / "sub" / "new", 20);
+  auto old = fs::last_write_time(dir / "old") - std::chrono::hours(48);
+  fs::last_write_time(dir / "old", old);
+
+  auto options = Options();
+  options.sets[0].mtime_only = true;
+  options.since_time = time(nullptr) - 3600;
+  auto result = FastEstimate(options, pool);
+  // directories are always counted
+  EXPECT_EQ(result.files, 3u);
+  EXPECT_EQ(result.bytes, 20u);
+}
+
+TEST_F(FastEstimateTest, ExtrapolatesWhenOutOfTime)
+{
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      MakeFile(dir / std::to_string(i) / std::to_string(j), 10);
+    }
+  }
+
+  auto options = Options();
+  options.time_limit = std::chrono::seconds(0);
+  auto result = FastEstimate(options, pool);
+  EXPECT_TRUE(result.Sampled());
+  EXPECT_EQ(result.files, 1u);
+  EXPECT_EQ(result.directories_left, 1u);
+  EXPECT_GE(result.samples, 1u);
+  // every path down the tree looks the same, so the estimate is exact
+  EXPECT_DOUBLE_EQ(result.estimated_files, 25.0);
+  EXPECT_DOUBLE_EQ(result.estimated_bytes, 200.0);
+  EXPECT_DOUBLE_EQ(result.files_error, 0.0);
+}
+
+TEST_F(FastEstimateTest, SamplesSkipLinksAlreadyCounted)
+{
+  MakeFile(dir / "file", 100);
+  fs::create_directories(dir / "tree");
+  fs::create_hard_link(dir / "file", dir / "tree" / "link");
+
+  FastEstimateOptions options;
+  options.sets.emplace_back();
+  options.sets.back().paths
+      = {(dir / "file").string(), (dir / "tree").string()};
+  options.time_limit = std::chrono::seconds(0);
+  auto result = FastEstimate(options, pool);
+  ASSERT_TRUE(result.Sampled());
+  // file, tree and the link found by the samples
+  EXPECT_DOUBLE_EQ(result.estimated_files, 3.0);
+  EXPECT_DOUBLE_EQ(result.estimated_bytes, 100.0);
+}
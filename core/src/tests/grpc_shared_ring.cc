@@ -0,0 +1,89 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#include "gtest/gtest.h"
+#include "plugins/filed/grpc/shared_memory.h"
+
+#include <cstring>
+#include <fcntl.h>
+
+TEST(SharedRing, RejectsEmptyRings)
+{
+  EXPECT_FALSE(SharedRing::Create(0, 4));
+  EXPECT_FALSE(SharedRing::Create(4096, 0));
+}
+
+TEST(SharedRing, SlotsWrapAround)
+{
+  auto ring = SharedRing::Create(4096, 3);
+  if (!ring) { GTEST_SKIP() << "memfd not available: " << strerror(errno); }
+
+  EXPECT_EQ(ring->size(), 3u * 4096);
+  EXPECT_EQ(ring->NextSlot(), 0u);
+  EXPECT_EQ(ring->NextSlot(), 4096u);
+  EXPECT_EQ(ring->NextSlot(), 8192u);
+  EXPECT_EQ(ring->NextSlot(), 0u);
+  EXPECT_EQ(ring->NextSlot(), 4096u);
+}
+
+TEST(SharedRing, ContainsOnlyWholeSlots)
+{
+  auto ring = SharedRing::Create(4096, 2);
+  if (!ring) { GTEST_SKIP() << "memfd not available: " << strerror(errno); }
+
+  EXPECT_TRUE(ring->Contains(0, 0));
+  EXPECT_TRUE(ring->Contains(0, 4096));
+  EXPECT_TRUE(ring->Contains(4096, 4096));
+
+  // larger than a slot
+  EXPECT_FALSE(ring->Contains(0, 4097));
+  EXPECT_FALSE(ring->Contains(4096, 4097));
+  // not the start of a slot
+  EXPECT_FALSE(ring->Contains(1, 16));
+  EXPECT_FALSE(ring->Contains(4095, 1));
+  // behind the ring
+  EXPECT_FALSE(ring->Contains(8192, 0));
+  EXPECT_FALSE(ring->Contains(UINT64_MAX - 4095, 16));
+}
+
+TEST(SharedRing, MappedRegionIsShared)
+{
+  auto ring = SharedRing::Create(4096, 2);
+  if (!ring) { GTEST_SKIP() << "memfd not available: " << strerror(errno); }
+
+  auto other = SharedRing::Map(fcntl(ring->fd(), F_DUPFD_CLOEXEC, 0),
+                               ring->slot_size(), ring->slot_count());
+  ASSERT_TRUE(other);
+
+  auto offset = ring->NextSlot();
+  std::strcpy(ring->at(offset), "shared");
+  EXPECT_STREQ(other->at(offset), "shared");
+}
+
+TEST(SharedRing, MapRejectsTooSmallRegions)
+{
+  auto ring = SharedRing::Create(4096, 2);
+  if (!ring) { GTEST_SKIP() << "memfd not available: " << strerror(errno); }
+
+  EXPECT_FALSE(SharedRing::Map(fcntl(ring->fd(), F_DUPFD_CLOEXEC, 0), 4096,
+                               3));
+  EXPECT_EQ(errno, EINVAL);
+}
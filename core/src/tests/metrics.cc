@@ -0,0 +1,131 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+
+#include "lib/metrics.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using metrics::Registry;
+
+namespace {
+bool Contains(const std::string& text, const std::string& line)
+{
+  return text.find(line + "\n") != std::string::npos;
+}
+}  // namespace
+
+TEST(Metrics, CounterIsRenderedWithTotalSuffix)
+{
+  Registry registry;
+  registry.GetCounter("bytes", "Bytes seen", {{"device", "FileStorage"}})
+      .Add(42);
+
+  auto text = registry.Render();
+  EXPECT_TRUE(Contains(text, "# TYPE bytes counter"));
+  EXPECT_TRUE(Contains(text, "# HELP bytes Bytes seen"));
+  EXPECT_TRUE(Contains(text, "bytes_total{device=\"FileStorage\"} 42"));
+  EXPECT_EQ(text.substr(text.size() - 6), "# EOF\n");
+}
+
+TEST(Metrics, SameLabelsReturnSameMetric)
+{
+  Registry registry;
+  auto& a = registry.GetGauge("jobs", "Jobs", {{"state", "running"}});
+  auto& b = registry.GetGauge("jobs", "Jobs", {{"state", "running"}});
+  auto& c = registry.GetGauge("jobs", "Jobs", {{"state", "waiting"}});
+  EXPECT_EQ(&a, &b);
+  EXPECT_NE(&a, &c);
+
+  a.Set(5);
+  c.Add(2);
+  c.Add(-1);
+  auto text = registry.Render();
+  EXPECT_TRUE(Contains(text, "jobs{state=\"running\"} 5"));
+  EXPECT_TRUE(Contains(text, "jobs{state=\"waiting\"} 1"));
+}
+
+TEST(Metrics, HistogramBucketsAreCumulative)
+{
+  Registry registry;
+  auto& histogram
+      = registry.GetHistogram("latency", "Latency", {}, {0.1, 1, 10});
+  histogram.Observe(0.05);
+  histogram.Observe(0.1);
+  histogram.Observe(5);
+  histogram.Observe(50);
+
+  auto text = registry.Render();
+  EXPECT_TRUE(Contains(text, "# TYPE latency histogram"));
+  EXPECT_TRUE(Contains(text, "latency_bucket{le=\"0.1\"} 2"));
+  EXPECT_TRUE(Contains(text, "latency_bucket{le=\"1\"} 2"));
+  EXPECT_TRUE(Contains(text, "latency_bucket{le=\"10\"} 3"));
+  EXPECT_TRUE(Contains(text, "latency_bucket{le=\"+Inf\"} 4"));
+  EXPECT_TRUE(Contains(text, "latency_count 4"));
+  EXPECT_DOUBLE_EQ(histogram.Take().sum, 55.15);
+}
+
+TEST(Metrics, ConcurrentUpdatesAreNotLost)
+{
+  Registry registry;
+  auto& counter = registry.GetCounter("ops", "Operations");
+  auto& histogram = registry.GetHistogram("size", "Sizes", {}, {1});
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 10000; ++j) {
+        counter.Add();
+        histogram.Observe(2);
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  EXPECT_EQ(counter.Value(), 40000u);
+  auto snap = histogram.Take();
+  EXPECT_EQ(snap.cumulative.back(), 40000u);
+  EXPECT_DOUBLE_EQ(snap.sum, 80000);
+}
+
+TEST(Metrics, CollectorsAreCalledOnRenderUntilRemoved)
+{
+  Registry registry;
+  int calls = 0;
+  auto id = registry.AddCollector([&calls](metrics::Writer& writer) {
+    ++calls;
+    writer.Family("spool_bytes", "gauge", "Spooled \"data\"");
+    writer.Sample("spool_bytes", {{"kind", "data"}}, std::int64_t{7});
+  });
+
+  auto text = registry.Render();
+  EXPECT_EQ(calls, 1);
+  EXPECT_TRUE(Contains(text, "# HELP spool_bytes Spooled \\\"data\\\""));
+  EXPECT_TRUE(Contains(text, "spool_bytes{kind=\"data\"} 7"));
+
+  registry.RemoveCollector(id);
+  text = registry.Render();
+  EXPECT_EQ(calls, 1);
+  EXPECT_FALSE(Contains(text, "spool_bytes{kind=\"data\"} 7"));
+  EXPECT_EQ(text, "# EOF\n");
+}
@@ -0,0 +1,147 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+
+#include "lib/pipeline_stats.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+void AddTime(PipelineStats& stats,
+             PipelineStage stage,
+             std::chrono::milliseconds time,
+             std::uint64_t bytes)
+{
+  auto start = PipelineStats::clock::now();
+  stats.Add(stage, start, start + time, bytes);
+}
+}  // namespace
+
+TEST(PipelineStats, SumsTimeAndBytesPerStage)
+{
+  PipelineStats stats;
+  EXPECT_TRUE(stats.Empty());
+
+  AddTime(stats, PipelineStage::kRead, 10ms, 1000);
+  AddTime(stats, PipelineStage::kRead, 20ms, 500);
+  AddTime(stats, PipelineStage::kSend, 5ms, 1500);
+
+  EXPECT_FALSE(stats.Empty());
+  auto read = stats.Get(PipelineStage::kRead);
+  EXPECT_EQ(read.time, 30ms);
+  EXPECT_EQ(read.bytes, 1500u);
+  EXPECT_EQ(read.items, 2u);
+  EXPECT_EQ(stats.Get(PipelineStage::kCompress).items, 0u);
+}
+
+TEST(PipelineStats, ReportNamesSlowestStage)
+{
+  PipelineStats stats;
+  AddTime(stats, PipelineStage::kRead, 100ms, 1 << 20);
+  AddTime(stats, PipelineStage::kCompress, 700ms, 1 << 20);
+  AddTime(stats, PipelineStage::kSend, 50ms, 1 << 19);
+  stats.Add(PipelineStage::kCatalogInsert, PipelineStats::clock::now(),
+            PipelineStats::clock::now(), 0, 42);
+
+  auto report = stats.Report(1s);
+  EXPECT_NE(report.find("  read "), std::string::npos);
+  EXPECT_NE(report.find("  compress "), std::string::npos);
+  EXPECT_NE(report.find("  send "), std::string::npos);
+  EXPECT_NE(report.find("42 items"), std::string::npos);
+  EXPECT_EQ(report.find("  digest "), std::string::npos);
+  EXPECT_NE(report.find("Bottleneck: compress (70% of 1.000 s)"),
+            std::string::npos)
+      << report;
+}
+
+TEST(PipelineStats, WaitingIsNoBottleneck)
+{
+  PipelineStats stats;
+  AddTime(stats, PipelineStage::kUpstreamWait, 900ms, 0);
+  AddTime(stats, PipelineStage::kReceive, 50ms, 1 << 20);
+  AddTime(stats, PipelineStage::kSpoolWrite, 30ms, 1 << 20);
+
+  auto report = stats.Report(1s);
+  EXPECT_NE(report.find("  upstream-wait "), std::string::npos);
+  EXPECT_NE(report.find("  spool-write "), std::string::npos);
+  EXPECT_NE(report.find("Bottleneck: receive (5% of 1.000 s)"),
+            std::string::npos)
+      << report;
+}
+
+TEST(PipelineStats, TimersFromManyThreadsAreCounted)
+{
+  PipelineStats stats;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&stats]() {
+      for (int j = 0; j < 1000; ++j) {
+        StageTimer timer(stats, PipelineStage::kDigest);
+        timer.SetBytes(10);
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  auto digest = stats.Get(PipelineStage::kDigest);
+  EXPECT_EQ(digest.items, 4000u);
+  EXPECT_EQ(digest.bytes, 40000u);
+}
+
+TEST(PipelineStats, TraceContainsRecordedSections)
+{
+  PipelineStats stats;
+  AddTime(stats, PipelineStage::kRead, 1ms, 10);  // before tracing
+  stats.EnableTrace(2);
+  AddTime(stats, PipelineStage::kRead, 3ms, 20);
+  AddTime(stats, PipelineStage::kDeviceWrite, 2ms, 30);
+  AddTime(stats, PipelineStage::kDeviceWrite, 2ms, 40);  // dropped
+
+  char path[] = "/tmp/pipeline_stats_test.XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  ASSERT_TRUE(stats.WriteTrace(path, "bareos-fd test"));
+
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  std::remove(path);
+  auto trace = content.str();
+
+  EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+  EXPECT_NE(trace.find("\"args\":{\"name\":\"bareos-fd test\"}"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"read\""), std::string::npos);
+  EXPECT_NE(trace.find("\"dur\":3000,\"args\":{\"bytes\":20}"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"device-write\""), std::string::npos);
+  EXPECT_EQ(trace.find("\"bytes\":10}"), std::string::npos);
+  EXPECT_EQ(trace.find("\"bytes\":40}"), std::string::npos);
+  EXPECT_NE(trace.find("\"dropped_events\":\"1\""), std::string::npos);
+}
@@ -0,0 +1,211 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "include/filetypes.h"
+
+#include "findlib/bfile.h"
+#include "findlib/restore_metadata.h"
+#include "lib/attr.h"
+#include "tests/temporary_directory.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+class RestoreMetadata : public TemporaryDirectoryTest {
+ protected:
+  void SetUp() override
+  {
+    if (!RestoreMetadataQueue::Supported()) { GTEST_SKIP(); }
+    TemporaryDirectoryTest::SetUp();
+  }
+
+  Attributes MakeAttr(const fs::path& path, int type, mode_t mode, time_t t)
+  {
+    Attributes attr{};
+    attr.type = type;
+    attr.ofname = GetPoolMemory(PM_FNAME);
+    PmStrcpy(attr.ofname, path.c_str());
+    attr.statp.st_uid = getuid();
+    attr.statp.st_gid = getgid();
+    attr.statp.st_mode = mode;
+    attr.statp.st_atime = t;
+    attr.statp.st_mtime = t;
+    return attr;
+  }
+
+  struct stat Stat(const fs::path& path)
+  {
+    struct stat st{};
+    EXPECT_EQ(lstat(path.c_str(), &st), 0) << path;
+    return st;
+  }
+
+  thread_pool pool;
+};
+}  // namespace
+
+TEST(DirectoryFdCache, EvictsLeastRecentlyUsed)
+{
+  DirectoryFdCache cache(2);
+
+  auto root = cache.Get("/");
+  ASSERT_NE(root, nullptr);
+  EXPECT_EQ(cache.Get("/"), root);
+  ASSERT_NE(cache.Get("."), nullptr);
+  EXPECT_EQ(cache.misses(), 2u);
+
+  ASSERT_NE(cache.Get("/tmp"), nullptr);
+  EXPECT_EQ(cache.size(), 2u);
+
+  // "/" was used least recently, so it has to be opened again
+  EXPECT_NE(cache.Get("/"), nullptr);
+  EXPECT_EQ(cache.misses(), 4u);
+
+  EXPECT_EQ(cache.Get("/does/not/exist"), nullptr);
+}
+
+TEST(RestoreMetadataQueueEntry, SplitsPath)
+{
+  struct stat st{};
+  auto entry = RestoreMetadataQueue::MakeEntry("/a/b/c/", FT_DIREND, st);
+  EXPECT_EQ(entry.path, "/a/b/c");
+  EXPECT_EQ(entry.path.substr(entry.name_offset), "c");
+  EXPECT_EQ(entry.depth, 3u);
+
+  entry = RestoreMetadataQueue::MakeEntry("file", FT_REG, st);
+  EXPECT_EQ(entry.name_offset, 0u);
+  EXPECT_EQ(entry.depth, 0u);
+}
+
+TEST_F(RestoreMetadata, AppliesModeAndTimes)
+{
+  RestoreMetadataQueue queue(nullptr, pool, 2);
+
+  std::vector<Attributes> files;
+  for (int i = 0; i < 200; ++i) {
+    fs::path path = dir / ("file" + std::to_string(i));
+    std::ofstream{path} << "x";
+    files.push_back(MakeAttr(path, FT_REG, S_IFREG | 0640, 1000000 + i));
+  }
+
+  BareosFilePacket bfd;
+  binit(&bfd);
+  for (auto& attr : files) {
+    ASSERT_TRUE(queue.Submit(&attr, &bfd));
+    EXPECT_STREQ(attr.ofname, "*None*");
+  }
+  EXPECT_EQ(queue.Finish(), 0u);
+
+  for (int i = 0; i < 200; ++i) {
+    auto st = Stat(dir / ("file" + std::to_string(i)));
+    EXPECT_EQ(st.st_mode & 07777, 0640u);
+    EXPECT_EQ(st.st_mtime, 1000000 + i);
+  }
+  for (auto& attr : files) { FreePoolMemory(attr.ofname); }
+}
+
+TEST_F(RestoreMetadata, SetsDirectoryMetadataLast)
+{
+  RestoreMetadataQueue queue(nullptr, pool, 1);
+  BareosFilePacket bfd;
+  binit(&bfd);
+
+  fs::path outer = dir / "outer";
+  fs::path inner = outer / "inner";
+  fs::create_directories(inner);
+  fs::permissions(inner, fs::perms(0755));
+
+  // directories are sent after their contents
+  auto inner_attr = MakeAttr(inner, FT_DIREND, S_IFDIR | 0500, 2000000);
+  ASSERT_TRUE(queue.Submit(&inner_attr, &bfd));
+  EXPECT_EQ(Stat(inner).st_mode & 07777, 0755u);
+
+  auto outer_attr = MakeAttr(outer, FT_DIREND, S_IFDIR | 0755, 3000000);
+  ASSERT_TRUE(queue.Submit(&outer_attr, &bfd));
+
+  // anything created afterwards must not change the restored times
+  std::ofstream{inner / "late"} << "x";
+  std::ofstream{outer / "late"} << "x";
+
+  EXPECT_EQ(queue.Finish(), 0u);
+  EXPECT_EQ(Stat(inner).st_mode & 07777, 0500u);
+  EXPECT_EQ(Stat(inner).st_mtime, 2000000);
+  EXPECT_EQ(Stat(outer).st_mtime, 3000000);
+
+  fs::permissions(inner, fs::perms(0755));
+  FreePoolMemory(inner_attr.ofname);
+  FreePoolMemory(outer_attr.ofname);
+}
+
+TEST_F(RestoreMetadata, AppliesDirectoriesEarlyWhenTooMany)
+{
+  RestoreMetadataQueue queue(nullptr, pool, 2, 2);
+  BareosFilePacket bfd;
+  binit(&bfd);
+
+  std::vector<Attributes> attrs;
+  for (int i = 0; i < 3; ++i) {
+    fs::path sub = dir / ("sub" + std::to_string(i));
+    fs::create_directories(sub);
+    fs::path file = sub / "file";
+    std::ofstream{file} << "x";
+    attrs.push_back(MakeAttr(file, FT_REG, S_IFREG | 0600, 1000000));
+    attrs.push_back(MakeAttr(sub, FT_DIREND, S_IFDIR | 0700, 2000000 + i));
+  }
+
+  for (auto& attr : attrs) { ASSERT_TRUE(queue.Submit(&attr, &bfd)); }
+
+  // the first two directories were applied together with their contents
+  EXPECT_EQ(Stat(dir / "sub0" / "file").st_mode & 07777, 0600u);
+  EXPECT_EQ(Stat(dir / "sub0").st_mtime, 2000000);
+  EXPECT_EQ(Stat(dir / "sub1").st_mtime, 2000001);
+  EXPECT_NE(Stat(dir / "sub2").st_mtime, 2000002);
+
+  EXPECT_EQ(queue.Finish(), 0u);
+  EXPECT_EQ(Stat(dir / "sub2").st_mode & 07777, 0700u);
+  EXPECT_EQ(Stat(dir / "sub2").st_mtime, 2000002);
+
+  for (auto& attr : attrs) { FreePoolMemory(attr.ofname); }
+}
+
+TEST_F(RestoreMetadata, KeepsLinkTarget)
+{
+  fs::path target = dir / "target";
+  std::ofstream{target} << "x";
+  fs::permissions(target, fs::perms(0600));
+  fs::create_symlink(target, dir / "link");
+
+  RestoreMetadataQueue queue(nullptr, pool, 1);
+  BareosFilePacket bfd;
+  binit(&bfd);
+
+  auto attr = MakeAttr(dir / "link", FT_LNK, S_IFLNK | 0777, 4000000);
+  ASSERT_TRUE(queue.Submit(&attr, &bfd));
+  EXPECT_EQ(queue.Finish(), 0u);
+
+  EXPECT_EQ(Stat(target).st_mode & 07777, 0600u);
+  FreePoolMemory(attr.ofname);
+}
@@ -214,6 +214,12 @@ class MockDatabase : public BareosDb {
   {
     return true;
   }
+  virtual bool SqlQueryPreparedWithoutHandler(SQL_QUERY,
+                                              const SqlParam*,
+                                              int) override
+  {
+    return true;
+  }
   virtual const char* sql_strerror(void) override { return ""; }
   virtual void SqlDataSeek(int) override {}
   virtual int SqlAffectedRows(void) override { return 0; }
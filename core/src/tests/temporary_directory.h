@@ -0,0 +1,53 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+
+#ifndef BAREOS_TESTS_TEMPORARY_DIRECTORY_H_
+#define BAREOS_TESTS_TEMPORARY_DIRECTORY_H_
+
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+
+/* Fixture for tests that work on files: every test gets an empty directory
+ * named after the test suite, which is removed again afterwards. */
+class TemporaryDirectoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    std::string suite
+        = ::testing::UnitTest::GetInstance()->current_test_suite()->name();
+    dir = std::filesystem::temp_directory_path()
+          / (suite + "_" + std::to_string(getpid()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+  }
+  void TearDown() override
+  {
+    if (!dir.empty()) { std::filesystem::remove_all(dir); }
+  }
+
+  std::filesystem::path dir;
+};
+
+#endif  // BAREOS_TESTS_TEMPORARY_DIRECTORY_H_
@@ -43,6 +43,7 @@
 #include "dird/dird_globals.h"
 
 #include "lib/tls/openssl.h"
+#include "lib/bsock_striped.h"
 #include "lib/bsock_tcp.h"
 #include "lib/bnet.h"
 #include "lib/bstringlist.h"
@@ -853,3 +854,137 @@ TEST(BNet, FormatAndSendResponseMessage)
   std::string test("1000 Test123");
   EXPECT_STREQ(args.JoinReadable().c_str(), test.c_str());
 }
+
+static std::string ReceiveBytes(BareosSocket* bs, std::size_t size)
+{
+  std::string received;
+  while (received.size() < size) {
+    int32_t len = bs->recv();
+    if (len <= 0) { break; }
+    received.append(bs->msg, len);
+  }
+  return received;
+}
+
+static void SendAndReceiveFragments(bool zerocopy)
+{
+  std::unique_ptr<TestSockets> test_sockets(
+      create_connected_server_and_client_bareos_socket());
+  ASSERT_NE(test_sockets.get(), nullptr)
+      << "Could not create Bareos test sockets.";
+
+  test_sockets->client->SetZeroCopy(zerocopy);
+
+  // a small message and one that needs more than one packet
+  std::string header("header");
+  std::string data(2'500'000, 'x');
+  for (std::size_t i = 0; i < data.size(); ++i) { data[i] = 'a' + i % 26; }
+
+  std::span<const char> fragments[] = {header, {}, data};
+  std::string expected = header + data;
+
+  auto received = std::async(std::launch::async, [&] {
+    auto first = ReceiveBytes(test_sockets->server.get(), header.size());
+    return first + ReceiveBytes(test_sockets->server.get(), expected.size());
+  });
+
+  std::span<const char> small[] = {header};
+  EXPECT_TRUE(test_sockets->client->SendFragments(small));
+  EXPECT_TRUE(test_sockets->client->SendFragments(fragments));
+
+  EXPECT_EQ(received.get(), header + expected);
+}
+
+TEST(BNet, SendFragments) { SendAndReceiveFragments(false); }
+
+TEST(BNet, SendFragmentsZeroCopy) { SendAndReceiveFragments(true); }
+
+TEST(BNet, SendFragmentsReleasesOwnedData)
+{
+  std::unique_ptr<TestSockets> test_sockets(
+      create_connected_server_and_client_bareos_socket());
+  ASSERT_NE(test_sockets.get(), nullptr)
+      << "Could not create Bareos test sockets.";
+
+  test_sockets->client->SetZeroCopy(true);
+
+  constexpr std::size_t message_size = 100'000;
+  constexpr int num_messages = 8;
+  auto received = std::async(std::launch::async, [&] {
+    return ReceiveBytes(test_sockets->server.get(),
+                        message_size * num_messages);
+  });
+
+  // the socket holds on to the messages at most until it is closed
+  std::string expected;
+  std::vector<std::weak_ptr<const std::string>> messages;
+  for (int i = 0; i < num_messages; ++i) {
+    auto data = std::make_shared<const std::string>(message_size, 'a' + i);
+    std::span<const char> fragments[] = {*data};
+    EXPECT_TRUE(test_sockets->client->SendFragments(fragments, data));
+    expected += *data;
+    messages.push_back(data);
+  }
+
+  EXPECT_EQ(received.get(), expected);
+  test_sockets->client->close();
+  for (auto& message : messages) { EXPECT_TRUE(message.expired()); }
+}
+
+TEST(BNet, StripedSendAndReceive)
+{
+  std::vector<std::unique_ptr<TestSockets>> pairs;
+  std::vector<BareosSocket*> clients, servers;
+  for (int i = 0; i < 3; ++i) {
+    auto& pair = pairs.emplace_back(
+        create_connected_server_and_client_bareos_socket());
+    ASSERT_NE(pair.get(), nullptr) << "Could not create Bareos test sockets.";
+    clients.push_back(pair->client.get());
+    servers.push_back(pair->server.get());
+  }
+
+  BareosSocketTCP owner;
+  StripedSender sender(&owner, clients);
+  StripedReceiver receiver(servers, 16);
+
+  std::vector<std::string> messages;
+  for (std::size_t i = 0; i < 500; ++i) {
+    messages.emplace_back(i * 37 % 5000, 'a' + i % 26);
+  }
+  // gets split into two frames
+  std::string big(striping::max_payload + 100, 'x');
+
+  auto sent = std::async(std::launch::async, [&] {
+    bool ok = true;
+    for (auto& message : messages) {
+      std::span<const char> fragment{message};
+      ok = ok && sender.Send({&fragment, 1});
+    }
+    std::span<const char> fragments[] = {big, {}};
+    ok = ok && sender.Send(fragments);
+    return ok && sender.Signal(BNET_EOD);
+  });
+
+  messages.push_back(big.substr(0, striping::max_payload));
+  messages.push_back(big.substr(striping::max_payload));
+  for (auto& message : messages) {
+    auto msg = receiver.Next();
+    if (!msg) { break; }
+    EXPECT_EQ(msg->status, static_cast<int32_t>(message.size()));
+    if (msg->status < 0) { break; }
+    EXPECT_EQ(std::string(msg->data.c_str(), msg->status), message);
+  }
+
+  auto eod = receiver.Next();
+  ASSERT_TRUE(eod.has_value());
+  EXPECT_EQ(eod->status, BNET_SIGNAL);
+  EXPECT_EQ(eod->signal, BNET_EOD);
+  EXPECT_TRUE(sent.get());
+
+  // the stream ends once all connections are gone
+  for (auto* client : clients) { client->close(); }
+  auto end = receiver.Next();
+  ASSERT_TRUE(end.has_value());
+  EXPECT_EQ(end->status, BNET_HARDEOF);
+  receiver.Close();
+}
@@ -0,0 +1,114 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+
+#include "lib/chunk_manifest.h"
+#include "lib/fastcdc.h"
+
+#include <random>
+
+namespace {
+std::vector<char> RandomData(std::size_t size, std::uint32_t seed)
+{
+  std::mt19937 gen(seed);
+  std::vector<char> data(size);
+  for (auto& c : data) { c = static_cast<char>(gen()); }
+  return data;
+}
+}  // namespace
+
+TEST(chunk_manifest, build_covers_data)
+{
+  FastCdcChunker chunker(4096);
+  auto data = RandomData(256 * 1024, 1);
+
+  auto chunks = chunk_manifest::Build(chunker, data.data(), data.size());
+  ASSERT_TRUE(chunks);
+  ASSERT_GT(chunks->size(), 1u);
+
+  std::size_t total = 0;
+  for (auto& c : *chunks) {
+    EXPECT_LE(c.size, chunker.MaxSize());
+    total += c.size;
+  }
+  EXPECT_EQ(total, data.size());
+
+  // same data, same manifest
+  auto again = chunk_manifest::Build(chunker, data.data(), data.size());
+  ASSERT_TRUE(again);
+  ASSERT_EQ(again->size(), chunks->size());
+  for (std::size_t i = 0; i < chunks->size(); ++i) {
+    EXPECT_EQ((*again)[i].size, (*chunks)[i].size);
+    EXPECT_EQ((*again)[i].digest, (*chunks)[i].digest);
+  }
+}
+
+TEST(chunk_manifest, encode_decode)
+{
+  FastCdcChunker chunker(4096);
+  chunk_manifest::batch records;
+  for (std::uint32_t seed : {2, 3}) {
+    auto data = RandomData(64 * 1024, seed);
+    auto chunks = chunk_manifest::Build(chunker, data.data(), data.size());
+    ASSERT_TRUE(chunks);
+    records.push_back(std::move(chunks).value());
+  }
+  records.emplace_back();  // records without chunks are allowed
+
+  PoolMem buffer(PM_MESSAGE);
+  auto size = chunk_manifest::Encode(records, buffer.addr());
+
+  auto decoded = chunk_manifest::Decode(buffer.c_str(), size);
+  ASSERT_TRUE(decoded);
+  ASSERT_EQ(decoded->size(), records.size());
+  for (std::size_t r = 0; r < records.size(); ++r) {
+    auto& chunks = records[r];
+    ASSERT_EQ((*decoded)[r].size(), chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      EXPECT_EQ((*decoded)[r][i].size, chunks[i].size);
+      EXPECT_EQ((*decoded)[r][i].digest, chunks[i].digest);
+    }
+  }
+
+  EXPECT_FALSE(chunk_manifest::Decode(buffer.c_str(), size - 1));
+  EXPECT_FALSE(chunk_manifest::Decode(buffer.c_str(), 2));
+
+  // trailing garbage
+  buffer.check_size(size + 1);
+  EXPECT_FALSE(chunk_manifest::Decode(buffer.c_str(), size + 1));
+}
+
+TEST(chunk_manifest, known_set)
+{
+  std::vector<bool> known{true, false, false, true, true, false, true, false,
+                          false, true, true};
+
+  PoolMem buffer(PM_MESSAGE);
+  auto size = chunk_manifest::EncodeKnown(known, buffer.addr());
+  EXPECT_EQ(size, 2u);
+
+  auto decoded = chunk_manifest::DecodeKnown(buffer.c_str(), size, known.size());
+  ASSERT_TRUE(decoded);
+  EXPECT_EQ(*decoded, known);
+
+  EXPECT_FALSE(chunk_manifest::DecodeKnown(buffer.c_str(), size, 17));
+}
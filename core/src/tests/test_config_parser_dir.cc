@@ -193,6 +193,35 @@ TEST_F(ConfigParser_Dir, foreach_res_and_reload)
   t2.join();
 }  // namespace directordaemon
 
+TEST_F(ConfigParser_Dir, RemoveAndRenameResourcesUpdateLookup)
+{
+  std::string path_to_config_file
+      = std::string("configs/bareos-configparser-tests");
+  std::unique_ptr<ConfigurationParser> dir_conf{
+      InitDirConfig(path_to_config_file.c_str(), M_ERROR_TERM)};
+  my_config = dir_conf.get();
+  my_config->ParseConfig();
+
+  ASSERT_NE(my_config->GetResWithName(R_CLIENT, "bareos-fd2"), nullptr);
+  EXPECT_TRUE(my_config->RemoveResource(R_CLIENT, "bareos-fd2"));
+  EXPECT_EQ(my_config->GetResWithName(R_CLIENT, "bareos-fd2"), nullptr);
+  EXPECT_FALSE(my_config->RemoveResource(R_CLIENT, "bareos-fd2"));
+
+  std::vector<std::string> names;
+  BareosResource* client = nullptr;
+  while ((client = my_config->GetNextRes(R_CLIENT, client))) {
+    names.push_back(client->resource_name_);
+  }
+  EXPECT_THAT(names, testing::ElementsAre("bareos-fd",
+                                          "bareos-fd-duplicate-interface",
+                                          "bareos-fd3"));
+
+  BareosResource* last = my_config->GetResWithName(R_CLIENT, "bareos-fd3");
+  my_config->RenameResource(R_CLIENT, last, "bareos-fd2");
+  EXPECT_EQ(my_config->GetResWithName(R_CLIENT, "bareos-fd3"), nullptr);
+  EXPECT_EQ(my_config->GetResWithName(R_CLIENT, "bareos-fd2"), last);
+}
+
 TEST_F(ConfigParser_Dir, runscript_test)
 {
   std::string path_to_config_file
@@ -0,0 +1,158 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+#include "include/jcr.h"
+#include "include/streams.h"
+#include "filed/verify.h"
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace filedaemon;
+
+namespace {
+class VerifyPipelineTest : public ::testing::Test {
+ protected:
+  VerifyPipeline::Sender Collect()
+  {
+    return [this](const char* msg, std::size_t length) {
+      sent.emplace_back(msg, length);
+      return true;
+    };
+  }
+
+  static std::string Attributes(uint32_t file_index)
+  {
+    return "attributes " + std::to_string(file_index);
+  }
+
+  static std::string DigestMessage(uint32_t file_index, const std::string& d)
+  {
+    return std::to_string(file_index) + " "
+           + std::to_string(STREAM_XXH128_DIGEST) + " " + d + " *XXH128-"
+           + std::to_string(file_index) + "*";
+  }
+
+  static DigestOutcome Digest(const std::string& d)
+  {
+    DigestOutcome outcome;
+    outcome.digest = d;
+    outcome.name = "XXH128";
+    return outcome;
+  }
+
+  JobControlRecord jcr;
+  thread_pool pool;
+  std::vector<std::string> sent;
+};
+}  // namespace
+
+TEST_F(VerifyPipelineTest, SendsInTheOrderFilesWereFound)
+{
+  VerifyPipeline pipeline(&jcr, pool, 4, Collect());
+
+  std::vector<std::string> expected;
+  for (uint32_t i = 1; i <= 8; ++i) {
+    std::string d = "digest" + std::to_string(i);
+    // later files are done first
+    ASSERT_TRUE(pipeline.Add(i, Attributes(i), STREAM_XXH128_DIGEST, [i, d] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5 * (9 - i)));
+      return Digest(d);
+    }));
+    expected.push_back(Attributes(i));
+    expected.push_back(DigestMessage(i, d));
+  }
+  ASSERT_TRUE(pipeline.Finish());
+
+  EXPECT_EQ(sent, expected);
+  EXPECT_EQ(jcr.JobErrors, 0u);
+}
+
+TEST_F(VerifyPipelineTest, CountsFilesThatCannotBeOpened)
+{
+  VerifyPipeline pipeline(&jcr, pool, 2, Collect());
+
+  ASSERT_TRUE(pipeline.Add(1, Attributes(1), STREAM_XXH128_DIGEST,
+                           [] { return DigestOutcome{.opened = false}; }));
+  ASSERT_TRUE(pipeline.Add(2, Attributes(2), STREAM_NONE, {}));
+  ASSERT_TRUE(pipeline.Add(3, Attributes(3), STREAM_XXH128_DIGEST,
+                           [] { return Digest("digest3"); }));
+  ASSERT_TRUE(pipeline.Finish());
+
+  // the attributes are sent anyway, the director reports the missing digest
+  EXPECT_EQ(sent, (std::vector<std::string>{Attributes(1), Attributes(2),
+                                            Attributes(3),
+                                            DigestMessage(3, "digest3")}));
+  EXPECT_EQ(jcr.JobErrors, 1u);
+}
+
+TEST_F(VerifyPipelineTest, SkipsWorkNotStartedBeforeCancel)
+{
+  VerifyPipeline pipeline(&jcr, pool, 1, Collect());
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  int started = 0;
+
+  ASSERT_TRUE(pipeline.Add(1, Attributes(1), STREAM_XXH128_DIGEST,
+                           [opened, &started] {
+                             started++;
+                             opened.wait();
+                             return Digest("digest1");
+                           }));
+  for (uint32_t i = 2; i <= 3; ++i) {
+    ASSERT_TRUE(pipeline.Add(i, Attributes(i), STREAM_XXH128_DIGEST,
+                             [&started] {
+                               started++;
+                               return Digest("never");
+                             }));
+  }
+
+  jcr.setJobStatus(JS_Canceled);
+  gate.set_value();
+
+  // more files than may be pending, so the oldest ones are sent
+  for (uint32_t i = 4; i <= 5; ++i) {
+    ASSERT_TRUE(pipeline.Add(i, Attributes(i), STREAM_XXH128_DIGEST,
+                             [&started] {
+                               started++;
+                               return Digest("never");
+                             }));
+  }
+  pipeline.Finish();
+
+  EXPECT_EQ(started, 1);
+  EXPECT_EQ(sent, (std::vector<std::string>{Attributes(1),
+                                            DigestMessage(1, "digest1")}));
+  EXPECT_EQ(jcr.JobErrors, 0u);
+}
+
+TEST_F(VerifyPipelineTest, StopsOnSendError)
+{
+  VerifyPipeline pipeline(&jcr, pool, 1,
+                          [](const char*, std::size_t) { return false; });
+
+  EXPECT_FALSE(pipeline.Add(1, Attributes(1), STREAM_NONE, {}));
+  EXPECT_FALSE(pipeline.Finish());
+}
@@ -0,0 +1,115 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+
+#include "stored/volume_index.h"
+
+using storagedaemon::VolumeIndex;
+
+namespace {
+// label block, then two interleaved sessions
+VolumeIndex SampleIndex()
+{
+  VolumeIndex index{"Full-0001"};
+  EXPECT_TRUE(index.AddBlock(0, 0, 0, 0, 0, 200));
+  EXPECT_TRUE(index.AddBlock(1, 100, 1, 3, 200, 1200));
+  EXPECT_TRUE(index.AddBlock(2, 100, 1, 1, 1200, 2200));
+  EXPECT_TRUE(index.AddBlock(1, 100, 3, 3, 2200, 3200));
+  EXPECT_TRUE(index.AddBlock(1, 100, 3, 7, 3200, 4200));
+  EXPECT_TRUE(index.AddBlock(2, 100, 1, 2, 4200, 5200));
+  return index;
+}
+}  // namespace
+
+TEST(VolumeIndex, LooksUpFirstBlockOfFile)
+{
+  VolumeIndex index = SampleIndex();
+
+  EXPECT_EQ(index.Lookup(1, 100, 1, 1), 200u);
+  EXPECT_EQ(index.Lookup(1, 100, 3, 3), 200u);
+  EXPECT_EQ(index.Lookup(1, 100, 4, 4), 3200u);
+  EXPECT_EQ(index.Lookup(1, 100, 5, 10), 3200u);
+  EXPECT_EQ(index.Lookup(2, 100, 2, 2), 4200u);
+}
+
+TEST(VolumeIndex, UnknownFilesAreNotFound)
+{
+  VolumeIndex index = SampleIndex();
+
+  EXPECT_FALSE(index.Lookup(1, 100, 8, 9));
+  EXPECT_FALSE(index.Lookup(1, 101, 1, 1));
+  EXPECT_FALSE(index.Lookup(3, 100, 1, 1));
+}
+
+TEST(VolumeIndex, SkipsContinuationBlocks)
+{
+  VolumeIndex index = SampleIndex();
+
+  // the block at 2200 only continues file 3 of session 1
+  EXPECT_EQ(index.Entries().size(), 4u);
+  EXPECT_EQ(index.CoveredUntil(), 5200u);
+  EXPECT_TRUE(index.Dirty());
+}
+
+TEST(VolumeIndex, RejectsGaps)
+{
+  VolumeIndex index{"Full-0001"};
+
+  EXPECT_FALSE(index.AddBlock(1, 100, 1, 1, 200, 1200));
+  EXPECT_TRUE(index.AddBlock(0, 0, 0, 0, 0, 200));
+  EXPECT_FALSE(index.AddBlock(1, 100, 1, 1, 300, 1300));
+  EXPECT_FALSE(index.AddBlock(1, 100, 1, 1, 200, 200));
+  EXPECT_EQ(index.CoveredUntil(), 200u);
+}
+
+TEST(VolumeIndex, SerializeRoundtrip)
+{
+  VolumeIndex index = SampleIndex();
+  std::vector<char> data = index.Serialize();
+
+  std::optional restored = VolumeIndex::Deserialize("Full-0001", data);
+  ASSERT_TRUE(restored);
+  EXPECT_EQ(restored->VolumeName(), "Full-0001");
+  EXPECT_EQ(restored->CoveredUntil(), index.CoveredUntil());
+  EXPECT_EQ(restored->Entries().size(), index.Entries().size());
+  EXPECT_FALSE(restored->Dirty());
+  EXPECT_EQ(restored->Lookup(1, 100, 4, 4), 3200u);
+  EXPECT_EQ(restored->Lookup(2, 100, 2, 2), 4200u);
+
+  // an index can be extended after loading it
+  EXPECT_TRUE(restored->AddBlock(2, 100, 3, 3, 5200, 6200));
+  EXPECT_EQ(restored->Lookup(2, 100, 3, 3), 5200u);
+}
+
+TEST(VolumeIndex, RejectsDamagedData)
+{
+  std::vector<char> data = SampleIndex().Serialize();
+
+  std::vector<char> truncated(data.begin(), data.end() - 1);
+  EXPECT_FALSE(VolumeIndex::Deserialize("Full-0001", truncated));
+
+  std::vector<char> bad_magic = data;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(VolumeIndex::Deserialize("Full-0001", bad_magic));
+
+  EXPECT_FALSE(VolumeIndex::Deserialize("Full-0001", {}));
+}
@@ -0,0 +1,80 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "gtest/gtest.h"
+#include "include/bareos.h"
+
+#include "stored/volume_prefetch.h"
+#include "tests/temporary_directory.h"
+
+#include <filesystem>
+#include <fstream>
+
+using storagedaemon::VolumePrefetcher;
+
+class VolumePrefetch : public TemporaryDirectoryTest {
+ protected:
+  std::string Create(const std::string& name, std::size_t size)
+  {
+    auto path = dir / name;
+    std::ofstream(path) << std::string(size, 'x');
+    return path.string();
+  }
+};
+
+TEST_F(VolumePrefetch, ReadsUpcomingVolumesOnly)
+{
+  std::vector<VolumePrefetcher::Volume> volumes{
+      {Create("Full-0001", 1000), {}},
+      {Create("Incr-0002", 2000), {}},
+      {Create("Incr-0003", 3000), {}},
+      {Create("Incr-0004", 4000), {}},
+  };
+
+  // the job reads the first volume, two more are read ahead
+  VolumePrefetcher prefetcher{volumes, 2, 1024 * 1024};
+  prefetcher.Finish();
+  EXPECT_EQ(prefetcher.BytesRequested(), 2000u + 3000u);
+}
+
+TEST_F(VolumePrefetch, HonorsRangesAndWindow)
+{
+  std::vector<VolumePrefetcher::Volume> volumes{
+      {Create("Full-0001", 1000), {}},
+      {Create("Incr-0002", 10000), {{100, 200}, {5000, 9000}}},
+      {(dir / "missing").string(), {}},
+  };
+
+  VolumePrefetcher prefetcher{volumes, 4, 1100};
+  prefetcher.Finish();
+  EXPECT_EQ(prefetcher.BytesRequested(), 1100u);
+}
+
+TEST_F(VolumePrefetch, StopsWhenDestroyed)
+{
+  std::vector<VolumePrefetcher::Volume> volumes;
+  for (int i = 0; i < 20; ++i) {
+    volumes.push_back({Create("Vol-" + std::to_string(i), 100000), {}});
+  }
+
+  auto prefetcher = std::make_unique<VolumePrefetcher>(volumes, 3, 100000);
+  prefetcher->Advance(10);
+  prefetcher.reset();
+}
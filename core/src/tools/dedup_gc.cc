@@ -0,0 +1,107 @@
+/*
+   BAREOS® - Backup Archiving REcovery Open Sourced
+
+   Copyright (C) 2026-2026 Bareos GmbH & Co. KG
+
+   This program is Free Software; you can redistribute it and/or
+   modify it under the terms of version three of the GNU Affero General Public
+   License as published by the Free Software Foundation and included
+   in the file LICENSE.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Affero General Public License for more details.
+
+   You should have received a copy of the GNU Affero General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.
+*/
+#include "lib/cli.h"
+#include "lib/version.h"
+#include "lib/edit.h"
+
+#include "stored/backends/dedupable/chunk_store.h"
+
+#include <iostream>
+#include <filesystem>
+
+namespace {
+std::string AsSize(std::uint64_t bytes)
+{
+  char buffer[edit::min_buffer_size];
+  return std::string{edit_uint64_with_suffix(bytes, buffer)} + "B";
+}
+
+void PrintStatistics(const dedup::chunk_store::statistics& stats)
+{
+  std::cout << "Chunks: " << stats.chunks << " ("
+            << stats.unreferenced_chunks << " unreferenced)\n"
+            << "  Referenced data: " << AsSize(stats.referenced_bytes) << "\n"
+            << "  Stored data: " << AsSize(stats.stored_bytes) << "\n"
+            << "  Containers: " << stats.containers << " ("
+            << AsSize(stats.container_bytes) << ")\n";
+  if (stats.stored_bytes > 0) {
+    char factor[100];
+    snprintf(factor, sizeof(factor), "%.2lf",
+             (double)stats.referenced_bytes / (double)stats.stored_bytes);
+    std::cout << "  Dedup factor: " << factor << "x\n";
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  CLI::App app;
+  std::string desc(1024, '\0');
+  kBareosVersionStrings.FormatCopyright(desc.data(), desc.size(), 2026);
+  desc.resize(strlen(desc.c_str()));
+  desc += "The Bareos Dedup Chunk Store Garbage Collector";
+  InitCLIApp(app, desc, 0);
+
+  std::string store_path;
+  app.add_option("-s,--store,store", store_path,
+                 "Path of the chunk store (the \"Chunk Store\" device option).")
+      ->check(CLI::ExistingDirectory)
+      ->required();
+
+  bool dry_run = false;
+  app.add_flag("-n,--dry-run", dry_run,
+               "Only report what would be done without changing anything.");
+
+  bool stats_only = false;
+  app.add_flag("--stats", stats_only,
+               "Only print statistics of the chunk store.");
+
+  unsigned int min_live_percent = 50;
+  app.add_option("-l,--min-live", min_live_percent,
+                 "Containers with less than this percentage of live data get "
+                 "compacted.")
+      ->check(CLI::Range(0, 100))
+      ->type_name("<percent>");
+
+  CLI11_PARSE(app, argc, argv);
+
+  try {
+    auto store = dedup::chunk_store::open(store_path);
+
+    if (!stats_only) {
+      auto res = store->CollectGarbage(min_live_percent / 100.0, dry_run);
+      std::cout << (dry_run ? "Would remove " : "Removed ")
+                << res.chunks_removed << " unreferenced chunks.\n"
+                << "  Containers removed: " << res.containers_removed << "\n"
+                << "  Containers compacted: " << res.containers_compacted
+                << " (" << AsSize(res.bytes_moved) << " moved)\n"
+                << "  Space freed: " << AsSize(res.bytes_freed) << "\n";
+    }
+
+    PrintStatistics(store->stats());
+  } catch (const std::exception& ex) {
+    std::cerr << "Could not collect garbage in chunk store '" << store_path
+              << "'. Err=" << ex.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}